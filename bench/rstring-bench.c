@@ -0,0 +1,721 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ */
+
+/*
+ * Benchmarks of the hot paths of the library, against the C library where it
+ * has an equivalent.
+ *
+ * Every benchmark runs over a sweep of sizes and several distributions of
+ * contents, and the results are printed to stdout as a single JSON document,
+ * one object per (group, impl, dist, size), so that runs of two releases can
+ * be compared by a script.
+ *
+ * Usage: rstring-bench [--quick] [--filter SUBSTRING] [--min-time MS]
+ */
+
+#define _GNU_SOURCE /* memmem, memrchr, strcasestr */
+
+#include <ctype.h>  /* tolower, toupper */
+#include <stdio.h>  /* printf, fprintf */
+#include <stdlib.h> /* malloc, realloc, free, strtoul */
+#include <string.h> /* memcmp, memmem, strcasecmp, ... */
+#include <time.h>   /* clock_gettime */
+
+#include "../rstring.h"
+
+/*
+ * Bytes no distribution uses in its body: the haystacks end with the last one,
+ * so that searches for them scan everything.
+ */
+#define BENCH_MARKERS "~|"
+#define BENCH_MARKER  '|'
+
+/* Length of the needles searched for */
+#define BENCH_NEEDLE_LEN 8
+
+/* Timed batches per benchmark, of which the fastest is reported */
+#define BENCH_BATCHES 5
+
+/*----------------------------------------------------------------------------*/
+
+enum bench_dist
+{
+    BENCH_DIST_RANDOM,     /* Uniform lower case letters */
+    BENCH_DIST_TEXT,       /* English-like words, some capitalized */
+    BENCH_DIST_REPETITIVE, /* A single byte, the worst case of naive search */
+    BENCH_DIST_BINARY,     /* Uniform bytes, null bytes included */
+    BENCH_DIST_COUNT,
+};
+
+static const char *const bench_dist_names[BENCH_DIST_COUNT] = {
+    "random",
+    "text",
+    "repetitive",
+    "binary",
+};
+
+/*
+ * The inputs of a benchmark, for a given distribution and size.
+ */
+struct bench_input
+{
+    struct rstring          hay;  /* Body, then the needle and BENCH_MARKER */
+    struct rstring          rhay; /* BENCH_MARKER, the needle, then the body */
+    struct rstring          needle;
+    struct rstring          needle_upper;
+    struct rstring          other;       /* |hay| but for its last byte */
+    struct rstring          other_upper; /* Upper case variant of |other| */
+    struct rstring          scratch;     /* Converted in place */
+    struct rstring_finder   finder;
+    struct rstring_finder   finder_ignore_case;
+    struct rstring_byte_set set;
+};
+
+typedef size_t
+bench_fn(struct bench_input *in);
+
+struct bench
+{
+    const char *group;
+    const char *impl;
+    bench_fn   *fn;
+    bool        binary_safe; /* Not stopped by null bytes */
+};
+
+/* Written by every iteration, so that no call is optimized away */
+static volatile size_t bench_sink;
+
+/*----------------------------------------------------------------------------*/
+/*                                 GENERATION                                 */
+/*----------------------------------------------------------------------------*/
+
+static uint64_t bench_rng_state = 0x9E3779B97F4A7C15;
+
+/* xorshift64*, so that every run measures the same contents */
+static uint64_t
+bench_rng(void)
+{
+    bench_rng_state ^= bench_rng_state >> 12;
+    bench_rng_state ^= bench_rng_state << 25;
+    bench_rng_state ^= bench_rng_state >> 27;
+    return bench_rng_state * 0x2545F4914F6CDD1D;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+bench_push_body(struct rstring *rs, enum bench_dist dist, size_t n)
+{
+    static const char *const words[] = {
+        "the",    "of",     "and",    "to",     "in",   "is",     "that",
+        "for",    "it",     "as",     "with",   "was",  "on",     "be",
+        "by",     "string", "buffer", "search", "find", "memory", "vector",
+        "length", "byte",   "case",   "lower",  "upper"};
+    const size_t n_words = sizeof(words) / sizeof(words[0]);
+    const size_t end     = rs->len + n;
+
+    while (rs->len < end)
+    {
+        switch (dist)
+        {
+        case BENCH_DIST_RANDOM:
+            rstring_push_byte(rs, 'a' + bench_rng() % 26);
+            break;
+
+        case BENCH_DIST_TEXT:
+        {
+            const char *word        = words[bench_rng() % n_words];
+            const bool  capitalized = bench_rng() % 8 == 0;
+
+            for (size_t i = 0; word[i] != '\0' && rs->len < end; ++i)
+            {
+                const char c = word[i];
+                rstring_push_byte(rs, i == 0 && capitalized ? toupper(c) : c);
+            }
+
+            if (rs->len < end)
+            {
+                rstring_push_byte(rs, bench_rng() % 12 == 0 ? '\n' : ' ');
+            }
+            break;
+        }
+
+        case BENCH_DIST_REPETITIVE:
+            rstring_push_byte(rs, 'a');
+            break;
+
+        case BENCH_DIST_BINARY:
+        {
+            const uint8_t byte = (uint8_t) bench_rng();
+
+            if (strchr(BENCH_MARKERS, byte) == NULL || byte == '\0')
+            {
+                rstring_push_byte(rs, byte);
+            }
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+bench_input_init(struct bench_input *in, enum bench_dist dist, size_t size)
+{
+    rstring_init(&in->hay);
+    rstring_init(&in->rhay);
+    rstring_init(&in->needle);
+    rstring_init(&in->needle_upper);
+    rstring_init(&in->other);
+    rstring_init(&in->other_upper);
+    rstring_init(&in->scratch);
+
+    if (dist == BENCH_DIST_TEXT)
+    {
+        rstring_push_str(&in->needle, "zeppelin");
+    }
+    else if (dist == BENCH_DIST_REPETITIVE)
+    {
+        rstring_push_str(&in->needle, "aaaaaaab");
+    }
+    else
+    {
+        bench_push_body(&in->needle, dist, BENCH_NEEDLE_LEN);
+    }
+
+    rstring_push(&in->needle_upper, &in->needle);
+    rstring_toupper(&in->needle_upper);
+
+    const size_t body = size - BENCH_NEEDLE_LEN - 1;
+
+    bench_push_body(&in->hay, dist, body);
+    rstring_push(&in->hay, &in->needle);
+    rstring_push_byte(&in->hay, BENCH_MARKER);
+
+    rstring_push_byte(&in->rhay, BENCH_MARKER);
+    rstring_push(&in->rhay, &in->needle);
+    bench_push_body(&in->rhay, dist, body);
+
+    /* Equal to |hay| up to the last byte, so that comparisons scan it all */
+    rstring_push_view(&in->other,
+                      rstring_view_from_buf(rstring_data(&in->hay), body));
+    rstring_push(&in->other, &in->needle);
+    rstring_push_byte(&in->other, '~');
+
+    rstring_push(&in->other_upper, &in->other);
+    rstring_toupper(&in->other_upper);
+
+    rstring_push(&in->scratch, &in->hay);
+
+    rstring_finder_compile(&in->finder, &in->needle);
+    rstring_finder_compile_ignore_case(&in->finder_ignore_case,
+                                       &in->needle_upper);
+    rstring_byte_set_init(&in->set, rstring_view_from_str(BENCH_MARKERS));
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+bench_input_free(struct bench_input *in)
+{
+    rstring_free(&in->hay);
+    rstring_free(&in->rhay);
+    rstring_free(&in->needle);
+    rstring_free(&in->needle_upper);
+    rstring_free(&in->other);
+    rstring_free(&in->other_upper);
+    rstring_free(&in->scratch);
+    rstring_finder_free(&in->finder);
+    rstring_finder_free(&in->finder_ignore_case);
+}
+
+/*----------------------------------------------------------------------------*/
+/*                                 BENCHMARKS                                 */
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_push_byte(struct bench_input *in)
+{
+    struct rstring rs;
+
+    rstring_init(&rs);
+    for (size_t i = 0; i < in->hay.len; ++i)
+    {
+        rstring_push_byte(&rs, rstring_data(&in->hay)[i]);
+    }
+
+    const size_t len = rs.len;
+    rstring_free(&rs);
+    return len;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_push_view(struct bench_input *in)
+{
+    const char    *hay = rstring_data(&in->hay);
+    struct rstring rs;
+
+    rstring_init(&rs);
+    for (size_t i = 0; i < in->hay.len; i += 16)
+    {
+        const size_t n = in->hay.len - i < 16 ? in->hay.len - i : 16;
+        rstring_push_view(&rs, rstring_view_from_buf(hay + i, n));
+    }
+
+    const size_t len = rs.len;
+    rstring_free(&rs);
+    return len;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* The usual hand-rolled buffer, doubled by realloc */
+static size_t
+bench_push_view_libc(struct bench_input *in)
+{
+    char  *buf = NULL;
+    size_t len = 0;
+    size_t cap = 0;
+
+    for (size_t i = 0; i < in->hay.len; i += 16)
+    {
+        const size_t n = in->hay.len - i < 16 ? in->hay.len - i : 16;
+
+        if (len + n + 1 > cap)
+        {
+            cap = cap == 0 ? 32 : cap * 2;
+            buf = realloc(buf, cap);
+        }
+        memcpy(buf + len, rstring_data(&in->hay) + i, n);
+        len += n;
+        buf[len] = '\0';
+    }
+
+    free(buf);
+    return len;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_find_first_byte(struct bench_input *in)
+{
+    return rstring_find_first_byte(&in->hay, BENCH_MARKER, 0);
+}
+
+static size_t
+bench_find_first_byte_libc(struct bench_input *in)
+{
+    const char *hay = rstring_data(&in->hay);
+
+    return (const char *) memchr(hay, BENCH_MARKER, in->hay.len) - hay;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_find_last_byte(struct bench_input *in)
+{
+    return rstring_find_last_byte(&in->rhay, BENCH_MARKER);
+}
+
+static size_t
+bench_find_last_byte_libc(struct bench_input *in)
+{
+    const char *rhay = rstring_data(&in->rhay);
+
+    return (const char *) memrchr(rhay, BENCH_MARKER, in->rhay.len) - rhay;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_find_first_of(struct bench_input *in)
+{
+    return rstring_view_find_first_of(rstring_view_from(&in->hay), &in->set,
+                                      0);
+}
+
+static size_t
+bench_find_first_of_libc(struct bench_input *in)
+{
+    return strcspn(rstring_data(&in->hay), BENCH_MARKERS);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_find_first(struct bench_input *in)
+{
+    return rstring_find_first(&in->hay, &in->needle, 0);
+}
+
+static size_t
+bench_find_first_libc(struct bench_input *in)
+{
+    const char *hay = rstring_data(&in->hay);
+
+    return (const char *) memmem(hay, in->hay.len, rstring_data(&in->needle),
+                                 in->needle.len)
+         - hay;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_find_first_str(struct bench_input *in)
+{
+    return rstring_find_first_str(&in->hay, rstring_data(&in->needle), 0);
+}
+
+static size_t
+bench_find_first_str_libc(struct bench_input *in)
+{
+    const char *hay = rstring_data(&in->hay);
+
+    return strstr(hay, rstring_data(&in->needle)) - hay;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_find_first_ignore_case(struct bench_input *in)
+{
+    return rstring_find_first_ignore_case(&in->hay, &in->needle_upper, 0);
+}
+
+static size_t
+bench_find_first_ignore_case_libc(struct bench_input *in)
+{
+    const char *hay = rstring_data(&in->hay);
+
+    return strcasestr(hay, rstring_data(&in->needle_upper)) - hay;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_find_last(struct bench_input *in)
+{
+    return rstring_find_last(&in->rhay, &in->needle, in->rhay.len);
+}
+
+static size_t
+bench_find_last_ignore_case(struct bench_input *in)
+{
+    return rstring_find_last_ignore_case(&in->rhay, &in->needle_upper,
+                                         in->rhay.len);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_finder_find(struct bench_input *in)
+{
+    return rstring_finder_find(&in->finder, &in->hay, 0);
+}
+
+static size_t
+bench_finder_find_ignore_case(struct bench_input *in)
+{
+    return rstring_finder_find(&in->finder_ignore_case, &in->hay, 0);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_cmp(struct bench_input *in)
+{
+    return (size_t) rstring_cmp(&in->hay, &in->other);
+}
+
+static size_t
+bench_cmp_libc(struct bench_input *in)
+{
+    return (size_t) memcmp(
+        rstring_data(&in->hay), rstring_data(&in->other), in->hay.len);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_cmp_ignore_case(struct bench_input *in)
+{
+    return (size_t) rstring_cmp_ignore_case(&in->hay, &in->other_upper);
+}
+
+static size_t
+bench_cmp_ignore_case_libc(struct bench_input *in)
+{
+    return (size_t) strcasecmp(rstring_data(&in->hay),
+                               rstring_data(&in->other_upper));
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_equals(struct bench_input *in)
+{
+    return rstring_equals(&in->hay, &in->other);
+}
+
+static size_t
+bench_common_prefix(struct bench_input *in)
+{
+    return rstring_common_prefix(&in->hay, &in->other);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_tolower(struct bench_input *in)
+{
+    rstring_tolower(&in->scratch);
+    return (uint8_t) rstring_data(&in->scratch)[0];
+}
+
+static size_t
+bench_tolower_libc(struct bench_input *in)
+{
+    char *p = rstring_data_mut(&in->scratch);
+
+    for (size_t i = 0; i < in->scratch.len; ++i)
+    {
+        p[i] = (char) tolower((uint8_t) p[i]);
+    }
+    return (uint8_t) p[0];
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+bench_toupper(struct bench_input *in)
+{
+    rstring_toupper(&in->scratch);
+    return (uint8_t) rstring_data(&in->scratch)[0];
+}
+
+static size_t
+bench_toupper_libc(struct bench_input *in)
+{
+    char *p = rstring_data_mut(&in->scratch);
+
+    for (size_t i = 0; i < in->scratch.len; ++i)
+    {
+        p[i] = (char) toupper((uint8_t) p[i]);
+    }
+    return (uint8_t) p[0];
+}
+
+/*----------------------------------------------------------------------------*/
+
+static const struct bench benches[] = {
+    {"push_byte", "rstring", bench_push_byte, true},
+    {"push_view", "rstring", bench_push_view, true},
+    {"push_view", "libc", bench_push_view_libc, true},
+    {"find_first_byte", "rstring", bench_find_first_byte, true},
+    {"find_first_byte", "libc", bench_find_first_byte_libc, true},
+    {"find_last_byte", "rstring", bench_find_last_byte, true},
+    {"find_last_byte", "libc", bench_find_last_byte_libc, true},
+    {"find_first_of", "rstring", bench_find_first_of, true},
+    {"find_first_of", "libc", bench_find_first_of_libc, false},
+    {"find_first", "rstring", bench_find_first, true},
+    {"find_first", "libc", bench_find_first_libc, true},
+    {"find_first_str", "rstring", bench_find_first_str, false},
+    {"find_first_str", "libc", bench_find_first_str_libc, false},
+    {"find_first_ignore_case", "rstring", bench_find_first_ignore_case, true},
+    {"find_first_ignore_case", "libc", bench_find_first_ignore_case_libc,
+     false},
+    {"find_last", "rstring", bench_find_last, true},
+    {"find_last_ignore_case", "rstring", bench_find_last_ignore_case, true},
+    {"finder_find", "rstring", bench_finder_find, true},
+    {"finder_find_ignore_case", "rstring", bench_finder_find_ignore_case,
+     true},
+    {"cmp", "rstring", bench_cmp, true},
+    {"cmp", "libc", bench_cmp_libc, true},
+    {"cmp_ignore_case", "rstring", bench_cmp_ignore_case, true},
+    {"cmp_ignore_case", "libc", bench_cmp_ignore_case_libc, false},
+    {"equals", "rstring", bench_equals, true},
+    {"common_prefix", "rstring", bench_common_prefix, true},
+    {"tolower", "rstring", bench_tolower, true},
+    {"tolower", "libc", bench_tolower_libc, true},
+    {"toupper", "rstring", bench_toupper, true},
+    {"toupper", "libc", bench_toupper_libc, true},
+};
+
+/*----------------------------------------------------------------------------*/
+/*                                   DRIVER                                   */
+/*----------------------------------------------------------------------------*/
+
+static double
+bench_now_ns(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e9 + (double) ts.tv_nsec;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static double
+bench_batch_ns(const struct bench *b, struct bench_input *in, size_t iters)
+{
+    const double start = bench_now_ns();
+
+    for (size_t i = 0; i < iters; ++i)
+    {
+        /* Keeps the compiler from hoisting calls it proves pure */
+        __asm__ volatile("" : : "r"(in) : "memory");
+        bench_sink = b->fn(in);
+    }
+
+    return bench_now_ns() - start;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Returns the fastest time per call, in nanoseconds, of batches lasting about
+ * |min_ns| / BENCH_BATCHES each, and the number of calls per batch.
+ */
+static double
+bench_measure(const struct bench *b, struct bench_input *in, double min_ns,
+              size_t *iters)
+{
+    const double target = min_ns / BENCH_BATCHES;
+
+    /* Calibrate, which also warms up the caches and the branch predictors */
+    *iters = 1;
+    for (;;)
+    {
+        const double elapsed = bench_batch_ns(b, in, *iters);
+        if (elapsed >= target)
+        {
+            break;
+        }
+
+        *iters = elapsed * 8 < target ? *iters * 8 : *iters * 2;
+    }
+
+    double best = -1;
+    for (int batch = 0; batch < BENCH_BATCHES; ++batch)
+    {
+        const double per_call = bench_batch_ns(b, in, *iters) / *iters;
+        if (best < 0 || per_call < best)
+        {
+            best = per_call;
+        }
+    }
+
+    return best;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+bench_usage(const char *argv0)
+{
+    fprintf(stderr,
+            "usage: %s [--quick] [--filter SUBSTRING] [--min-time MS]\n"
+            "  --quick      fewer sizes and shorter runs\n"
+            "  --filter     only run the groups containing SUBSTRING\n"
+            "  --min-time   time spent per measurement, 50 ms by default\n",
+            argv0);
+}
+
+/*----------------------------------------------------------------------------*/
+
+int
+main(int argc, char **argv)
+{
+    static const size_t sizes[]       = {16, 64, 256, 1024, 4096, 65536,
+                                         1 << 20};
+    static const size_t quick_sizes[] = {64, 4096, 65536};
+
+    const size_t *sweep   = sizes;
+    size_t        n_sizes = sizeof(sizes) / sizeof(sizes[0]);
+    const char   *filter  = NULL;
+    unsigned long min_ms  = 50;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--quick") == 0)
+        {
+            sweep   = quick_sizes;
+            n_sizes = sizeof(quick_sizes) / sizeof(quick_sizes[0]);
+            min_ms  = 10;
+        }
+        else if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc)
+        {
+            filter = argv[++i];
+        }
+        else if (strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+        {
+            min_ms = strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+
+    printf("{\n");
+    printf("  \"benchmark\": \"rstring-bench\",\n");
+#ifdef RSTRING_NO_SIMD
+    printf("  \"simd\": false,\n");
+#else
+    printf("  \"simd\": true,\n");
+#endif
+    printf("  \"min_time_ms\": %lu,\n", min_ms);
+    printf("  \"results\": [");
+
+    bool first = true;
+    for (int dist = 0; dist < BENCH_DIST_COUNT; ++dist)
+    {
+        for (size_t s = 0; s < n_sizes; ++s)
+        {
+            struct bench_input in;
+
+            bench_input_init(&in, (enum bench_dist) dist, sweep[s]);
+
+            for (size_t i = 0; i < sizeof(benches) / sizeof(benches[0]); ++i)
+            {
+                const struct bench *b = &benches[i];
+
+                if ((filter != NULL && strstr(b->group, filter) == NULL)
+                    || (dist == BENCH_DIST_BINARY && !b->binary_safe))
+                {
+                    continue;
+                }
+
+                size_t       iters;
+                const double ns = bench_measure(b, &in, min_ms * 1e6, &iters);
+
+                printf("%s\n    {\"group\": \"%s\", \"impl\": \"%s\", "
+                       "\"dist\": \"%s\", \"size\": %zu, "
+                       "\"iterations\": %zu, \"ns_per_op\": %.3f, "
+                       "\"gb_per_s\": %.3f}",
+                       first ? "" : ",", b->group, b->impl,
+                       bench_dist_names[dist], in.hay.len, iters, ns,
+                       in.hay.len / ns);
+                fflush(stdout);
+                first = false;
+            }
+
+            bench_input_free(&in);
+        }
+    }
+
+    printf("\n  ]\n}\n");
+    return 0;
+}
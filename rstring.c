@@ -7,299 +7,3761 @@
  * Subroutines related to the 'rstring' data structure.
  */
 
-#include <stdlib.h> /* malloc, realloc */
+#include <stdlib.h> /* malloc, realloc, free */
 
 #include <string.h>  /* strlen, memcpy */
-#include <strings.h> /* strncasecmp*/
 #include <ctype.h>   /* tolower, toupper */
 
 #include "rstring.h"
+#include "rstring_internal.h"
 
 /*----------------------------------------------------------------------------*/
-/* STATIC BUFFERS                                                             */
+/* INTERNAL MACROS                                                            */
+/*----------------------------------------------------------------------------*/
+
+#define ONE_BYTE 0xFFU
+
+/* Page size and malloc header size the `RSTRING_GROWTH_PAGES` policy assumes */
+#define GROWTH_PAGE_SIZE     4096
+#define GROWTH_MALLOC_HEADER (2 * sizeof(size_t))
+
+/* Pieces whose lengths rstring_internal_join_str keeps on the stack */
+#define JOIN_STR_BATCH 32
+
+/*----------------------------------------------------------------------------*/
+/* SEARCH KERNELS                                                             */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * A needle, as seen by the search kernels. |probe1| and |probe2| are the
+ * offsets of two needle bytes used to filter candidate positions; plain
+ * searches probe the first and the last byte, compiled finders probe the two
+ * rarest bytes instead.
+ */
+struct rstring_internal_needle
+{
+    const uint8_t *ptr;
+    size_t         len;
+    size_t         probe1;
+    size_t         probe2;
+    bool           ignore_case;
+};
+
+/*
+ * All kernels share the same contract: find the first offset in which |needle|
+ * occurs inside |hay|, where 1 <= |needle->len| <= |hay_len|. Both buffers are
+ * treated as raw bytes - null bytes have no special meaning.
+ *
+ * The vectorized kernels compare a block of the haystack starting at
+ * |probe1| against the needle's byte at |probe1|, and the block starting at
+ * |probe2| against the needle's byte at |probe2|. Only positions where both
+ * match are verified with a full comparison.
+ */
+typedef size_t (*rstring_internal_search_fn)(
+    const uint8_t *hay, size_t hay_len,
+    const struct rstring_internal_needle *needle);
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Scalar search over the positions [start, last], used both as the portable
+ * kernel and for the tails the vectorized kernels leave behind.
+ */
+static size_t
+rstring_internal_search_range(const uint8_t *hay, size_t start, size_t last,
+                              const struct rstring_internal_needle *needle)
+{
+    const size_t  probe = needle->probe1;
+    const uint8_t byte  = needle->ptr[probe];
+    const uint8_t fold  = rstring_internal_fold(byte);
+
+    for (size_t i = start; i <= last; ++i)
+    {
+        if (!needle->ignore_case)
+        {
+            const uint8_t *p = memchr(hay + i + probe, byte, last - i + 1);
+            if (p == NULL)
+            {
+                return RSTRING_NOT_FOUND;
+            }
+            i = p - hay - probe;
+        }
+        else if (rstring_internal_fold(hay[i + probe]) != fold)
+        {
+            continue;
+        }
+
+        if (rstring_internal_memeq(
+                hay + i, needle->ptr, needle->len, needle->ignore_case))
+        {
+            return i;
+        }
+    }
+
+    return RSTRING_NOT_FOUND;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_search_scalar(const uint8_t *hay, size_t hay_len,
+                               const struct rstring_internal_needle *needle)
+{
+    return rstring_internal_search_range(hay, 0, hay_len - needle->len, needle);
+}
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef RSTRING_HAVE_X86_SIMD
+
+/*
+ * Verifies the candidates in |mask| (bit k set means the position |base| + k
+ * matched on both probes). Returns the first verified position.
+ */
+static inline size_t
+rstring_internal_verify_mask(uint32_t mask, const uint8_t *hay, size_t base,
+                             const struct rstring_internal_needle *needle)
+{
+    while (mask)
+    {
+        const size_t pos = base + (size_t) __builtin_ctz(mask);
+
+        if (rstring_internal_memeq(
+                hay + pos, needle->ptr, needle->len, needle->ignore_case))
+        {
+            return pos;
+        }
+
+        mask &= mask - 1;
+    }
+
+    return RSTRING_NOT_FOUND;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Candidate mask for the 16 positions starting at |p|: bit k is set when both
+ * probes of the needle match at |p| + k.
+ *
+ * Case-folded variants compare every haystack byte against both the lower and
+ * upper case of the needle's byte; for non-letters both are the same byte.
+ */
+__attribute__((always_inline)) static inline uint32_t
+rstring_internal_candidates_sse2(const uint8_t *p, size_t off1, size_t off2,
+                                 __m128i v1, __m128i v1_swap, __m128i v2,
+                                 __m128i v2_swap, bool ignore_case)
+{
+    const __m128i a = _mm_loadu_si128((const __m128i *) (p + off1));
+    const __m128i b = _mm_loadu_si128((const __m128i *) (p + off2));
+    __m128i       eq1;
+    __m128i       eq2;
+
+    if (ignore_case)
+    {
+        eq1 = _mm_or_si128(_mm_cmpeq_epi8(a, v1), _mm_cmpeq_epi8(a, v1_swap));
+        eq2 = _mm_or_si128(_mm_cmpeq_epi8(b, v2), _mm_cmpeq_epi8(b, v2_swap));
+    }
+    else
+    {
+        eq1 = _mm_cmpeq_epi8(a, v1);
+        eq2 = _mm_cmpeq_epi8(b, v2);
+    }
+
+    return (uint32_t) _mm_movemask_epi8(_mm_and_si128(eq1, eq2));
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_search_sse2(const uint8_t *hay, size_t hay_len,
+                             const struct rstring_internal_needle *needle)
+{
+    const size_t last_pos = hay_len - needle->len;
+    const size_t off1     = needle->probe1;
+    const size_t off2     = needle->probe2;
+    uint8_t      b1       = needle->ptr[off1];
+    uint8_t      b2       = needle->ptr[off2];
+    size_t       i        = 0;
+
+    if (needle->ignore_case)
+    {
+        b1 = rstring_internal_fold(b1);
+        b2 = rstring_internal_fold(b2);
+    }
+
+    const __m128i v1 = _mm_set1_epi8((char) b1);
+    const __m128i v2 = _mm_set1_epi8((char) b2);
+    const __m128i v1_swap =
+        _mm_set1_epi8((char) rstring_internal_swap_case(b1));
+    const __m128i v2_swap =
+        _mm_set1_epi8((char) rstring_internal_swap_case(b2));
+
+    for (; i + 16 <= last_pos + 1; i += 16)
+    {
+        const uint32_t mask = rstring_internal_candidates_sse2(
+            hay + i, off1, off2, v1, v1_swap, v2, v2_swap, needle->ignore_case);
+
+        if (mask)
+        {
+            const size_t pos =
+                rstring_internal_verify_mask(mask, hay, i, needle);
+            if (pos != RSTRING_NOT_FOUND)
+            {
+                return pos;
+            }
+        }
+    }
+
+    if (i > last_pos)
+    {
+        return RSTRING_NOT_FOUND;
+    }
+
+    return rstring_internal_search_range(hay, i, last_pos, needle);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Candidate mask for the 32 positions starting at |p|: bit k is set when both
+ * probes of the needle match at |p| + k.
+ */
+__attribute__((target("avx2"), always_inline)) static inline uint32_t
+rstring_internal_candidates_avx2(const uint8_t *p, size_t off1, size_t off2,
+                                 __m256i v1, __m256i v1_swap, __m256i v2,
+                                 __m256i v2_swap, bool ignore_case)
+{
+    const __m256i a = _mm256_loadu_si256((const __m256i *) (p + off1));
+    const __m256i b = _mm256_loadu_si256((const __m256i *) (p + off2));
+    __m256i       eq1;
+    __m256i       eq2;
+
+    if (ignore_case)
+    {
+        eq1 = _mm256_or_si256(_mm256_cmpeq_epi8(a, v1),
+                              _mm256_cmpeq_epi8(a, v1_swap));
+        eq2 = _mm256_or_si256(_mm256_cmpeq_epi8(b, v2),
+                              _mm256_cmpeq_epi8(b, v2_swap));
+    }
+    else
+    {
+        eq1 = _mm256_cmpeq_epi8(a, v1);
+        eq2 = _mm256_cmpeq_epi8(b, v2);
+    }
+
+    return (uint32_t) _mm256_movemask_epi8(_mm256_and_si256(eq1, eq2));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Processes 64 positions per iteration. |ignore_case| is always a constant at
+ * the call sites below, so each mode gets its own branch-free loop.
+ */
+__attribute__((target("avx2"), always_inline)) static inline size_t
+rstring_internal_search_avx2_loop(const uint8_t *hay, size_t hay_len,
+                                  const struct rstring_internal_needle *needle,
+                                  bool ignore_case)
+{
+    const size_t last_pos = hay_len - needle->len;
+    const size_t off1     = needle->probe1;
+    const size_t off2     = needle->probe2;
+    uint8_t      b1       = needle->ptr[off1];
+    uint8_t      b2       = needle->ptr[off2];
+    size_t       i        = 0;
+
+    if (ignore_case)
+    {
+        b1 = rstring_internal_fold(b1);
+        b2 = rstring_internal_fold(b2);
+    }
+
+    const __m256i v1 = _mm256_set1_epi8((char) b1);
+    const __m256i v2 = _mm256_set1_epi8((char) b2);
+    const __m256i v1_swap =
+        _mm256_set1_epi8((char) rstring_internal_swap_case(b1));
+    const __m256i v2_swap =
+        _mm256_set1_epi8((char) rstring_internal_swap_case(b2));
+
+    for (; i + 64 <= last_pos + 1; i += 64)
+    {
+        const uint32_t lo = rstring_internal_candidates_avx2(
+            hay + i, off1, off2, v1, v1_swap, v2, v2_swap, ignore_case);
+        const uint32_t hi = rstring_internal_candidates_avx2(
+            hay + i + 32, off1, off2, v1, v1_swap, v2, v2_swap, ignore_case);
+
+        if ((lo | hi) == 0)
+        {
+            continue;
+        }
+
+        size_t pos = rstring_internal_verify_mask(lo, hay, i, needle);
+        if (pos == RSTRING_NOT_FOUND)
+        {
+            pos = rstring_internal_verify_mask(hi, hay, i + 32, needle);
+        }
+
+        if (pos != RSTRING_NOT_FOUND)
+        {
+            return pos;
+        }
+    }
+
+    if (i > last_pos)
+    {
+        return RSTRING_NOT_FOUND;
+    }
+
+    /* Finish the tail with 16-byte blocks */
+    _mm256_zeroupper(); /* See rstring_internal_mismatch_avx2 */
+    const size_t pos =
+        rstring_internal_search_sse2(hay + i, hay_len - i, needle);
+
+    return pos == RSTRING_NOT_FOUND ? pos : pos + i;
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("avx2"))) static size_t
+rstring_internal_search_avx2(const uint8_t *hay, size_t hay_len,
+                             const struct rstring_internal_needle *needle)
+{
+    if (needle->ignore_case)
+    {
+        return rstring_internal_search_avx2_loop(hay, hay_len, needle, true);
+    }
+
+    return rstring_internal_search_avx2_loop(hay, hay_len, needle, false);
+}
+#endif /* RSTRING_HAVE_X86_SIMD */
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_search_resolve(const uint8_t *hay, size_t hay_len,
+                                const struct rstring_internal_needle *needle);
+
+/* Selected on first use, see KERNEL_LOAD */
+static rstring_internal_search_fn rstring_internal_search =
+    rstring_internal_search_resolve;
+
+static size_t
+rstring_internal_search_resolve(const uint8_t *hay, size_t hay_len,
+                                const struct rstring_internal_needle *needle)
+{
+    rstring_internal_search_fn fn = rstring_internal_search_scalar;
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    fn = __builtin_cpu_supports("avx2") ? rstring_internal_search_avx2
+                                        : rstring_internal_search_sse2;
+#endif
+
+    KERNEL_STORE(rstring_internal_search, fn);
+    return fn(hay, hay_len, needle);
+}
+
+/*----------------------------------------------------------------------------*/
+/* REVERSE SEARCH KERNELS                                                     */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Mirror images of the search kernels: find the last offset in which |needle|
+ * occurs inside |hay|, under the same contract. Blocks are scanned from the
+ * end of the haystack backwards, and the candidates of a block from the
+ * highest position down.
+ *
+ * Byte searches are single-byte, case-sensitive needles. Their candidate masks
+ * are exact, so the vectorized kernels give them a loop of their own which
+ * compares every block once and skips verification.
+ */
+
+/*
+ * Scalar reverse search over the positions [start, last], used both as the
+ * portable kernel and for the heads the vectorized kernels leave behind.
+ */
+static size_t
+rstring_internal_rsearch_range(const uint8_t *hay, size_t start, size_t last,
+                               const struct rstring_internal_needle *needle)
+{
+    const size_t probe = needle->probe1;
+    uint8_t      byte  = needle->ptr[probe];
+
+    if (needle->ignore_case)
+    {
+        byte = rstring_internal_fold(byte);
+    }
+
+    for (size_t i = last + 1; i-- > start;)
+    {
+        uint8_t c = hay[i + probe];
+
+        if (needle->ignore_case)
+        {
+            c = rstring_internal_fold(c);
+        }
+
+        if (c == byte
+            && rstring_internal_memeq(
+                hay + i, needle->ptr, needle->len, needle->ignore_case))
+        {
+            return i;
+        }
+    }
+
+    return RSTRING_NOT_FOUND;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_rsearch_scalar(const uint8_t *hay, size_t hay_len,
+                                const struct rstring_internal_needle *needle)
+{
+    return rstring_internal_rsearch_range(
+        hay, 0, hay_len - needle->len, needle);
+}
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef RSTRING_HAVE_X86_SIMD
+
+/*
+ * Verifies the candidates in |mask|, like rstring_internal_verify_mask, but
+ * returns the last verified position.
+ */
+static inline size_t
+rstring_internal_verify_mask_reverse(
+    uint32_t mask, const uint8_t *hay, size_t base,
+    const struct rstring_internal_needle *needle)
+{
+    while (mask)
+    {
+        const unsigned bit = 31U - (unsigned) __builtin_clz(mask);
+        const size_t   pos = base + bit;
+
+        if (rstring_internal_memeq(
+                hay + pos, needle->ptr, needle->len, needle->ignore_case))
+        {
+            return pos;
+        }
+
+        mask ^= 1U << bit;
+    }
+
+    return RSTRING_NOT_FOUND;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * |ignore_case| and |byte| are constants at the call sites below; |byte|
+ * selects the byte search loop.
+ */
+__attribute__((always_inline)) static inline size_t
+rstring_internal_rsearch_sse2_loop(const uint8_t *hay, size_t hay_len,
+                                   const struct rstring_internal_needle *needle,
+                                   bool ignore_case, bool byte)
+{
+    const size_t off1 = needle->probe1;
+    const size_t off2 = needle->probe2;
+    uint8_t      b1   = needle->ptr[off1];
+    uint8_t      b2   = needle->ptr[off2];
+    size_t       end  = hay_len - needle->len + 1; /* Positions [0, end) */
+
+    if (ignore_case)
+    {
+        b1 = rstring_internal_fold(b1);
+        b2 = rstring_internal_fold(b2);
+    }
+
+    const __m128i v1 = _mm_set1_epi8((char) b1);
+    const __m128i v2 = _mm_set1_epi8((char) b2);
+    const __m128i v1_swap =
+        _mm_set1_epi8((char) rstring_internal_swap_case(b1));
+    const __m128i v2_swap =
+        _mm_set1_epi8((char) rstring_internal_swap_case(b2));
+
+    for (; end >= 16; end -= 16)
+    {
+        const size_t i = end - 16;
+
+        if (byte)
+        {
+            const __m128i  c    = _mm_loadu_si128((const __m128i *) (hay + i));
+            const uint32_t mask =
+                (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(c, v1));
+
+            if (mask)
+            {
+                return i + 31U - (unsigned) __builtin_clz(mask);
+            }
+            continue;
+        }
+
+        const uint32_t mask = rstring_internal_candidates_sse2(
+            hay + i, off1, off2, v1, v1_swap, v2, v2_swap, ignore_case);
+
+        if (mask)
+        {
+            const size_t pos =
+                rstring_internal_verify_mask_reverse(mask, hay, i, needle);
+            if (pos != RSTRING_NOT_FOUND)
+            {
+                return pos;
+            }
+        }
+    }
+
+    if (end == 0)
+    {
+        return RSTRING_NOT_FOUND;
+    }
+
+    return rstring_internal_rsearch_range(hay, 0, end - 1, needle);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_rsearch_sse2(const uint8_t *hay, size_t hay_len,
+                              const struct rstring_internal_needle *needle)
+{
+    if (needle->ignore_case)
+    {
+        return rstring_internal_rsearch_sse2_loop(
+            hay, hay_len, needle, true, false);
+    }
+
+    if (needle->len == 1)
+    {
+        return rstring_internal_rsearch_sse2_loop(
+            hay, hay_len, needle, false, true);
+    }
+
+    return rstring_internal_rsearch_sse2_loop(
+        hay, hay_len, needle, false, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Processes 64 positions per iteration, the upper 32 first. See
+ * rstring_internal_rsearch_sse2_loop for |ignore_case| and |byte|.
+ */
+__attribute__((target("avx2"), always_inline)) static inline size_t
+rstring_internal_rsearch_avx2_loop(const uint8_t *hay, size_t hay_len,
+                                   const struct rstring_internal_needle *needle,
+                                   bool ignore_case, bool byte)
+{
+    const size_t off1 = needle->probe1;
+    const size_t off2 = needle->probe2;
+    uint8_t      b1   = needle->ptr[off1];
+    uint8_t      b2   = needle->ptr[off2];
+    size_t       end  = hay_len - needle->len + 1; /* Positions [0, end) */
+
+    if (ignore_case)
+    {
+        b1 = rstring_internal_fold(b1);
+        b2 = rstring_internal_fold(b2);
+    }
+
+    const __m256i v1 = _mm256_set1_epi8((char) b1);
+    const __m256i v2 = _mm256_set1_epi8((char) b2);
+    const __m256i v1_swap =
+        _mm256_set1_epi8((char) rstring_internal_swap_case(b1));
+    const __m256i v2_swap =
+        _mm256_set1_epi8((char) rstring_internal_swap_case(b2));
+
+    /*
+     * Byte searches only need one compare per block, so take 128 at a time,
+     * from an aligned end: the last 32 positions are checked first, which
+     * covers the ones the alignment skips.
+     */
+    if (byte && end >= 128)
+    {
+        const uint32_t mask = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *) (hay + end - 32)), v1));
+
+        if (mask)
+        {
+            return end - 32 + 31U - (unsigned) __builtin_clz(mask);
+        }
+
+        end -= (uintptr_t) (hay + end) & 31U;
+    }
+
+    for (; byte && end >= 128; end -= 128)
+    {
+        const size_t  i  = end - 128;
+        const __m256i e0 = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *) (hay + i)), v1);
+        const __m256i e1 = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *) (hay + i + 32)), v1);
+        const __m256i e2 = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *) (hay + i + 64)), v1);
+        const __m256i e3 = _mm256_cmpeq_epi8(
+            _mm256_loadu_si256((const __m256i *) (hay + i + 96)), v1);
+        const __m256i any =
+            _mm256_or_si256(_mm256_or_si256(e0, e1), _mm256_or_si256(e2, e3));
+
+        if (_mm256_testz_si256(any, any))
+        {
+            continue;
+        }
+
+        const uint64_t hi = (uint64_t) (uint32_t) _mm256_movemask_epi8(e3) << 32
+                            | (uint32_t) _mm256_movemask_epi8(e2);
+        if (hi)
+        {
+            return i + 64 + 63U - (unsigned) __builtin_clzll(hi);
+        }
+
+        const uint64_t lo = (uint64_t) (uint32_t) _mm256_movemask_epi8(e1) << 32
+                            | (uint32_t) _mm256_movemask_epi8(e0);
+        return i + 63U - (unsigned) __builtin_clzll(lo);
+    }
+
+    for (; end >= 64; end -= 64)
+    {
+        const size_t i  = end - 64;
+        uint32_t     lo = 0;
+        uint32_t     hi = 0;
+
+        if (byte)
+        {
+            lo = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                _mm256_loadu_si256((const __m256i *) (hay + i)), v1));
+            hi = (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(
+                _mm256_loadu_si256((const __m256i *) (hay + i + 32)), v1));
+
+            if (hi)
+            {
+                return i + 32 + 31U - (unsigned) __builtin_clz(hi);
+            }
+            if (lo)
+            {
+                return i + 31U - (unsigned) __builtin_clz(lo);
+            }
+            continue;
+        }
+
+        lo = rstring_internal_candidates_avx2(
+            hay + i, off1, off2, v1, v1_swap, v2, v2_swap, ignore_case);
+        hi = rstring_internal_candidates_avx2(
+            hay + i + 32, off1, off2, v1, v1_swap, v2, v2_swap, ignore_case);
+
+        if ((lo | hi) == 0)
+        {
+            continue;
+        }
+
+        size_t pos =
+            rstring_internal_verify_mask_reverse(hi, hay, i + 32, needle);
+        if (pos == RSTRING_NOT_FOUND)
+        {
+            pos = rstring_internal_verify_mask_reverse(lo, hay, i, needle);
+        }
+
+        if (pos != RSTRING_NOT_FOUND)
+        {
+            return pos;
+        }
+    }
+
+    if (end == 0)
+    {
+        return RSTRING_NOT_FOUND;
+    }
+
+    /* Finish the head with 16-byte blocks */
+    _mm256_zeroupper(); /* See rstring_internal_mismatch_avx2 */
+    return rstring_internal_rsearch_sse2(hay, end - 1 + needle->len, needle);
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("avx2"))) static size_t
+rstring_internal_rsearch_avx2(const uint8_t *hay, size_t hay_len,
+                              const struct rstring_internal_needle *needle)
+{
+    if (needle->ignore_case)
+    {
+        return rstring_internal_rsearch_avx2_loop(
+            hay, hay_len, needle, true, false);
+    }
+
+    if (needle->len == 1)
+    {
+        return rstring_internal_rsearch_avx2_loop(
+            hay, hay_len, needle, false, true);
+    }
+
+    return rstring_internal_rsearch_avx2_loop(
+        hay, hay_len, needle, false, false);
+}
+#endif /* RSTRING_HAVE_X86_SIMD */
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_rsearch_resolve(const uint8_t *hay, size_t hay_len,
+                                 const struct rstring_internal_needle *needle);
+
+/* Selected on first use, like rstring_internal_search */
+static rstring_internal_search_fn rstring_internal_rsearch =
+    rstring_internal_rsearch_resolve;
+
+static size_t
+rstring_internal_rsearch_resolve(const uint8_t *hay, size_t hay_len,
+                                 const struct rstring_internal_needle *needle)
+{
+    rstring_internal_search_fn fn = rstring_internal_rsearch_scalar;
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    fn = __builtin_cpu_supports("avx2") ? rstring_internal_rsearch_avx2
+                                        : rstring_internal_rsearch_sse2;
+#endif
+
+    KERNEL_STORE(rstring_internal_rsearch, fn);
+    return fn(hay, hay_len, needle);
+}
+
+/*----------------------------------------------------------------------------*/
+/* MULTIPLE MATCH KERNELS                                                     */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Where the multiple match kernels report the matches they find, in
+ * increasing order. Positions are recorded plus |base|, into |out| when it is
+ * set, else into the first |cap| entries of |buf|; |count| counts them all.
+ *
+ * A match only counts if it starts at |next| or after; recording one moves
+ * |next| to its position plus |step|, which is 1 to report overlapping matches
+ * and the needle's length to skip them.
+ */
+struct rstring_internal_matches
+{
+    struct rstring_offsets *out;
+    size_t                 *buf;
+    size_t                  cap;
+    size_t                  base;
+    size_t                  count;
+    size_t                  next;
+    size_t                  step;
+    rstring_status_t        rc;
+};
+
+/*
+ * Same contract as the search kernels, except that every match of |needle|
+ * is reported to |matches|, until the end of |hay| or a failure to record.
+ * Candidates come from the same probes, but a whole block of them is
+ * verified before moving on, instead of returning at the first match.
+ */
+typedef void (*rstring_internal_search_all_fn)(
+    const uint8_t *hay, size_t hay_len,
+    const struct rstring_internal_needle *needle,
+    struct rstring_internal_matches      *matches);
+
+/*----------------------------------------------------------------------------*/
+
+/* Records a match at |pos|. Returns false if the search must stop */
+static inline bool
+rstring_internal_matches_add(struct rstring_internal_matches *matches,
+                             size_t                           pos)
+{
+    if (matches->out != NULL)
+    {
+        if (rstring_internal_offsets_push(matches->out, matches->base + pos)
+            != RSTRING_OK)
+        {
+            matches->rc = RSTRING_ERROR_ALLOC;
+            return false;
+        }
+    }
+    else if (matches->count < matches->cap)
+    {
+        matches->buf[matches->count] = matches->base + pos;
+    }
+
+    matches->count++;
+    matches->next = pos + matches->step;
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Scalar search for every match over the positions [start, last] */
+static void
+rstring_internal_search_all_range(const uint8_t *hay, size_t start,
+                                  size_t                                last,
+                                  const struct rstring_internal_needle *needle,
+                                  struct rstring_internal_matches *matches)
+{
+    size_t i = start < matches->next ? matches->next : start;
+
+    while (i <= last)
+    {
+        const size_t pos = rstring_internal_search_range(hay, i, last, needle);
+
+        if (pos == RSTRING_NOT_FOUND
+            || !rstring_internal_matches_add(matches, pos))
+        {
+            return;
+        }
+
+        i = matches->next;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+rstring_internal_search_all_scalar(const uint8_t *hay, size_t hay_len,
+                                   const struct rstring_internal_needle *needle,
+                                   struct rstring_internal_matches *matches)
+{
+    rstring_internal_search_all_range(
+        hay, 0, hay_len - needle->len, needle, matches);
+}
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef RSTRING_HAVE_X86_SIMD
+
+/*
+ * Verifies and records every candidate in |mask|, like
+ * rstring_internal_verify_mask. Returns false if the search must stop.
+ */
+static inline bool
+rstring_internal_verify_mask_all(uint32_t mask, const uint8_t *hay,
+                                 size_t                                base,
+                                 const struct rstring_internal_needle *needle,
+                                 struct rstring_internal_matches *matches)
+{
+    while (mask)
+    {
+        const size_t pos = base + (size_t) __builtin_ctz(mask);
+
+        if (pos >= matches->next
+            && rstring_internal_memeq(
+                hay + pos, needle->ptr, needle->len, needle->ignore_case)
+            && !rstring_internal_matches_add(matches, pos))
+        {
+            return false;
+        }
+
+        mask &= mask - 1;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+rstring_internal_search_all_sse2(const uint8_t *hay, size_t hay_len,
+                                 const struct rstring_internal_needle *needle,
+                                 struct rstring_internal_matches *matches)
+{
+    const size_t last_pos = hay_len - needle->len;
+    const size_t off1     = needle->probe1;
+    const size_t off2     = needle->probe2;
+    uint8_t      b1       = needle->ptr[off1];
+    uint8_t      b2       = needle->ptr[off2];
+    size_t       i        = 0;
+
+    if (needle->ignore_case)
+    {
+        b1 = rstring_internal_fold(b1);
+        b2 = rstring_internal_fold(b2);
+    }
+
+    const __m128i v1 = _mm_set1_epi8((char) b1);
+    const __m128i v2 = _mm_set1_epi8((char) b2);
+    const __m128i v1_swap =
+        _mm_set1_epi8((char) rstring_internal_swap_case(b1));
+    const __m128i v2_swap =
+        _mm_set1_epi8((char) rstring_internal_swap_case(b2));
+
+    for (; i + 16 <= last_pos + 1; i += 16)
+    {
+        const uint32_t mask = rstring_internal_candidates_sse2(
+            hay + i, off1, off2, v1, v1_swap, v2, v2_swap, needle->ignore_case);
+
+        if (mask
+            && !rstring_internal_verify_mask_all(
+                mask, hay, i, needle, matches))
+        {
+            return;
+        }
+    }
+
+    rstring_internal_search_all_range(hay, i, last_pos, needle, matches);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Processes 64 positions per iteration, see rstring_internal_search_avx2 */
+__attribute__((target("avx2"), always_inline)) static inline void
+rstring_internal_search_all_avx2_loop(
+    const uint8_t *hay, size_t hay_len,
+    const struct rstring_internal_needle *needle,
+    struct rstring_internal_matches *matches, bool ignore_case)
+{
+    const size_t last_pos = hay_len - needle->len;
+    const size_t off1     = needle->probe1;
+    const size_t off2     = needle->probe2;
+    uint8_t      b1       = needle->ptr[off1];
+    uint8_t      b2       = needle->ptr[off2];
+    size_t       i        = 0;
+
+    if (ignore_case)
+    {
+        b1 = rstring_internal_fold(b1);
+        b2 = rstring_internal_fold(b2);
+    }
+
+    const __m256i v1 = _mm256_set1_epi8((char) b1);
+    const __m256i v2 = _mm256_set1_epi8((char) b2);
+    const __m256i v1_swap =
+        _mm256_set1_epi8((char) rstring_internal_swap_case(b1));
+    const __m256i v2_swap =
+        _mm256_set1_epi8((char) rstring_internal_swap_case(b2));
+
+    for (; i + 64 <= last_pos + 1; i += 64)
+    {
+        const uint32_t lo = rstring_internal_candidates_avx2(
+            hay + i, off1, off2, v1, v1_swap, v2, v2_swap, ignore_case);
+        const uint32_t hi = rstring_internal_candidates_avx2(
+            hay + i + 32, off1, off2, v1, v1_swap, v2, v2_swap, ignore_case);
+
+        if ((lo | hi) == 0)
+        {
+            continue;
+        }
+
+        if (!rstring_internal_verify_mask_all(lo, hay, i, needle, matches)
+            || !rstring_internal_verify_mask_all(
+                hi, hay, i + 32, needle, matches))
+        {
+            _mm256_zeroupper(); /* See rstring_internal_mismatch_avx2 */
+            return;
+        }
+    }
+
+    /* The tail has fewer than 64 positions left */
+    _mm256_zeroupper(); /* See rstring_internal_mismatch_avx2 */
+    rstring_internal_search_all_range(hay, i, last_pos, needle, matches);
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("avx2"))) static void
+rstring_internal_search_all_avx2(const uint8_t *hay, size_t hay_len,
+                                 const struct rstring_internal_needle *needle,
+                                 struct rstring_internal_matches *matches)
+{
+    if (needle->ignore_case)
+    {
+        rstring_internal_search_all_avx2_loop(
+            hay, hay_len, needle, matches, true);
+        return;
+    }
+
+    rstring_internal_search_all_avx2_loop(hay, hay_len, needle, matches, false);
+}
+#endif /* RSTRING_HAVE_X86_SIMD */
+
+/*----------------------------------------------------------------------------*/
+
+static void
+rstring_internal_search_all_resolve(
+    const uint8_t *hay, size_t hay_len,
+    const struct rstring_internal_needle *needle,
+    struct rstring_internal_matches      *matches);
+
+/* Selected on first use, like rstring_internal_search */
+static rstring_internal_search_all_fn rstring_internal_search_all =
+    rstring_internal_search_all_resolve;
+
+static void
+rstring_internal_search_all_resolve(
+    const uint8_t *hay, size_t hay_len,
+    const struct rstring_internal_needle *needle,
+    struct rstring_internal_matches      *matches)
+{
+    rstring_internal_search_all_fn fn = rstring_internal_search_all_scalar;
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    fn = __builtin_cpu_supports("avx2") ? rstring_internal_search_all_avx2
+                                        : rstring_internal_search_all_sse2;
+#endif
+
+    KERNEL_STORE(rstring_internal_search_all, fn);
+    fn(hay, hay_len, needle, matches);
+}
+
+/*----------------------------------------------------------------------------*/
+/* CASE CONVERSION KERNELS                                                    */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Flips the case bit (0x20) of every byte of |src| in the range
+ * [|first|, |first| + 25] and writes the result to |dst|, which is either
+ * |src| itself or a non-overlapping buffer. |first| is 'A' to lower case and
+ * 'a' to upper case.
+ */
+typedef void (*rstring_internal_case_fn)(uint8_t *dst, const uint8_t *src,
+                                         size_t n, uint8_t first);
+
+static void
+rstring_internal_case_scalar(uint8_t *dst, const uint8_t *src, size_t n,
+                             uint8_t first)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        const uint8_t c = src[i];
+        dst[i] = (uint8_t) ((unsigned) (c - first) < 26U ? c ^ 0x20U : c);
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef RSTRING_HAVE_X86_SIMD
+/*
+ * SSE2 and AVX2 only compare signed bytes, so the range check is done by
+ * moving |first| to -128: a byte is a letter iff c + (0x80 - first) < -102.
+ */
+static void
+rstring_internal_case_sse2(uint8_t *dst, const uint8_t *src, size_t n,
+                           uint8_t first)
+{
+    const __m128i shift = _mm_set1_epi8((char) (0x80 - first));
+    const __m128i limit = _mm_set1_epi8(-128 + 26);
+    const __m128i flip  = _mm_set1_epi8(0x20);
+    size_t        i     = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i c = _mm_loadu_si128((const __m128i *) (src + i));
+        const __m128i letter =
+            _mm_cmplt_epi8(_mm_add_epi8(c, shift), limit);
+
+        _mm_storeu_si128((__m128i *) (dst + i),
+                         _mm_xor_si128(c, _mm_and_si128(letter, flip)));
+    }
+
+    rstring_internal_case_scalar(dst + i, src + i, n - i, first);
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("avx2"))) static void
+rstring_internal_case_avx2(uint8_t *dst, const uint8_t *src, size_t n,
+                           uint8_t first)
+{
+    const __m256i shift = _mm256_set1_epi8((char) (0x80 - first));
+    const __m256i limit = _mm256_set1_epi8(-128 + 26);
+    const __m256i flip  = _mm256_set1_epi8(0x20);
+    size_t        i     = 0;
+
+    for (; i + 32 <= n; i += 32)
+    {
+        const __m256i c = _mm256_loadu_si256((const __m256i *) (src + i));
+        const __m256i letter =
+            _mm256_cmpgt_epi8(limit, _mm256_add_epi8(c, shift));
+
+        _mm256_storeu_si256(
+            (__m256i *) (dst + i),
+            _mm256_xor_si256(c, _mm256_and_si256(letter, flip)));
+    }
+
+    _mm256_zeroupper(); /* See rstring_internal_mismatch_avx2 */
+    rstring_internal_case_sse2(dst + i, src + i, n - i, first);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * AVX-512BW compares unsigned bytes into a mask directly, and its masked loads
+ * and stores handle the tail without a scalar loop.
+ */
+__attribute__((target("avx512bw"))) static void
+rstring_internal_case_avx512(uint8_t *dst, const uint8_t *src, size_t n,
+                             uint8_t first)
+{
+    const __m512i base = _mm512_set1_epi8((char) first);
+    const __m512i span = _mm512_set1_epi8(26);
+    const __m512i flip = _mm512_set1_epi8(0x20);
+
+    for (size_t i = 0; i < n; i += 64)
+    {
+        const __mmask64 valid = n - i >= 64 ? ~(__mmask64) 0
+                                            : ((__mmask64) 1 << (n - i)) - 1;
+        const __m512i   c     = _mm512_maskz_loadu_epi8(valid, src + i);
+        const __mmask64 letter =
+            _mm512_cmplt_epu8_mask(_mm512_sub_epi8(c, base), span);
+
+        _mm512_mask_storeu_epi8(
+            dst + i, valid,
+            _mm512_mask_blend_epi8(letter, c, _mm512_xor_si512(c, flip)));
+    }
+}
+#endif /* RSTRING_HAVE_X86_SIMD */
+
+/*----------------------------------------------------------------------------*/
+
+static void
+rstring_internal_case_resolve(uint8_t *dst, const uint8_t *src, size_t n,
+                              uint8_t first);
+
+/* Selected on first use, like rstring_internal_search */
+static rstring_internal_case_fn rstring_internal_case =
+    rstring_internal_case_resolve;
+
+static void
+rstring_internal_case_resolve(uint8_t *dst, const uint8_t *src, size_t n,
+                              uint8_t first)
+{
+    rstring_internal_case_fn fn = rstring_internal_case_scalar;
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw"))
+    {
+        fn = rstring_internal_case_avx512;
+    }
+    else if (__builtin_cpu_supports("avx2"))
+    {
+        fn = rstring_internal_case_avx2;
+    }
+    else
+    {
+        fn = rstring_internal_case_sse2;
+    }
+#endif
+
+    KERNEL_STORE(rstring_internal_case, fn);
+    fn(dst, src, n, first);
+}
+
+/*----------------------------------------------------------------------------*/
+/* COMPARISON KERNELS                                                         */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * All kernels return the offset of the first byte in which |a| and |b|, of
+ * |n| bytes each, differ, or |n| if they do not. With |ignore_case|, bytes
+ * are folded to lower case, as by rstring_internal_fold, before they are
+ * compared.
+ */
+typedef size_t (*rstring_internal_mismatch_fn)(const uint8_t *a,
+                                               const uint8_t *b, size_t n,
+                                               bool ignore_case);
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_mismatch_scalar(const uint8_t *a, const uint8_t *b, size_t n,
+                                 bool ignore_case)
+{
+    size_t i = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        uint64_t x;
+        uint64_t y;
+
+        memcpy(&x, a + i, sizeof(x));
+        memcpy(&y, b + i, sizeof(y));
+        if (ignore_case)
+        {
+            x = rstring_internal_fold64(x);
+            y = rstring_internal_fold64(y);
+        }
+
+        if (x != y)
+        {
+            break;
+        }
+    }
+
+    for (; i < n; ++i)
+    {
+        if (ignore_case ? rstring_internal_fold(a[i])
+                              != rstring_internal_fold(b[i])
+                        : a[i] != b[i])
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef RSTRING_HAVE_X86_SIMD
+/*
+ * Folds 'A' - 'Z' of |c| to lower case, with the signed range check of
+ * rstring_internal_case_sse2.
+ */
+static inline __m128i
+rstring_internal_fold_sse2(__m128i c)
+{
+    const __m128i shift = _mm_set1_epi8((char) (0x80 - 'A'));
+    const __m128i limit = _mm_set1_epi8(-128 + 26);
+    const __m128i upper = _mm_cmplt_epi8(_mm_add_epi8(c, shift), limit);
+
+    return _mm_or_si128(c, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_mismatch_sse2(const uint8_t *a, const uint8_t *b, size_t n,
+                               bool ignore_case)
+{
+    size_t i = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        __m128i x = _mm_loadu_si128((const __m128i *) (a + i));
+        __m128i y = _mm_loadu_si128((const __m128i *) (b + i));
+
+        if (ignore_case)
+        {
+            x = rstring_internal_fold_sse2(x);
+            y = rstring_internal_fold_sse2(y);
+        }
+
+        const uint32_t diff =
+            (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) ^ 0xFFFFU;
+        if (diff)
+        {
+            return i + (size_t) __builtin_ctz(diff);
+        }
+    }
+
+    return i
+         + rstring_internal_mismatch_scalar(a + i, b + i, n - i, ignore_case);
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("avx2"), always_inline)) static inline __m256i
+rstring_internal_fold_avx2(__m256i c)
+{
+    const __m256i shift = _mm256_set1_epi8((char) (0x80 - 'A'));
+    const __m256i limit = _mm256_set1_epi8(-128 + 26);
+    const __m256i upper =
+        _mm256_cmpgt_epi8(limit, _mm256_add_epi8(c, shift));
+
+    return _mm256_or_si256(c, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("avx2"))) static size_t
+rstring_internal_mismatch_avx2(const uint8_t *a, const uint8_t *b, size_t n,
+                               bool ignore_case)
+{
+    size_t i = 0;
+
+    for (; i + 32 <= n; i += 32)
+    {
+        __m256i x = _mm256_loadu_si256((const __m256i *) (a + i));
+        __m256i y = _mm256_loadu_si256((const __m256i *) (b + i));
+
+        if (ignore_case)
+        {
+            x = rstring_internal_fold_avx2(x);
+            y = rstring_internal_fold_avx2(y);
+        }
+
+        const uint32_t diff =
+            ~(uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y));
+        if (diff)
+        {
+            return i + (size_t) __builtin_ctz(diff);
+        }
+    }
+
+    /*
+     * GCC does not clear the upper halves of the registers before calling a
+     * kernel of the same file built without AVX, whose SSE instructions then
+     * stall on them.
+     */
+    _mm256_zeroupper();
+    return i + rstring_internal_mismatch_sse2(a + i, b + i, n - i, ignore_case);
+}
+#endif /* RSTRING_HAVE_X86_SIMD */
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_mismatch_resolve(const uint8_t *a, const uint8_t *b, size_t n,
+                                  bool ignore_case);
+
+/* Selected on first use, like rstring_internal_search */
+static rstring_internal_mismatch_fn rstring_internal_mismatch =
+    rstring_internal_mismatch_resolve;
+
+static size_t
+rstring_internal_mismatch_resolve(const uint8_t *a, const uint8_t *b, size_t n,
+                                  bool ignore_case)
+{
+    rstring_internal_mismatch_fn fn = rstring_internal_mismatch_scalar;
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    fn = __builtin_cpu_supports("avx2") ? rstring_internal_mismatch_avx2
+                                        : rstring_internal_mismatch_sse2;
+#endif
+
+    KERNEL_STORE(rstring_internal_mismatch, fn);
+    return fn(a, b, n, ignore_case);
+}
+
+/*----------------------------------------------------------------------------*/
+/* BYTE SET KERNELS                                                           */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * All kernels find the first of |n| bytes at |p| which belongs to |set|.
+ *
+ * The vectorized kernels look up the low and high nibbles of every byte in
+ * two 16-byte tables with a shuffle: the byte is a member iff both entries
+ * share a bit. Table [0] gives each high nibble 0 - 7 its own bit, and table
+ * [1] does the same for 8 - 15, so the test is exact for any set; table [1]
+ * is skipped for sets of ASCII bytes only.
+ */
+typedef size_t (*rstring_internal_find_any_fn)(
+    const uint8_t *p, size_t n, const struct rstring_byte_set *set);
+
+static size_t
+rstring_internal_find_any_scalar(const uint8_t *p, size_t n,
+                                 const struct rstring_byte_set *set)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        if ((set->bits[p[i] >> 3] >> (p[i] & 7)) & 1)
+        {
+            return i;
+        }
+    }
+
+    return RSTRING_NOT_FOUND;
+}
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef RSTRING_HAVE_X86_SIMD
+/*
+ * Membership mask of the 16 bytes of |c|, |high| is a constant. Shuffles read
+ * 0 for indices with the top bit set, so for ASCII sets the low nibble needs
+ * no masking: bytes of 0x80 and up are never members.
+ */
+__attribute__((target("ssse3"), always_inline)) static inline uint32_t
+rstring_internal_classify_ssse3(__m128i c, __m128i lo0, __m128i hi0,
+                                __m128i lo1, __m128i hi1, bool high)
+{
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i lo_n   = high ? _mm_and_si128(c, nibble) : c;
+    const __m128i hi_n   = _mm_and_si128(_mm_srli_epi16(c, 4), nibble);
+    __m128i       m      = _mm_and_si128(_mm_shuffle_epi8(lo0, lo_n),
+                                  _mm_shuffle_epi8(hi0, hi_n));
+
+    if (high)
+    {
+        m = _mm_or_si128(m,
+                         _mm_and_si128(_mm_shuffle_epi8(lo1, lo_n),
+                                       _mm_shuffle_epi8(hi1, hi_n)));
+    }
+
+    return (uint32_t) _mm_movemask_epi8(
+               _mm_cmpeq_epi8(m, _mm_setzero_si128()))
+           ^ 0xFFFFU;
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("ssse3"), always_inline)) static inline size_t
+rstring_internal_find_any_ssse3_loop(const uint8_t *p, size_t n,
+                                     const struct rstring_byte_set *set,
+                                     bool                           high)
+{
+    const __m128i lo0 = _mm_loadu_si128((const __m128i *) set->lo[0]);
+    const __m128i hi0 = _mm_loadu_si128((const __m128i *) set->hi[0]);
+    const __m128i lo1 = _mm_loadu_si128((const __m128i *) set->lo[1]);
+    const __m128i hi1 = _mm_loadu_si128((const __m128i *) set->hi[1]);
+    size_t        i   = 0;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        const uint32_t mask = rstring_internal_classify_ssse3(
+            _mm_loadu_si128((const __m128i *) (p + i)), lo0, hi0, lo1, hi1,
+            high);
+
+        if (mask)
+        {
+            return i + (size_t) __builtin_ctz(mask);
+        }
+    }
+
+    const size_t pos = rstring_internal_find_any_scalar(p + i, n - i, set);
+    return pos == RSTRING_NOT_FOUND ? pos : pos + i;
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("ssse3"))) static size_t
+rstring_internal_find_any_ssse3(const uint8_t *p, size_t n,
+                                const struct rstring_byte_set *set)
+{
+    if (set->high)
+    {
+        return rstring_internal_find_any_ssse3_loop(p, n, set, true);
+    }
+
+    return rstring_internal_find_any_ssse3_loop(p, n, set, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Non-zero bytes of the result mark the members among the 32 bytes of |c|.
+ * Shuffles read 0 for indices with the top bit set, so for ASCII sets the
+ * low nibble needs no masking: bytes of 0x80 and up are never members.
+ */
+__attribute__((target("avx2"), always_inline)) static inline __m256i
+rstring_internal_classify_avx2(__m256i c, __m256i lo0, __m256i hi0,
+                               __m256i lo1, __m256i hi1, bool high)
+{
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i hi_n   = _mm256_and_si256(_mm256_srli_epi16(c, 4), nibble);
+
+    if (!high)
+    {
+        return _mm256_and_si256(_mm256_shuffle_epi8(lo0, c),
+                                _mm256_shuffle_epi8(hi0, hi_n));
+    }
+
+    const __m256i lo_n = _mm256_and_si256(c, nibble);
+
+    return _mm256_or_si256(
+        _mm256_and_si256(_mm256_shuffle_epi8(lo0, lo_n),
+                         _mm256_shuffle_epi8(hi0, hi_n)),
+        _mm256_and_si256(_mm256_shuffle_epi8(lo1, lo_n),
+                         _mm256_shuffle_epi8(hi1, hi_n)));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Processes 64 bytes per iteration, the tables are repeated in both lanes */
+__attribute__((target("avx2"), always_inline)) static inline size_t
+rstring_internal_find_any_avx2_loop(const uint8_t *p, size_t n,
+                                    const struct rstring_byte_set *set,
+                                    bool                           high)
+{
+    const __m256i lo0 = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *) set->lo[0]));
+    const __m256i hi0 = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *) set->hi[0]));
+    const __m256i lo1 = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *) set->lo[1]));
+    const __m256i hi1 = _mm256_broadcastsi128_si256(
+        _mm_loadu_si128((const __m128i *) set->hi[1]));
+    const __m256i zero = _mm256_setzero_si256();
+    size_t        i    = 0;
+
+    for (; i + 64 <= n; i += 64)
+    {
+        const __m256i a = rstring_internal_classify_avx2(
+            _mm256_loadu_si256((const __m256i *) (p + i)), lo0, hi0, lo1, hi1,
+            high);
+        const __m256i b = rstring_internal_classify_avx2(
+            _mm256_loadu_si256((const __m256i *) (p + i + 32)), lo0, hi0, lo1,
+            hi1, high);
+        const __m256i any = _mm256_or_si256(a, b);
+
+        if (_mm256_testz_si256(any, any))
+        {
+            continue;
+        }
+
+        const uint32_t lo =
+            ~(uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(a, zero));
+        const uint32_t hi =
+            ~(uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(b, zero));
+
+        return i + (size_t) __builtin_ctzll((uint64_t) hi << 32 | lo);
+    }
+
+    /* Finish the tail with 16-byte blocks */
+    _mm256_zeroupper(); /* See rstring_internal_mismatch_avx2 */
+    const size_t pos = rstring_internal_find_any_ssse3(p + i, n - i, set);
+    return pos == RSTRING_NOT_FOUND ? pos : pos + i;
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("avx2"))) static size_t
+rstring_internal_find_any_avx2(const uint8_t *p, size_t n,
+                               const struct rstring_byte_set *set)
+{
+    if (set->high)
+    {
+        return rstring_internal_find_any_avx2_loop(p, n, set, true);
+    }
+
+    return rstring_internal_find_any_avx2_loop(p, n, set, false);
+}
+#endif /* RSTRING_HAVE_X86_SIMD */
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_find_any_resolve(const uint8_t *p, size_t n,
+                                  const struct rstring_byte_set *set);
+
+/* Selected on first use, like rstring_internal_search */
+static rstring_internal_find_any_fn rstring_internal_find_any =
+    rstring_internal_find_any_resolve;
+
+static size_t
+rstring_internal_find_any_resolve(const uint8_t *p, size_t n,
+                                  const struct rstring_byte_set *set)
+{
+    rstring_internal_find_any_fn fn = rstring_internal_find_any_scalar;
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        fn = rstring_internal_find_any_avx2;
+    }
+    else if (__builtin_cpu_supports("ssse3"))
+    {
+        fn = rstring_internal_find_any_ssse3;
+    }
+#endif
+
+    KERNEL_STORE(rstring_internal_find_any, fn);
+    return fn(p, n, set);
+}
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL FUNCTIONS */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Heap buffer management, through the rstring's allocator or the C library.
+ * |rs->cap| is the size of the current heap buffer.
+ */
+static char *
+rstring_internal_alloc(const struct rstring *rs, size_t size)
+{
+    const struct rstring_allocator *a = rs->allocator;
+    return a ? a->alloc(a->ctx, size) : malloc(size);
+}
+
+static char *
+rstring_internal_realloc(const struct rstring *rs, size_t new_size)
+{
+    const struct rstring_allocator *a = rs->allocator;
+    return a ? a->realloc(a->ctx, rs->data, rs->cap, new_size)
+             : realloc(rs->data, new_size);
+}
+
+static void
+rstring_internal_dealloc(const struct rstring *rs)
+{
+    const struct rstring_allocator *a = rs->allocator;
+
+    STATS_ADD(frees, 1);
+    STATS_ADD(unused_bytes, rs->cap - rs->len);
+    STATS_ADD(fill[rs->len * RSTRING_STATS_FILL_BUCKETS / rs->cap], 1);
+
+    if (a)
+    {
+        a->free(a->ctx, rs->data, rs->cap);
+    }
+    else
+    {
+        free(rs->data);
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Moves the contents of |rs| to a heap buffer of |new_size| bytes, from the
+ * inline buffer or the current heap one. |rs| is unchanged on failure.
+ */
+static rstring_status_t
+rstring_internal_resize(struct rstring *rs, size_t new_size)
+{
+    char *p;
+
+    if (rstring_is_inline(rs))
+    {
+        p = rstring_internal_alloc(rs, new_size);
+        if (p)
+        {
+            memcpy(p, rs->sso, rs->len + 1);
+        }
+        STATS_ADD(allocs, 1);
+    }
+    else
+    {
+        p = rstring_internal_realloc(rs, new_size);
+        STATS_ADD(reallocs, 1);
+        STATS_ADD(realloc_bytes, rs->len + 1);
+    }
+
+    if (!p)
+    {
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    rs->cap  = new_size;
+    rs->data = p;
+
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* The policy of rstring_ensure_capacity, see `rstring_set_growth_policy` */
+static enum rstring_growth_policy rstring_internal_growth = RSTRING_GROWTH_X1_5;
+
+/*
+ * Returns the capacity a heap buffer of |cap| bytes grows to, for at least
+ * |wanted_cap| bytes, under the current growth policy.
+ */
+static size_t
+rstring_internal_grown_cap(size_t cap, size_t wanted_cap)
+{
+    size_t grown;
+
+    switch (rstring_internal_growth)
+    {
+    case RSTRING_GROWTH_X2:
+        grown = cap <= SIZE_MAX / 2 ? cap * 2 : SIZE_MAX;
+        break;
+
+    case RSTRING_GROWTH_POW2:
+        grown = 1;
+        while (grown < wanted_cap && grown <= SIZE_MAX / 2)
+        {
+            grown *= 2;
+        }
+        break;
+
+    case RSTRING_GROWTH_PAGES:
+        if (cap < RSTRING_GROWTH_PAGES_THRESHOLD)
+        {
+            grown = cap * 2;
+            break;
+        }
+        /* fall through */
+
+    case RSTRING_GROWTH_X1_5:
+    default:
+        grown = cap <= SIZE_MAX / 3 * 2 ? cap + cap / 2 : SIZE_MAX;
+        break;
+    }
+
+    if (grown < wanted_cap)
+    {
+        grown = wanted_cap;
+    }
+
+    if (rstring_internal_growth == RSTRING_GROWTH_PAGES
+        && grown >= RSTRING_GROWTH_PAGES_THRESHOLD
+        && grown <= SIZE_MAX - GROWTH_MALLOC_HEADER - GROWTH_PAGE_SIZE)
+    {
+        const size_t with_header = grown + GROWTH_MALLOC_HEADER;
+        const size_t pages = (with_header + GROWTH_PAGE_SIZE - 1) /
+                             GROWTH_PAGE_SIZE;
+
+        grown = pages * GROWTH_PAGE_SIZE - GROWTH_MALLOC_HEADER;
+    }
+
+    return grown;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Translates |ptr| to the buffer of |dest| after it grew from |old_data|, if it
+ * pointed inside its |old_len| bytes of contents.
+ */
+static const char *
+rstring_internal_rebase(const char *ptr, uintptr_t old_data, size_t old_len,
+                        const char *data)
+{
+    const uintptr_t offset = (uintptr_t) ptr - old_data;
+    return (uintptr_t) ptr >= old_data && offset < old_len ? data + offset
+                                                            : ptr;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static rstring_status_t
+rstring_internal_push(struct rstring *dest, const char *src, size_t n)
+{
+    if (n == 0)
+    {
+        return RSTRING_OK;
+    }
+
+    /* |src| may be a part of |dest|, which growing would move */
+    const uintptr_t old_data = (uintptr_t) rstring_data(dest);
+
+    const size_t new_length = dest->len + n;
+    ENSURE_CAPACITY(dest, new_length + 1);    // Add one for nullterm
+    char *data = rstring_internal_data(dest);
+    src        = rstring_internal_rebase(src, old_data, dest->len, data);
+    memcpy(data + dest->len, src, n);
+    dest->len        = new_length;
+    data[new_length] = '\0';
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Element types of the arrays rstring_internal_join accepts */
+enum rstring_internal_pieces
+{
+    RSTRING_INTERNAL_PIECES_RSTRING,
+    RSTRING_INTERNAL_PIECES_VIEW,
+    RSTRING_INTERNAL_PIECES_STR,
+};
+
+static struct rstring_view
+rstring_internal_piece(const void *pieces, size_t i,
+                       enum rstring_internal_pieces type)
+{
+    if (type == RSTRING_INTERNAL_PIECES_RSTRING)
+    {
+        return rstring_view_from((const struct rstring *) pieces + i);
+    }
+
+    if (type == RSTRING_INTERNAL_PIECES_STR)
+    {
+        return rstring_view_from_str(((const char *const *) pieces)[i]);
+    }
+
+    return ((const struct rstring_view *) pieces)[i];
+}
+
+/*
+ * Piece |i| as it is copied, once |dest| grew from |old_data| to |data|. A C
+ * string inside the old contents is measured again in the new buffer, where
+ * only bytes past |old_len| have been written, so it ends at the latest where
+ * the old contents did.
+ */
+static struct rstring_view
+rstring_internal_copied_piece(const void *pieces, size_t i,
+                              enum rstring_internal_pieces type,
+                              uintptr_t old_data, size_t old_len,
+                              const char *data)
+{
+    if (type == RSTRING_INTERNAL_PIECES_STR)
+    {
+        const char     *ptr    = ((const char *const *) pieces)[i];
+        const uintptr_t offset = (uintptr_t) ptr - old_data;
+
+        if ((uintptr_t) ptr >= old_data && offset <= old_len)
+        {
+            const char *end = memchr(data + offset, '\0', old_len - offset);
+            return (struct rstring_view){
+                data + offset,
+                end ? (size_t) (end - (data + offset)) : old_len - offset};
+        }
+
+        return rstring_view_from_str(ptr);
+    }
+
+    struct rstring_view piece = rstring_internal_piece(pieces, i, type);
+    piece.ptr = rstring_internal_rebase(piece.ptr, old_data, old_len, data);
+    return piece;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Appends |n| pieces to |dest| with |sep| between each two, growing |dest|
+ * once. The lengths are summed in a first pass and the bytes are copied in a
+ * second one.
+ */
+static rstring_status_t
+rstring_internal_join(struct rstring *dest, struct rstring_view sep,
+                      const void *pieces, size_t n,
+                      enum rstring_internal_pieces type)
+{
+    const uintptr_t old_data = (uintptr_t) rstring_data(dest);
+    const size_t    old_len  = dest->len;
+    size_t          total    = old_len;
+
+    if (n == 0)
+    {
+        return RSTRING_OK;
+    }
+
+    if (sep.len > 0 && n - 1 > (SIZE_MAX - 1 - total) / sep.len)
+    {
+        return RSTRING_ERROR_ALLOC;
+    }
+    total += (n - 1) * sep.len;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const size_t len = rstring_internal_piece(pieces, i, type).len;
+
+        if (len > SIZE_MAX - 1 - total)
+        {
+            return RSTRING_ERROR_ALLOC;
+        }
+        total += len;
+    }
+
+    ENSURE_CAPACITY(dest, total + 1);
+
+    /* Pieces referring to |dest| are read from its new buffer */
+    char *data = rstring_internal_data(dest);
+    char *out  = data + old_len;
+
+    sep.ptr = rstring_internal_rebase(sep.ptr, old_data, old_len, data);
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (i > 0 && sep.len > 0)
+        {
+            memcpy(out, sep.ptr, sep.len);
+            out += sep.len;
+        }
+
+        const struct rstring_view piece = rstring_internal_copied_piece(
+            pieces, i, type, old_data, old_len, data);
+
+        if (piece.len > 0)
+        {
+            memcpy(out, piece.ptr, piece.len);
+            out += piece.len;
+        }
+    }
+
+    dest->len   = total;
+    data[total] = '\0';
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * rstring_internal_join of C strings. Up to JOIN_STR_BATCH of them are
+ * measured once, into views on the stack. More are measured again as they are
+ * copied, rather than through a second allocation next to the one of |dest|.
+ */
+static rstring_status_t
+rstring_internal_join_str(struct rstring *dest, struct rstring_view sep,
+                          const char *const *pieces, size_t n)
+{
+    struct rstring_view views[JOIN_STR_BATCH];
+
+    if (n > JOIN_STR_BATCH)
+    {
+        return rstring_internal_join(
+            dest, sep, pieces, n, RSTRING_INTERNAL_PIECES_STR);
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        views[i] = rstring_view_from_str(pieces[i]);
+    }
+
+    return rstring_internal_join(
+        dest, sep, views, n, RSTRING_INTERNAL_PIECES_VIEW);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_find_first(const char *haystack, const char *needle,
+                            size_t haystack_len, size_t needle_len, size_t from,
+                            bool ignore_case)
+{
+    if (needle_len > haystack_len)
+    {
+        return RSTRING_NOT_FOUND;
+    }
+
+    if (from > haystack_len - needle_len)
+    {
+        return RSTRING_NOT_FOUND;
+    }
+
+    if (needle_len == 0)
+    {
+        return from;
+    }
+
+    const struct rstring_internal_needle n = {
+        .ptr         = (const uint8_t *) needle,
+        .len         = needle_len,
+        .probe1      = 0,
+        .probe2      = needle_len - 1,
+        .ignore_case = ignore_case,
+    };
+
+    const size_t pos = KERNEL_LOAD(rstring_internal_search)(
+        (const uint8_t *) haystack + from, haystack_len - from, &n);
+
+    STATS_ADD(finds, 1);
+    STATS_ADD(find_bytes, pos == RSTRING_NOT_FOUND ? haystack_len - from
+                                                   : pos + needle_len);
+
+    return pos == RSTRING_NOT_FOUND ? pos : pos + from;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Reports every occurrence of |needle| inside |haystack| from |from| to
+ * |matches|, whose destination the caller sets. An empty needle has none.
+ */
+static void
+rstring_internal_find_all(const char *haystack, const char *needle,
+                          size_t haystack_len, size_t needle_len, size_t from,
+                          enum rstring_overlap             overlap,
+                          struct rstring_internal_matches *matches)
+{
+    matches->base  = from;
+    matches->count = 0;
+    matches->next  = 0;
+    matches->step  = overlap == RSTRING_NON_OVERLAPPING ? needle_len : 1;
+    matches->rc    = RSTRING_OK;
+
+    if (needle_len == 0 || needle_len > haystack_len
+        || from > haystack_len - needle_len)
+    {
+        return;
+    }
+
+    const struct rstring_internal_needle n = {
+        .ptr         = (const uint8_t *) needle,
+        .len         = needle_len,
+        .probe1      = 0,
+        .probe2      = needle_len - 1,
+        .ignore_case = false,
+    };
+
+    KERNEL_LOAD(rstring_internal_search_all)(
+        (const uint8_t *) haystack + from, haystack_len - from, &n, matches);
+
+    STATS_ADD(finds, 1);
+    STATS_ADD(find_bytes, haystack_len - from);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_find_last(const char *haystack, const char *needle,
+                           size_t haystack_len, size_t needle_len, size_t end,
+                           bool ignore_case)
+{
+    if (end > haystack_len)
+    {
+        end = haystack_len;
+    }
+
+    if (needle_len > end)
+    {
+        return RSTRING_NOT_FOUND;
+    }
+
+    if (needle_len == 0)
+    {
+        return end;
+    }
+
+    const struct rstring_internal_needle n = {
+        .ptr         = (const uint8_t *) needle,
+        .len         = needle_len,
+        .probe1      = 0,
+        .probe2      = needle_len - 1,
+        .ignore_case = ignore_case,
+    };
+
+    const size_t pos = KERNEL_LOAD(rstring_internal_rsearch)(
+        (const uint8_t *) haystack, end, &n);
+
+    STATS_ADD(finds, 1);
+    STATS_ADD(find_bytes, pos == RSTRING_NOT_FOUND ? end : end - pos);
+
+    return pos;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Whether |view| refers to the contents of |rs| */
+static bool
+rstring_internal_overlaps(const struct rstring *rs, struct rstring_view view)
+{
+    const uintptr_t data = (uintptr_t) rstring_data(rs);
+    const uintptr_t ptr  = (uintptr_t) view.ptr;
+
+    return view.len > 0 && ptr >= data && ptr - data < rs->len;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Replaces the |n| bytes at |pos| of |rs| with |with|, clamping the range to
+ * the contents. The tail is moved once, after growing |rs| if needed.
+ */
+static rstring_status_t
+rstring_internal_splice(struct rstring *rs, size_t pos, size_t n,
+                        struct rstring_view with)
+{
+    /* Moving the tail would clobber a replacement taken from |rs| itself */
+    if (rstring_internal_overlaps(rs, with))
+    {
+        struct rstring copy;
+        rstring_init(&copy);
+
+        rstring_status_t rc = rstring_push_view(&copy, with);
+        if (rc == RSTRING_OK)
+        {
+            rc = rstring_internal_splice(rs, pos, n, rstring_view_from(&copy));
+        }
+
+        rstring_free(&copy);
+        return rc;
+    }
+
+    const size_t len = rs->len;
+
+    if (pos > len)
+    {
+        pos = len;
+    }
+
+    if (n > len - pos)
+    {
+        n = len - pos;
+    }
+
+    if (with.len > SIZE_MAX - 1 - (len - n))
+    {
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    const size_t new_length = len - n + with.len;
+    ENSURE_CAPACITY(rs, new_length + 1);    // Add one for nullterm
+    char *data = rstring_internal_data(rs);
+
+    /* The tail and its null-terminator */
+    memmove(data + pos + with.len, data + pos + n, len - pos - n + 1);
+
+    if (with.len > 0)
+    {
+        memcpy(data + pos, with.ptr, with.len);
+    }
+
+    rs->len = new_length;
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Replaces every non-overlapping occurrence of |from| in |rs|, scanning left to
+ * right, with |to|.
+ *
+ * The contents are rewritten in a single forward pass, with the write position
+ * never ahead of the read position. When |to| is longer than |from|, the
+ * occurrences are counted first so that |rs| grows once, to its final size,
+ * and the contents from the first one on are moved to the end of the new
+ * buffer to make room for that pass.
+ */
+static rstring_status_t
+rstring_internal_replace_all(struct rstring *rs, struct rstring_view from,
+                             struct rstring_view to)
+{
+    if (from.len == 0 || from.len > rs->len)
+    {
+        return RSTRING_OK;
+    }
+
+    /* The contents move, |from| and |to| must not move along */
+    if (rstring_internal_overlaps(rs, from)
+        || rstring_internal_overlaps(rs, to))
+    {
+        struct rstring copy;
+        rstring_init(&copy);
+
+        rstring_status_t rc = rstring_push_view(&copy, from);
+        if (rc == RSTRING_OK)
+        {
+            rc = rstring_push_view(&copy, to);
+        }
+
+        if (rc == RSTRING_OK)
+        {
+            const struct rstring_view both = rstring_view_from(&copy);
+
+            from = rstring_view_prefix(both, from.len);
+            to   = rstring_view_slice(both, from.len, to.len);
+            rc   = rstring_internal_replace_all(rs, from, to);
+        }
+
+        rstring_free(&copy);
+        return rc;
+    }
+
+    const size_t len    = rs->len;
+    size_t       growth = 0;
+
+    size_t pos = rstring_internal_find_first(
+        rstring_data(rs), from.ptr, len, from.len, 0, false);
+
+    if (pos == RSTRING_NOT_FOUND)
+    {
+        return RSTRING_OK;
+    }
+
+    if (to.len > from.len)
+    {
+        const size_t delta = to.len - from.len;
+        const size_t count = rstring_view_count(
+            rstring_view_from(rs), from, pos, RSTRING_NON_OVERLAPPING);
+
+        if (count > (SIZE_MAX - 1 - len) / delta)
+        {
+            return RSTRING_ERROR_ALLOC;
+        }
+
+        growth = count * delta;
+        ENSURE_CAPACITY(rs, len + growth + 1);    // Add one for nullterm
+    }
+
+    char       *data  = rstring_internal_data(rs);
+    const char *src   = data + growth;
+    size_t      read  = pos;
+    size_t      write = pos;
+
+    /* Everything from the first occurrence on is read from |src| */
+    if (growth > 0)
+    {
+        memmove(data + growth + pos, data + pos, len - pos);
+    }
+
+    while (pos != RSTRING_NOT_FOUND)
+    {
+        if (write != read + growth)
+        {
+            memmove(data + write, src + read, pos - read);
+        }
+        write += pos - read;
+
+        if (to.len > 0)
+        {
+            memcpy(data + write, to.ptr, to.len);
+            write += to.len;
+        }
+        read = pos + from.len;
+
+        pos = rstring_internal_find_first(
+            src, from.ptr, len, from.len, read, false);
+    }
+
+    if (write != read + growth)
+    {
+        memmove(data + write, src + read, len - read);
+    }
+    write += len - read;
+
+    data[write] = '\0';
+    rs->len     = write;
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+/* HASHING                                                                    */
+/*----------------------------------------------------------------------------*/
+
+/* Unaligned loads in native byte order */
+static inline uint64_t
+rstring_internal_read64(const uint8_t *p)
+{
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static inline uint64_t
+rstring_internal_read32(const uint8_t *p)
+{
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Up to 3 bytes, every one of which is read */
+static inline uint64_t
+rstring_internal_read_small(const uint8_t *p, size_t n)
+{
+    return ((uint64_t) p[0] << 16) | ((uint64_t) p[n >> 1] << 8) | p[n - 1];
+}
+
+/*----------------------------------------------------------------------------*/
+
+static inline uint64_t
+rstring_internal_hash_mix(uint64_t a, uint64_t b)
+{
+    uint64_t hi, lo;
+    rstring_internal_mul_64x64(a, b, &hi, &lo);
+    return hi ^ lo;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Odd constants with balanced bits, from wyhash */
+static const uint64_t rstring_internal_hash_secret[4] = {
+    UINT64_C(0x2D358DCCAA6C78A5),
+    UINT64_C(0x8BB84B93962EACC9),
+    UINT64_C(0x4B33A62ED433D4A3),
+    UINT64_C(0x4D5A2DA51DE1AA47),
+};
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * With |fold|, every word read is lower-cased first, which hashes the bytes as
+ * if they were converted by rstring_tolower.
+ */
+__attribute__((always_inline)) static inline uint64_t
+rstring_internal_hash(const uint8_t *p, size_t len, uint64_t seed, bool fold)
+{
+    const uint64_t *secret = rstring_internal_hash_secret;
+    uint64_t        a, b;
+
+    seed ^= rstring_internal_hash_mix(seed ^ secret[0], secret[1]);
+
+    if (len <= 16)
+    {
+        if (len >= 4)
+        {
+            /* Two pairs of overlapping 4-byte loads cover 4 to 16 bytes */
+            const size_t step = (len >> 3) << 2;
+
+            a = (rstring_internal_read32(p) << 32)
+                | rstring_internal_read32(p + step);
+            b = (rstring_internal_read32(p + len - 4) << 32)
+                | rstring_internal_read32(p + len - 4 - step);
+        }
+        else if (len > 0)
+        {
+            a = rstring_internal_read_small(p, len);
+            b = 0;
+        }
+        else
+        {
+            a = 0;
+            b = 0;
+        }
+
+        if (fold)
+        {
+            a = rstring_internal_fold64(a);
+            b = rstring_internal_fold64(b);
+        }
+    }
+    else
+    {
+        size_t i = len;
+
+        /* Every load below is 8 bytes wide */
+#define READ(q)                                                                \
+    (fold ? rstring_internal_fold64(rstring_internal_read64(q))                \
+          : rstring_internal_read64(q))
+
+        if (i > 48)
+        {
+            uint64_t lane1 = seed;
+            uint64_t lane2 = seed;
+
+            do
+            {
+                seed  = rstring_internal_hash_mix(
+                    READ(p) ^ secret[1],
+                    READ(p + 8) ^ seed);
+                lane1 = rstring_internal_hash_mix(
+                    READ(p + 16) ^ secret[2],
+                    READ(p + 24) ^ lane1);
+                lane2 = rstring_internal_hash_mix(
+                    READ(p + 32) ^ secret[3],
+                    READ(p + 40) ^ lane2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+
+            seed ^= lane1 ^ lane2;
+        }
+
+        while (i > 16)
+        {
+            seed = rstring_internal_hash_mix(
+                READ(p) ^ secret[1],
+                READ(p + 8) ^ seed);
+            p += 16;
+            i -= 16;
+        }
+
+        /* The last 16 bytes, overlapping the ones already mixed in */
+        a = READ(p + i - 16);
+        b = READ(p + i - 8);
+#undef READ
+    }
+
+    uint64_t hi, lo;
+    rstring_internal_mul_64x64(a ^ secret[1], b ^ seed, &hi, &lo);
+
+    return rstring_internal_hash_mix(lo ^ secret[0] ^ len, hi ^ secret[1]);
+}
+
+/*----------------------------------------------------------------------------*/
+/* FINDER ALGORITHMS                                                          */
+/*----------------------------------------------------------------------------*/
+
+/* Needles shorter than this always use the prefilter */
+#define FINDER_SHORT_NEEDLE 8
+
+/* Needles of at least this length always use Two-Way */
+#define FINDER_LONG_NEEDLE 256
+
+/* Probing on a byte of this rank or below is selective enough to prefilter */
+#define FINDER_RARE_RANK 3
+
+#ifdef RSTRING_HAVE_X86_SIMD
+#    define FINDER_VECTORIZED true
+#else
+#    define FINDER_VECTORIZED false
+#endif
+
+/*
+ * Rough frequency class of a byte in text-like data (logs, headers, prose),
+ * higher is more common.
+ */
+static unsigned
+rstring_internal_byte_rank(uint8_t c)
+{
+    if (c == ' ' || (c != '\0' && strchr("etaoinsrhl", c)))
+    {
+        return 5;
+    }
+
+    if (c >= 'a' && c <= 'z')
+    {
+        return 4;
+    }
+
+    if ((c >= '0' && c <= '9') || (c != '\0' && strchr(".,-_/:=\n", c)))
+    {
+        return 3;
+    }
+
+    if (c >= 'A' && c <= 'Z')
+    {
+        return 2;
+    }
+
+    return (c >= 0x20 && c < 0x7F) ? 1 : 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Computes the maximal suffix of |x| for one of the two orderings of the
+ * alphabet, and its period. Returns the position the suffix starts at, minus
+ * one (modulo SIZE_MAX + 1, so the empty prefix is SIZE_MAX).
+ */
+static size_t
+rstring_internal_maximal_suffix(const uint8_t *x, size_t m, bool reverse,
+                                size_t *period)
+{
+    size_t max_suffix = SIZE_MAX;
+    size_t j          = 0;
+    size_t k          = 1;
+    size_t p          = 1;
+
+    while (j + k < m)
+    {
+        const uint8_t a = x[j + k];
+        const uint8_t b = x[max_suffix + k];
+
+        if (reverse ? (b < a) : (a < b))
+        {
+            j += k;
+            k = 1;
+            p = j - max_suffix;
+        }
+        else if (a == b)
+        {
+            if (k != p)
+            {
+                ++k;
+            }
+            else
+            {
+                j += p;
+                k = 1;
+            }
+        }
+        else
+        {
+            max_suffix = j++;
+            k = p = 1;
+        }
+    }
+
+    *period = p;
+    return max_suffix;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+rstring_internal_two_way_compile(struct rstring_finder *finder)
+{
+    const uint8_t *x = (const uint8_t *) rstring_data(&finder->needle);
+    const size_t   m = finder->needle.len;
+    size_t         period1;
+    size_t         period2;
+
+    const size_t s1 = rstring_internal_maximal_suffix(x, m, false, &period1);
+    const size_t s2 = rstring_internal_maximal_suffix(x, m, true, &period2);
+
+    /* The critical factorization is given by the later of the two suffixes */
+    if (s2 + 1 < s1 + 1)
+    {
+        finder->critical_pos = s1 + 1;
+        finder->period       = period1;
+    }
+    else
+    {
+        finder->critical_pos = s2 + 1;
+        finder->period       = period2;
+    }
+
+    finder->periodic =
+        memcmp(x, x + finder->period, finder->critical_pos) == 0;
+
+    if (!finder->periodic)
+    {
+        const size_t right = m - finder->critical_pos;
+        finder->period =
+            (finder->critical_pos > right ? finder->critical_pos : right) + 1;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+static inline uint8_t
+rstring_internal_canon(uint8_t c, bool ignore_case)
+{
+    return ignore_case ? rstring_internal_fold(c) : c;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Crochemore-Perrin Two-Way search, over the positions [0, hay_len - m] */
+static size_t
+rstring_internal_two_way_search(const struct rstring_finder *finder,
+                                const uint8_t *hay, size_t hay_len)
+{
+    const uint8_t *x      = (const uint8_t *) rstring_data(&finder->needle);
+    const size_t   m      = finder->needle.len;
+    const size_t   crit   = finder->critical_pos;
+    const size_t   period = finder->period;
+    const bool     ic     = finder->ignore_case;
+    size_t         memory = 0;
+    size_t         j      = 0;
+
+    while (j <= hay_len - m)
+    {
+        /* Scan the right half, skipping what is remembered to match */
+        size_t i = (finder->periodic && memory > crit) ? memory : crit;
+        while (i < m && x[i] == rstring_internal_canon(hay[i + j], ic))
+        {
+            ++i;
+        }
+
+        if (i < m)
+        {
+            j += i - crit + 1;
+            memory = 0;
+            continue;
+        }
+
+        /* Scan the left half, backwards */
+        const size_t stop = finder->periodic ? memory : 0;
+        i                 = crit;
+        while (i > stop &&
+               x[i - 1] == rstring_internal_canon(hay[i - 1 + j], ic))
+        {
+            --i;
+        }
+
+        if (i <= stop)
+        {
+            return j;
+        }
+
+        j += period;
+        memory = finder->periodic ? m - period : 0;
+    }
+
+    return RSTRING_NOT_FOUND;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+rstring_internal_horspool_compile(struct rstring_finder *finder)
+{
+    const uint8_t *x = (const uint8_t *) rstring_data(&finder->needle);
+    const size_t   m = finder->needle.len;
+
+    memset(finder->shift, (int) m, sizeof(finder->shift));
+
+    for (size_t i = 0; i + 1 < m; ++i)
+    {
+        finder->shift[x[i]] = (uint8_t) (m - 1 - i);
+
+        if (finder->ignore_case)
+        {
+            finder->shift[rstring_internal_swap_case(x[i])] =
+                (uint8_t) (m - 1 - i);
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Boyer-Moore-Horspool search, over the positions [0, hay_len - m] */
+static size_t
+rstring_internal_horspool_search(const struct rstring_finder *finder,
+                                 const uint8_t *hay, size_t hay_len)
+{
+    const uint8_t *x    = (const uint8_t *) rstring_data(&finder->needle);
+    const size_t   m    = finder->needle.len;
+    const bool     ic   = finder->ignore_case;
+    const uint8_t  last = x[m - 1];
+
+    for (size_t j = 0; j <= hay_len - m; j += finder->shift[hay[j + m - 1]])
+    {
+        if (rstring_internal_canon(hay[j + m - 1], ic) == last &&
+            rstring_internal_memeq(hay + j, x, m - 1, ic))
+        {
+            return j;
+        }
+    }
+
+    return RSTRING_NOT_FOUND;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+rstring_internal_prefilter_compile(struct rstring_finder *finder)
+{
+    const uint8_t *x = (const uint8_t *) rstring_data(&finder->needle);
+    const size_t   m = finder->needle.len;
+
+    finder->probe1 = 0;
+    for (size_t i = 1; i < m; ++i)
+    {
+        if (rstring_internal_byte_rank(x[i]) <
+            rstring_internal_byte_rank(x[finder->probe1]))
+        {
+            finder->probe1 = i;
+        }
+    }
+
+    finder->probe2 = finder->probe1 == m - 1 ? 0 : m - 1;
+    for (size_t i = 0; i < m; ++i)
+    {
+        if (i != finder->probe1 && rstring_internal_byte_rank(x[i]) <
+                                       rstring_internal_byte_rank(
+                                           x[finder->probe2]))
+        {
+            finder->probe2 = i;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+static rstring_status_t
+rstring_internal_finder_compile(struct rstring_finder *finder,
+                                const char *needle, size_t needle_len,
+                                bool ignore_case)
+{
+    rstring_init(&finder->needle);
+
+    if (needle_len > 0)
+    {
+        ENSURE_CAPACITY((&finder->needle), needle_len + 1);
+    }
+
+    uint8_t *x = (uint8_t *) rstring_internal_data(&finder->needle);
+    for (size_t i = 0; i < needle_len; ++i)
+    {
+        x[i] = rstring_internal_canon((uint8_t) needle[i], ignore_case);
+    }
+    x[needle_len]      = '\0';
+    finder->needle.len = needle_len;
+
+    finder->ignore_case = ignore_case;
+    finder->algorithm   = RSTRING_FINDER_PREFILTER;
+
+    if (needle_len == 0)
+    {
+        return RSTRING_OK;
+    }
+
+    if (needle_len >= FINDER_LONG_NEEDLE)
+    {
+        finder->algorithm = RSTRING_FINDER_TWO_WAY;
+        rstring_internal_two_way_compile(finder);
+        return RSTRING_OK;
+    }
+
+    rstring_internal_prefilter_compile(finder);
+
+    /*
+     * The vectorized prefilter beats Horspool even on common bytes. Without it,
+     * the scalar prefilter is only as good as memchr on its probe byte.
+     */
+    if (!FINDER_VECTORIZED && needle_len >= FINDER_SHORT_NEEDLE &&
+        rstring_internal_byte_rank(x[finder->probe1]) > FINDER_RARE_RANK)
+    {
+        finder->algorithm = RSTRING_FINDER_HORSPOOL;
+        rstring_internal_horspool_compile(finder);
+    }
+
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+/* PUBLIC FUNCTIONS */
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_init(struct rstring *rs)
+{
+    rstring_init_with_allocator(rs, NULL);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_init_with_allocator(struct rstring                 *rs,
+                            const struct rstring_allocator *allocator)
+{
+    rs->len       = 0;
+    rs->cap       = RSTRING_SSO_CAPACITY;
+    rs->data      = NULL;
+    rs->allocator = allocator;
+    rs->sso[0]    = '\0';
+#ifdef RSTRING_CACHED_HASH
+    rs->hash = 0;
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_ensure_capacity(struct rstring *rs, const size_t wanted_cap)
+{
+    if (rstring_is_inline(rs))
+    {
+        /* A zero-initialized rstring is inline with a capacity of 0 */
+        rs->cap = RSTRING_SSO_CAPACITY;
+    }
+
+    if (wanted_cap <= rs->cap)
+    {
+        return RSTRING_OK;
+    }
+
+    return rstring_internal_resize(
+        rs, rstring_internal_grown_cap(rs->cap, wanted_cap));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_reserve_exact(struct rstring *rs, size_t wanted_cap)
+{
+    if (rstring_is_inline(rs))
+    {
+        rs->cap = RSTRING_SSO_CAPACITY;
+    }
+
+    if (wanted_cap <= rs->cap)
+    {
+        return RSTRING_OK;
+    }
+
+    return rstring_internal_resize(rs, wanted_cap);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_shrink_to_fit(struct rstring *rs)
+{
+    if (rstring_is_inline(rs) || rs->cap == rs->len + 1)
+    {
+        return RSTRING_OK;
+    }
+
+    if (rs->len < RSTRING_SSO_CAPACITY)
+    {
+        /* Back to the inline buffer, the heap one is not needed anymore */
+        memcpy(rs->sso, rs->data, rs->len + 1);
+        rstring_internal_dealloc(rs);
+
+        rs->cap  = RSTRING_SSO_CAPACITY;
+        rs->data = NULL;
+        return RSTRING_OK;
+    }
+
+    return rstring_internal_resize(rs, rs->len + 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+enum rstring_growth_policy
+rstring_set_growth_policy(enum rstring_growth_policy policy)
+{
+    const enum rstring_growth_policy previous = rstring_internal_growth;
+
+    rstring_internal_growth = policy;
+    return previous;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push(struct rstring *dest, const struct rstring *src)
+{
+    return rstring_internal_push(dest, rstring_data(src), src->len);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_byte(struct rstring *rs, uint8_t byte)
+{
+    const size_t new_length = rs->len + 1;
+
+    ENSURE_CAPACITY(rs, new_length + 1);
+
+    char *data = rstring_internal_data(rs);
+
+    ((uint8_t *) data)[rs->len] = byte;
+    rs->len                     = new_length;
+    data[rs->len]               = '\0';
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_str(struct rstring *rs, const char *str)
+{
+    return rstring_internal_push(rs, str, strlen(str));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_view(struct rstring *rs, struct rstring_view view)
+{
+    return rstring_internal_push(rs, view.ptr, view.len);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_many(struct rstring *dest, const struct rstring *pieces, size_t n)
+{
+    const struct rstring_view no_sep = {NULL, 0};
+    return rstring_internal_join(
+        dest, no_sep, pieces, n, RSTRING_INTERNAL_PIECES_RSTRING);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_many_str(struct rstring *dest, const char *const *pieces,
+                      size_t n)
+{
+    const struct rstring_view no_sep = {NULL, 0};
+    return rstring_internal_join_str(dest, no_sep, pieces, n);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_many_view(struct rstring *dest, const struct rstring_view *pieces,
+                       size_t n)
+{
+    const struct rstring_view no_sep = {NULL, 0};
+    return rstring_internal_join(
+        dest, no_sep, pieces, n, RSTRING_INTERNAL_PIECES_VIEW);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_join(struct rstring *dest, const struct rstring *sep,
+             const struct rstring *pieces, size_t n)
+{
+    return rstring_internal_join(dest,
+                                 rstring_view_from(sep),
+                                 pieces,
+                                 n,
+                                 RSTRING_INTERNAL_PIECES_RSTRING);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_join_str(struct rstring *dest, const char *sep,
+                 const char *const *pieces, size_t n)
+{
+    return rstring_internal_join_str(
+        dest, rstring_view_from_str(sep), pieces, n);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_join_view(struct rstring *dest, struct rstring_view sep,
+                  const struct rstring_view *pieces, size_t n)
+{
+    return rstring_internal_join(
+        dest, sep, pieces, n, RSTRING_INTERNAL_PIECES_VIEW);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_insert(struct rstring *rs, size_t pos, const struct rstring *src)
+{
+    return rstring_internal_splice(rs, pos, 0, rstring_view_from(src));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_insert_str(struct rstring *rs, size_t pos, const char *str)
+{
+    return rstring_internal_splice(rs, pos, 0, rstring_view_from_str(str));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_insert_view(struct rstring *rs, size_t pos, struct rstring_view view)
+{
+    return rstring_internal_splice(rs, pos, 0, view);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_erase(struct rstring *rs, size_t pos, size_t n)
+{
+    const size_t len = rs->len;
+
+    if (pos >= len || n == 0)
+    {
+        return;
+    }
+
+    if (n > len - pos)
+    {
+        n = len - pos;
+    }
+
+    char *data = rstring_internal_data(rs);
+
+    /* The tail and its null-terminator */
+    memmove(data + pos, data + pos + n, len - pos - n + 1);
+    rs->len = len - n;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_splice(struct rstring *rs, size_t pos, size_t n,
+               const struct rstring *with)
+{
+    return rstring_internal_splice(rs, pos, n, rstring_view_from(with));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_splice_str(struct rstring *rs, size_t pos, size_t n, const char *with)
+{
+    return rstring_internal_splice(rs, pos, n, rstring_view_from_str(with));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_splice_view(struct rstring *rs, size_t pos, size_t n,
+                    struct rstring_view with)
+{
+    return rstring_internal_splice(rs, pos, n, with);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_replace_all(struct rstring *rs, const struct rstring *from,
+                    const struct rstring *to)
+{
+    return rstring_internal_replace_all(
+        rs, rstring_view_from(from), rstring_view_from(to));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_replace_all_str(struct rstring *rs, const char *from, const char *to)
+{
+    return rstring_internal_replace_all(
+        rs, rstring_view_from_str(from), rstring_view_from_str(to));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_replace_all_view(struct rstring *rs, struct rstring_view from,
+                         struct rstring_view to)
+{
+    return rstring_internal_replace_all(rs, from, to);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t
+rstring_hash(struct rstring *rs)
+{
+#ifdef RSTRING_CACHED_HASH
+    if (rs->hash != 0)
+    {
+        return rs->hash;
+    }
+
+    /* A hash of 0 is not cached, and is computed again on every call */
+    rs->hash = rstring_internal_hash(
+        (const uint8_t *) rstring_data(rs), rs->len, 0, false);
+    return rs->hash;
+#else
+    return rstring_internal_hash(
+        (const uint8_t *) rstring_data(rs), rs->len, 0, false);
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t
+rstring_hash_view(struct rstring_view view, uint64_t seed)
+{
+    return rstring_internal_hash(
+        (const uint8_t *) view.ptr, view.len, seed, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t
+rstring_hash_str(const char *str, uint64_t seed)
+{
+    return rstring_internal_hash(
+        (const uint8_t *) str, strlen(str), seed, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t
+rstring_hash_view_ignore_case(struct rstring_view view, uint64_t seed)
+{
+    return rstring_internal_hash(
+        (const uint8_t *) view.ptr, view.len, seed, true);
+}
+
+/*----------------------------------------------------------------------------*/
+
+uint64_t
+rstring_hash_str_ignore_case(const char *str, uint64_t seed)
+{
+    return rstring_internal_hash(
+        (const uint8_t *) str, strlen(str), seed, true);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_free(struct rstring *rs)
+{
+    if (!rstring_is_inline(rs))
+    {
+        rstring_internal_dealloc(rs);
+    }
+
+    rstring_init_with_allocator(rs, rs->allocator);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_find_first_byte(const struct rstring *rs, uint8_t byte, size_t from)
+{
+    return rstring_view_find_first_byte(rstring_view_from(rs), byte, from);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_find_last_byte(const struct rstring *rs, uint8_t byte)
+{
+    return rstring_find_last_byte_from(rs, byte, rs->len);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_find_last_byte_from(const struct rstring *rs, uint8_t byte, size_t end)
+{
+    return rstring_internal_find_last(
+        rstring_data(rs), (const char *) &byte, rs->len, 1, end, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_find_first(const struct rstring *haystack, const struct rstring *needle,
+                   size_t from)
+{
+    return rstring_internal_find_first(rstring_data(haystack),
+                                       rstring_data(needle),
+                                       haystack->len,
+                                       needle->len,
+                                       from,
+                                       false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_find_first_str(const struct rstring *haystack, const char *needle,
+                       size_t from)
+{
+    const size_t needle_len = strlen(needle);
+    return rstring_internal_find_first(rstring_data(haystack),
+                                       needle,
+                                       haystack->len,
+                                       needle_len,
+                                       from,
+                                       false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_find_first_ignore_case(const struct rstring *haystack,
+                               const struct rstring *needle, size_t from)
+{
+    return rstring_internal_find_first(rstring_data(haystack),
+                                       rstring_data(needle),
+                                       haystack->len,
+                                       needle->len,
+                                       from,
+                                       true);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_find_first_str_ignore_case(const struct rstring *haystack,
+                                   const char *needle, size_t from)
+{
+    const size_t needle_len = strlen(needle);
+    return rstring_internal_find_first(rstring_data(haystack),
+                                       needle,
+                                       haystack->len,
+                                       needle_len,
+                                       from,
+                                       true);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_offsets_init(struct rstring_offsets *offsets)
+{
+    offsets->data = NULL;
+    offsets->len  = 0;
+    offsets->cap  = 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_offsets_free(struct rstring_offsets *offsets)
+{
+    free(offsets->data);
+    rstring_offsets_init(offsets);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_internal_offsets_reserve(struct rstring_offsets *offsets, size_t n)
+{
+    if (n <= offsets->cap - offsets->len)
+    {
+        return RSTRING_OK;
+    }
+
+    if (n > SIZE_MAX / sizeof(size_t) - offsets->len)
+    {
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    /* Doubles, starting from a cache line of offsets */
+    size_t cap = offsets->cap < 8 ? 8 : offsets->cap;
+    cap        = cap <= SIZE_MAX / sizeof(size_t) / 2 ? cap * 2 : cap;
+    if (cap < offsets->len + n)
+    {
+        cap = offsets->len + n;
+    }
+
+    size_t *data = realloc(offsets->data, cap * sizeof(size_t));
+    if (data == NULL)
+    {
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    offsets->data = data;
+    offsets->cap  = cap;
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_find_all(const struct rstring *haystack, const struct rstring *needle,
+                 size_t from, enum rstring_overlap overlap,
+                 struct rstring_offsets *out)
+{
+    return rstring_view_find_all(rstring_view_from(haystack),
+                                 rstring_view_from(needle),
+                                 from,
+                                 overlap,
+                                 out);
+}
+
 /*----------------------------------------------------------------------------*/
 
-/* Sentinel empty buffer */
-char _rstring_empty[1];
+rstring_status_t
+rstring_find_all_str(const struct rstring *haystack, const char *needle,
+                     size_t from, enum rstring_overlap overlap,
+                     struct rstring_offsets *out)
+{
+    return rstring_view_find_all(rstring_view_from(haystack),
+                                 rstring_view_from_str(needle),
+                                 from,
+                                 overlap,
+                                 out);
+}
 
 /*----------------------------------------------------------------------------*/
-/* INTERNAL MACROS                                                            */
-/*----------------------------------------------------------------------------*/
-
-#define ONE_BYTE 0xFFU
 
-/*
- * Only call ensure_capacity when needed, because calling ensure_capacity
- * triggers either a malloc or a realloc, which is expensive.
- */
-#define ENSURE_CAPACITY(rs, newcap)                                            \
-    do                                                                         \
-    {                                                                          \
-        if (newcap >= rs->cap)                                                 \
-        {                                                                      \
-            rstring_status_t __temp_rc = rstring_ensure_capacity(rs, newcap);  \
-            if (__temp_rc != RSTRING_OK)                                       \
-            {                                                                  \
-                return __temp_rc;                                              \
-            }                                                                  \
-        }                                                                      \
-    } while (0)
+size_t
+rstring_count(const struct rstring *haystack, const struct rstring *needle,
+              size_t from, enum rstring_overlap overlap)
+{
+    return rstring_view_count(
+        rstring_view_from(haystack), rstring_view_from(needle), from, overlap);
+}
 
 /*----------------------------------------------------------------------------*/
-/* INTERNAL FUNCTIONS */
+
+size_t
+rstring_count_str(const struct rstring *haystack, const char *needle,
+                  size_t from, enum rstring_overlap overlap)
+{
+    return rstring_view_count(rstring_view_from(haystack),
+                              rstring_view_from_str(needle),
+                              from,
+                              overlap);
+}
+
 /*----------------------------------------------------------------------------*/
 
-static rstring_status_t
-rstring_internal_push(struct rstring *dest, const char *src, size_t n)
+int
+rstring_view_cmp_ignore_case(struct rstring_view v1, struct rstring_view v2)
 {
-    if (n == 0)
+    const size_t   n  = v1.len < v2.len ? v1.len : v2.len;
+    const uint8_t *p1 = (const uint8_t *) v1.ptr;
+    const uint8_t *p2 = (const uint8_t *) v2.ptr;
+    const size_t   i  = KERNEL_LOAD(rstring_internal_mismatch)(p1, p2, n, true);
+
+    if (i < n)
     {
-        return RSTRING_OK;
+        return rstring_internal_fold(p1[i]) < rstring_internal_fold(p2[i])
+                 ? -1
+                 : 1;
     }
 
-    const size_t new_length = dest->len + n;
-    ENSURE_CAPACITY(dest, new_length + 1);    // Add one for nullterm
-    memcpy(dest->data + dest->len, src, n);
-    dest->len              = new_length;
-    dest->data[new_length] = '\0';
-    return RSTRING_OK;
+    if (v1.len == v2.len)
+    {
+        return 0;
+    }
+
+    return v1.len < v2.len ? -1 : 1;
 }
 
 /*----------------------------------------------------------------------------*/
 
-static size_t
-rstring_internal_find_first(const char *haystack, const char *needle,
-                            size_t haystack_len, size_t needle_len, size_t from,
-                            bool ignore_case)
+size_t
+rstring_view_common_prefix(struct rstring_view v1, struct rstring_view v2)
 {
-    char *p = NULL;
+    return KERNEL_LOAD(rstring_internal_mismatch)(
+        (const uint8_t *) v1.ptr,
+        (const uint8_t *) v2.ptr,
+        v1.len < v2.len ? v1.len : v2.len,
+        false);
+}
 
-    if (needle_len > haystack_len)
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_view_common_prefix_ignore_case(struct rstring_view v1,
+                                       struct rstring_view v2)
+{
+    return KERNEL_LOAD(rstring_internal_mismatch)(
+        (const uint8_t *) v1.ptr,
+        (const uint8_t *) v2.ptr,
+        v1.len < v2.len ? v1.len : v2.len,
+        true);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_view_find_first_byte(struct rstring_view view, uint8_t byte,
+                             size_t from)
+{
+    if (from >= view.len)
     {
         return RSTRING_NOT_FOUND;
     }
 
-    if (from > haystack_len - needle_len)
+    const char *p = memchr(view.ptr + from, byte, view.len - from);
+
+    STATS_ADD(finds, 1);
+    STATS_ADD(find_bytes, p ? (size_t) (p - view.ptr) + 1 - from
+                            : view.len - from);
+
+    return p ? (size_t) (p - view.ptr) : RSTRING_NOT_FOUND;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_view_find_last_byte(struct rstring_view view, uint8_t byte,
+                            size_t end)
+{
+    return rstring_internal_find_last(
+        view.ptr, (const char *) &byte, view.len, 1, end, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_view_find_first(struct rstring_view haystack,
+                        struct rstring_view needle, size_t from)
+{
+    return rstring_internal_find_first(
+        haystack.ptr, needle.ptr, haystack.len, needle.len, from, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_view_find_first_ignore_case(struct rstring_view haystack,
+                                    struct rstring_view needle, size_t from)
+{
+    return rstring_internal_find_first(
+        haystack.ptr, needle.ptr, haystack.len, needle.len, from, true);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_view_find_last(struct rstring_view haystack, struct rstring_view needle,
+                       size_t end)
+{
+    return rstring_internal_find_last(
+        haystack.ptr, needle.ptr, haystack.len, needle.len, end, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_view_find_last_ignore_case(struct rstring_view haystack,
+                                   struct rstring_view needle, size_t end)
+{
+    return rstring_internal_find_last(
+        haystack.ptr, needle.ptr, haystack.len, needle.len, end, true);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_view_find_all(struct rstring_view haystack, struct rstring_view needle,
+                      size_t from, enum rstring_overlap overlap,
+                      struct rstring_offsets *out)
+{
+    struct rstring_internal_matches matches = {.out = out};
+    const size_t                    len     = out->len;
+
+    rstring_internal_find_all(haystack.ptr,
+                              needle.ptr,
+                              haystack.len,
+                              needle.len,
+                              from,
+                              overlap,
+                              &matches);
+
+    if (matches.rc != RSTRING_OK)
     {
-        return RSTRING_NOT_FOUND;
+        out->len = len;
     }
 
-    if (ignore_case)
+    return matches.rc;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_view_find_all_into(struct rstring_view haystack,
+                           struct rstring_view needle, size_t from,
+                           enum rstring_overlap overlap, size_t *offsets,
+                           size_t cap)
+{
+    struct rstring_internal_matches matches = {.buf = offsets, .cap = cap};
+
+    rstring_internal_find_all(haystack.ptr,
+                              needle.ptr,
+                              haystack.len,
+                              needle.len,
+                              from,
+                              overlap,
+                              &matches);
+
+    return matches.count;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_view_count(struct rstring_view haystack, struct rstring_view needle,
+                   size_t from, enum rstring_overlap overlap)
+{
+    return rstring_view_find_all_into(haystack, needle, from, overlap, NULL, 0);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_byte_set_init(struct rstring_byte_set *set,
+                      struct rstring_view      members)
+{
+    memset(set, 0, sizeof(*set));
+
+    for (unsigned h = 0; h < 16; ++h)
     {
-        p = strcasestr(haystack + from, needle);
+        set->hi[h >> 3][h] = (uint8_t) (1U << (h & 7));
     }
-    else
+
+    for (size_t i = 0; i < members.len; ++i)
     {
-        p = strstr(haystack + from, needle);
+        const uint8_t c = (uint8_t) members.ptr[i];
+
+        set->bits[c >> 3] |= (uint8_t) (1U << (c & 7));
+        set->lo[c >> 7][c & 0x0F] |= (uint8_t) (1U << ((c >> 4) & 7));
+        set->high = set->high || c >= 0x80;
     }
+}
 
-    if (!p)
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_view_find_first_of(struct rstring_view            view,
+                           const struct rstring_byte_set *set, size_t from)
+{
+    if (from >= view.len)
     {
         return RSTRING_NOT_FOUND;
     }
 
-    return p - haystack;
+    const size_t pos = KERNEL_LOAD(rstring_internal_find_any)(
+        (const uint8_t *) view.ptr + from, view.len - from, set);
+
+    STATS_ADD(finds, 1);
+    STATS_ADD(find_bytes, pos == RSTRING_NOT_FOUND ? view.len - from : pos + 1);
+
+    return pos == RSTRING_NOT_FOUND ? pos : pos + from;
 }
 
 /*----------------------------------------------------------------------------*/
-/* PUBLIC FUNCTIONS */
+
+void
+rstring_split_init_byte(struct rstring_split *it, struct rstring_view source,
+                        uint8_t byte)
+{
+    it->rest = source;
+    it->done = false;
+    it->kind = RSTRING_SPLIT_BYTE;
+    it->byte = byte;
+}
+
 /*----------------------------------------------------------------------------*/
 
 void
-rstring_init(struct rstring *rs)
+rstring_split_init(struct rstring_split *it, struct rstring_view source,
+                   struct rstring_view delim)
 {
-    rs->len           = 0;
-    rs->data          = _rstring_empty;
-    rs->cap           = 0;
-    _rstring_empty[0] = '\0';
+    it->rest  = source;
+    it->done  = false;
+    it->kind  = RSTRING_SPLIT_SUBSTRING;
+    it->delim = delim;
 }
 
 /*----------------------------------------------------------------------------*/
 
-rstring_status_t
-rstring_ensure_capacity(struct rstring *rs, const size_t wanted_cap)
+void
+rstring_split_init_any(struct rstring_split *it, struct rstring_view source,
+                       struct rstring_view delims)
 {
-    size_t new_size =
-        rs->cap < RSTRING_INITIAL_CAPACITY ? RSTRING_INITIAL_CAPACITY : rs->cap;
+    it->rest = source;
+    it->done = false;
+    it->kind = RSTRING_SPLIT_ANY;
+    rstring_byte_set_init(&it->set, delims);
+}
 
-    char *p = NULL;
+/*----------------------------------------------------------------------------*/
 
-    /* Grow by 1.5 */
-    while (new_size < wanted_cap)
-    {
-        new_size = (new_size * 3) / 2;
-    }
+bool
+rstring_split_next(struct rstring_split *it, struct rstring_view *token)
+{
+    size_t at   = RSTRING_NOT_FOUND;
+    size_t skip = 1;
 
-    if (rs->cap == 0)
+    if (it->done)
     {
-        p = malloc(new_size);
+        return false;
     }
-    else
+
+    switch (it->kind)
     {
-        p = realloc(rs->data, new_size);
+    case RSTRING_SPLIT_BYTE:
+        at = rstring_view_find_first_byte(it->rest, it->byte, 0);
+        break;
+
+    case RSTRING_SPLIT_SUBSTRING:
+        if (it->delim.len > 0)
+        {
+            at = rstring_view_find_first(it->rest, it->delim, 0);
+        }
+        skip = it->delim.len;
+        break;
+
+    case RSTRING_SPLIT_ANY:
+        at = rstring_view_find_first_of(it->rest, &it->set, 0);
+        break;
     }
 
-    if (!p)
+    if (at == RSTRING_NOT_FOUND)
     {
-        return RSTRING_ERROR_ALLOC;
+        *token   = it->rest;
+        it->done = true;
+        return true;
     }
 
-    rs->cap  = new_size;
-    rs->data = p;
+    *token   = rstring_view_prefix(it->rest, at);
+    it->rest = rstring_view_slice(it->rest, at + skip, SIZE_MAX);
+    return true;
+}
 
-    return RSTRING_OK;
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_find_last(const struct rstring *haystack, const struct rstring *needle,
+                  size_t end)
+{
+    return rstring_internal_find_last(rstring_data(haystack),
+                                      rstring_data(needle),
+                                      haystack->len,
+                                      needle->len,
+                                      end,
+                                      false);
 }
 
 /*----------------------------------------------------------------------------*/
 
-rstring_status_t
-rstring_push(struct rstring *dest, const struct rstring *src)
+size_t
+rstring_find_last_str(const struct rstring *haystack, const char *needle,
+                      size_t end)
+{
+    const size_t needle_len = strlen(needle);
+    return rstring_internal_find_last(rstring_data(haystack),
+                                      needle,
+                                      haystack->len,
+                                      needle_len,
+                                      end,
+                                      false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_find_last_ignore_case(const struct rstring *haystack,
+                              const struct rstring *needle, size_t end)
+{
+    return rstring_internal_find_last(rstring_data(haystack),
+                                      rstring_data(needle),
+                                      haystack->len,
+                                      needle->len,
+                                      end,
+                                      true);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_find_last_str_ignore_case(const struct rstring *haystack,
+                                  const char *needle, size_t end)
 {
-    return rstring_internal_push(dest, src->data, src->len);
+    const size_t needle_len = strlen(needle);
+    return rstring_internal_find_last(rstring_data(haystack),
+                                      needle,
+                                      haystack->len,
+                                      needle_len,
+                                      end,
+                                      true);
 }
 
 /*----------------------------------------------------------------------------*/
 
 rstring_status_t
-rstring_push_byte(struct rstring *rs, uint8_t byte)
+rstring_finder_compile(struct rstring_finder *finder,
+                       const struct rstring  *needle)
 {
-    const size_t new_length = rs->len + 1;
+    return rstring_internal_finder_compile(
+        finder, rstring_data(needle), needle->len, false);
+}
 
-    ENSURE_CAPACITY(rs, new_length + 1);
+/*----------------------------------------------------------------------------*/
 
-    ((uint8_t *) rs->data)[rs->len] = byte;
-    rs->len                         = new_length;
-    rs->data[rs->len]               = '\0';
-    return RSTRING_OK;
+rstring_status_t
+rstring_finder_compile_str(struct rstring_finder *finder, const char *needle)
+{
+    return rstring_internal_finder_compile(
+        finder, needle, strlen(needle), false);
 }
 
 /*----------------------------------------------------------------------------*/
 
 rstring_status_t
-rstring_push_str(struct rstring *rs, const char *str)
+rstring_finder_compile_ignore_case(struct rstring_finder *finder,
+                                   const struct rstring  *needle)
 {
-    return rstring_internal_push(rs, str, strlen(str));
+    return rstring_internal_finder_compile(
+        finder, rstring_data(needle), needle->len, true);
 }
 
 /*----------------------------------------------------------------------------*/
 
-void
-rstring_free(struct rstring *rs)
+rstring_status_t
+rstring_finder_compile_str_ignore_case(struct rstring_finder *finder,
+                                       const char            *needle)
 {
-    if (rs->cap != 0)
-    {
-        free(rs->data);
-        rs->len  = 0;
-        rs->cap  = 0;
-        rs->data = _rstring_empty;
-    }
+    return rstring_internal_finder_compile(
+        finder, needle, strlen(needle), true);
 }
 
 /*----------------------------------------------------------------------------*/
 
 size_t
-rstring_find_last_byte(const struct rstring *rs, uint8_t byte)
+rstring_finder_find(const struct rstring_finder *finder,
+                    const struct rstring *haystack, size_t from)
 {
-    const uint8_t *p = (uint8_t *) rs->data;
+    const size_t needle_len = finder->needle.len;
+    size_t       pos        = RSTRING_NOT_FOUND;
 
-    if (rs->len == 0)
+    if (needle_len > haystack->len || from > haystack->len - needle_len)
     {
         return RSTRING_NOT_FOUND;
     }
 
-    if (rs->len == 1)
+    if (needle_len == 0)
     {
-        return (p[0] == byte) ? 0 : RSTRING_NOT_FOUND;
+        return from;
     }
 
-    for (size_t i = rs->len - 1; i != 0; --i)
-    {
-        if (p[i] == byte)
-        {
-            return i;
-        }
-    }
+    const uint8_t *hay     = (const uint8_t *) rstring_data(haystack) + from;
+    const size_t   hay_len = haystack->len - from;
 
-    if (p[0] == byte)
+    switch (finder->algorithm)
     {
-        return 0;
+    case RSTRING_FINDER_TWO_WAY:
+        pos = rstring_internal_two_way_search(finder, hay, hay_len);
+        break;
+
+    case RSTRING_FINDER_HORSPOOL:
+        pos = rstring_internal_horspool_search(finder, hay, hay_len);
+        break;
+
+    case RSTRING_FINDER_PREFILTER:
+    default: {
+        const struct rstring_internal_needle n = {
+            .ptr         = (const uint8_t *) rstring_data(&finder->needle),
+            .len         = needle_len,
+            .probe1      = finder->probe1,
+            .probe2      = finder->probe2,
+            .ignore_case = finder->ignore_case,
+        };
+        pos = KERNEL_LOAD(rstring_internal_search)(hay, hay_len, &n);
+        break;
+    }
     }
 
-    return RSTRING_NOT_FOUND;
+    STATS_ADD(finds, 1);
+    STATS_ADD(find_bytes,
+              pos == RSTRING_NOT_FOUND ? hay_len : pos + needle_len);
+
+    return pos == RSTRING_NOT_FOUND ? pos : pos + from;
 }
 
 /*----------------------------------------------------------------------------*/
 
-size_t
-rstring_find_first(const struct rstring *haystack, const struct rstring *needle,
-                   size_t from)
+void
+rstring_finder_free(struct rstring_finder *finder)
 {
-    return rstring_internal_find_first(haystack->data,
-                                       needle->data,
-                                       haystack->len,
-                                       needle->len,
-                                       from,
-                                       false);
+    rstring_free(&finder->needle);
 }
 
 /*----------------------------------------------------------------------------*/
 
-size_t
-rstring_find_first_str(const struct rstring *haystack, const char *needle,
-                       size_t from)
+void
+rstring_tolower(struct rstring *rs)
 {
-    const size_t needle_len = strlen(needle);
-    return rstring_internal_find_first(haystack->data,
-                                       needle,
-                                       haystack->len,
-                                       needle_len,
-                                       from,
-                                       false);
+    uint8_t *data = (uint8_t *) rstring_internal_data(rs);
+    KERNEL_LOAD(rstring_internal_case)(data, data, rs->len, 'A');
 }
 
 /*----------------------------------------------------------------------------*/
 
-size_t
-rstring_find_first_ignore_case(const struct rstring *haystack,
-                               const struct rstring *needle, size_t from)
+void
+rstring_toupper(struct rstring *rs)
 {
-    return rstring_internal_find_first(haystack->data,
-                                       needle->data,
-                                       haystack->len,
-                                       needle->len,
-                                       from,
-                                       true);
+    uint8_t *data = (uint8_t *) rstring_internal_data(rs);
+    KERNEL_LOAD(rstring_internal_case)(data, data, rs->len, 'a');
 }
 
 /*----------------------------------------------------------------------------*/
 
-size_t
-rstring_find_first_str_ignore_case(const struct rstring *haystack,
-                                   const char *needle, size_t from)
+static rstring_status_t
+rstring_internal_case_copy(struct rstring *dest, const struct rstring *src,
+                           uint8_t first)
 {
-    const size_t needle_len = strlen(needle);
-    return rstring_internal_find_first(haystack->data,
-                                       needle,
-                                       haystack->len,
-                                       needle_len,
-                                       from,
-                                       true);
+    if (dest == src)
+    {
+        uint8_t *data = (uint8_t *) rstring_internal_data(dest);
+        KERNEL_LOAD(rstring_internal_case)(data, data, dest->len, first);
+        return RSTRING_OK;
+    }
+
+    ENSURE_CAPACITY(dest, src->len + 1);
+
+    char *data = rstring_internal_data(dest);
+    KERNEL_LOAD(rstring_internal_case)(
+        (uint8_t *) data, (const uint8_t *) rstring_data(src), src->len, first);
+    dest->len       = src->len;
+    data[dest->len] = '\0';
+    return RSTRING_OK;
 }
 
 /*----------------------------------------------------------------------------*/
 
-void rstring_tolower(struct rstring *rs)
+rstring_status_t
+rstring_tolower_copy(struct rstring *dest, const struct rstring *src)
+{
+    return rstring_internal_case_copy(dest, src, 'A');
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_toupper_copy(struct rstring *dest, const struct rstring *src)
+{
+    return rstring_internal_case_copy(dest, src, 'a');
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_tolower_locale(struct rstring *rs)
 {
-    for (size_t i = 0; i < rs->len; ++i) {
-        rs->data[i] = (char) (tolower(rs->data[i]) & ONE_BYTE);
+    char *data = rstring_internal_data(rs);
+    for (size_t i = 0; i < rs->len; ++i)
+    {
+        data[i] = (char) (tolower((unsigned char) data[i]) & ONE_BYTE);
     }
 }
 
 /*----------------------------------------------------------------------------*/
 
-void rstring_toupper(struct rstring *rs)
+void
+rstring_toupper_locale(struct rstring *rs)
 {
-    for (size_t i = 0; i < rs->len; ++i) {
-        rs->data[i] = (char) (toupper(rs->data[i]) & ONE_BYTE);
+    char *data = rstring_internal_data(rs);
+    for (size_t i = 0; i < rs->len; ++i)
+    {
+        data[i] = (char) (toupper((unsigned char) data[i]) & ONE_BYTE);
     }
 }
@@ -6,29 +6,170 @@
 #ifndef RSTRING_H
 #define RSTRING_H
 
+#include <stdarg.h>  /* va_list */
 #include <stdbool.h> /* bool, true, false */
 #include <stddef.h>  /* size_t */
 #include <stdint.h>  /* uint8_t */
-#include <string.h>  /* memcmp */
+#include <string.h>  /* memcmp, strlen */
 #include <strings.h> /* strcasecmp */
 
+/*
+ * Size of the inline (small-string) buffer, including the null terminator.
+ * Strings of up to `RSTRING_SSO_CAPACITY - 1` bytes never touch the heap.
+ *
+ * On 64-bit targets, struct rstring takes 32 bytes plus this buffer, rounded up
+ * to 8: 56 bytes with the default of 24, and 8 more with RSTRING_CACHED_HASH.
+ * Constrained targets may define a smaller size, for the library and every
+ * user of this header alike - see the CMake option of the same name. A size of
+ * 1 keeps only empty strings inline.
+ */
+#ifndef RSTRING_SSO_CAPACITY
+#    define RSTRING_SSO_CAPACITY 24
+#endif
+
+#if RSTRING_SSO_CAPACITY < 1
+#    error "RSTRING_SSO_CAPACITY must leave room for the null terminator"
+#endif
+
+/*
+ * Hooks an rstring uses to manage its heap buffer, see
+ * `rstring_init_with_allocator`. |ctx| is passed back to every hook, and every
+ * size passed to |realloc| and |free| is the one the buffer was requested
+ * with, so allocators need not track sizes themselves.
+ *
+ * |alloc| and |realloc| return NULL on failure; a failed |realloc| must leave
+ * the original buffer intact.
+ */
+struct rstring_allocator
+{
+    void *(*alloc)(void *ctx, size_t size);
+    void *(*realloc)(void *ctx, void *ptr, size_t old_size, size_t new_size);
+    void (*free)(void *ctx, void *ptr, size_t size);
+    void *ctx;
+};
+
+/*
+ * An rstring is either 'inline' - its bytes live in |sso| and |cap| is at most
+ * `RSTRING_SSO_CAPACITY`, or 'heap' - its bytes live in a dynamically allocated
+ * buffer of |cap| bytes.
+ *
+ * |data| is internal: it is the heap buffer of a heap rstring, and NULL for an
+ * inline one. Read the contents through `rstring_data`, or `rstring_data_mut`
+ * to modify them in place. No field points into the structure itself, so an
+ * rstring may be moved by value - returned from a function, or in an array
+ * grown with realloc or sorted with qsort. Moving it transfers ownership of its
+ * heap buffer, and a copy left behind must not be freed or used.
+ *
+ * Heap buffers come from |allocator|, or from malloc when it is NULL.
+ *
+ * Defining RSTRING_CACHED_HASH - for the library and every user of this
+ * header alike - adds |hash|, see `rstring_hash`. It costs 8 bytes per
+ * rstring, so it is off by default.
+ */
 struct rstring
 {
-    size_t len;
-    size_t cap;
-    char  *data;
+    size_t                          len;
+    size_t                          cap;
+    char                           *data;
+    const struct rstring_allocator *allocator;
+#ifdef RSTRING_CACHED_HASH
+    uint64_t hash; /* Cached by rstring_hash, or 0 */
+#endif
+    char                            sso[RSTRING_SSO_CAPACITY];
 };
 
-#define RSTRING_OK          0
-#define RSTRING_ERROR_ALLOC 1
-#define RSTRING_NOT_FOUND   (SIZE_MAX)
+/*
+ * A non-owning view of a byte range, typically a part of an rstring or of a C
+ * string. A view is only valid as long as the memory it refers to is; views of
+ * an rstring are invalidated by any function which modifies, moves or frees
+ * it. The bytes are not null-terminated in general.
+ */
+struct rstring_view
+{
+    const char *ptr;
+    size_t      len;
+};
+
+#define RSTRING_OK             0
+#define RSTRING_ERROR_ALLOC    1
+#define RSTRING_ERROR_FORMAT   2
+#define RSTRING_ERROR_IO       3
+#define RSTRING_ERROR_ENCODING 4
+#define RSTRING_NOT_FOUND      (SIZE_MAX)
 
 typedef size_t rstring_status_t;
 
+/*
+ * Has the compiler check the arguments of printf-like functions against their
+ * format string.
+ */
+#if defined(__GNUC__)
+#    define RSTRING_PRINTF(fmt, args) __attribute__((format(printf, fmt, args)))
+#else
+#    define RSTRING_PRINTF(fmt, args)
+#endif
+
+/*
+ * Kept for source compatibility, and has no effect: a heap buffer starts from
+ * the inline capacity, and its growth follows the policy set with
+ * rstring_set_growth_policy.
+ */
 #define RSTRING_INITIAL_CAPACITY 8
 
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Checks whether an rstring stores its contents inline.
+ *
+ * @param rs Pointer to the rstring to check.
+ * @return `true` if the contents live inside the structure itself, `false` if
+ * they live in a dynamically allocated buffer.
+ */
+static inline bool
+rstring_is_inline(const struct rstring *rs)
+{
+    return rs->cap <= RSTRING_SSO_CAPACITY;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns a pointer to the null-terminated contents of an rstring.
+ *
+ * The pointer is valid until |rs| is modified, moved or freed.
+ *
+ * @param rs Pointer to the rstring.
+ * @return Pointer to the first byte of the rstring's contents.
+ */
+static inline const char *
+rstring_data(const struct rstring *rs)
+{
+    return rstring_is_inline(rs) ? rs->sso : rs->data;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns a pointer to the contents of an rstring, to modify them in
+ * place.
+ *
+ * Bytes up to |rs->len| may be changed, the null terminator and the length may
+ * not. With RSTRING_CACHED_HASH, the cached hash is dropped.
+ *
+ * @param rs Pointer to the rstring.
+ * @return Pointer to the first byte of the rstring's contents.
+ */
+static inline char *
+rstring_data_mut(struct rstring *rs)
+{
+#ifdef RSTRING_CACHED_HASH
+    rs->hash = 0;
+#endif
+    return rstring_is_inline(rs) ? rs->sso : rs->data;
+}
+
+/*----------------------------------------------------------------------------*/
+
 /**
  * @brief Initialize an rstring structure to an empty string.
  *
@@ -39,6 +180,25 @@ rstring_init(struct rstring *rs);
 
 /*----------------------------------------------------------------------------*/
 
+/**
+ * @brief Initialize an rstring structure to an empty string, whose heap buffer
+ * will be managed by a given allocator.
+ *
+ * The allocator is kept for the rstring's whole lifetime, including after
+ * `rstring_free`. Many rstrings may share one allocator, for example all the
+ * rstrings of a request may be allocated from a single `rstring_arena` and
+ * released together.
+ *
+ * @param rs Pointer to the rstring to initialize.
+ * @param allocator Pointer to the allocator, which must outlive |rs|. NULL
+ * selects malloc, like `rstring_init`.
+ */
+void
+rstring_init_with_allocator(struct rstring                 *rs,
+                            const struct rstring_allocator *allocator);
+
+/*----------------------------------------------------------------------------*/
+
 /**
  * @brief Append the contents of one rstring to another.
  *
@@ -98,315 +258,1859 @@ rstring_push_str(struct rstring *rs, const char *str);
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief Ensures that an rstring has at least the specified capacity.
- *
- * If the current capacity of the string is less than |wanted_cap|, this
- * function reallocates the underlying buffer to accommodate at least
- * |wanted_cap| bytes.
- *
- * The growth strategy increases capacity by 1.5 until the requirement is met.
- *
- * If the current capacity is 0, it starts from `RSTRING_INITIAL_CAPACITY`.
+ * @brief Appends the bytes of a view to an rstring.
  *
- * On success, the internal buffer pointer and capacity are updated.
+ * |view| may refer to |rs| itself, e.g. a slice of it.
  *
- * @param rs Pointer to the rstring to possibly grow.
- * @param wanted_cap  Minimum capacity required, in bytes.
+ * @param rs Pointer to the rstring to append to.
+ * @param view The bytes to append.
  * @return `RSTRING_OK` on success, error code if memory
  * allocation fails.
  *
- * @note If allocation fails, |rs|'s underlying buffer and capacity are not
- * corrupted.
+ * @note If allocation fails, |rs|'s underlying buffer is not corrupted.
  */
 rstring_status_t
-rstring_ensure_capacity(struct rstring *rs, size_t wanted_cap);
+rstring_push_view(struct rstring *rs, struct rstring_view view);
 
 /*----------------------------------------------------------------------------*/
 
-/* FIXME: check max between rs1 and rs2's lengths. This may lead to bugs when
- * null bytes are in the middle of the strings? */
-
 /**
- * @brief Compares the contents of two rstrings.
+ * @brief Appends several rstrings to an rstring.
  *
- * Performs byte-wise comparison of the first |rs1|->len bytes and of |rs1| and
- * |rs2|.
+ * The total length is computed first, so |dest| grows at most once, and the
+ * pieces are then copied one after the other. Any piece may be |dest| itself.
  *
- * @param rs1 Pointer to the first rstring.
- * @param rs2 Pointer to the second rstring.
- * @return The equivalent result of a memcmp between the strings.
+ * @param dest Pointer to the rstring to append to.
+ * @param pieces Array of the rstrings to append, in order.
+ * @param n Number of elements in |pieces|.
+ * @return `RSTRING_OK` on success, error code if memory
+ * allocation fails or the total length overflows.
+ *
+ * @note On failure, |dest| is not modified.
  */
-static inline int
-rstring_cmp(const struct rstring *rs1, const struct rstring *rs2)
-{
-    return memcmp(rs1->data, rs2->data, rs1->len);
-}
+rstring_status_t
+rstring_push_many(struct rstring *dest, const struct rstring *pieces, size_t n);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief Compares an rstring to a null-terminated C string.
-
- * This function performs a standard C-style `strcmp` between the contents
- * of the rstring |rs| and the given C string.
-
- * @param rs Pointer to the rstring.
- * @param str Pointer to the null-terminated C string.
- * @return The equivalent result of a strcmp between the strings.
+ * @brief Null-terminated C strings variant of rstring_push_many.
  *
- * @note If the rstring contains null bytes, behavior is undefined.
+ * Up to 32 pieces are measured once, more are measured again as they are
+ * copied. The pieces may point into |dest| itself.
  */
-static inline int
-rstring_cmp_str(const struct rstring *rs, const char *str)
-{
-    return strcmp(rs->data, str);
-}
+rstring_status_t
+rstring_push_many_str(struct rstring *dest, const char *const *pieces,
+                      size_t n);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief ASCII case-insensitive variant of rstring_cmp.
-
- * @param rs1 Pointer to the first rstring.
- * @param rs2 Pointer to the second rstring.
- * @return The equivalent result of a strcasecmp between the strings.
+ * @brief Views variant of rstring_push_many.
+ *
+ * The views may refer to |dest| itself.
  */
-static inline int
-rstring_cmp_ignore_case(const struct rstring *rs1, const struct rstring *rs2)
-{
-    return strcasecmp(rs1->data, rs2->data);
-}
+rstring_status_t
+rstring_push_many_view(struct rstring *dest, const struct rstring_view *pieces,
+                       size_t n);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief ASCII case-insensitive variant of rstring_cmp_str.
-
- * @param rs Pointer to the rstring.
- * @param str Pointer to the null-terminated C string.
- * @return The equivalent result of a strcasecmp between the strings.
+ * @brief Appends several rstrings to an rstring, with a separator between
+ * each two.
+ *
+ * Like `rstring_push_many`, |dest| grows at most once. Joining no pieces
+ * appends nothing, and a single piece is appended without a separator.
+ *
+ * @param dest Pointer to the rstring to append to.
+ * @param sep Pointer to the separator rstring.
+ * @param pieces Array of the rstrings to join, in order.
+ * @param n Number of elements in |pieces|.
+ * @return `RSTRING_OK` on success, error code if memory
+ * allocation fails or the total length overflows.
+ *
+ * @note On failure, |dest| is not modified.
  */
-static inline int
-rstring_cmp_str_ignore_case(const struct rstring *rs, const char *str)
-{
-    return strcasecmp(rs->data, str);
-}
+rstring_status_t
+rstring_join(struct rstring *dest, const struct rstring *sep,
+             const struct rstring *pieces, size_t n);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief Checks whether two rstrings are equal.
+ * @brief Null-terminated C strings variant of rstring_join.
  *
- * @param rs1 Pointer to the first rstring.
- * @param rs2 Pointer to the second rstring.
- * @return true if the strings are equal in their lengths and contents
- * (byte-by-byte), false otherwise.
+ * See `rstring_push_many_str`; the separator and pieces may point into |dest|.
  */
-static inline bool
-rstring_equals(const struct rstring *rs1, const struct rstring *rs2)
-{
-    if (rs1->len != rs2->len)
-    {
-        return false;
-    }
-
-    return rstring_cmp(rs1, rs2) == 0;
-}
+rstring_status_t
+rstring_join_str(struct rstring *dest, const char *sep,
+                 const char *const *pieces, size_t n);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief Checks whether an rstring is equal to a null-terminated C string.
- *
- * @param rs Pointer to the rstring.
- * @param str Pointer to the null-terminated C string.
- * @return true if the strings are equal (byte-by-byte), false otherwise.
+ * @brief Views variant of rstring_join.
  */
-static inline bool
-rstring_equals_str(const struct rstring *rs, const char *str)
-{
-    return rstring_cmp_str(rs, str) == 0;
-}
+rstring_status_t
+rstring_join_view(struct rstring *dest, struct rstring_view sep,
+                  const struct rstring_view *pieces, size_t n);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief ASCII case-insensitive variant of rstring_cmp.
+ * @brief Appends printf-style formatted text to an rstring.
+ *
+ * The text is formatted directly into the spare capacity of |rs|. Only when it
+ * does not fit is |rs| grown once, to at least the size needed as the growth
+ * policy decides, and the text formatted again.
+ *
+ * @param rs Pointer to the rstring to append to.
+ * @param fmt The printf format string.
+ * @return `RSTRING_OK` on success, `RSTRING_ERROR_FORMAT` if formatting fails,
+ * error code if memory allocation fails. On failure |rs| is not modified.
+ *
+ * @note The arguments must not point into |rs|.
  */
-static inline bool
-rstring_equals_ignore_case(const struct rstring *rs1, const struct rstring *rs2)
-{
-    if (rs1->len != rs2->len)
-    {
-        return false;
-    }
-
-    return rstring_cmp_ignore_case(rs1, rs2) == 0;
-}
+RSTRING_PRINTF(2, 3)
+rstring_status_t
+rstring_push_fmt(struct rstring *rs, const char *fmt, ...);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief ASCII case-insensitive variant of rstring_cmp_str.
+ * @brief va_list variant of rstring_push_fmt.
+ *
+ * |args| is left indeterminate, as by vsnprintf.
  */
-static inline bool
-rstring_equals_str_ignore_case(const struct rstring *rs, const char *str)
-{
-    return rstring_cmp_str_ignore_case(rs, str) == 0;
-}
+RSTRING_PRINTF(2, 0)
+rstring_status_t
+rstring_push_vfmt(struct rstring *rs, const char *fmt, va_list args);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief Finds the first occurrence of a byte in an rstring, from a given
- * offset.
+ * @brief Appends the decimal representation of an unsigned integer to an
+ * rstring.
  *
- * @param rs Pointer to the rstring to search in.
- * @param byte The byte value to search for.
- * @param from The offset from |rs->data| to start the search from.
- * @return The byte's offset from |rs->data| if found, else RSTRING_NOT_FOUND
+ * Digits are generated two at a time from a lookup table, straight into |rs|.
+ *
+ * @param rs Pointer to the rstring to append to.
+ * @param value The integer to append.
+ * @return `RSTRING_OK` on success, error code if memory
+ * allocation fails.
  */
-static inline size_t
-rstring_find_first_byte(const struct rstring *rs, uint8_t byte, size_t from)
-{
-    if (from >= rs->len)
-    {
-        return RSTRING_NOT_FOUND;
-    }
+rstring_status_t
+rstring_push_u64(struct rstring *rs, uint64_t value);
 
-    const char *p = memchr(rs->data + from, byte, rs->len - from);
-    if (p == NULL)
-    {
-        return RSTRING_NOT_FOUND;
-    }
+/*----------------------------------------------------------------------------*/
 
-    return p - rs->data;
-}
+/**
+ * @brief Signed variant of rstring_push_u64.
+ */
+rstring_status_t
+rstring_push_i64(struct rstring *rs, int64_t value);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief Finds the last last occurrence of a byte in an rstring.
+ * @brief Appends the hexadecimal representation of an unsigned integer to an
+ * rstring.
  *
- * @param rs Pointer to the rstring to search in.
- * @param byte The byte value to search for.
- * @return The byte's offset from |rs->data| if found, else `RSTRING_NOT_FOUND`.
+ * Digits are lower case, without a "0x" prefix or leading zeros: 255 is
+ * appended as "ff", and 0 as "0".
+ *
+ * @param rs Pointer to the rstring to append to.
+ * @param value The integer to append.
+ * @return `RSTRING_OK` on success, error code if memory
+ * allocation fails.
  */
-size_t
-rstring_find_last_byte(const struct rstring *rs, uint8_t byte);
+rstring_status_t
+rstring_push_hex(struct rstring *rs, uint64_t value);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief Finds the first occurrence of an rstring inside another rstring, from
- * a given offset.
+ * @brief Appends the shortest decimal representation of a double which reads
+ * back as the same value to an rstring.
  *
- * @param haystack Pointer to the rstring to search in.
- * @param needle Pointer to the rstring to search for
- * @param from The offset to start searching from.
- * @return The offset from |rs->data| in which |needle| can be found, else
- * `RSTRING_NOT_FOUND`.
+ * The digits are those of the shortest decimal that strtod converts back to
+ * |value| (the closest one if there are several), found with the Schubfach
+ * algorithm, without the trial and error of printf-based approaches.
+ *
+ * They are laid out like JavaScript's Number.prototype.toString: in fixed
+ * notation for magnitudes in [1e-6, 1e21) ("0.1", "1.5", "100"), and in
+ * exponential notation otherwise ("1e+21", "2.5e-7"). Negative zero is
+ * appended as "-0", infinities as "inf" and "-inf", and NaNs as "nan".
+ *
+ * @param rs Pointer to the rstring to append to.
+ * @param value The double to append.
+ * @return `RSTRING_OK` on success, error code if memory
+ * allocation fails.
  */
-size_t
-rstring_find_first(const struct rstring *haystack, const struct rstring *needle,
-                   size_t from);
+rstring_status_t
+rstring_push_double(struct rstring *rs, double value);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief Finds the first occurrence of a null-terminated C string inside
- * another rstring, from a given offset.
+ * @brief Inserts an rstring into another one, at a given offset.
  *
- * @param haystack Pointer to the rstring to search in.
- * @param needle Pointer to the C string to to search for.
- * @param from The offset to start searching from.
- * @return The offset from |rs->data| in which |needle| can be found, else
- * `RSTRING_NOT_FOUND`.
+ * The bytes from |pos| on are moved once, with memmove, after growing |rs| if
+ * needed.
+ *
+ * @param rs Pointer to the rstring to insert into.
+ * @param pos The offset to insert at, clamped to the length of |rs|.
+ * @param src Pointer to the rstring to insert, which may be |rs| itself.
+ * @return `RSTRING_OK` on success, error code if memory
+ * allocation fails.
  */
-size_t
-rstring_find_first_str(const struct rstring *haystack, const char *needle,
-                       size_t from);
+rstring_status_t
+rstring_insert(struct rstring *rs, size_t pos, const struct rstring *src);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief ASCII case-insensitive variant of rstring_find_first.
+ * @brief Null-terminated C string variant of rstring_insert.
  */
-size_t
-rstring_find_first_ignore_case(const struct rstring *haystack,
-                               const struct rstring *needle, size_t from);
+rstring_status_t
+rstring_insert_str(struct rstring *rs, size_t pos, const char *str);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief ASCII case-insensitive variant of rstring_find_first_str.
+ * @brief View variant of rstring_insert.
  */
-size_t
-rstring_find_first_str_ignore_case(const struct rstring *haystack,
-                                   const char *needle, size_t from);
+rstring_status_t
+rstring_insert_view(struct rstring *rs, size_t pos, struct rstring_view view);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief Clears the contents of an rstring (lightweight version), resets
- * length.
- *
- * This function ensures the first byte of the rstring's data is zeroed, so that
- * other rstring (and C library) functions regard it as an empty string.
+ * @brief Removes a range of bytes from an rstring.
  *
- * In case the rstring was already an empty string, this is a no-op.
+ * The bytes after the range are moved once, with memmove. The capacity is
+ * kept.
  *
- * @param rs Pointer to the rstring to clear.
+ * @param rs Pointer to the rstring to erase from.
+ * @param pos The offset of the first byte to remove.
+ * @param n The number of bytes to remove. The range is clamped to the
+ * contents of |rs|.
  */
-inline void
-rstring_clear(struct rstring *rs)
-{
-    if (rs->cap)
-    {
-        rs->data[0] = '\0';
-        rs->len     = 0;
-    }
-}
+void
+rstring_erase(struct rstring *rs, size_t pos, size_t n);
 
 /*----------------------------------------------------------------------------*/
 
 /**
- * @brief Checks if the rstring is an empty string.
+ * @brief Replaces a range of bytes of an rstring with another rstring.
  *
- * Emptyness-checking does not depend on whether the rstring is using
- * dynamically allocated memory or is pointing to a static sentinel buffer. It
- * depends only on the length specifier of the rstring structure, which is not
- * violated as long as usage is through rstring library functions, and memory is
- * not corrupted.
+ * Generalizes `rstring_insert` (|n| of 0) and `rstring_erase` (an empty
+ * |with|): the bytes after the range are moved once, after growing |rs| if
+ * needed.
  *
- * @param rs Pointer to the rstring to check.
- * @return `true` if the rstring is empty, false otherwise.
+ * @param rs Pointer to the rstring to modify.
+ * @param pos The offset of the first byte to replace.
+ * @param n The number of bytes to replace. The range is clamped to the
+ * contents of |rs|.
+ * @param with Pointer to the replacement, which may be |rs| itself.
+ * @return `RSTRING_OK` on success, error code if memory
+ * allocation fails.
  */
-inline bool
-rstring_is_empty(const struct rstring *rs)
-{
-    return rs->len == 0;
+rstring_status_t
+rstring_splice(struct rstring *rs, size_t pos, size_t n,
+               const struct rstring *with);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_splice.
+ */
+rstring_status_t
+rstring_splice_str(struct rstring *rs, size_t pos, size_t n, const char *with);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_splice.
+ */
+rstring_status_t
+rstring_splice_view(struct rstring *rs, size_t pos, size_t n,
+                    struct rstring_view with);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Replaces every occurrence of an rstring inside another one.
+ *
+ * Occurrences are found left to right with the vectorized search kernel, and
+ * do not overlap: replacing "aa" in "aaa" replaces the first two bytes only.
+ * The result is written in a single pass over |rs|:
+ * - When |to| is not longer than |from|, in place, without allocating.
+ * - Otherwise, the occurrences are counted first and |rs| grows once, to its
+ *   exact final size.
+ *
+ * @param rs Pointer to the rstring to modify.
+ * @param from Pointer to the rstring to search for. Replacing an empty
+ * rstring does nothing.
+ * @param to Pointer to the replacement.
+ * @return `RSTRING_OK` on success, error code if memory
+ * allocation fails.
+ *
+ * @note |from| and |to| may refer to |rs|, at the cost of a temporary copy.
+ */
+rstring_status_t
+rstring_replace_all(struct rstring *rs, const struct rstring *from,
+                    const struct rstring *to);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C strings variant of rstring_replace_all.
+ */
+rstring_status_t
+rstring_replace_all_str(struct rstring *rs, const char *from, const char *to);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Views variant of rstring_replace_all.
+ */
+rstring_status_t
+rstring_replace_all_view(struct rstring *rs, struct rstring_view from,
+                         struct rstring_view to);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Ensures that an rstring has at least the specified capacity.
+ *
+ * If the current capacity of the string is less than |wanted_cap|, this
+ * function reallocates the underlying buffer to accommodate at least
+ * |wanted_cap| bytes.
+ *
+ * The buffer grows to the larger of |wanted_cap| and the capacity the growth
+ * policy gives, see `rstring_set_growth_policy`: growing by a factor keeps
+ * repeated appends amortized, while a single large request is allocated as
+ * is, without stepping through the factors.
+ *
+ * Requests of up to `RSTRING_SSO_CAPACITY` bytes are satisfied by the inline
+ * buffer and never allocate. When an inline rstring outgrows it, growth starts
+ * from `RSTRING_SSO_CAPACITY` and the contents are moved to the heap.
+ *
+ * On success, the internal buffer pointer and capacity are updated.
+ *
+ * @param rs Pointer to the rstring to possibly grow.
+ * @param wanted_cap  Minimum capacity required, in bytes.
+ * @return `RSTRING_OK` on success, error code if memory
+ * allocation fails.
+ *
+ * @note If allocation fails, |rs|'s underlying buffer and capacity are not
+ * corrupted.
+ */
+rstring_status_t
+rstring_ensure_capacity(struct rstring *rs, size_t wanted_cap);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Ensures that an rstring has at least the specified capacity, without
+ * growing past it.
+ *
+ * Unlike `rstring_ensure_capacity`, the growth policy is not applied: meant
+ * for callers which know the final size of the string.
+ *
+ * @param rs Pointer to the rstring to possibly grow.
+ * @param wanted_cap Minimum capacity required, in bytes, the null terminator
+ * included.
+ * @return `RSTRING_OK` on success, error code if memory allocation fails, in
+ * which case |rs| is not modified.
+ */
+rstring_status_t
+rstring_reserve_exact(struct rstring *rs, size_t wanted_cap);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Gives the unused capacity of an rstring back to its allocator.
+ *
+ * A heap rstring short enough for the inline buffer moves back into it and
+ * releases its heap buffer; a longer one is reallocated to its length, plus
+ * the null terminator. Meant for long-lived strings which are done growing.
+ *
+ * @param rs Pointer to the rstring to shrink.
+ * @return `RSTRING_OK` on success, error code if the reallocation fails, in
+ * which case |rs| is not modified.
+ */
+rstring_status_t
+rstring_shrink_to_fit(struct rstring *rs);
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * How `rstring_ensure_capacity` grows heap buffers.
+ */
+enum rstring_growth_policy
+{
+    /* Grow by half, the default: wastes at most a third of the buffer */
+    RSTRING_GROWTH_X1_5,
+
+    /* Double: fewer reallocations, at most half of the buffer wasted */
+    RSTRING_GROWTH_X2,
+
+    /* Round up to a power of two, which suits size-class allocators */
+    RSTRING_GROWTH_POW2,
+
+    /*
+     * Double up to `RSTRING_GROWTH_PAGES_THRESHOLD` bytes, then grow by half,
+     * rounded so that the buffer and the header of a typical malloc fill whole
+     * pages. Above its mmap threshold, glibc maps such buffers on their own,
+     * and reallocates them with mremap, without copying the contents.
+     */
+    RSTRING_GROWTH_PAGES,
+};
+
+/*
+ * Capacity from which `RSTRING_GROWTH_PAGES` rounds to pages, the default mmap
+ * threshold of glibc's malloc.
+ */
+#define RSTRING_GROWTH_PAGES_THRESHOLD (128 * 1024)
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Selects how rstrings grow, for the whole process.
+ *
+ * The policy applies to every later growth of every rstring. It is meant to
+ * be set once, before other threads use the library.
+ *
+ * @param policy The policy to use from now on.
+ * @return The policy used until now.
+ */
+enum rstring_growth_policy
+rstring_set_growth_policy(enum rstring_growth_policy policy);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Hashes the contents of an rstring, caching the result in it.
+ *
+ * Equal to `rstring_hash_view` of the contents with a seed of 0. With
+ * RSTRING_CACHED_HASH, the hash is kept in |rs->hash| until the next
+ * modification of |rs| through the library, so hashing an unchanged rstring
+ * again costs a load; code which writes to the contents directly must then
+ * reset |rs->hash| to 0. Without it, every call hashes the contents.
+ *
+ * @param rs Pointer to the rstring to hash.
+ * @return The 64-bit hash of the contents of |rs|.
+ */
+uint64_t
+rstring_hash(struct rstring *rs);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Hashes a byte range with a seed.
+ *
+ * A wyhash-style hash: 16 bytes per step, and up to 48 per iteration in three
+ * independent lanes on long inputs, are mixed into the state by 64x64->128-bit
+ * multiplications. Short inputs are read with a few overlapping loads, without
+ * a loop. The result depends on every byte and on the length.
+ *
+ * Hash values may change between library versions, and differ between
+ * platforms of different byte orders; they are not meant to be persisted.
+ * Pick a random |seed| for tables keyed by untrusted input.
+ *
+ * @param view The bytes to hash.
+ * @param seed Selects one hash function of the family.
+ * @return The 64-bit hash of the bytes of |view|.
+ */
+uint64_t
+rstring_hash_view(struct rstring_view view, uint64_t seed);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_hash_view.
+ */
+uint64_t
+rstring_hash_str(const char *str, uint64_t seed);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Case-insensitive variant of rstring_hash_view.
+ *
+ * Hashes the bytes as if ASCII letters were lower case, so views which are
+ * equal ignoring case, as rstring_equals_ignore_case compares them, hash the
+ * same. The input is folded a word at a time, in registers, without a copy.
+ */
+uint64_t
+rstring_hash_view_ignore_case(struct rstring_view view, uint64_t seed);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_hash_view_ignore_case.
+ */
+uint64_t
+rstring_hash_str_ignore_case(const char *str, uint64_t seed);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the first occurrence of a byte in an rstring, from a given
+ * offset.
+ *
+ * @param rs Pointer to the rstring to search in.
+ * @param byte The byte value to search for.
+ * @param from The offset in |rs| to start the search from.
+ * @return The byte's offset in |rs| if found, else RSTRING_NOT_FOUND
+ */
+size_t
+rstring_find_first_byte(const struct rstring *rs, uint8_t byte, size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the last occurrence of a byte in an rstring.
+ *
+ * The rstring is scanned backwards, 64 bytes at a time with AVX2 or 16 bytes
+ * at a time with SSE2 on x86-64, depending on what the CPU supports.
+ *
+ * @param rs Pointer to the rstring to search in.
+ * @param byte The byte value to search for.
+ * @return The byte's offset in |rs| if found, else `RSTRING_NOT_FOUND`.
+ */
+size_t
+rstring_find_last_byte(const struct rstring *rs, uint8_t byte);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the last occurrence of a byte in an rstring, before a given
+ * offset.
+ *
+ * Only the offsets [0, |end|) are searched, so passing the offset of the
+ * previous result finds the occurrence before it. An |end| past the length of
+ * |rs| searches the whole rstring.
+ *
+ * @param rs Pointer to the rstring to search in.
+ * @param byte The byte value to search for.
+ * @param end The offset in |rs| to end the search at (exclusive).
+ * @return The byte's offset in |rs| if found, else `RSTRING_NOT_FOUND`.
+ */
+size_t
+rstring_find_last_byte_from(const struct rstring *rs, uint8_t byte, size_t end);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the first occurrence of an rstring inside another rstring, from
+ * a given offset.
+ *
+ * The search is driven by the lengths of both strings, so null bytes are
+ * matched like any other byte. On x86-64, an SSE2 or AVX2 kernel is selected
+ * at runtime, depending on what the CPU supports.
+ *
+ * @param haystack Pointer to the rstring to search in.
+ * @param needle Pointer to the rstring to search for
+ * @param from The offset to start searching from.
+ * @return The offset in |rs| in which |needle| can be found, else
+ * `RSTRING_NOT_FOUND`.
+ */
+size_t
+rstring_find_first(const struct rstring *haystack, const struct rstring *needle,
+                   size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the first occurrence of a null-terminated C string inside
+ * another rstring, from a given offset.
+ *
+ * @param haystack Pointer to the rstring to search in.
+ * @param needle Pointer to the C string to to search for.
+ * @param from The offset to start searching from.
+ * @return The offset in |rs| in which |needle| can be found, else
+ * `RSTRING_NOT_FOUND`.
+ */
+size_t
+rstring_find_first_str(const struct rstring *haystack, const char *needle,
+                       size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_find_first.
+ */
+size_t
+rstring_find_first_ignore_case(const struct rstring *haystack,
+                               const struct rstring *needle, size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_find_first_str.
+ */
+size_t
+rstring_find_first_str_ignore_case(const struct rstring *haystack,
+                                   const char *needle, size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the last occurrence of an rstring inside another rstring, which
+ * ends before a given offset.
+ *
+ * Only occurrences lying entirely inside the offsets [0, |end|) are found. An
+ * |end| past the length of |haystack| searches the whole rstring. The search
+ * uses the same kernels as `rstring_find_first`, scanning backwards.
+ *
+ * @param haystack Pointer to the rstring to search in.
+ * @param needle Pointer to the rstring to search for.
+ * @param end The offset in |haystack| to end the search at
+ * (exclusive).
+ * @return The offset in |rs| in which |needle| can be found, else
+ * `RSTRING_NOT_FOUND`. An empty |needle| is found at |end|, clamped to the
+ * length of |haystack|.
+ */
+size_t
+rstring_find_last(const struct rstring *haystack, const struct rstring *needle,
+                  size_t end);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_find_last.
+ */
+size_t
+rstring_find_last_str(const struct rstring *haystack, const char *needle,
+                      size_t end);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_find_last.
+ */
+size_t
+rstring_find_last_ignore_case(const struct rstring *haystack,
+                              const struct rstring *needle, size_t end);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_find_last_str.
+ */
+size_t
+rstring_find_last_str_ignore_case(const struct rstring *haystack,
+                                  const char *needle, size_t end);
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * A growable array of offsets into a haystack, filled by the functions which
+ * find every occurrence of a needle.
+ */
+struct rstring_offsets
+{
+    size_t *data;
+    size_t  len;
+    size_t  cap;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an empty array of offsets, which allocates nothing until
+ * filled.
+ *
+ * @param offsets Pointer to the array to initialize.
+ */
+void
+rstring_offsets_init(struct rstring_offsets *offsets);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Frees the memory of an array of offsets, and leaves it empty.
+ *
+ * @param offsets Pointer to the array to free.
+ */
+void
+rstring_offsets_free(struct rstring_offsets *offsets);
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Whether the functions which find every occurrence of a needle report the
+ * ones overlapping an occurrence already reported.
+ */
+enum rstring_overlap
+{
+    RSTRING_OVERLAPPING,     /* "aa" occurs at 0, 1 and 2 in "aaaa" */
+    RSTRING_NON_OVERLAPPING, /* At 0 and 2, as `rstring_replace_all` sees it */
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds every occurrence of an rstring inside another one, from a given
+ * offset, in a single pass.
+ *
+ * The search uses the same vectorized kernels as `rstring_find_first`, but
+ * verifies every candidate of a block before moving on to the next block,
+ * rather than starting a new search after each occurrence.
+ *
+ * @param haystack Pointer to the rstring to search in.
+ * @param needle Pointer to the rstring to search for. An empty needle has no
+ * occurrences.
+ * @param from The offset to start searching from.
+ * @param overlap Whether overlapping occurrences are reported.
+ * @param out Pointer to the array to append the offsets to, in increasing
+ * order.
+ * @return RSTRING_OK on success, or RSTRING_ERROR_ALLOC if memory allocation
+ * fails, in which case |out| keeps its original length.
+ */
+rstring_status_t
+rstring_find_all(const struct rstring *haystack, const struct rstring *needle,
+                 size_t from, enum rstring_overlap overlap,
+                 struct rstring_offsets *out);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_find_all.
+ */
+rstring_status_t
+rstring_find_all_str(const struct rstring *haystack, const char *needle,
+                     size_t from, enum rstring_overlap overlap,
+                     struct rstring_offsets *out);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Counts the occurrences of an rstring inside another one, from a given
+ * offset, without allocating memory.
+ *
+ * @param haystack Pointer to the rstring to search in.
+ * @param needle Pointer to the rstring to search for. An empty needle has no
+ * occurrences.
+ * @param from The offset to start searching from.
+ * @param overlap Whether overlapping occurrences are counted.
+ * @return The number of occurrences, as `rstring_find_all` would find.
+ */
+size_t
+rstring_count(const struct rstring *haystack, const struct rstring *needle,
+              size_t from, enum rstring_overlap overlap);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_count.
+ */
+size_t
+rstring_count_str(const struct rstring *haystack, const char *needle,
+                  size_t from, enum rstring_overlap overlap);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns a view of an rstring's contents.
+ *
+ * @param rs Pointer to the rstring.
+ * @return A view of all of |rs|'s bytes.
+ */
+static inline struct rstring_view
+rstring_view_from(const struct rstring *rs)
+{
+    const struct rstring_view view = {rstring_data(rs), rs->len};
+    return view;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns a view of a null-terminated C string, without the terminator.
+ *
+ * @param str Pointer to the null-terminated C string.
+ * @return A view of the bytes of |str|.
+ */
+static inline struct rstring_view
+rstring_view_from_str(const char *str)
+{
+    const struct rstring_view view = {str, strlen(str)};
+    return view;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns a view of a buffer of a given length.
+ *
+ * @param ptr Pointer to the first byte, may be NULL if |len| is 0.
+ * @param len Number of bytes in the buffer.
+ * @return A view of the buffer.
+ */
+static inline struct rstring_view
+rstring_view_from_buf(const char *ptr, size_t len)
+{
+    const struct rstring_view view = {ptr, len};
+    return view;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns a part of a view.
+ *
+ * The range is clamped to the view: a |from| past its end gives an empty view
+ * at its end, and |len| is cut down to the bytes available after |from|.
+ *
+ * @param view The view to slice.
+ * @param from Offset of the first byte of the slice, relative to |view|.
+ * @param len Maximal length of the slice, `SIZE_MAX` for the rest of |view|.
+ * @return The slice, referring to the same memory as |view|.
+ */
+static inline struct rstring_view
+rstring_view_slice(struct rstring_view view, size_t from, size_t len)
+{
+    if (from > view.len)
+    {
+        from = view.len;
+    }
+
+    if (len > view.len - from)
+    {
+        len = view.len - from;
+    }
+
+    return rstring_view_from_buf(view.ptr + from, len);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns a view of a part of an rstring, see `rstring_view_slice`.
+ */
+static inline struct rstring_view
+rstring_slice(const struct rstring *rs, size_t from, size_t len)
+{
+    return rstring_view_slice(rstring_view_from(rs), from, len);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns the first |n| bytes of a view, or all of it if shorter.
+ */
+static inline struct rstring_view
+rstring_view_prefix(struct rstring_view view, size_t n)
+{
+    return rstring_view_slice(view, 0, n);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns the last |n| bytes of a view, or all of it if shorter.
+ */
+static inline struct rstring_view
+rstring_view_suffix(struct rstring_view view, size_t n)
+{
+    return rstring_view_slice(view, n < view.len ? view.len - n : 0, n);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Compares two views, byte by byte.
+ *
+ * The comparison covers both views entirely: when one view is a prefix of the
+ * other, the shorter one orders first. Null bytes are compared like any other
+ * byte.
+ *
+ * @param v1 The first view.
+ * @param v2 The second view.
+ * @return A negative value, zero or a positive value if |v1| orders before,
+ * equal to or after |v2|.
+ */
+static inline int
+rstring_view_cmp(struct rstring_view v1, struct rstring_view v2)
+{
+    const size_t n = v1.len < v2.len ? v1.len : v2.len;
+    const int    r = n ? memcmp(v1.ptr, v2.ptr, n) : 0;
+
+    if (r != 0 || v1.len == v2.len)
+    {
+        return r;
+    }
+
+    return v1.len < v2.len ? -1 : 1;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_view_cmp.
+ *
+ * Bytes are compared after folding 'A' - 'Z' to lower case, regardless of the
+ * current locale.
+ */
+int
+rstring_view_cmp_ignore_case(struct rstring_view v1, struct rstring_view v2);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns the length of the longest common prefix of two views.
+ *
+ * Blocks of 16 or 32 bytes are compared at once by an SSE2 or AVX2 kernel,
+ * selected at runtime. Null bytes are compared like any other byte.
+ *
+ * @param v1 The first view.
+ * @param v2 The second view.
+ * @return The number of leading bytes |v1| and |v2| have in common, at most
+ * the length of the shorter one.
+ */
+size_t
+rstring_view_common_prefix(struct rstring_view v1, struct rstring_view v2);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_view_common_prefix.
+ *
+ * Both blocks are folded to lower case in registers before they are compared,
+ * as rstring_view_cmp_ignore_case does.
+ */
+size_t
+rstring_view_common_prefix_ignore_case(struct rstring_view v1,
+                                       struct rstring_view v2);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks whether two views have the same length and bytes.
+ */
+static inline bool
+rstring_view_equals(struct rstring_view v1, struct rstring_view v2)
+{
+    return v1.len == v2.len && (v1.len == 0 || !memcmp(v1.ptr, v2.ptr, v1.len));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_view_equals.
+ */
+static inline bool
+rstring_view_equals_ignore_case(struct rstring_view v1, struct rstring_view v2)
+{
+    return v1.len == v2.len
+        && rstring_view_common_prefix_ignore_case(v1, v2) == v1.len;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks whether a view starts with another view.
+ *
+ * @param view The view to check.
+ * @param prefix The prefix to look for. Every view starts with an empty one.
+ * @return true if the first bytes of |view| are those of |prefix|.
+ */
+static inline bool
+rstring_view_starts_with(struct rstring_view view, struct rstring_view prefix)
+{
+    return rstring_view_equals(rstring_view_prefix(view, prefix.len), prefix);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_view_starts_with.
+ */
+static inline bool
+rstring_view_starts_with_ignore_case(struct rstring_view view,
+                                     struct rstring_view prefix)
+{
+    return rstring_view_equals_ignore_case(
+        rstring_view_prefix(view, prefix.len), prefix);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks whether a view ends with another view.
+ *
+ * @param view The view to check.
+ * @param suffix The suffix to look for. Every view ends with an empty one.
+ * @return true if the last bytes of |view| are those of |suffix|.
+ */
+static inline bool
+rstring_view_ends_with(struct rstring_view view, struct rstring_view suffix)
+{
+    return rstring_view_equals(rstring_view_suffix(view, suffix.len), suffix);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_view_ends_with.
+ */
+static inline bool
+rstring_view_ends_with_ignore_case(struct rstring_view view,
+                                   struct rstring_view suffix)
+{
+    return rstring_view_equals_ignore_case(
+        rstring_view_suffix(view, suffix.len), suffix);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_find_first_byte.
+ */
+size_t
+rstring_view_find_first_byte(struct rstring_view view, uint8_t byte,
+                             size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_find_last_byte_from.
+ */
+size_t
+rstring_view_find_last_byte(struct rstring_view view, uint8_t byte,
+                            size_t end);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_find_first.
+ *
+ * @return The offset from |haystack.ptr| in which |needle| can be found, else
+ * `RSTRING_NOT_FOUND`.
+ */
+size_t
+rstring_view_find_first(struct rstring_view haystack,
+                        struct rstring_view needle, size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_view_find_first.
+ */
+size_t
+rstring_view_find_first_ignore_case(struct rstring_view haystack,
+                                    struct rstring_view needle, size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_find_last.
+ */
+size_t
+rstring_view_find_last(struct rstring_view haystack, struct rstring_view needle,
+                       size_t end);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_view_find_last.
+ */
+size_t
+rstring_view_find_last_ignore_case(struct rstring_view haystack,
+                                   struct rstring_view needle, size_t end);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_find_all.
+ */
+rstring_status_t
+rstring_view_find_all(struct rstring_view haystack, struct rstring_view needle,
+                      size_t from, enum rstring_overlap overlap,
+                      struct rstring_offsets *out);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Variant of rstring_view_find_all which fills an array provided by
+ * the caller, and never allocates.
+ *
+ * @param offsets The array to store the offsets in, in increasing order. May
+ * be NULL if |cap| is 0.
+ * @param cap The number of offsets |offsets| can hold. Occurrences past it are
+ * counted, but not stored.
+ * @return The number of occurrences, which may be more than |cap|: calling
+ * again with an array that large stores them all.
+ */
+size_t
+rstring_view_find_all_into(struct rstring_view haystack,
+                           struct rstring_view needle, size_t from,
+                           enum rstring_overlap overlap, size_t *offsets,
+                           size_t cap);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_count.
+ */
+size_t
+rstring_view_count(struct rstring_view haystack, struct rstring_view needle,
+                   size_t from, enum rstring_overlap overlap);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the first occurrence of a view inside an rstring, see
+ * `rstring_find_first`.
+ */
+static inline size_t
+rstring_find_first_view(const struct rstring *haystack,
+                        struct rstring_view needle, size_t from)
+{
+    return rstring_view_find_first(rstring_view_from(haystack), needle, from);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_find_first_view.
+ */
+static inline size_t
+rstring_find_first_view_ignore_case(const struct rstring *haystack,
+                                    struct rstring_view   needle, size_t from)
+{
+    return rstring_view_find_first_ignore_case(
+        rstring_view_from(haystack), needle, from);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Compares an rstring to a view, see `rstring_view_cmp`.
+ */
+static inline int
+rstring_cmp_view(const struct rstring *rs, struct rstring_view view)
+{
+    return rstring_view_cmp(rstring_view_from(rs), view);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_cmp_view.
+ */
+static inline int
+rstring_cmp_view_ignore_case(const struct rstring *rs, struct rstring_view view)
+{
+    return rstring_view_cmp_ignore_case(rstring_view_from(rs), view);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks whether an rstring has the same length and bytes as a view.
+ */
+static inline bool
+rstring_equals_view(const struct rstring *rs, struct rstring_view view)
+{
+    return rstring_view_equals(rstring_view_from(rs), view);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_equals_view.
+ */
+static inline bool
+rstring_equals_view_ignore_case(const struct rstring *rs,
+                                struct rstring_view   view)
+{
+    return rstring_view_equals_ignore_case(rstring_view_from(rs), view);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Compares the contents of two rstrings.
+ *
+ * The comparison covers both rstrings entirely, byte by byte, null bytes
+ * included: when one is a prefix of the other, the shorter one orders first,
+ * see `rstring_view_cmp`.
+ *
+ * @param rs1 Pointer to the first rstring.
+ * @param rs2 Pointer to the second rstring.
+ * @return A negative value, zero or a positive value if |rs1| orders before,
+ * equal to or after |rs2|.
+ */
+static inline int
+rstring_cmp(const struct rstring *rs1, const struct rstring *rs2)
+{
+    return rstring_view_cmp(rstring_view_from(rs1), rstring_view_from(rs2));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Compares an rstring to a null-terminated C string.
+ *
+ * The C string is measured once, then compared as rstring_cmp does: null
+ * bytes inside the rstring are compared like any other byte, which orders an
+ * rstring holding one after the C string it starts with.
+ *
+ * @param rs Pointer to the rstring.
+ * @param str Pointer to the null-terminated C string.
+ * @return As rstring_cmp.
+ */
+static inline int
+rstring_cmp_str(const struct rstring *rs, const char *str)
+{
+    return rstring_view_cmp(rstring_view_from(rs), rstring_view_from_str(str));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_cmp.
+ *
+ * Bytes are compared after folding 'A' - 'Z' to lower case, regardless of the
+ * current locale, see `rstring_view_cmp_ignore_case`.
+ */
+static inline int
+rstring_cmp_ignore_case(const struct rstring *rs1, const struct rstring *rs2)
+{
+    return rstring_view_cmp_ignore_case(rstring_view_from(rs1),
+                                        rstring_view_from(rs2));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_cmp_str.
+ */
+static inline int
+rstring_cmp_str_ignore_case(const struct rstring *rs, const char *str)
+{
+    return rstring_view_cmp_ignore_case(rstring_view_from(rs),
+                                        rstring_view_from_str(str));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks whether two rstrings are equal.
+ *
+ * With RSTRING_CACHED_HASH, when both rstrings have a hash cached by
+ * `rstring_hash`, different hashes reject the pair without comparing any
+ * bytes.
+ *
+ * @param rs1 Pointer to the first rstring.
+ * @param rs2 Pointer to the second rstring.
+ * @return true if the strings are equal in their lengths and contents
+ * (byte-by-byte), false otherwise.
+ */
+static inline bool
+rstring_equals(const struct rstring *rs1, const struct rstring *rs2)
+{
+#ifdef RSTRING_CACHED_HASH
+    if (rs1->hash != 0 && rs2->hash != 0 && rs1->hash != rs2->hash)
+    {
+        return false;
+    }
+#endif
+
+    return rstring_view_equals(rstring_view_from(rs1), rstring_view_from(rs2));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks whether an rstring is equal to a null-terminated C string.
+ *
+ * @param rs Pointer to the rstring.
+ * @param str Pointer to the null-terminated C string.
+ * @return true if the strings are equal in their lengths and contents
+ * (byte-by-byte), false otherwise. An rstring holding a null byte is never
+ * equal to a C string.
+ */
+static inline bool
+rstring_equals_str(const struct rstring *rs, const char *str)
+{
+    return rstring_view_equals(rstring_view_from(rs),
+                               rstring_view_from_str(str));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_equals.
+ */
+static inline bool
+rstring_equals_ignore_case(const struct rstring *rs1, const struct rstring *rs2)
+{
+    return rstring_view_equals_ignore_case(rstring_view_from(rs1),
+                                           rstring_view_from(rs2));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_equals_str.
+ */
+static inline bool
+rstring_equals_str_ignore_case(const struct rstring *rs, const char *str)
+{
+    return rstring_view_equals_ignore_case(rstring_view_from(rs),
+                                           rstring_view_from_str(str));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns the length of the longest common prefix of two rstrings, see
+ * `rstring_view_common_prefix`.
+ */
+static inline size_t
+rstring_common_prefix(const struct rstring *rs1, const struct rstring *rs2)
+{
+    return rstring_view_common_prefix(rstring_view_from(rs1),
+                                      rstring_view_from(rs2));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_common_prefix.
+ */
+static inline size_t
+rstring_common_prefix_ignore_case(const struct rstring *rs1,
+                                  const struct rstring *rs2)
+{
+    return rstring_view_common_prefix_ignore_case(rstring_view_from(rs1),
+                                                  rstring_view_from(rs2));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks whether an rstring starts with the contents of another one,
+ * see `rstring_view_starts_with`.
+ */
+static inline bool
+rstring_starts_with(const struct rstring *rs, const struct rstring *prefix)
+{
+    return rstring_view_starts_with(rstring_view_from(rs),
+                                    rstring_view_from(prefix));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_starts_with.
+ */
+static inline bool
+rstring_starts_with_str(const struct rstring *rs, const char *prefix)
+{
+    return rstring_view_starts_with(rstring_view_from(rs),
+                                    rstring_view_from_str(prefix));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_starts_with.
+ */
+static inline bool
+rstring_starts_with_view(const struct rstring *rs, struct rstring_view prefix)
+{
+    return rstring_view_starts_with(rstring_view_from(rs), prefix);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_starts_with.
+ */
+static inline bool
+rstring_starts_with_ignore_case(const struct rstring *rs,
+                                const struct rstring *prefix)
+{
+    return rstring_view_starts_with_ignore_case(rstring_view_from(rs),
+                                                rstring_view_from(prefix));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_starts_with_str.
+ */
+static inline bool
+rstring_starts_with_str_ignore_case(const struct rstring *rs,
+                                    const char           *prefix)
+{
+    return rstring_view_starts_with_ignore_case(rstring_view_from(rs),
+                                                rstring_view_from_str(prefix));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_starts_with_view.
+ */
+static inline bool
+rstring_starts_with_view_ignore_case(const struct rstring *rs,
+                                     struct rstring_view   prefix)
+{
+    return rstring_view_starts_with_ignore_case(rstring_view_from(rs), prefix);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks whether an rstring ends with the contents of another one, see
+ * `rstring_view_ends_with`.
+ */
+static inline bool
+rstring_ends_with(const struct rstring *rs, const struct rstring *suffix)
+{
+    return rstring_view_ends_with(rstring_view_from(rs),
+                                  rstring_view_from(suffix));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_ends_with.
+ */
+static inline bool
+rstring_ends_with_str(const struct rstring *rs, const char *suffix)
+{
+    return rstring_view_ends_with(rstring_view_from(rs),
+                                  rstring_view_from_str(suffix));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_ends_with.
+ */
+static inline bool
+rstring_ends_with_view(const struct rstring *rs, struct rstring_view suffix)
+{
+    return rstring_view_ends_with(rstring_view_from(rs), suffix);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_ends_with.
+ */
+static inline bool
+rstring_ends_with_ignore_case(const struct rstring *rs,
+                              const struct rstring *suffix)
+{
+    return rstring_view_ends_with_ignore_case(rstring_view_from(rs),
+                                              rstring_view_from(suffix));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_ends_with_str.
+ */
+static inline bool
+rstring_ends_with_str_ignore_case(const struct rstring *rs, const char *suffix)
+{
+    return rstring_view_ends_with_ignore_case(rstring_view_from(rs),
+                                              rstring_view_from_str(suffix));
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_ends_with_view.
+ */
+static inline bool
+rstring_ends_with_view_ignore_case(const struct rstring *rs,
+                                   struct rstring_view   suffix)
+{
+    return rstring_view_ends_with_ignore_case(rstring_view_from(rs), suffix);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * A set of bytes, preprocessed for `rstring_view_find_first_of` and
+ * `rstring_split_init_any`.
+ *
+ * Fields are private to the library.
+ */
+struct rstring_byte_set
+{
+    uint8_t bits[32]; /* Bitmap of the members */
+
+    /* Nibble tables, [0] for members below 0x80 and [1] for the others */
+    uint8_t lo[2][16];
+    uint8_t hi[2][16];
+    bool    high; /* Whether any member is 0x80 or above */
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a byte set from the bytes of a view.
+ *
+ * @param set Pointer to the byte set to initialize.
+ * @param members The bytes to include, in any order, duplicates allowed.
+ */
+void
+rstring_byte_set_init(struct rstring_byte_set *set,
+                      struct rstring_view      members);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the first byte of a view which belongs to a byte set, from a
+ * given offset.
+ *
+ * Each byte's high and low nibbles index two 16-entry tables, and the byte is
+ * a member if the entries share a bit. On x86-64, this runs 32 bytes at a time
+ * with AVX2, or 16 with SSSE3, depending on what the CPU supports.
+ *
+ * @param view The view to search in.
+ * @param set Pointer to the set of bytes to search for.
+ * @param from The offset from |view.ptr| to start the search from.
+ * @return The byte's offset from |view.ptr| if found, else
+ * `RSTRING_NOT_FOUND`.
+ */
+size_t
+rstring_view_find_first_of(struct rstring_view            view,
+                           const struct rstring_byte_set *set, size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Delimiters a split iterator may split on.
+ */
+enum rstring_split_kind
+{
+    RSTRING_SPLIT_BYTE,
+    RSTRING_SPLIT_SUBSTRING,
+    RSTRING_SPLIT_ANY,
+};
+
+/*
+ * An iterator over the tokens of a view, see `rstring_split_next`.
+ *
+ * Fields are private to the library.
+ */
+struct rstring_split
+{
+    struct rstring_view     rest; /* Not split yet */
+    bool                    done;
+    enum rstring_split_kind kind;
+    uint8_t                 byte;
+    struct rstring_view     delim;
+    struct rstring_byte_set set;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an iterator splitting a view on a single byte.
+ *
+ * Splitting never allocates: tokens are views into |source|, which must stay
+ * valid during the iteration.
+ *
+ * @param it Pointer to the iterator to initialize.
+ * @param source The view to split.
+ * @param byte The delimiting byte.
+ */
+void
+rstring_split_init_byte(struct rstring_split *it, struct rstring_view source,
+                        uint8_t byte);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an iterator splitting a view on a substring.
+ *
+ * An empty |delim| never matches, so the whole of |source| is a single token.
+ * |delim| is not copied, and must stay valid during the iteration.
+ *
+ * @param it Pointer to the iterator to initialize.
+ * @param source The view to split.
+ * @param delim The delimiting substring.
+ */
+void
+rstring_split_init(struct rstring_split *it, struct rstring_view source,
+                   struct rstring_view delim);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an iterator splitting a view on any byte of a set.
+ *
+ * Each delimiting byte ends a token, so runs of delimiters produce empty
+ * tokens. Delimiters are searched with `rstring_view_find_first_of`.
+ *
+ * @param it Pointer to the iterator to initialize.
+ * @param source The view to split.
+ * @param delims The delimiting bytes, copied into the iterator.
+ */
+void
+rstring_split_init_any(struct rstring_split *it, struct rstring_view source,
+                       struct rstring_view delims);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Advances a split iterator to its next token.
+ *
+ * A source with N delimiters has N + 1 tokens, which are empty between
+ * adjacent delimiters and at the edges of the source. An empty source has a
+ * single empty token.
+ *
+ * @param it Pointer to the iterator.
+ * @param token Receives the next token, not including its delimiter.
+ * @return `true` if a token was produced, `false` once all tokens were.
+ */
+bool
+rstring_split_next(struct rstring_split *it, struct rstring_view *token);
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Search algorithms a compiled finder may pick, see `rstring_finder_compile`.
+ */
+enum rstring_finder_algorithm
+{
+    RSTRING_FINDER_PREFILTER,
+    RSTRING_FINDER_HORSPOOL,
+    RSTRING_FINDER_TWO_WAY,
+};
+
+/*
+ * A needle which was preprocessed once, to be searched for in many haystacks.
+ *
+ * Fields are private to the library, except for |algorithm|, which may be
+ * inspected.
+ */
+struct rstring_finder
+{
+    struct rstring                needle; /* Case-folded when ignoring case */
+    enum rstring_finder_algorithm algorithm;
+    bool                          ignore_case;
+    size_t                        probe1; /* Prefilter: rarest needle bytes */
+    size_t                        probe2;
+    size_t                        critical_pos; /* Two-Way factorization */
+    size_t                        period;
+    bool                          periodic;
+    uint8_t                       shift[256]; /* Horspool bad-char shifts */
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Compiles an rstring into a finder, for repeated searches.
+ *
+ * The needle is copied, so |needle| may be modified or freed afterwards. The
+ * algorithm is picked once, from the length and the bytes of the needle:
+ *
+ * - Needles of 256 bytes or more use Two-Way, which is linear in the
+ *   haystack's length no matter how the needle repeats itself.
+ * - Other needles use a prefilter, which probes the haystack for the two
+ *   rarest bytes of the needle (vectorized on x86-64).
+ * - When the prefilter is not vectorized, needles of 8 bytes or more that only
+ *   contain bytes which are common in text use Boyer-Moore-Horspool instead.
+ *
+ * @param finder Pointer to the finder to initialize.
+ * @param needle Pointer to the rstring to search for.
+ * @return `RSTRING_OK` on success, error code if memory allocation fails.
+ */
+rstring_status_t
+rstring_finder_compile(struct rstring_finder *finder,
+                       const struct rstring  *needle);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_finder_compile.
+ */
+rstring_status_t
+rstring_finder_compile_str(struct rstring_finder *finder, const char *needle);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_finder_compile.
+ */
+rstring_status_t
+rstring_finder_compile_ignore_case(struct rstring_finder *finder,
+                                   const struct rstring  *needle);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_finder_compile_str.
+ */
+rstring_status_t
+rstring_finder_compile_str_ignore_case(struct rstring_finder *finder,
+                                       const char            *needle);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the first occurrence of a compiled needle inside an rstring,
+ * from a given offset.
+ *
+ * @param finder Pointer to the compiled finder.
+ * @param haystack Pointer to the rstring to search in.
+ * @param from The offset to start searching from.
+ * @return The offset in |haystack| in which the needle can be found,
+ * else `RSTRING_NOT_FOUND`.
+ */
+size_t
+rstring_finder_find(const struct rstring_finder *finder,
+                    const struct rstring *haystack, size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Frees the memory owned by a finder.
+ *
+ * @param finder Pointer to the finder to free.
+ */
+void
+rstring_finder_free(struct rstring_finder *finder);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Clears the contents of an rstring (lightweight version), resets
+ * length.
+ *
+ * This function ensures the first byte of the rstring's data is zeroed, so that
+ * other rstring (and C library) functions regard it as an empty string.
+ *
+ * The capacity is kept, a heap rstring stays on the heap.
+ *
+ * @param rs Pointer to the rstring to clear.
+ */
+static inline void
+rstring_clear(struct rstring *rs)
+{
+    rstring_data_mut(rs)[0] = '\0';
+    rs->len                 = 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks if the rstring is an empty string.
+ *
+ * Emptyness-checking does not depend on whether the rstring is using
+ * dynamically allocated memory or its inline buffer. It depends only on the
+ * length specifier of the rstring structure, which is not violated as long as
+ * usage is through rstring library functions, and memory is not corrupted.
+ *
+ * @param rs Pointer to the rstring to check.
+ * @return `true` if the rstring is empty, false otherwise.
+ */
+static inline bool
+rstring_is_empty(const struct rstring *rs)
+{
+    return rs->len == 0;
 }
 
 /*----------------------------------------------------------------------------*/
 
-void rstring_tolower(struct rstring *rs);
+/**
+ * @brief Converts an rstring to lower case, in place.
+ *
+ * Only the ASCII letters 'A' - 'Z' are converted, regardless of the current
+ * locale; every other byte is kept as is. On x86-64, an SSE2, AVX2 or AVX-512
+ * kernel is selected at runtime, depending on what the CPU supports.
+ *
+ * @param rs Pointer to the rstring to convert.
+ */
+void
+rstring_tolower(struct rstring *rs);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Converts an rstring to upper case, in place.
+ *
+ * Only the ASCII letters 'a' - 'z' are converted, see `rstring_tolower`.
+ *
+ * @param rs Pointer to the rstring to convert.
+ */
+void
+rstring_toupper(struct rstring *rs);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Sets an rstring to the lower case contents of another rstring.
+ *
+ * Equivalent to copying |src| into |dest| and calling `rstring_tolower` on
+ * |dest|, in a single pass. |dest| and |src| may be the same rstring.
+ *
+ * @param dest Pointer to the destination rstring, which will be overwritten.
+ * @param src Pointer to the source rstring.
+ * @return `RSTRING_OK` on success, error code if memory allocation fails.
+ *
+ * @note If allocation fails, |dest| is not modified.
+ */
+rstring_status_t
+rstring_tolower_copy(struct rstring *dest, const struct rstring *src);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Upper case variant of rstring_tolower_copy.
+ */
+rstring_status_t
+rstring_toupper_copy(struct rstring *dest, const struct rstring *src);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Converts an rstring to lower case, in place, according to the current
+ * locale.
+ *
+ * Every byte is passed through the C library's `tolower`, so the result
+ * depends on `LC_CTYPE`. This is considerably slower than `rstring_tolower`.
+ *
+ * @param rs Pointer to the rstring to convert.
+ */
+void
+rstring_tolower_locale(struct rstring *rs);
 
 /*----------------------------------------------------------------------------*/
 
-void rstring_toupper(struct rstring *rs);
+/**
+ * @brief Upper case variant of rstring_tolower_locale.
+ */
+void
+rstring_toupper_locale(struct rstring *rs);
 
 /*----------------------------------------------------------------------------*/
 
 /**
  * @brief Frees the memory which was dynamically allocated by an rstring.
  *
- * If the rstring isn't using memory which was dynamically allocated, this is
- * equivalent to a no-op and is safe to use (for idiomatic reasons).
+ * If the rstring isn't using memory which was dynamically allocated (i.e. it is
+ * inline), no memory is freed and the rstring is only reset.
  *
  * Calling this function leads to resetting the length, capacity and data
  * buffers for the rstring it was called on, as if it were to be initialized
- * with `rstring_init`.
+ * with `rstring_init`. The rstring's allocator is kept.
  *
  * After freeing, |rs| could be re-used given you initialize it first (this
  * maintains API stability).
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ *
+ * rstring_alloc.c
+ * ---------------
+ * Allocators for rstrings whose memory is released all at once: a linear
+ * arena, and a size-class pool on top of it.
+ */
+
+#include <stdint.h> /* uintptr_t */
+#include <stdlib.h> /* malloc, free */
+
+#include <string.h> /* memcpy, memset */
+
+#include "rstring.h"
+#include "rstring_alloc.h"
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL TYPES                                                             */
+/*----------------------------------------------------------------------------*/
+
+struct rstring_arena_chunk
+{
+    struct rstring_arena_chunk *next;
+    size_t                      size; /* Bytes available in |bytes| */
+    unsigned char               bytes[];
+};
+
+/*----------------------------------------------------------------------------*/
+/* ARENA                                                                      */
+/*----------------------------------------------------------------------------*/
+
+/* Offset of the first aligned byte at or after |used| in |chunk| */
+static size_t
+rstring_internal_arena_align(const struct rstring_arena_chunk *chunk,
+                             size_t                            used)
+{
+    const uintptr_t p       = (uintptr_t) (chunk->bytes + used);
+    const uintptr_t aligned = (p + RSTRING_ARENA_ALIGNMENT - 1)
+                              & ~(uintptr_t) (RSTRING_ARENA_ALIGNMENT - 1);
+
+    return used + (size_t) (aligned - p);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Makes the chunk after the current one fit for an allocation of |size|
+ * bytes: either a chunk which was kept by a reset, or a new one.
+ */
+static struct rstring_arena_chunk *
+rstring_internal_arena_next_chunk(struct rstring_arena *arena, size_t size)
+{
+    const size_t need = size + RSTRING_ARENA_ALIGNMENT - 1;
+    struct rstring_arena_chunk *next =
+        arena->current ? arena->current->next : arena->first;
+
+    if (need < size)
+    {
+        return NULL;
+    }
+
+    if (next && next->size >= need)
+    {
+        return next;
+    }
+
+    const size_t chunk_size = need > arena->chunk_size ? need
+                                                       : arena->chunk_size;
+    struct rstring_arena_chunk *chunk =
+        malloc(sizeof(struct rstring_arena_chunk) + chunk_size);
+
+    if (!chunk)
+    {
+        return NULL;
+    }
+
+    chunk->size = chunk_size;
+    chunk->next = next;
+    arena->reserved += sizeof(struct rstring_arena_chunk) + chunk_size;
+
+    if (arena->current)
+    {
+        arena->current->next = chunk;
+    }
+    else
+    {
+        arena->first = chunk;
+    }
+
+    return chunk;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void *
+rstring_internal_arena_alloc(void *ctx, size_t size)
+{
+    struct rstring_arena       *arena = ctx;
+    struct rstring_arena_chunk *chunk = arena->current;
+    size_t                      start = 0;
+
+    if (chunk)
+    {
+        start = rstring_internal_arena_align(chunk, arena->used);
+    }
+
+    if (!chunk || start > chunk->size || size > chunk->size - start)
+    {
+        chunk = rstring_internal_arena_next_chunk(arena, size);
+        if (!chunk)
+        {
+            return NULL;
+        }
+
+        arena->current = chunk;
+        start          = rstring_internal_arena_align(chunk, 0);
+    }
+
+    arena->used = start + size;
+    arena->last = chunk->bytes + start;
+    return arena->last;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void *
+rstring_internal_arena_realloc(void *ctx, void *ptr, size_t old_size,
+                               size_t new_size)
+{
+    struct rstring_arena *arena = ctx;
+
+    /* The most recent allocation grows or shrinks in place when it fits */
+    if (ptr == arena->last)
+    {
+        const size_t start =
+            (size_t) ((unsigned char *) ptr - arena->current->bytes);
+
+        if (new_size <= arena->current->size - start)
+        {
+            arena->used = start + new_size;
+            return ptr;
+        }
+    }
+
+    void *p = rstring_internal_arena_alloc(ctx, new_size);
+    if (p)
+    {
+        memcpy(p, ptr, old_size < new_size ? old_size : new_size);
+    }
+
+    return p;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+rstring_internal_arena_free(void *ctx, void *ptr, size_t size)
+{
+    struct rstring_arena *arena = ctx;
+
+    (void) size;
+
+    if (ptr == arena->last)
+    {
+        arena->used = (size_t) ((unsigned char *) ptr - arena->current->bytes);
+        arena->last = NULL;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/* POOL                                                                       */
+/*----------------------------------------------------------------------------*/
+
+/* Size class of a |size| bytes request, `RSTRING_POOL_CLASSES` if too large */
+static size_t
+rstring_internal_pool_class(size_t size)
+{
+    size_t cls = 0;
+
+    while (cls < RSTRING_POOL_CLASSES
+           && ((size_t) 1 << (RSTRING_POOL_MIN_SHIFT + cls)) < size)
+    {
+        ++cls;
+    }
+
+    return cls;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void *
+rstring_internal_pool_alloc(void *ctx, size_t size)
+{
+    struct rstring_pool *pool = ctx;
+    const size_t         cls  = rstring_internal_pool_class(size);
+
+    if (cls == RSTRING_POOL_CLASSES)
+    {
+        return rstring_internal_arena_alloc(&pool->arena, size);
+    }
+
+    void *p = pool->free_lists[cls];
+    if (p)
+    {
+        pool->free_lists[cls] = *(void **) p;
+        return p;
+    }
+
+    return rstring_internal_arena_alloc(
+        &pool->arena, (size_t) 1 << (RSTRING_POOL_MIN_SHIFT + cls));
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+rstring_internal_pool_free(void *ctx, void *ptr, size_t size)
+{
+    struct rstring_pool *pool = ctx;
+    const size_t         cls  = rstring_internal_pool_class(size);
+
+    if (cls == RSTRING_POOL_CLASSES)
+    {
+        rstring_internal_arena_free(&pool->arena, ptr, size);
+        return;
+    }
+
+    *(void **) ptr        = pool->free_lists[cls];
+    pool->free_lists[cls] = ptr;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void *
+rstring_internal_pool_realloc(void *ctx, void *ptr, size_t old_size,
+                              size_t new_size)
+{
+    struct rstring_pool *pool    = ctx;
+    const size_t         old_cls = rstring_internal_pool_class(old_size);
+    const size_t         new_cls = rstring_internal_pool_class(new_size);
+
+    if (old_cls == new_cls)
+    {
+        if (old_cls < RSTRING_POOL_CLASSES)
+        {
+            return ptr;
+        }
+
+        return rstring_internal_arena_realloc(
+            &pool->arena, ptr, old_size, new_size);
+    }
+
+    void *p = rstring_internal_pool_alloc(ctx, new_size);
+    if (p)
+    {
+        memcpy(p, ptr, old_size < new_size ? old_size : new_size);
+        rstring_internal_pool_free(ctx, ptr, old_size);
+    }
+
+    return p;
+}
+
+/*----------------------------------------------------------------------------*/
+/* PUBLIC FUNCTIONS                                                           */
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_arena_init(struct rstring_arena *arena, size_t chunk_size)
+{
+    arena->allocator.alloc   = rstring_internal_arena_alloc;
+    arena->allocator.realloc = rstring_internal_arena_realloc;
+    arena->allocator.free    = rstring_internal_arena_free;
+    arena->allocator.ctx     = arena;
+
+    arena->first      = NULL;
+    arena->current    = NULL;
+    arena->used       = 0;
+    arena->chunk_size = chunk_size ? chunk_size
+                                   : RSTRING_ARENA_DEFAULT_CHUNK_SIZE;
+    arena->reserved   = 0;
+    arena->last       = NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_arena_reset(struct rstring_arena *arena)
+{
+    arena->current = arena->first;
+    arena->used    = 0;
+    arena->last    = NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_arena_free(struct rstring_arena *arena)
+{
+    struct rstring_arena_chunk *chunk = arena->first;
+
+    while (chunk)
+    {
+        struct rstring_arena_chunk *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    arena->first    = NULL;
+    arena->current  = NULL;
+    arena->used     = 0;
+    arena->reserved = 0;
+    arena->last     = NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_pool_init(struct rstring_pool *pool, size_t chunk_size)
+{
+    pool->allocator.alloc   = rstring_internal_pool_alloc;
+    pool->allocator.realloc = rstring_internal_pool_realloc;
+    pool->allocator.free    = rstring_internal_pool_free;
+    pool->allocator.ctx     = pool;
+
+    rstring_arena_init(&pool->arena, chunk_size);
+    memset(pool->free_lists, 0, sizeof(pool->free_lists));
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_pool_reset(struct rstring_pool *pool)
+{
+    rstring_arena_reset(&pool->arena);
+    memset(pool->free_lists, 0, sizeof(pool->free_lists));
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_pool_free(struct rstring_pool *pool)
+{
+    rstring_arena_free(&pool->arena);
+    memset(pool->free_lists, 0, sizeof(pool->free_lists));
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef RSTRING_ALLOC_H
+#define RSTRING_ALLOC_H
+
+#include <stddef.h> /* size_t */
+
+#include "rstring.h"
+
+/*
+ * Chunk size used by arenas and pools initialized with a |chunk_size| of 0.
+ */
+#define RSTRING_ARENA_DEFAULT_CHUNK_SIZE (64 * 1024)
+
+/*
+ * Every arena allocation is aligned to this many bytes.
+ */
+#define RSTRING_ARENA_ALIGNMENT 16
+
+/*
+ * Pools serve requests of up to 2^(RSTRING_POOL_MIN_SHIFT +
+ * RSTRING_POOL_CLASSES - 1) bytes from per-size free lists, in power of two
+ * size classes starting at 2^RSTRING_POOL_MIN_SHIFT bytes. Larger requests are
+ * served by the underlying arena.
+ */
+#define RSTRING_POOL_MIN_SHIFT 5
+#define RSTRING_POOL_CLASSES   8
+
+struct rstring_arena_chunk;
+
+/*
+ * A linear (bump) allocator. Memory is carved out of large chunks obtained
+ * from malloc, and is released all at once by `rstring_arena_reset`.
+ *
+ * Freeing or growing the most recent allocation is done in place, so a single
+ * rstring growing at the top of the arena wastes no memory. Other frees are
+ * no-ops until the arena is reset.
+ *
+ * Fields are private to the library, except for |allocator|, which is to be
+ * passed to `rstring_init_with_allocator`, and |reserved|, the bytes obtained
+ * from malloc, which may be inspected. An arena must not be moved while in
+ * use, as |allocator| refers back to it.
+ */
+struct rstring_arena
+{
+    struct rstring_allocator    allocator;
+    struct rstring_arena_chunk *first;
+    struct rstring_arena_chunk *current;
+    size_t                      used; /* Bytes used in |current| */
+    size_t                      chunk_size;
+    size_t                      reserved; /* Bytes of all the chunks */
+    void                       *last;     /* Most recent allocation */
+};
+
+/*
+ * A size-class allocator on top of an arena. Freed buffers are kept on a free
+ * list per size class and reused by later requests of the same class, which
+ * suits rstrings that are created and freed repeatedly. Like an arena, a pool
+ * releases all of its memory at once with `rstring_pool_reset`.
+ *
+ * Fields are private to the library, except for |allocator|, see
+ * `rstring_arena`.
+ */
+struct rstring_pool
+{
+    struct rstring_allocator allocator;
+    struct rstring_arena     arena;
+    void                    *free_lists[RSTRING_POOL_CLASSES];
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an empty arena.
+ *
+ * No memory is allocated until the first request.
+ *
+ * @param arena Pointer to the arena to initialize.
+ * @param chunk_size Size of the chunks requested from malloc, 0 selects
+ * `RSTRING_ARENA_DEFAULT_CHUNK_SIZE`. Larger requests get a chunk of their own.
+ */
+void
+rstring_arena_init(struct rstring_arena *arena, size_t chunk_size);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Releases every allocation made from an arena, in constant time.
+ *
+ * The arena's chunks are kept and reused by later requests. Every rstring
+ * allocated from the arena becomes invalid, and must be re-initialized before
+ * it is used again - including with `rstring_free`.
+ *
+ * @param arena Pointer to the arena to reset.
+ */
+void
+rstring_arena_reset(struct rstring_arena *arena);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns an arena's memory to the system.
+ *
+ * Like `rstring_arena_reset`, every rstring allocated from the arena becomes
+ * invalid. The arena may be reused afterwards.
+ *
+ * @param arena Pointer to the arena to free.
+ */
+void
+rstring_arena_free(struct rstring_arena *arena);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an empty pool.
+ *
+ * @param pool Pointer to the pool to initialize.
+ * @param chunk_size Chunk size of the underlying arena, see
+ * `rstring_arena_init`.
+ */
+void
+rstring_pool_init(struct rstring_pool *pool, size_t chunk_size);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Releases every allocation made from a pool, in constant time.
+ *
+ * See `rstring_arena_reset`.
+ *
+ * @param pool Pointer to the pool to reset.
+ */
+void
+rstring_pool_reset(struct rstring_pool *pool);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns a pool's memory to the system.
+ *
+ * See `rstring_arena_free`.
+ *
+ * @param pool Pointer to the pool to free.
+ */
+void
+rstring_pool_free(struct rstring_pool *pool);
+
+#endif /* RSTRING_ALLOC_H */
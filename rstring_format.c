@@ -0,0 +1,1141 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ *
+ * rstring_format.c
+ * ----------------
+ * Formatted appends: printf-style formatting into an rstring's spare
+ * capacity, and dedicated integer and floating-point formatters.
+ */
+
+#include <stdarg.h> /* va_list, va_copy */
+#include <stdint.h> /* uint64_t, int64_t */
+#include <stdio.h>  /* vsnprintf */
+
+#include <string.h> /* memcpy, memmove, memset */
+
+#include "rstring.h"
+#include "rstring_internal.h"
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL MACROS                                                            */
+/*----------------------------------------------------------------------------*/
+
+/* Longest output of rstring_internal_format_double, "-0.0000012345678901234" */
+#define RSTRING_INTERNAL_DOUBLE_MAX 32
+
+/* Decimal exponents covered by rstring_internal_pow10 */
+#define RSTRING_INTERNAL_POW10_MIN (-292)
+
+#define RSTRING_INTERNAL_DOUBLE_MANTISSA_BITS 52
+#define RSTRING_INTERNAL_DOUBLE_BIAS          1075 /* Exponent bias + 52 */
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL TABLES                                                            */
+/*----------------------------------------------------------------------------*/
+
+static const char rstring_internal_digit_pairs[201] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char rstring_internal_hex_digits[17] = "0123456789abcdef";
+
+/*
+ * 128-bit approximations of the powers of 10 from 10^-292 to 10^324, as
+ * {high, low} halves. Entry k - RSTRING_INTERNAL_POW10_MIN holds
+ * ceil(10^k / 2^e) with e = floor(log2(10^k)) + 1 - 128, which is normalized
+ * to exactly 128 bits. Generated with exact rational arithmetic.
+ */
+static const uint64_t rstring_internal_pow10[617][2] = {
+    {UINT64_C(0xFF77B1FCBEBCDC4F), UINT64_C(0x25E8E89C13BB0F7B)},
+    {UINT64_C(0x9FAACF3DF73609B1), UINT64_C(0x77B191618C54E9AD)},
+    {UINT64_C(0xC795830D75038C1D), UINT64_C(0xD59DF5B9EF6A2418)},
+    {UINT64_C(0xF97AE3D0D2446F25), UINT64_C(0x4B0573286B44AD1E)},
+    {UINT64_C(0x9BECCE62836AC577), UINT64_C(0x4EE367F9430AEC33)},
+    {UINT64_C(0xC2E801FB244576D5), UINT64_C(0x229C41F793CDA740)},
+    {UINT64_C(0xF3A20279ED56D48A), UINT64_C(0x6B43527578C11110)},
+    {UINT64_C(0x9845418C345644D6), UINT64_C(0x830A13896B78AAAA)},
+    {UINT64_C(0xBE5691EF416BD60C), UINT64_C(0x23CC986BC656D554)},
+    {UINT64_C(0xEDEC366B11C6CB8F), UINT64_C(0x2CBFBE86B7EC8AA9)},
+    {UINT64_C(0x94B3A202EB1C3F39), UINT64_C(0x7BF7D71432F3D6AA)},
+    {UINT64_C(0xB9E08A83A5E34F07), UINT64_C(0xDAF5CCD93FB0CC54)},
+    {UINT64_C(0xE858AD248F5C22C9), UINT64_C(0xD1B3400F8F9CFF69)},
+    {UINT64_C(0x91376C36D99995BE), UINT64_C(0x23100809B9C21FA2)},
+    {UINT64_C(0xB58547448FFFFB2D), UINT64_C(0xABD40A0C2832A78B)},
+    {UINT64_C(0xE2E69915B3FFF9F9), UINT64_C(0x16C90C8F323F516D)},
+    {UINT64_C(0x8DD01FAD907FFC3B), UINT64_C(0xAE3DA7D97F6792E4)},
+    {UINT64_C(0xB1442798F49FFB4A), UINT64_C(0x99CD11CFDF41779D)},
+    {UINT64_C(0xDD95317F31C7FA1D), UINT64_C(0x40405643D711D584)},
+    {UINT64_C(0x8A7D3EEF7F1CFC52), UINT64_C(0x482835EA666B2573)},
+    {UINT64_C(0xAD1C8EAB5EE43B66), UINT64_C(0xDA3243650005EED0)},
+    {UINT64_C(0xD863B256369D4A40), UINT64_C(0x90BED43E40076A83)},
+    {UINT64_C(0x873E4F75E2224E68), UINT64_C(0x5A7744A6E804A292)},
+    {UINT64_C(0xA90DE3535AAAE202), UINT64_C(0x711515D0A205CB37)},
+    {UINT64_C(0xD3515C2831559A83), UINT64_C(0x0D5A5B44CA873E04)},
+    {UINT64_C(0x8412D9991ED58091), UINT64_C(0xE858790AFE9486C3)},
+    {UINT64_C(0xA5178FFF668AE0B6), UINT64_C(0x626E974DBE39A873)},
+    {UINT64_C(0xCE5D73FF402D98E3), UINT64_C(0xFB0A3D212DC81290)},
+    {UINT64_C(0x80FA687F881C7F8E), UINT64_C(0x7CE66634BC9D0B9A)},
+    {UINT64_C(0xA139029F6A239F72), UINT64_C(0x1C1FFFC1EBC44E81)},
+    {UINT64_C(0xC987434744AC874E), UINT64_C(0xA327FFB266B56221)},
+    {UINT64_C(0xFBE9141915D7A922), UINT64_C(0x4BF1FF9F0062BAA9)},
+    {UINT64_C(0x9D71AC8FADA6C9B5), UINT64_C(0x6F773FC3603DB4AA)},
+    {UINT64_C(0xC4CE17B399107C22), UINT64_C(0xCB550FB4384D21D4)},
+    {UINT64_C(0xF6019DA07F549B2B), UINT64_C(0x7E2A53A146606A49)},
+    {UINT64_C(0x99C102844F94E0FB), UINT64_C(0x2EDA7444CBFC426E)},
+    {UINT64_C(0xC0314325637A1939), UINT64_C(0xFA911155FEFB5309)},
+    {UINT64_C(0xF03D93EEBC589F88), UINT64_C(0x793555AB7EBA27CB)},
+    {UINT64_C(0x96267C7535B763B5), UINT64_C(0x4BC1558B2F3458DF)},
+    {UINT64_C(0xBBB01B9283253CA2), UINT64_C(0x9EB1AAEDFB016F17)},
+    {UINT64_C(0xEA9C227723EE8BCB), UINT64_C(0x465E15A979C1CADD)},
+    {UINT64_C(0x92A1958A7675175F), UINT64_C(0x0BFACD89EC191ECA)},
+    {UINT64_C(0xB749FAED14125D36), UINT64_C(0xCEF980EC671F667C)},
+    {UINT64_C(0xE51C79A85916F484), UINT64_C(0x82B7E12780E7401B)},
+    {UINT64_C(0x8F31CC0937AE58D2), UINT64_C(0xD1B2ECB8B0908811)},
+    {UINT64_C(0xB2FE3F0B8599EF07), UINT64_C(0x861FA7E6DCB4AA16)},
+    {UINT64_C(0xDFBDCECE67006AC9), UINT64_C(0x67A791E093E1D49B)},
+    {UINT64_C(0x8BD6A141006042BD), UINT64_C(0xE0C8BB2C5C6D24E1)},
+    {UINT64_C(0xAECC49914078536D), UINT64_C(0x58FAE9F773886E19)},
+    {UINT64_C(0xDA7F5BF590966848), UINT64_C(0xAF39A475506A899F)},
+    {UINT64_C(0x888F99797A5E012D), UINT64_C(0x6D8406C952429604)},
+    {UINT64_C(0xAAB37FD7D8F58178), UINT64_C(0xC8E5087BA6D33B84)},
+    {UINT64_C(0xD5605FCDCF32E1D6), UINT64_C(0xFB1E4A9A90880A65)},
+    {UINT64_C(0x855C3BE0A17FCD26), UINT64_C(0x5CF2EEA09A550680)},
+    {UINT64_C(0xA6B34AD8C9DFC06F), UINT64_C(0xF42FAA48C0EA481F)},
+    {UINT64_C(0xD0601D8EFC57B08B), UINT64_C(0xF13B94DAF124DA27)},
+    {UINT64_C(0x823C12795DB6CE57), UINT64_C(0x76C53D08D6B70859)},
+    {UINT64_C(0xA2CB1717B52481ED), UINT64_C(0x54768C4B0C64CA6F)},
+    {UINT64_C(0xCB7DDCDDA26DA268), UINT64_C(0xA9942F5DCF7DFD0A)},
+    {UINT64_C(0xFE5D54150B090B02), UINT64_C(0xD3F93B35435D7C4D)},
+    {UINT64_C(0x9EFA548D26E5A6E1), UINT64_C(0xC47BC5014A1A6DB0)},
+    {UINT64_C(0xC6B8E9B0709F109A), UINT64_C(0x359AB6419CA1091C)},
+    {UINT64_C(0xF867241C8CC6D4C0), UINT64_C(0xC30163D203C94B63)},
+    {UINT64_C(0x9B407691D7FC44F8), UINT64_C(0x79E0DE63425DCF1E)},
+    {UINT64_C(0xC21094364DFB5636), UINT64_C(0x985915FC12F542E5)},
+    {UINT64_C(0xF294B943E17A2BC4), UINT64_C(0x3E6F5B7B17B2939E)},
+    {UINT64_C(0x979CF3CA6CEC5B5A), UINT64_C(0xA705992CEECF9C43)},
+    {UINT64_C(0xBD8430BD08277231), UINT64_C(0x50C6FF782A838354)},
+    {UINT64_C(0xECE53CEC4A314EBD), UINT64_C(0xA4F8BF5635246429)},
+    {UINT64_C(0x940F4613AE5ED136), UINT64_C(0x871B7795E136BE9A)},
+    {UINT64_C(0xB913179899F68584), UINT64_C(0x28E2557B59846E40)},
+    {UINT64_C(0xE757DD7EC07426E5), UINT64_C(0x331AEADA2FE589D0)},
+    {UINT64_C(0x9096EA6F3848984F), UINT64_C(0x3FF0D2C85DEF7622)},
+    {UINT64_C(0xB4BCA50B065ABE63), UINT64_C(0x0FED077A756B53AA)},
+    {UINT64_C(0xE1EBCE4DC7F16DFB), UINT64_C(0xD3E8495912C62895)},
+    {UINT64_C(0x8D3360F09CF6E4BD), UINT64_C(0x64712DD7ABBBD95D)},
+    {UINT64_C(0xB080392CC4349DEC), UINT64_C(0xBD8D794D96AACFB4)},
+    {UINT64_C(0xDCA04777F541C567), UINT64_C(0xECF0D7A0FC5583A1)},
+    {UINT64_C(0x89E42CAAF9491B60), UINT64_C(0xF41686C49DB57245)},
+    {UINT64_C(0xAC5D37D5B79B6239), UINT64_C(0x311C2875C522CED6)},
+    {UINT64_C(0xD77485CB25823AC7), UINT64_C(0x7D633293366B828C)},
+    {UINT64_C(0x86A8D39EF77164BC), UINT64_C(0xAE5DFF9C02033198)},
+    {UINT64_C(0xA8530886B54DBDEB), UINT64_C(0xD9F57F830283FDFD)},
+    {UINT64_C(0xD267CAA862A12D66), UINT64_C(0xD072DF63C324FD7C)},
+    {UINT64_C(0x8380DEA93DA4BC60), UINT64_C(0x4247CB9E59F71E6E)},
+    {UINT64_C(0xA46116538D0DEB78), UINT64_C(0x52D9BE85F074E609)},
+    {UINT64_C(0xCD795BE870516656), UINT64_C(0x67902E276C921F8C)},
+    {UINT64_C(0x806BD9714632DFF6), UINT64_C(0x00BA1CD8A3DB53B7)},
+    {UINT64_C(0xA086CFCD97BF97F3), UINT64_C(0x80E8A40ECCD228A5)},
+    {UINT64_C(0xC8A883C0FDAF7DF0), UINT64_C(0x6122CD128006B2CE)},
+    {UINT64_C(0xFAD2A4B13D1B5D6C), UINT64_C(0x796B805720085F82)},
+    {UINT64_C(0x9CC3A6EEC6311A63), UINT64_C(0xCBE3303674053BB1)},
+    {UINT64_C(0xC3F490AA77BD60FC), UINT64_C(0xBEDBFC4411068A9D)},
+    {UINT64_C(0xF4F1B4D515ACB93B), UINT64_C(0xEE92FB5515482D45)},
+    {UINT64_C(0x991711052D8BF3C5), UINT64_C(0x751BDD152D4D1C4B)},
+    {UINT64_C(0xBF5CD54678EEF0B6), UINT64_C(0xD262D45A78A0635E)},
+    {UINT64_C(0xEF340A98172AACE4), UINT64_C(0x86FB897116C87C35)},
+    {UINT64_C(0x9580869F0E7AAC0E), UINT64_C(0xD45D35E6AE3D4DA1)},
+    {UINT64_C(0xBAE0A846D2195712), UINT64_C(0x8974836059CCA10A)},
+    {UINT64_C(0xE998D258869FACD7), UINT64_C(0x2BD1A438703FC94C)},
+    {UINT64_C(0x91FF83775423CC06), UINT64_C(0x7B6306A34627DDD0)},
+    {UINT64_C(0xB67F6455292CBF08), UINT64_C(0x1A3BC84C17B1D543)},
+    {UINT64_C(0xE41F3D6A7377EECA), UINT64_C(0x20CABA5F1D9E4A94)},
+    {UINT64_C(0x8E938662882AF53E), UINT64_C(0x547EB47B7282EE9D)},
+    {UINT64_C(0xB23867FB2A35B28D), UINT64_C(0xE99E619A4F23AA44)},
+    {UINT64_C(0xDEC681F9F4C31F31), UINT64_C(0x6405FA00E2EC94D5)},
+    {UINT64_C(0x8B3C113C38F9F37E), UINT64_C(0xDE83BC408DD3DD05)},
+    {UINT64_C(0xAE0B158B4738705E), UINT64_C(0x9624AB50B148D446)},
+    {UINT64_C(0xD98DDAEE19068C76), UINT64_C(0x3BADD624DD9B0958)},
+    {UINT64_C(0x87F8A8D4CFA417C9), UINT64_C(0xE54CA5D70A80E5D7)},
+    {UINT64_C(0xA9F6D30A038D1DBC), UINT64_C(0x5E9FCF4CCD211F4D)},
+    {UINT64_C(0xD47487CC8470652B), UINT64_C(0x7647C32000696720)},
+    {UINT64_C(0x84C8D4DFD2C63F3B), UINT64_C(0x29ECD9F40041E074)},
+    {UINT64_C(0xA5FB0A17C777CF09), UINT64_C(0xF468107100525891)},
+    {UINT64_C(0xCF79CC9DB955C2CC), UINT64_C(0x7182148D4066EEB5)},
+    {UINT64_C(0x81AC1FE293D599BF), UINT64_C(0xC6F14CD848405531)},
+    {UINT64_C(0xA21727DB38CB002F), UINT64_C(0xB8ADA00E5A506A7D)},
+    {UINT64_C(0xCA9CF1D206FDC03B), UINT64_C(0xA6D90811F0E4851D)},
+    {UINT64_C(0xFD442E4688BD304A), UINT64_C(0x908F4A166D1DA664)},
+    {UINT64_C(0x9E4A9CEC15763E2E), UINT64_C(0x9A598E4E043287FF)},
+    {UINT64_C(0xC5DD44271AD3CDBA), UINT64_C(0x40EFF1E1853F29FE)},
+    {UINT64_C(0xF7549530E188C128), UINT64_C(0xD12BEE59E68EF47D)},
+    {UINT64_C(0x9A94DD3E8CF578B9), UINT64_C(0x82BB74F8301958CF)},
+    {UINT64_C(0xC13A148E3032D6E7), UINT64_C(0xE36A52363C1FAF02)},
+    {UINT64_C(0xF18899B1BC3F8CA1), UINT64_C(0xDC44E6C3CB279AC2)},
+    {UINT64_C(0x96F5600F15A7B7E5), UINT64_C(0x29AB103A5EF8C0BA)},
+    {UINT64_C(0xBCB2B812DB11A5DE), UINT64_C(0x7415D448F6B6F0E8)},
+    {UINT64_C(0xEBDF661791D60F56), UINT64_C(0x111B495B3464AD22)},
+    {UINT64_C(0x936B9FCEBB25C995), UINT64_C(0xCAB10DD900BEEC35)},
+    {UINT64_C(0xB84687C269EF3BFB), UINT64_C(0x3D5D514F40EEA743)},
+    {UINT64_C(0xE65829B3046B0AFA), UINT64_C(0x0CB4A5A3112A5113)},
+    {UINT64_C(0x8FF71A0FE2C2E6DC), UINT64_C(0x47F0E785EABA72AC)},
+    {UINT64_C(0xB3F4E093DB73A093), UINT64_C(0x59ED216765690F57)},
+    {UINT64_C(0xE0F218B8D25088B8), UINT64_C(0x306869C13EC3532D)},
+    {UINT64_C(0x8C974F7383725573), UINT64_C(0x1E414218C73A13FC)},
+    {UINT64_C(0xAFBD2350644EEACF), UINT64_C(0xE5D1929EF90898FB)},
+    {UINT64_C(0xDBAC6C247D62A583), UINT64_C(0xDF45F746B74ABF3A)},
+    {UINT64_C(0x894BC396CE5DA772), UINT64_C(0x6B8BBA8C328EB784)},
+    {UINT64_C(0xAB9EB47C81F5114F), UINT64_C(0x066EA92F3F326565)},
+    {UINT64_C(0xD686619BA27255A2), UINT64_C(0xC80A537B0EFEFEBE)},
+    {UINT64_C(0x8613FD0145877585), UINT64_C(0xBD06742CE95F5F37)},
+    {UINT64_C(0xA798FC4196E952E7), UINT64_C(0x2C48113823B73705)},
+    {UINT64_C(0xD17F3B51FCA3A7A0), UINT64_C(0xF75A15862CA504C6)},
+    {UINT64_C(0x82EF85133DE648C4), UINT64_C(0x9A984D73DBE722FC)},
+    {UINT64_C(0xA3AB66580D5FDAF5), UINT64_C(0xC13E60D0D2E0EBBB)},
+    {UINT64_C(0xCC963FEE10B7D1B3), UINT64_C(0x318DF905079926A9)},
+    {UINT64_C(0xFFBBCFE994E5C61F), UINT64_C(0xFDF17746497F7053)},
+    {UINT64_C(0x9FD561F1FD0F9BD3), UINT64_C(0xFEB6EA8BEDEFA634)},
+    {UINT64_C(0xC7CABA6E7C5382C8), UINT64_C(0xFE64A52EE96B8FC1)},
+    {UINT64_C(0xF9BD690A1B68637B), UINT64_C(0x3DFDCE7AA3C673B1)},
+    {UINT64_C(0x9C1661A651213E2D), UINT64_C(0x06BEA10CA65C084F)},
+    {UINT64_C(0xC31BFA0FE5698DB8), UINT64_C(0x486E494FCFF30A63)},
+    {UINT64_C(0xF3E2F893DEC3F126), UINT64_C(0x5A89DBA3C3EFCCFB)},
+    {UINT64_C(0x986DDB5C6B3A76B7), UINT64_C(0xF89629465A75E01D)},
+    {UINT64_C(0xBE89523386091465), UINT64_C(0xF6BBB397F1135824)},
+    {UINT64_C(0xEE2BA6C0678B597F), UINT64_C(0x746AA07DED582E2D)},
+    {UINT64_C(0x94DB483840B717EF), UINT64_C(0xA8C2A44EB4571CDD)},
+    {UINT64_C(0xBA121A4650E4DDEB), UINT64_C(0x92F34D62616CE414)},
+    {UINT64_C(0xE896A0D7E51E1566), UINT64_C(0x77B020BAF9C81D18)},
+    {UINT64_C(0x915E2486EF32CD60), UINT64_C(0x0ACE1474DC1D122F)},
+    {UINT64_C(0xB5B5ADA8AAFF80B8), UINT64_C(0x0D819992132456BB)},
+    {UINT64_C(0xE3231912D5BF60E6), UINT64_C(0x10E1FFF697ED6C6A)},
+    {UINT64_C(0x8DF5EFABC5979C8F), UINT64_C(0xCA8D3FFA1EF463C2)},
+    {UINT64_C(0xB1736B96B6FD83B3), UINT64_C(0xBD308FF8A6B17CB3)},
+    {UINT64_C(0xDDD0467C64BCE4A0), UINT64_C(0xAC7CB3F6D05DDBDF)},
+    {UINT64_C(0x8AA22C0DBEF60EE4), UINT64_C(0x6BCDF07A423AA96C)},
+    {UINT64_C(0xAD4AB7112EB3929D), UINT64_C(0x86C16C98D2C953C7)},
+    {UINT64_C(0xD89D64D57A607744), UINT64_C(0xE871C7BF077BA8B8)},
+    {UINT64_C(0x87625F056C7C4A8B), UINT64_C(0x11471CD764AD4973)},
+    {UINT64_C(0xA93AF6C6C79B5D2D), UINT64_C(0xD598E40D3DD89BD0)},
+    {UINT64_C(0xD389B47879823479), UINT64_C(0x4AFF1D108D4EC2C4)},
+    {UINT64_C(0x843610CB4BF160CB), UINT64_C(0xCEDF722A585139BB)},
+    {UINT64_C(0xA54394FE1EEDB8FE), UINT64_C(0xC2974EB4EE658829)},
+    {UINT64_C(0xCE947A3DA6A9273E), UINT64_C(0x733D226229FEEA33)},
+    {UINT64_C(0x811CCC668829B887), UINT64_C(0x0806357D5A3F5260)},
+    {UINT64_C(0xA163FF802A3426A8), UINT64_C(0xCA07C2DCB0CF26F8)},
+    {UINT64_C(0xC9BCFF6034C13052), UINT64_C(0xFC89B393DD02F0B6)},
+    {UINT64_C(0xFC2C3F3841F17C67), UINT64_C(0xBBAC2078D443ACE3)},
+    {UINT64_C(0x9D9BA7832936EDC0), UINT64_C(0xD54B944B84AA4C0E)},
+    {UINT64_C(0xC5029163F384A931), UINT64_C(0x0A9E795E65D4DF12)},
+    {UINT64_C(0xF64335BCF065D37D), UINT64_C(0x4D4617B5FF4A16D6)},
+    {UINT64_C(0x99EA0196163FA42E), UINT64_C(0x504BCED1BF8E4E46)},
+    {UINT64_C(0xC06481FB9BCF8D39), UINT64_C(0xE45EC2862F71E1D7)},
+    {UINT64_C(0xF07DA27A82C37088), UINT64_C(0x5D767327BB4E5A4D)},
+    {UINT64_C(0x964E858C91BA2655), UINT64_C(0x3A6A07F8D510F870)},
+    {UINT64_C(0xBBE226EFB628AFEA), UINT64_C(0x890489F70A55368C)},
+    {UINT64_C(0xEADAB0ABA3B2DBE5), UINT64_C(0x2B45AC74CCEA842F)},
+    {UINT64_C(0x92C8AE6B464FC96F), UINT64_C(0x3B0B8BC90012929E)},
+    {UINT64_C(0xB77ADA0617E3BBCB), UINT64_C(0x09CE6EBB40173745)},
+    {UINT64_C(0xE55990879DDCAABD), UINT64_C(0xCC420A6A101D0516)},
+    {UINT64_C(0x8F57FA54C2A9EAB6), UINT64_C(0x9FA946824A12232E)},
+    {UINT64_C(0xB32DF8E9F3546564), UINT64_C(0x47939822DC96ABFA)},
+    {UINT64_C(0xDFF9772470297EBD), UINT64_C(0x59787E2B93BC56F8)},
+    {UINT64_C(0x8BFBEA76C619EF36), UINT64_C(0x57EB4EDB3C55B65B)},
+    {UINT64_C(0xAEFAE51477A06B03), UINT64_C(0xEDE622920B6B23F2)},
+    {UINT64_C(0xDAB99E59958885C4), UINT64_C(0xE95FAB368E45ECEE)},
+    {UINT64_C(0x88B402F7FD75539B), UINT64_C(0x11DBCB0218EBB415)},
+    {UINT64_C(0xAAE103B5FCD2A881), UINT64_C(0xD652BDC29F26A11A)},
+    {UINT64_C(0xD59944A37C0752A2), UINT64_C(0x4BE76D3346F04960)},
+    {UINT64_C(0x857FCAE62D8493A5), UINT64_C(0x6F70A4400C562DDC)},
+    {UINT64_C(0xA6DFBD9FB8E5B88E), UINT64_C(0xCB4CCD500F6BB953)},
+    {UINT64_C(0xD097AD07A71F26B2), UINT64_C(0x7E2000A41346A7A8)},
+    {UINT64_C(0x825ECC24C873782F), UINT64_C(0x8ED400668C0C28C9)},
+    {UINT64_C(0xA2F67F2DFA90563B), UINT64_C(0x728900802F0F32FB)},
+    {UINT64_C(0xCBB41EF979346BCA), UINT64_C(0x4F2B40A03AD2FFBA)},
+    {UINT64_C(0xFEA126B7D78186BC), UINT64_C(0xE2F610C84987BFA9)},
+    {UINT64_C(0x9F24B832E6B0F436), UINT64_C(0x0DD9CA7D2DF4D7CA)},
+    {UINT64_C(0xC6EDE63FA05D3143), UINT64_C(0x91503D1C79720DBC)},
+    {UINT64_C(0xF8A95FCF88747D94), UINT64_C(0x75A44C6397CE912B)},
+    {UINT64_C(0x9B69DBE1B548CE7C), UINT64_C(0xC986AFBE3EE11ABB)},
+    {UINT64_C(0xC24452DA229B021B), UINT64_C(0xFBE85BADCE996169)},
+    {UINT64_C(0xF2D56790AB41C2A2), UINT64_C(0xFAE27299423FB9C4)},
+    {UINT64_C(0x97C560BA6B0919A5), UINT64_C(0xDCCD879FC967D41B)},
+    {UINT64_C(0xBDB6B8E905CB600F), UINT64_C(0x5400E987BBC1C921)},
+    {UINT64_C(0xED246723473E3813), UINT64_C(0x290123E9AAB23B69)},
+    {UINT64_C(0x9436C0760C86E30B), UINT64_C(0xF9A0B6720AAF6522)},
+    {UINT64_C(0xB94470938FA89BCE), UINT64_C(0xF808E40E8D5B3E6A)},
+    {UINT64_C(0xE7958CB87392C2C2), UINT64_C(0xB60B1D1230B20E05)},
+    {UINT64_C(0x90BD77F3483BB9B9), UINT64_C(0xB1C6F22B5E6F48C3)},
+    {UINT64_C(0xB4ECD5F01A4AA828), UINT64_C(0x1E38AEB6360B1AF4)},
+    {UINT64_C(0xE2280B6C20DD5232), UINT64_C(0x25C6DA63C38DE1B1)},
+    {UINT64_C(0x8D590723948A535F), UINT64_C(0x579C487E5A38AD0F)},
+    {UINT64_C(0xB0AF48EC79ACE837), UINT64_C(0x2D835A9DF0C6D852)},
+    {UINT64_C(0xDCDB1B2798182244), UINT64_C(0xF8E431456CF88E66)},
+    {UINT64_C(0x8A08F0F8BF0F156B), UINT64_C(0x1B8E9ECB641B5900)},
+    {UINT64_C(0xAC8B2D36EED2DAC5), UINT64_C(0xE272467E3D222F40)},
+    {UINT64_C(0xD7ADF884AA879177), UINT64_C(0x5B0ED81DCC6ABB10)},
+    {UINT64_C(0x86CCBB52EA94BAEA), UINT64_C(0x98E947129FC2B4EA)},
+    {UINT64_C(0xA87FEA27A539E9A5), UINT64_C(0x3F2398D747B36225)},
+    {UINT64_C(0xD29FE4B18E88640E), UINT64_C(0x8EEC7F0D19A03AAE)},
+    {UINT64_C(0x83A3EEEEF9153E89), UINT64_C(0x1953CF68300424AD)},
+    {UINT64_C(0xA48CEAAAB75A8E2B), UINT64_C(0x5FA8C3423C052DD8)},
+    {UINT64_C(0xCDB02555653131B6), UINT64_C(0x3792F412CB06794E)},
+    {UINT64_C(0x808E17555F3EBF11), UINT64_C(0xE2BBD88BBEE40BD1)},
+    {UINT64_C(0xA0B19D2AB70E6ED6), UINT64_C(0x5B6ACEAEAE9D0EC5)},
+    {UINT64_C(0xC8DE047564D20A8B), UINT64_C(0xF245825A5A445276)},
+    {UINT64_C(0xFB158592BE068D2E), UINT64_C(0xEED6E2F0F0D56713)},
+    {UINT64_C(0x9CED737BB6C4183D), UINT64_C(0x55464DD69685606C)},
+    {UINT64_C(0xC428D05AA4751E4C), UINT64_C(0xAA97E14C3C26B887)},
+    {UINT64_C(0xF53304714D9265DF), UINT64_C(0xD53DD99F4B3066A9)},
+    {UINT64_C(0x993FE2C6D07B7FAB), UINT64_C(0xE546A8038EFE402A)},
+    {UINT64_C(0xBF8FDB78849A5F96), UINT64_C(0xDE98520472BDD034)},
+    {UINT64_C(0xEF73D256A5C0F77C), UINT64_C(0x963E66858F6D4441)},
+    {UINT64_C(0x95A8637627989AAD), UINT64_C(0xDDE7001379A44AA9)},
+    {UINT64_C(0xBB127C53B17EC159), UINT64_C(0x5560C018580D5D53)},
+    {UINT64_C(0xE9D71B689DDE71AF), UINT64_C(0xAAB8F01E6E10B4A7)},
+    {UINT64_C(0x9226712162AB070D), UINT64_C(0xCAB3961304CA70E9)},
+    {UINT64_C(0xB6B00D69BB55C8D1), UINT64_C(0x3D607B97C5FD0D23)},
+    {UINT64_C(0xE45C10C42A2B3B05), UINT64_C(0x8CB89A7DB77C506B)},
+    {UINT64_C(0x8EB98A7A9A5B04E3), UINT64_C(0x77F3608E92ADB243)},
+    {UINT64_C(0xB267ED1940F1C61C), UINT64_C(0x55F038B237591ED4)},
+    {UINT64_C(0xDF01E85F912E37A3), UINT64_C(0x6B6C46DEC52F6689)},
+    {UINT64_C(0x8B61313BBABCE2C6), UINT64_C(0x2323AC4B3B3DA016)},
+    {UINT64_C(0xAE397D8AA96C1B77), UINT64_C(0xABEC975E0A0D081B)},
+    {UINT64_C(0xD9C7DCED53C72255), UINT64_C(0x96E7BD358C904A22)},
+    {UINT64_C(0x881CEA14545C7575), UINT64_C(0x7E50D64177DA2E55)},
+    {UINT64_C(0xAA242499697392D2), UINT64_C(0xDDE50BD1D5D0B9EA)},
+    {UINT64_C(0xD4AD2DBFC3D07787), UINT64_C(0x955E4EC64B44E865)},
+    {UINT64_C(0x84EC3C97DA624AB4), UINT64_C(0xBD5AF13BEF0B113F)},
+    {UINT64_C(0xA6274BBDD0FADD61), UINT64_C(0xECB1AD8AEACDD58F)},
+    {UINT64_C(0xCFB11EAD453994BA), UINT64_C(0x67DE18EDA5814AF3)},
+    {UINT64_C(0x81CEB32C4B43FCF4), UINT64_C(0x80EACF948770CED8)},
+    {UINT64_C(0xA2425FF75E14FC31), UINT64_C(0xA1258379A94D028E)},
+    {UINT64_C(0xCAD2F7F5359A3B3E), UINT64_C(0x096EE45813A04331)},
+    {UINT64_C(0xFD87B5F28300CA0D), UINT64_C(0x8BCA9D6E188853FD)},
+    {UINT64_C(0x9E74D1B791E07E48), UINT64_C(0x775EA264CF55347E)},
+    {UINT64_C(0xC612062576589DDA), UINT64_C(0x95364AFE032A819E)},
+    {UINT64_C(0xF79687AED3EEC551), UINT64_C(0x3A83DDBD83F52205)},
+    {UINT64_C(0x9ABE14CD44753B52), UINT64_C(0xC4926A9672793543)},
+    {UINT64_C(0xC16D9A0095928A27), UINT64_C(0x75B7053C0F178294)},
+    {UINT64_C(0xF1C90080BAF72CB1), UINT64_C(0x5324C68B12DD6339)},
+    {UINT64_C(0x971DA05074DA7BEE), UINT64_C(0xD3F6FC16EBCA5E04)},
+    {UINT64_C(0xBCE5086492111AEA), UINT64_C(0x88F4BB1CA6BCF585)},
+    {UINT64_C(0xEC1E4A7DB69561A5), UINT64_C(0x2B31E9E3D06C32E6)},
+    {UINT64_C(0x9392EE8E921D5D07), UINT64_C(0x3AFF322E62439FD0)},
+    {UINT64_C(0xB877AA3236A4B449), UINT64_C(0x09BEFEB9FAD487C3)},
+    {UINT64_C(0xE69594BEC44DE15B), UINT64_C(0x4C2EBE687989A9B4)},
+    {UINT64_C(0x901D7CF73AB0ACD9), UINT64_C(0x0F9D37014BF60A11)},
+    {UINT64_C(0xB424DC35095CD80F), UINT64_C(0x538484C19EF38C95)},
+    {UINT64_C(0xE12E13424BB40E13), UINT64_C(0x2865A5F206B06FBA)},
+    {UINT64_C(0x8CBCCC096F5088CB), UINT64_C(0xF93F87B7442E45D4)},
+    {UINT64_C(0xAFEBFF0BCB24AAFE), UINT64_C(0xF78F69A51539D749)},
+    {UINT64_C(0xDBE6FECEBDEDD5BE), UINT64_C(0xB573440E5A884D1C)},
+    {UINT64_C(0x89705F4136B4A597), UINT64_C(0x31680A88F8953031)},
+    {UINT64_C(0xABCC77118461CEFC), UINT64_C(0xFDC20D2B36BA7C3E)},
+    {UINT64_C(0xD6BF94D5E57A42BC), UINT64_C(0x3D32907604691B4D)},
+    {UINT64_C(0x8637BD05AF6C69B5), UINT64_C(0xA63F9A49C2C1B110)},
+    {UINT64_C(0xA7C5AC471B478423), UINT64_C(0x0FCF80DC33721D54)},
+    {UINT64_C(0xD1B71758E219652B), UINT64_C(0xD3C36113404EA4A9)},
+    {UINT64_C(0x83126E978D4FDF3B), UINT64_C(0x645A1CAC083126EA)},
+    {UINT64_C(0xA3D70A3D70A3D70A), UINT64_C(0x3D70A3D70A3D70A4)},
+    {UINT64_C(0xCCCCCCCCCCCCCCCC), UINT64_C(0xCCCCCCCCCCCCCCCD)},
+    {UINT64_C(0x8000000000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xA000000000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xC800000000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xFA00000000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0x9C40000000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xC350000000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xF424000000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0x9896800000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xBEBC200000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xEE6B280000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0x9502F90000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xBA43B74000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xE8D4A51000000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0x9184E72A00000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xB5E620F480000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xE35FA931A0000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0x8E1BC9BF04000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xB1A2BC2EC5000000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xDE0B6B3A76400000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0x8AC7230489E80000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xAD78EBC5AC620000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xD8D726B7177A8000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0x878678326EAC9000), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xA968163F0A57B400), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xD3C21BCECCEDA100), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0x84595161401484A0), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xA56FA5B99019A5C8), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0xCECB8F27F4200F3A), UINT64_C(0x0000000000000000)},
+    {UINT64_C(0x813F3978F8940984), UINT64_C(0x4000000000000000)},
+    {UINT64_C(0xA18F07D736B90BE5), UINT64_C(0x5000000000000000)},
+    {UINT64_C(0xC9F2C9CD04674EDE), UINT64_C(0xA400000000000000)},
+    {UINT64_C(0xFC6F7C4045812296), UINT64_C(0x4D00000000000000)},
+    {UINT64_C(0x9DC5ADA82B70B59D), UINT64_C(0xF020000000000000)},
+    {UINT64_C(0xC5371912364CE305), UINT64_C(0x6C28000000000000)},
+    {UINT64_C(0xF684DF56C3E01BC6), UINT64_C(0xC732000000000000)},
+    {UINT64_C(0x9A130B963A6C115C), UINT64_C(0x3C7F400000000000)},
+    {UINT64_C(0xC097CE7BC90715B3), UINT64_C(0x4B9F100000000000)},
+    {UINT64_C(0xF0BDC21ABB48DB20), UINT64_C(0x1E86D40000000000)},
+    {UINT64_C(0x96769950B50D88F4), UINT64_C(0x1314448000000000)},
+    {UINT64_C(0xBC143FA4E250EB31), UINT64_C(0x17D955A000000000)},
+    {UINT64_C(0xEB194F8E1AE525FD), UINT64_C(0x5DCFAB0800000000)},
+    {UINT64_C(0x92EFD1B8D0CF37BE), UINT64_C(0x5AA1CAE500000000)},
+    {UINT64_C(0xB7ABC627050305AD), UINT64_C(0xF14A3D9E40000000)},
+    {UINT64_C(0xE596B7B0C643C719), UINT64_C(0x6D9CCD05D0000000)},
+    {UINT64_C(0x8F7E32CE7BEA5C6F), UINT64_C(0xE4820023A2000000)},
+    {UINT64_C(0xB35DBF821AE4F38B), UINT64_C(0xDDA2802C8A800000)},
+    {UINT64_C(0xE0352F62A19E306E), UINT64_C(0xD50B2037AD200000)},
+    {UINT64_C(0x8C213D9DA502DE45), UINT64_C(0x4526F422CC340000)},
+    {UINT64_C(0xAF298D050E4395D6), UINT64_C(0x9670B12B7F410000)},
+    {UINT64_C(0xDAF3F04651D47B4C), UINT64_C(0x3C0CDD765F114000)},
+    {UINT64_C(0x88D8762BF324CD0F), UINT64_C(0xA5880A69FB6AC800)},
+    {UINT64_C(0xAB0E93B6EFEE0053), UINT64_C(0x8EEA0D047A457A00)},
+    {UINT64_C(0xD5D238A4ABE98068), UINT64_C(0x72A4904598D6D880)},
+    {UINT64_C(0x85A36366EB71F041), UINT64_C(0x47A6DA2B7F864750)},
+    {UINT64_C(0xA70C3C40A64E6C51), UINT64_C(0x999090B65F67D924)},
+    {UINT64_C(0xD0CF4B50CFE20765), UINT64_C(0xFFF4B4E3F741CF6D)},
+    {UINT64_C(0x82818F1281ED449F), UINT64_C(0xBFF8F10E7A8921A5)},
+    {UINT64_C(0xA321F2D7226895C7), UINT64_C(0xAFF72D52192B6A0E)},
+    {UINT64_C(0xCBEA6F8CEB02BB39), UINT64_C(0x9BF4F8A69F764491)},
+    {UINT64_C(0xFEE50B7025C36A08), UINT64_C(0x02F236D04753D5B5)},
+    {UINT64_C(0x9F4F2726179A2245), UINT64_C(0x01D762422C946591)},
+    {UINT64_C(0xC722F0EF9D80AAD6), UINT64_C(0x424D3AD2B7B97EF6)},
+    {UINT64_C(0xF8EBAD2B84E0D58B), UINT64_C(0xD2E0898765A7DEB3)},
+    {UINT64_C(0x9B934C3B330C8577), UINT64_C(0x63CC55F49F88EB30)},
+    {UINT64_C(0xC2781F49FFCFA6D5), UINT64_C(0x3CBF6B71C76B25FC)},
+    {UINT64_C(0xF316271C7FC3908A), UINT64_C(0x8BEF464E3945EF7B)},
+    {UINT64_C(0x97EDD871CFDA3A56), UINT64_C(0x97758BF0E3CBB5AD)},
+    {UINT64_C(0xBDE94E8E43D0C8EC), UINT64_C(0x3D52EEED1CBEA318)},
+    {UINT64_C(0xED63A231D4C4FB27), UINT64_C(0x4CA7AAA863EE4BDE)},
+    {UINT64_C(0x945E455F24FB1CF8), UINT64_C(0x8FE8CAA93E74EF6B)},
+    {UINT64_C(0xB975D6B6EE39E436), UINT64_C(0xB3E2FD538E122B45)},
+    {UINT64_C(0xE7D34C64A9C85D44), UINT64_C(0x60DBBCA87196B617)},
+    {UINT64_C(0x90E40FBEEA1D3A4A), UINT64_C(0xBC8955E946FE31CE)},
+    {UINT64_C(0xB51D13AEA4A488DD), UINT64_C(0x6BABAB6398BDBE42)},
+    {UINT64_C(0xE264589A4DCDAB14), UINT64_C(0xC696963C7EED2DD2)},
+    {UINT64_C(0x8D7EB76070A08AEC), UINT64_C(0xFC1E1DE5CF543CA3)},
+    {UINT64_C(0xB0DE65388CC8ADA8), UINT64_C(0x3B25A55F43294BCC)},
+    {UINT64_C(0xDD15FE86AFFAD912), UINT64_C(0x49EF0EB713F39EBF)},
+    {UINT64_C(0x8A2DBF142DFCC7AB), UINT64_C(0x6E3569326C784338)},
+    {UINT64_C(0xACB92ED9397BF996), UINT64_C(0x49C2C37F07965405)},
+    {UINT64_C(0xD7E77A8F87DAF7FB), UINT64_C(0xDC33745EC97BE907)},
+    {UINT64_C(0x86F0AC99B4E8DAFD), UINT64_C(0x69A028BB3DED71A4)},
+    {UINT64_C(0xA8ACD7C0222311BC), UINT64_C(0xC40832EA0D68CE0D)},
+    {UINT64_C(0xD2D80DB02AABD62B), UINT64_C(0xF50A3FA490C30191)},
+    {UINT64_C(0x83C7088E1AAB65DB), UINT64_C(0x792667C6DA79E0FB)},
+    {UINT64_C(0xA4B8CAB1A1563F52), UINT64_C(0x577001B891185939)},
+    {UINT64_C(0xCDE6FD5E09ABCF26), UINT64_C(0xED4C0226B55E6F87)},
+    {UINT64_C(0x80B05E5AC60B6178), UINT64_C(0x544F8158315B05B5)},
+    {UINT64_C(0xA0DC75F1778E39D6), UINT64_C(0x696361AE3DB1C722)},
+    {UINT64_C(0xC913936DD571C84C), UINT64_C(0x03BC3A19CD1E38EA)},
+    {UINT64_C(0xFB5878494ACE3A5F), UINT64_C(0x04AB48A04065C724)},
+    {UINT64_C(0x9D174B2DCEC0E47B), UINT64_C(0x62EB0D64283F9C77)},
+    {UINT64_C(0xC45D1DF942711D9A), UINT64_C(0x3BA5D0BD324F8395)},
+    {UINT64_C(0xF5746577930D6500), UINT64_C(0xCA8F44EC7EE3647A)},
+    {UINT64_C(0x9968BF6ABBE85F20), UINT64_C(0x7E998B13CF4E1ECC)},
+    {UINT64_C(0xBFC2EF456AE276E8), UINT64_C(0x9E3FEDD8C321A67F)},
+    {UINT64_C(0xEFB3AB16C59B14A2), UINT64_C(0xC5CFE94EF3EA101F)},
+    {UINT64_C(0x95D04AEE3B80ECE5), UINT64_C(0xBBA1F1D158724A13)},
+    {UINT64_C(0xBB445DA9CA61281F), UINT64_C(0x2A8A6E45AE8EDC98)},
+    {UINT64_C(0xEA1575143CF97226), UINT64_C(0xF52D09D71A3293BE)},
+    {UINT64_C(0x924D692CA61BE758), UINT64_C(0x593C2626705F9C57)},
+    {UINT64_C(0xB6E0C377CFA2E12E), UINT64_C(0x6F8B2FB00C77836D)},
+    {UINT64_C(0xE498F455C38B997A), UINT64_C(0x0B6DFB9C0F956448)},
+    {UINT64_C(0x8EDF98B59A373FEC), UINT64_C(0x4724BD4189BD5EAD)},
+    {UINT64_C(0xB2977EE300C50FE7), UINT64_C(0x58EDEC91EC2CB658)},
+    {UINT64_C(0xDF3D5E9BC0F653E1), UINT64_C(0x2F2967B66737E3EE)},
+    {UINT64_C(0x8B865B215899F46C), UINT64_C(0xBD79E0D20082EE75)},
+    {UINT64_C(0xAE67F1E9AEC07187), UINT64_C(0xECD8590680A3AA12)},
+    {UINT64_C(0xDA01EE641A708DE9), UINT64_C(0xE80E6F4820CC9496)},
+    {UINT64_C(0x884134FE908658B2), UINT64_C(0x3109058D147FDCDE)},
+    {UINT64_C(0xAA51823E34A7EEDE), UINT64_C(0xBD4B46F0599FD416)},
+    {UINT64_C(0xD4E5E2CDC1D1EA96), UINT64_C(0x6C9E18AC7007C91B)},
+    {UINT64_C(0x850FADC09923329E), UINT64_C(0x03E2CF6BC604DDB1)},
+    {UINT64_C(0xA6539930BF6BFF45), UINT64_C(0x84DB8346B786151D)},
+    {UINT64_C(0xCFE87F7CEF46FF16), UINT64_C(0xE612641865679A64)},
+    {UINT64_C(0x81F14FAE158C5F6E), UINT64_C(0x4FCB7E8F3F60C07F)},
+    {UINT64_C(0xA26DA3999AEF7749), UINT64_C(0xE3BE5E330F38F09E)},
+    {UINT64_C(0xCB090C8001AB551C), UINT64_C(0x5CADF5BFD3072CC6)},
+    {UINT64_C(0xFDCB4FA002162A63), UINT64_C(0x73D9732FC7C8F7F7)},
+    {UINT64_C(0x9E9F11C4014DDA7E), UINT64_C(0x2867E7FDDCDD9AFB)},
+    {UINT64_C(0xC646D63501A1511D), UINT64_C(0xB281E1FD541501B9)},
+    {UINT64_C(0xF7D88BC24209A565), UINT64_C(0x1F225A7CA91A4227)},
+    {UINT64_C(0x9AE757596946075F), UINT64_C(0x3375788DE9B06959)},
+    {UINT64_C(0xC1A12D2FC3978937), UINT64_C(0x0052D6B1641C83AF)},
+    {UINT64_C(0xF209787BB47D6B84), UINT64_C(0xC0678C5DBD23A49B)},
+    {UINT64_C(0x9745EB4D50CE6332), UINT64_C(0xF840B7BA963646E1)},
+    {UINT64_C(0xBD176620A501FBFF), UINT64_C(0xB650E5A93BC3D899)},
+    {UINT64_C(0xEC5D3FA8CE427AFF), UINT64_C(0xA3E51F138AB4CEBF)},
+    {UINT64_C(0x93BA47C980E98CDF), UINT64_C(0xC66F336C36B10138)},
+    {UINT64_C(0xB8A8D9BBE123F017), UINT64_C(0xB80B0047445D4185)},
+    {UINT64_C(0xE6D3102AD96CEC1D), UINT64_C(0xA60DC059157491E6)},
+    {UINT64_C(0x9043EA1AC7E41392), UINT64_C(0x87C89837AD68DB30)},
+    {UINT64_C(0xB454E4A179DD1877), UINT64_C(0x29BABE4598C311FC)},
+    {UINT64_C(0xE16A1DC9D8545E94), UINT64_C(0xF4296DD6FEF3D67B)},
+    {UINT64_C(0x8CE2529E2734BB1D), UINT64_C(0x1899E4A65F58660D)},
+    {UINT64_C(0xB01AE745B101E9E4), UINT64_C(0x5EC05DCFF72E7F90)},
+    {UINT64_C(0xDC21A1171D42645D), UINT64_C(0x76707543F4FA1F74)},
+    {UINT64_C(0x899504AE72497EBA), UINT64_C(0x6A06494A791C53A9)},
+    {UINT64_C(0xABFA45DA0EDBDE69), UINT64_C(0x0487DB9D17636893)},
+    {UINT64_C(0xD6F8D7509292D603), UINT64_C(0x45A9D2845D3C42B7)},
+    {UINT64_C(0x865B86925B9BC5C2), UINT64_C(0x0B8A2392BA45A9B3)},
+    {UINT64_C(0xA7F26836F282B732), UINT64_C(0x8E6CAC7768D7141F)},
+    {UINT64_C(0xD1EF0244AF2364FF), UINT64_C(0x3207D795430CD927)},
+    {UINT64_C(0x8335616AED761F1F), UINT64_C(0x7F44E6BD49E807B9)},
+    {UINT64_C(0xA402B9C5A8D3A6E7), UINT64_C(0x5F16206C9C6209A7)},
+    {UINT64_C(0xCD036837130890A1), UINT64_C(0x36DBA887C37A8C10)},
+    {UINT64_C(0x802221226BE55A64), UINT64_C(0xC2494954DA2C978A)},
+    {UINT64_C(0xA02AA96B06DEB0FD), UINT64_C(0xF2DB9BAA10B7BD6D)},
+    {UINT64_C(0xC83553C5C8965D3D), UINT64_C(0x6F92829494E5ACC8)},
+    {UINT64_C(0xFA42A8B73ABBF48C), UINT64_C(0xCB772339BA1F17FA)},
+    {UINT64_C(0x9C69A97284B578D7), UINT64_C(0xFF2A760414536EFC)},
+    {UINT64_C(0xC38413CF25E2D70D), UINT64_C(0xFEF5138519684ABB)},
+    {UINT64_C(0xF46518C2EF5B8CD1), UINT64_C(0x7EB258665FC25D6A)},
+    {UINT64_C(0x98BF2F79D5993802), UINT64_C(0xEF2F773FFBD97A62)},
+    {UINT64_C(0xBEEEFB584AFF8603), UINT64_C(0xAAFB550FFACFD8FB)},
+    {UINT64_C(0xEEAABA2E5DBF6784), UINT64_C(0x95BA2A53F983CF39)},
+    {UINT64_C(0x952AB45CFA97A0B2), UINT64_C(0xDD945A747BF26184)},
+    {UINT64_C(0xBA756174393D88DF), UINT64_C(0x94F971119AEEF9E5)},
+    {UINT64_C(0xE912B9D1478CEB17), UINT64_C(0x7A37CD5601AAB85E)},
+    {UINT64_C(0x91ABB422CCB812EE), UINT64_C(0xAC62E055C10AB33B)},
+    {UINT64_C(0xB616A12B7FE617AA), UINT64_C(0x577B986B314D600A)},
+    {UINT64_C(0xE39C49765FDF9D94), UINT64_C(0xED5A7E85FDA0B80C)},
+    {UINT64_C(0x8E41ADE9FBEBC27D), UINT64_C(0x14588F13BE847308)},
+    {UINT64_C(0xB1D219647AE6B31C), UINT64_C(0x596EB2D8AE258FC9)},
+    {UINT64_C(0xDE469FBD99A05FE3), UINT64_C(0x6FCA5F8ED9AEF3BC)},
+    {UINT64_C(0x8AEC23D680043BEE), UINT64_C(0x25DE7BB9480D5855)},
+    {UINT64_C(0xADA72CCC20054AE9), UINT64_C(0xAF561AA79A10AE6B)},
+    {UINT64_C(0xD910F7FF28069DA4), UINT64_C(0x1B2BA1518094DA05)},
+    {UINT64_C(0x87AA9AFF79042286), UINT64_C(0x90FB44D2F05D0843)},
+    {UINT64_C(0xA99541BF57452B28), UINT64_C(0x353A1607AC744A54)},
+    {UINT64_C(0xD3FA922F2D1675F2), UINT64_C(0x42889B8997915CE9)},
+    {UINT64_C(0x847C9B5D7C2E09B7), UINT64_C(0x69956135FEBADA12)},
+    {UINT64_C(0xA59BC234DB398C25), UINT64_C(0x43FAB9837E699096)},
+    {UINT64_C(0xCF02B2C21207EF2E), UINT64_C(0x94F967E45E03F4BC)},
+    {UINT64_C(0x8161AFB94B44F57D), UINT64_C(0x1D1BE0EEBAC278F6)},
+    {UINT64_C(0xA1BA1BA79E1632DC), UINT64_C(0x6462D92A69731733)},
+    {UINT64_C(0xCA28A291859BBF93), UINT64_C(0x7D7B8F7503CFDCFF)},
+    {UINT64_C(0xFCB2CB35E702AF78), UINT64_C(0x5CDA735244C3D43F)},
+    {UINT64_C(0x9DEFBF01B061ADAB), UINT64_C(0x3A0888136AFA64A8)},
+    {UINT64_C(0xC56BAEC21C7A1916), UINT64_C(0x088AAA1845B8FDD1)},
+    {UINT64_C(0xF6C69A72A3989F5B), UINT64_C(0x8AAD549E57273D46)},
+    {UINT64_C(0x9A3C2087A63F6399), UINT64_C(0x36AC54E2F678864C)},
+    {UINT64_C(0xC0CB28A98FCF3C7F), UINT64_C(0x84576A1BB416A7DE)},
+    {UINT64_C(0xF0FDF2D3F3C30B9F), UINT64_C(0x656D44A2A11C51D6)},
+    {UINT64_C(0x969EB7C47859E743), UINT64_C(0x9F644AE5A4B1B326)},
+    {UINT64_C(0xBC4665B596706114), UINT64_C(0x873D5D9F0DDE1FEF)},
+    {UINT64_C(0xEB57FF22FC0C7959), UINT64_C(0xA90CB506D155A7EB)},
+    {UINT64_C(0x9316FF75DD87CBD8), UINT64_C(0x09A7F12442D588F3)},
+    {UINT64_C(0xB7DCBF5354E9BECE), UINT64_C(0x0C11ED6D538AEB30)},
+    {UINT64_C(0xE5D3EF282A242E81), UINT64_C(0x8F1668C8A86DA5FB)},
+    {UINT64_C(0x8FA475791A569D10), UINT64_C(0xF96E017D694487BD)},
+    {UINT64_C(0xB38D92D760EC4455), UINT64_C(0x37C981DCC395A9AD)},
+    {UINT64_C(0xE070F78D3927556A), UINT64_C(0x85BBE253F47B1418)},
+    {UINT64_C(0x8C469AB843B89562), UINT64_C(0x93956D7478CCEC8F)},
+    {UINT64_C(0xAF58416654A6BABB), UINT64_C(0x387AC8D1970027B3)},
+    {UINT64_C(0xDB2E51BFE9D0696A), UINT64_C(0x06997B05FCC0319F)},
+    {UINT64_C(0x88FCF317F22241E2), UINT64_C(0x441FECE3BDF81F04)},
+    {UINT64_C(0xAB3C2FDDEEAAD25A), UINT64_C(0xD527E81CAD7626C4)},
+    {UINT64_C(0xD60B3BD56A5586F1), UINT64_C(0x8A71E223D8D3B075)},
+    {UINT64_C(0x85C7056562757456), UINT64_C(0xF6872D5667844E4A)},
+    {UINT64_C(0xA738C6BEBB12D16C), UINT64_C(0xB428F8AC016561DC)},
+    {UINT64_C(0xD106F86E69D785C7), UINT64_C(0xE13336D701BEBA53)},
+    {UINT64_C(0x82A45B450226B39C), UINT64_C(0xECC0024661173474)},
+    {UINT64_C(0xA34D721642B06084), UINT64_C(0x27F002D7F95D0191)},
+    {UINT64_C(0xCC20CE9BD35C78A5), UINT64_C(0x31EC038DF7B441F5)},
+    {UINT64_C(0xFF290242C83396CE), UINT64_C(0x7E67047175A15272)},
+    {UINT64_C(0x9F79A169BD203E41), UINT64_C(0x0F0062C6E984D387)},
+    {UINT64_C(0xC75809C42C684DD1), UINT64_C(0x52C07B78A3E60869)},
+    {UINT64_C(0xF92E0C3537826145), UINT64_C(0xA7709A56CCDF8A83)},
+    {UINT64_C(0x9BBCC7A142B17CCB), UINT64_C(0x88A66076400BB692)},
+    {UINT64_C(0xC2ABF989935DDBFE), UINT64_C(0x6ACFF893D00EA436)},
+    {UINT64_C(0xF356F7EBF83552FE), UINT64_C(0x0583F6B8C4124D44)},
+    {UINT64_C(0x98165AF37B2153DE), UINT64_C(0xC3727A337A8B704B)},
+    {UINT64_C(0xBE1BF1B059E9A8D6), UINT64_C(0x744F18C0592E4C5D)},
+    {UINT64_C(0xEDA2EE1C7064130C), UINT64_C(0x1162DEF06F79DF74)},
+    {UINT64_C(0x9485D4D1C63E8BE7), UINT64_C(0x8ADDCB5645AC2BA9)},
+    {UINT64_C(0xB9A74A0637CE2EE1), UINT64_C(0x6D953E2BD7173693)},
+    {UINT64_C(0xE8111C87C5C1BA99), UINT64_C(0xC8FA8DB6CCDD0438)},
+    {UINT64_C(0x910AB1D4DB9914A0), UINT64_C(0x1D9C9892400A22A3)},
+    {UINT64_C(0xB54D5E4A127F59C8), UINT64_C(0x2503BEB6D00CAB4C)},
+    {UINT64_C(0xE2A0B5DC971F303A), UINT64_C(0x2E44AE64840FD61E)},
+    {UINT64_C(0x8DA471A9DE737E24), UINT64_C(0x5CEAECFED289E5D3)},
+    {UINT64_C(0xB10D8E1456105DAD), UINT64_C(0x7425A83E872C5F48)},
+    {UINT64_C(0xDD50F1996B947518), UINT64_C(0xD12F124E28F7771A)},
+    {UINT64_C(0x8A5296FFE33CC92F), UINT64_C(0x82BD6B70D99AAA70)},
+    {UINT64_C(0xACE73CBFDC0BFB7B), UINT64_C(0x636CC64D1001550C)},
+    {UINT64_C(0xD8210BEFD30EFA5A), UINT64_C(0x3C47F7E05401AA4F)},
+    {UINT64_C(0x8714A775E3E95C78), UINT64_C(0x65ACFAEC34810A72)},
+    {UINT64_C(0xA8D9D1535CE3B396), UINT64_C(0x7F1839A741A14D0E)},
+    {UINT64_C(0xD31045A8341CA07C), UINT64_C(0x1EDE48111209A051)},
+    {UINT64_C(0x83EA2B892091E44D), UINT64_C(0x934AED0AAB460433)},
+    {UINT64_C(0xA4E4B66B68B65D60), UINT64_C(0xF81DA84D56178540)},
+    {UINT64_C(0xCE1DE40642E3F4B9), UINT64_C(0x36251260AB9D668F)},
+    {UINT64_C(0x80D2AE83E9CE78F3), UINT64_C(0xC1D72B7C6B42601A)},
+    {UINT64_C(0xA1075A24E4421730), UINT64_C(0xB24CF65B8612F820)},
+    {UINT64_C(0xC94930AE1D529CFC), UINT64_C(0xDEE033F26797B628)},
+    {UINT64_C(0xFB9B7CD9A4A7443C), UINT64_C(0x169840EF017DA3B2)},
+    {UINT64_C(0x9D412E0806E88AA5), UINT64_C(0x8E1F289560EE864F)},
+    {UINT64_C(0xC491798A08A2AD4E), UINT64_C(0xF1A6F2BAB92A27E3)},
+    {UINT64_C(0xF5B5D7EC8ACB58A2), UINT64_C(0xAE10AF696774B1DC)},
+    {UINT64_C(0x9991A6F3D6BF1765), UINT64_C(0xACCA6DA1E0A8EF2A)},
+    {UINT64_C(0xBFF610B0CC6EDD3F), UINT64_C(0x17FD090A58D32AF4)},
+    {UINT64_C(0xEFF394DCFF8A948E), UINT64_C(0xDDFC4B4CEF07F5B1)},
+    {UINT64_C(0x95F83D0A1FB69CD9), UINT64_C(0x4ABDAF101564F98F)},
+    {UINT64_C(0xBB764C4CA7A4440F), UINT64_C(0x9D6D1AD41ABE37F2)},
+    {UINT64_C(0xEA53DF5FD18D5513), UINT64_C(0x84C86189216DC5EE)},
+    {UINT64_C(0x92746B9BE2F8552C), UINT64_C(0x32FD3CF5B4E49BB5)},
+    {UINT64_C(0xB7118682DBB66A77), UINT64_C(0x3FBC8C33221DC2A2)},
+    {UINT64_C(0xE4D5E82392A40515), UINT64_C(0x0FABAF3FEAA5334B)},
+    {UINT64_C(0x8F05B1163BA6832D), UINT64_C(0x29CB4D87F2A7400F)},
+    {UINT64_C(0xB2C71D5BCA9023F8), UINT64_C(0x743E20E9EF511013)},
+    {UINT64_C(0xDF78E4B2BD342CF6), UINT64_C(0x914DA9246B255417)},
+    {UINT64_C(0x8BAB8EEFB6409C1A), UINT64_C(0x1AD089B6C2F7548F)},
+    {UINT64_C(0xAE9672ABA3D0C320), UINT64_C(0xA184AC2473B529B2)},
+    {UINT64_C(0xDA3C0F568CC4F3E8), UINT64_C(0xC9E5D72D90A2741F)},
+    {UINT64_C(0x8865899617FB1871), UINT64_C(0x7E2FA67C7A658893)},
+    {UINT64_C(0xAA7EEBFB9DF9DE8D), UINT64_C(0xDDBB901B98FEEAB8)},
+    {UINT64_C(0xD51EA6FA85785631), UINT64_C(0x552A74227F3EA566)},
+    {UINT64_C(0x8533285C936B35DE), UINT64_C(0xD53A88958F872760)},
+    {UINT64_C(0xA67FF273B8460356), UINT64_C(0x8A892ABAF368F138)},
+    {UINT64_C(0xD01FEF10A657842C), UINT64_C(0x2D2B7569B0432D86)},
+    {UINT64_C(0x8213F56A67F6B29B), UINT64_C(0x9C3B29620E29FC74)},
+    {UINT64_C(0xA298F2C501F45F42), UINT64_C(0x8349F3BA91B47B90)},
+    {UINT64_C(0xCB3F2F7642717713), UINT64_C(0x241C70A936219A74)},
+    {UINT64_C(0xFE0EFB53D30DD4D7), UINT64_C(0xED238CD383AA0111)},
+    {UINT64_C(0x9EC95D1463E8A506), UINT64_C(0xF4363804324A40AB)},
+    {UINT64_C(0xC67BB4597CE2CE48), UINT64_C(0xB143C6053EDCD0D6)},
+    {UINT64_C(0xF81AA16FDC1B81DA), UINT64_C(0xDD94B7868E94050B)},
+    {UINT64_C(0x9B10A4E5E9913128), UINT64_C(0xCA7CF2B4191C8327)},
+    {UINT64_C(0xC1D4CE1F63F57D72), UINT64_C(0xFD1C2F611F63A3F1)},
+    {UINT64_C(0xF24A01A73CF2DCCF), UINT64_C(0xBC633B39673C8CED)},
+    {UINT64_C(0x976E41088617CA01), UINT64_C(0xD5BE0503E085D814)},
+    {UINT64_C(0xBD49D14AA79DBC82), UINT64_C(0x4B2D8644D8A74E19)},
+    {UINT64_C(0xEC9C459D51852BA2), UINT64_C(0xDDF8E7D60ED1219F)},
+    {UINT64_C(0x93E1AB8252F33B45), UINT64_C(0xCABB90E5C942B504)},
+    {UINT64_C(0xB8DA1662E7B00A17), UINT64_C(0x3D6A751F3B936244)},
+    {UINT64_C(0xE7109BFBA19C0C9D), UINT64_C(0x0CC512670A783AD5)},
+    {UINT64_C(0x906A617D450187E2), UINT64_C(0x27FB2B80668B24C6)},
+    {UINT64_C(0xB484F9DC9641E9DA), UINT64_C(0xB1F9F660802DEDF7)},
+    {UINT64_C(0xE1A63853BBD26451), UINT64_C(0x5E7873F8A0396974)},
+    {UINT64_C(0x8D07E33455637EB2), UINT64_C(0xDB0B487B6423E1E9)},
+    {UINT64_C(0xB049DC016ABC5E5F), UINT64_C(0x91CE1A9A3D2CDA63)},
+    {UINT64_C(0xDC5C5301C56B75F7), UINT64_C(0x7641A140CC7810FC)},
+    {UINT64_C(0x89B9B3E11B6329BA), UINT64_C(0xA9E904C87FCB0A9E)},
+    {UINT64_C(0xAC2820D9623BF429), UINT64_C(0x546345FA9FBDCD45)},
+    {UINT64_C(0xD732290FBACAF133), UINT64_C(0xA97C177947AD4096)},
+    {UINT64_C(0x867F59A9D4BED6C0), UINT64_C(0x49ED8EABCCCC485E)},
+    {UINT64_C(0xA81F301449EE8C70), UINT64_C(0x5C68F256BFFF5A75)},
+    {UINT64_C(0xD226FC195C6A2F8C), UINT64_C(0x73832EEC6FFF3112)},
+    {UINT64_C(0x83585D8FD9C25DB7), UINT64_C(0xC831FD53C5FF7EAC)},
+    {UINT64_C(0xA42E74F3D032F525), UINT64_C(0xBA3E7CA8B77F5E56)},
+    {UINT64_C(0xCD3A1230C43FB26F), UINT64_C(0x28CE1BD2E55F35EC)},
+    {UINT64_C(0x80444B5E7AA7CF85), UINT64_C(0x7980D163CF5B81B4)},
+    {UINT64_C(0xA0555E361951C366), UINT64_C(0xD7E105BCC3326220)},
+    {UINT64_C(0xC86AB5C39FA63440), UINT64_C(0x8DD9472BF3FEFAA8)},
+    {UINT64_C(0xFA856334878FC150), UINT64_C(0xB14F98F6F0FEB952)},
+    {UINT64_C(0x9C935E00D4B9D8D2), UINT64_C(0x6ED1BF9A569F33D4)},
+    {UINT64_C(0xC3B8358109E84F07), UINT64_C(0x0A862F80EC4700C9)},
+    {UINT64_C(0xF4A642E14C6262C8), UINT64_C(0xCD27BB612758C0FB)},
+    {UINT64_C(0x98E7E9CCCFBD7DBD), UINT64_C(0x8038D51CB897789D)},
+    {UINT64_C(0xBF21E44003ACDD2C), UINT64_C(0xE0470A63E6BD56C4)},
+    {UINT64_C(0xEEEA5D5004981478), UINT64_C(0x1858CCFCE06CAC75)},
+    {UINT64_C(0x95527A5202DF0CCB), UINT64_C(0x0F37801E0C43EBC9)},
+    {UINT64_C(0xBAA718E68396CFFD), UINT64_C(0xD30560258F54E6BB)},
+    {UINT64_C(0xE950DF20247C83FD), UINT64_C(0x47C6B82EF32A206A)},
+    {UINT64_C(0x91D28B7416CDD27E), UINT64_C(0x4CDC331D57FA5442)},
+    {UINT64_C(0xB6472E511C81471D), UINT64_C(0xE0133FE4ADF8E953)},
+    {UINT64_C(0xE3D8F9E563A198E5), UINT64_C(0x58180FDDD97723A7)},
+    {UINT64_C(0x8E679C2F5E44FF8F), UINT64_C(0x570F09EAA7EA7649)},
+    {UINT64_C(0xB201833B35D63F73), UINT64_C(0x2CD2CC6551E513DB)},
+    {UINT64_C(0xDE81E40A034BCF4F), UINT64_C(0xF8077F7EA65E58D2)},
+    {UINT64_C(0x8B112E86420F6191), UINT64_C(0xFB04AFAF27FAF783)},
+    {UINT64_C(0xADD57A27D29339F6), UINT64_C(0x79C5DB9AF1F9B564)},
+    {UINT64_C(0xD94AD8B1C7380874), UINT64_C(0x18375281AE7822BD)},
+    {UINT64_C(0x87CEC76F1C830548), UINT64_C(0x8F2293910D0B15B6)},
+    {UINT64_C(0xA9C2794AE3A3C69A), UINT64_C(0xB2EB3875504DDB23)},
+    {UINT64_C(0xD433179D9C8CB841), UINT64_C(0x5FA60692A46151EC)},
+    {UINT64_C(0x849FEEC281D7F328), UINT64_C(0xDBC7C41BA6BCD334)},
+    {UINT64_C(0xA5C7EA73224DEFF3), UINT64_C(0x12B9B522906C0801)},
+    {UINT64_C(0xCF39E50FEAE16BEF), UINT64_C(0xD768226B34870A01)},
+    {UINT64_C(0x81842F29F2CCE375), UINT64_C(0xE6A1158300D46641)},
+    {UINT64_C(0xA1E53AF46F801C53), UINT64_C(0x60495AE3C1097FD1)},
+    {UINT64_C(0xCA5E89B18B602368), UINT64_C(0x385BB19CB14BDFC5)},
+    {UINT64_C(0xFCF62C1DEE382C42), UINT64_C(0x46729E03DD9ED7B6)},
+    {UINT64_C(0x9E19DB92B4E31BA9), UINT64_C(0x6C07A2C26A8346D2)},
+};
+
+/*----------------------------------------------------------------------------*/
+/* INTEGER FORMATTING                                                         */
+/*----------------------------------------------------------------------------*/
+
+/* Number of decimal digits of |v|, at least 1 */
+static unsigned
+rstring_internal_count_digits(uint64_t v)
+{
+    unsigned n = 1;
+
+    for (;;)
+    {
+        if (v < 10U)
+        {
+            return n;
+        }
+        if (v < 100U)
+        {
+            return n + 1;
+        }
+        if (v < 1000U)
+        {
+            return n + 2;
+        }
+        if (v < 10000U)
+        {
+            return n + 3;
+        }
+
+        v /= 10000U;
+        n += 4;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Writes the decimal digits of |v| backwards, ending right before |end| */
+static void
+rstring_internal_write_digits(char *end, uint64_t v)
+{
+    while (v >= 100U)
+    {
+        const size_t pair = (size_t) (v % 100U) * 2;
+        v /= 100U;
+        end -= 2;
+        memcpy(end, rstring_internal_digit_pairs + pair, 2);
+    }
+
+    if (v >= 10U)
+    {
+        memcpy(end - 2, rstring_internal_digit_pairs + v * 2, 2);
+    }
+    else
+    {
+        end[-1] = (char) ('0' + v);
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+static rstring_status_t
+rstring_internal_push_decimal(struct rstring *rs, uint64_t magnitude,
+                              bool negative)
+{
+    const size_t new_length =
+        rs->len + negative + rstring_internal_count_digits(magnitude);
+
+    ENSURE_CAPACITY(rs, new_length + 1);    // Add one for nullterm
+    char *data = rstring_internal_data(rs);
+
+    if (negative)
+    {
+        data[rs->len] = '-';
+    }
+
+    rstring_internal_write_digits(data + new_length, magnitude);
+    data[new_length] = '\0';
+    rs->len          = new_length;
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+/* FLOATING-POINT FORMATTING                                                  */
+/*----------------------------------------------------------------------------*/
+
+/* A decimal floating-point number, |digits| * 10^|exponent| */
+struct rstring_internal_decimal
+{
+    uint64_t digits;
+    int      exponent;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/* floor(log10(2^e)), for e in [-2620, 2620] */
+static int
+rstring_internal_floor_log10_pow2(int e)
+{
+    return (e * 1262611) >> 22;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* floor(log10(3/4 * 2^e)), for e in [-2620, 2620] */
+static int
+rstring_internal_floor_log10_three_quarters_pow2(int e)
+{
+    return (e * 1262611 - 524031) >> 22;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* floor(log2(10^e)), for e in [-1233, 1233] */
+static int
+rstring_internal_floor_log2_pow10(int e)
+{
+    return (e * 1741647) >> 19;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * The top 64 bits of the 192-bit product |g| * |cp|, rounded to odd: the
+ * lowest bit is set when the discarded bits are not (close enough to) zero,
+ * which keeps comparisons against the exact product correct.
+ */
+static uint64_t
+rstring_internal_round_to_odd(const uint64_t g[2], uint64_t cp)
+{
+    uint64_t x_hi, x_lo, y_hi, y_lo;
+
+    rstring_internal_mul_64x64(g[1], cp, &x_hi, &x_lo);
+    rstring_internal_mul_64x64(g[0], cp, &y_hi, &y_lo);
+
+    const uint64_t mid = y_lo + x_hi;
+    const uint64_t top = y_hi + (mid < y_lo);
+
+    return top | (mid > 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Shortest decimal in the rounding interval of the positive, finite double
+ * with the given IEEE fields, using Raffaello Giulietti's Schubfach algorithm.
+ * The interval is scaled by a power of 10 chosen so that it contains at most
+ * one multiple of 10, which is preferred when present; otherwise the closest
+ * of the two candidates around the scaled value is picked.
+ */
+static struct rstring_internal_decimal
+rstring_internal_shortest(uint64_t ieee_mantissa, unsigned ieee_exponent)
+{
+    struct rstring_internal_decimal dec;
+    uint64_t                        m2 = ieee_mantissa;
+    int e2 = 1 - RSTRING_INTERNAL_DOUBLE_BIAS;
+
+    if (ieee_exponent != 0)
+    {
+        m2 |= (uint64_t) 1 << RSTRING_INTERNAL_DOUBLE_MANTISSA_BITS;
+        e2 = (int) ieee_exponent - RSTRING_INTERNAL_DOUBLE_BIAS;
+    }
+
+    /* Integers below 2^53 are exact, and their digits are the shortest */
+    if (-RSTRING_INTERNAL_DOUBLE_MANTISSA_BITS <= e2 && e2 <= 0
+        && (m2 & (((uint64_t) 1 << -e2) - 1)) == 0)
+    {
+        dec.digits   = m2 >> -e2;
+        dec.exponent = 0;
+    }
+    else
+    {
+        const bool accept_bounds = (m2 & 1) == 0;
+        const bool lower_closer  = ieee_mantissa == 0 && ieee_exponent > 1;
+
+        /* The value and the bounds of its rounding interval, times 4 */
+        const uint64_t cbl = 4 * m2 - 2 + lower_closer;
+        const uint64_t cb  = 4 * m2;
+        const uint64_t cbr = 4 * m2 + 2;
+
+        const int k =
+            lower_closer ? rstring_internal_floor_log10_three_quarters_pow2(e2)
+                         : rstring_internal_floor_log10_pow2(e2);
+        const int h = e2 + rstring_internal_floor_log2_pow10(-k) + 1;
+
+        const uint64_t *g =
+            rstring_internal_pow10[-k - RSTRING_INTERNAL_POW10_MIN];
+
+        const uint64_t vbl = rstring_internal_round_to_odd(g, cbl << h);
+        const uint64_t vb  = rstring_internal_round_to_odd(g, cb << h);
+        const uint64_t vbr = rstring_internal_round_to_odd(g, cbr << h);
+
+        const uint64_t lower = vbl + !accept_bounds;
+        const uint64_t upper = vbr - !accept_bounds;
+        const uint64_t s     = vb / 4;
+
+        dec.exponent = k;
+
+        if (s >= 10)
+        {
+            /* One digit less, if a multiple of 10 is inside the interval */
+            const uint64_t sp        = s / 10;
+            const bool     up_inside = lower <= 40 * sp;
+            const bool     wp_inside = 40 * sp + 40 <= upper;
+
+            if (up_inside != wp_inside)
+            {
+                dec.digits   = sp + wp_inside;
+                dec.exponent = k + 1;
+                goto strip;
+            }
+        }
+
+        const bool u_inside = lower <= 4 * s;
+        const bool w_inside = 4 * s + 4 <= upper;
+
+        if (u_inside != w_inside)
+        {
+            dec.digits = s + w_inside;
+        }
+        else
+        {
+            /* Both are inside: the closest one, the even one on a tie */
+            const uint64_t mid = 4 * s + 2;
+            dec.digits         = s + (vb > mid || (vb == mid && (s & 1) != 0));
+        }
+    }
+
+strip:
+    while (dec.digits % 10 == 0)
+    {
+        dec.digits /= 10;
+        dec.exponent++;
+    }
+
+    return dec;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Writes |value| to |buf|, which holds at least RSTRING_INTERNAL_DOUBLE_MAX
+ * bytes, without a null-terminator. Returns the number of bytes written.
+ */
+static size_t
+rstring_internal_format_double(char *buf, double value)
+{
+    uint64_t bits;
+    char    *p = buf;
+
+    memcpy(&bits, &value, sizeof(bits));
+
+    const uint64_t mantissa =
+        bits & (((uint64_t) 1 << RSTRING_INTERNAL_DOUBLE_MANTISSA_BITS) - 1);
+    const unsigned exponent =
+        (unsigned) (bits >> RSTRING_INTERNAL_DOUBLE_MANTISSA_BITS) & 0x7FFU;
+
+    if (exponent == 0x7FFU && mantissa != 0)
+    {
+        memcpy(p, "nan", 3);
+        return 3;
+    }
+
+    if (bits >> 63)
+    {
+        *p++ = '-';
+    }
+
+    if (exponent == 0x7FFU)
+    {
+        memcpy(p, "inf", 3);
+        return (size_t) (p - buf) + 3;
+    }
+
+    if (exponent == 0 && mantissa == 0)
+    {
+        *p++ = '0';
+        return (size_t) (p - buf);
+    }
+
+    const struct rstring_internal_decimal dec =
+        rstring_internal_shortest(mantissa, exponent);
+    const int ndigits = (int) rstring_internal_count_digits(dec.digits);
+
+    /* Position of the decimal point relative to the first digit */
+    const int point = dec.exponent + ndigits;
+
+    if (ndigits <= point && point <= 21)
+    {
+        /* 1500 */
+        rstring_internal_write_digits(p + ndigits, dec.digits);
+        memset(p + ndigits, '0', (size_t) (point - ndigits));
+        p += point;
+    }
+    else if (0 < point && point <= 21)
+    {
+        /* 1.5 */
+        rstring_internal_write_digits(p + 1 + ndigits, dec.digits);
+        memmove(p, p + 1, (size_t) point);
+        p[point] = '.';
+        p += 1 + ndigits;
+    }
+    else if (-6 < point && point <= 0)
+    {
+        /* 0.0015 */
+        p[0] = '0';
+        p[1] = '.';
+        memset(p + 2, '0', (size_t) -point);
+        p += 2 - point;
+        rstring_internal_write_digits(p + ndigits, dec.digits);
+        p += ndigits;
+    }
+    else
+    {
+        /* 1.5e+21 */
+        rstring_internal_write_digits(p + 1 + ndigits, dec.digits);
+        p[0] = p[1];
+        if (ndigits > 1)
+        {
+            p[1] = '.';
+            p += 1 + ndigits;
+        }
+        else
+        {
+            p += 1;
+        }
+
+        const int e = point - 1;
+        *p++        = 'e';
+        *p++        = e < 0 ? '-' : '+';
+
+        const uint64_t abs_e = (uint64_t) (e < 0 ? -e : e);
+        p += rstring_internal_count_digits(abs_e);
+        rstring_internal_write_digits(p, abs_e);
+    }
+
+    return (size_t) (p - buf);
+}
+
+/*----------------------------------------------------------------------------*/
+/* PUBLIC FUNCTIONS                                                           */
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_fmt(struct rstring *rs, const char *fmt, ...)
+{
+    va_list args;
+
+    va_start(args, fmt);
+    const rstring_status_t rc = rstring_push_vfmt(rs, fmt, args);
+    va_end(args);
+
+    return rc;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_vfmt(struct rstring *rs, const char *fmt, va_list args)
+{
+    rstring_status_t rc = RSTRING_OK;
+    va_list          retry;
+
+    /* Gives a zero-initialized rstring its inline capacity */
+    ENSURE_CAPACITY(rs, rs->len + 1);
+
+    char        *data  = rstring_internal_data(rs);
+    const size_t spare = rs->cap - rs->len;
+
+    va_copy(retry, args);
+    int n = vsnprintf(data + rs->len, spare, fmt, args);
+
+    if (n >= 0 && (size_t) n >= spare)
+    {
+        rc = rstring_ensure_capacity(rs, rs->len + (size_t) n + 1);
+        if (rc == RSTRING_OK)
+        {
+            data = rstring_internal_data(rs);
+            n    = vsnprintf(data + rs->len, (size_t) n + 1, fmt, retry);
+        }
+    }
+
+    va_end(retry);
+
+    if (rc == RSTRING_OK && n < 0)
+    {
+        rc = RSTRING_ERROR_FORMAT;
+    }
+
+    if (rc != RSTRING_OK)
+    {
+        /* Drop whatever was formatted past the contents */
+        data[rs->len] = '\0';
+        return rc;
+    }
+
+    rs->len += (size_t) n;
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_u64(struct rstring *rs, uint64_t value)
+{
+    return rstring_internal_push_decimal(rs, value, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_i64(struct rstring *rs, int64_t value)
+{
+    /* Computed in unsigned arithmetic, which INT64_MIN does not overflow */
+    const uint64_t magnitude =
+        value < 0 ? 0 - (uint64_t) value : (uint64_t) value;
+
+    return rstring_internal_push_decimal(rs, magnitude, value < 0);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_hex(struct rstring *rs, uint64_t value)
+{
+    size_t ndigits = 1;
+
+    while (ndigits < 16 && (value >> (4 * ndigits)) != 0)
+    {
+        ++ndigits;
+    }
+
+    const size_t new_length = rs->len + ndigits;
+
+    ENSURE_CAPACITY(rs, new_length + 1);    // Add one for nullterm
+    char *data = rstring_internal_data(rs);
+
+    for (size_t i = new_length; i > rs->len; --i)
+    {
+        data[i - 1] = rstring_internal_hex_digits[value & 0xFU];
+        value >>= 4;
+    }
+
+    data[new_length] = '\0';
+    rs->len          = new_length;
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_double(struct rstring *rs, double value)
+{
+    char         buf[RSTRING_INTERNAL_DOUBLE_MAX];
+    const size_t n = rstring_internal_format_double(buf, value);
+
+    const size_t new_length = rs->len + n;
+
+    ENSURE_CAPACITY(rs, new_length + 1);    // Add one for nullterm
+    char *data = rstring_internal_data(rs);
+
+    memcpy(data + rs->len, buf, n);
+    data[new_length] = '\0';
+    rs->len          = new_length;
+    return RSTRING_OK;
+}
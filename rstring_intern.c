@@ -0,0 +1,234 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ *
+ * rstring_intern.c
+ * ----------------
+ * String interning: a hash set of immutable rstrings stored in an arena.
+ */
+
+#include <stddef.h> /* offsetof */
+#include <stdint.h> /* uint64_t */
+#include <stdlib.h> /* calloc, free */
+
+#include <string.h> /* memcmp, memcpy, memset */
+
+#include "rstring.h"
+#include "rstring_alloc.h"
+#include "rstring_intern.h"
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL MACROS                                                            */
+/*----------------------------------------------------------------------------*/
+
+/* Number of slots of the table allocated by the first lookup */
+#define INTERNER_INITIAL_SLOTS 64
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL FUNCTIONS                                                         */
+/*----------------------------------------------------------------------------*/
+
+/* Brings stats.memory up to date, after the arena or the table grew */
+static void
+rstring_internal_interner_count_memory(struct rstring_interner *interner)
+{
+    interner->stats.memory =
+        interner->arena.reserved
+        + interner->nslots * sizeof(struct rstring_interner_slot);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Doubles the size of the table, which is kept at most half full */
+static bool
+rstring_internal_interner_grow(struct rstring_interner *interner)
+{
+    const size_t nslots =
+        interner->nslots ? interner->nslots * 2 : INTERNER_INITIAL_SLOTS;
+    struct rstring_interner_slot *slots =
+        calloc(nslots, sizeof(struct rstring_interner_slot));
+
+    if (!slots)
+    {
+        return false;
+    }
+
+    /* Stored hashes spare rehashing the strings */
+    for (size_t i = 0; i < interner->nslots; ++i)
+    {
+        const struct rstring_interner_slot slot = interner->slots[i];
+
+        if (slot.rs)
+        {
+            size_t j = (size_t) slot.hash & (nslots - 1);
+            while (slots[j].rs)
+            {
+                j = (j + 1) & (nslots - 1);
+            }
+            slots[j] = slot;
+        }
+    }
+
+    free(interner->slots);
+    interner->slots  = slots;
+    interner->nslots = nslots;
+    rstring_internal_interner_count_memory(interner);
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Copies |view| into the arena, as a read-only rstring - with |hash| cached,
+ * when rstrings cache theirs.
+ * Contents which fit are kept in the inline buffer; longer contents follow the
+ * fields directly, in place of it.
+ */
+static const struct rstring *
+rstring_internal_interner_store(struct rstring_interner *interner,
+                                struct rstring_view view, uint64_t hash)
+{
+    const bool   fits = view.len < RSTRING_SSO_CAPACITY;
+    const size_t size = fits ? sizeof(struct rstring)
+                             : offsetof(struct rstring, sso) + view.len + 1;
+
+    if (size < view.len)
+    {
+        return NULL;
+    }
+
+    struct rstring *rs = interner->arena.allocator.alloc(
+        interner->arena.allocator.ctx, size);
+
+    if (!rs)
+    {
+        return NULL;
+    }
+
+    /* The inline buffer, extended past its end for longer contents */
+    char *bytes = (char *) rs + offsetof(struct rstring, sso);
+
+    rs->len       = view.len;
+    rs->cap       = fits ? RSTRING_SSO_CAPACITY : view.len + 1;
+    rs->data      = fits ? NULL : bytes;
+    rs->allocator = NULL;
+#ifdef RSTRING_CACHED_HASH
+    rs->hash = hash;
+#else
+    (void) hash;
+#endif
+
+    if (view.len > 0)
+    {
+        memcpy(bytes, view.ptr, view.len);
+    }
+    bytes[view.len] = '\0';
+
+    rstring_internal_interner_count_memory(interner);
+    return rs;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static const struct rstring *
+rstring_internal_intern(struct rstring_interner *interner,
+                        struct rstring_view view, uint64_t hash)
+{
+    interner->stats.lookups++;
+    interner->stats.bytes_requested += view.len;
+
+    /* Grow ahead of the insertion which may follow */
+    if ((interner->stats.strings + 1) * 2 > interner->nslots
+        && !rstring_internal_interner_grow(interner))
+    {
+        return NULL;
+    }
+
+    const size_t mask = interner->nslots - 1;
+    size_t       i    = (size_t) hash & mask;
+
+    for (; interner->slots[i].rs; i = (i + 1) & mask)
+    {
+        const struct rstring_interner_slot slot = interner->slots[i];
+
+        if (slot.hash == hash && slot.rs->len == view.len
+            && (view.len == 0
+                || memcmp(rstring_data(slot.rs), view.ptr, view.len) == 0))
+        {
+            interner->stats.hits++;
+            return slot.rs;
+        }
+    }
+
+    const struct rstring *rs =
+        rstring_internal_interner_store(interner, view, hash);
+
+    if (rs)
+    {
+        interner->slots[i].hash = hash;
+        interner->slots[i].rs   = rs;
+        interner->stats.strings++;
+        interner->stats.bytes_stored += view.len;
+    }
+
+    return rs;
+}
+
+/*----------------------------------------------------------------------------*/
+/* PUBLIC FUNCTIONS                                                           */
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_interner_init(struct rstring_interner *interner)
+{
+    rstring_arena_init(&interner->arena, 0);
+    interner->slots  = NULL;
+    interner->nslots = 0;
+    memset(&interner->stats, 0, sizeof(interner->stats));
+}
+
+/*----------------------------------------------------------------------------*/
+
+const struct rstring *
+rstring_intern(struct rstring_interner *interner, const struct rstring *rs)
+{
+    const struct rstring_view view = rstring_view_from(rs);
+
+#ifdef RSTRING_CACHED_HASH
+    /* The cached hash, if any, is the one rstring_hash_view computes */
+    const uint64_t hash = rs->hash ? rs->hash : rstring_hash_view(view, 0);
+#else
+    const uint64_t hash = rstring_hash_view(view, 0);
+#endif
+
+    return rstring_internal_intern(interner, view, hash);
+}
+
+/*----------------------------------------------------------------------------*/
+
+const struct rstring *
+rstring_intern_str(struct rstring_interner *interner, const char *str)
+{
+    return rstring_intern_view(interner, rstring_view_from_str(str));
+}
+
+/*----------------------------------------------------------------------------*/
+
+const struct rstring *
+rstring_intern_view(struct rstring_interner *interner,
+                    struct rstring_view      view)
+{
+    return rstring_internal_intern(interner, view, rstring_hash_view(view, 0));
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_interner_free(struct rstring_interner *interner)
+{
+    rstring_arena_free(&interner->arena);
+    free(interner->slots);
+    interner->slots  = NULL;
+    interner->nslots = 0;
+    memset(&interner->stats, 0, sizeof(interner->stats));
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef RSTRING_INTERN_H
+#define RSTRING_INTERN_H
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint64_t */
+
+#include "rstring.h"
+#include "rstring_alloc.h"
+
+/*
+ * Counters kept by an interner, see `rstring_interner`.
+ */
+struct rstring_interner_stats
+{
+    size_t strings;         /* Distinct strings interned */
+    size_t lookups;         /* Calls to the rstring_intern functions */
+    size_t hits;            /* Lookups which found an interned string */
+    size_t bytes_requested; /* Bytes passed to every lookup */
+    size_t bytes_stored;    /* Bytes of the distinct strings */
+    size_t memory;          /* Bytes of the arena's chunks and the table */
+};
+
+/*
+ * An entry of an interner's hash table.
+ */
+struct rstring_interner_slot
+{
+    uint64_t              hash;
+    const struct rstring *rs; /* NULL when the slot is empty */
+};
+
+/*
+ * A set of distinct, immutable rstrings. Interning an rstring returns the
+ * set's handle for its contents, adding a copy first if needed, so equal
+ * contents always map to the same handle: interned rstrings are equal if and
+ * only if their handles are, which makes comparing them a pointer comparison.
+ *
+ * Handles are read-only rstrings stored, with their contents, in a single
+ * arena. They may be passed to any function which takes a const rstring, and
+ * remain valid until the interner is freed. The hash of each handle is kept in
+ * the interner's table, so that growing it rehashes no string. With
+ * RSTRING_CACHED_HASH, it is also stored in the handle's |hash| field, which
+ * `rstring_intern` and `rstring_equals` then use.
+ *
+ * Fields are private to the library, except for |stats|, which may be
+ * inspected: bytes_requested - bytes_stored is the amount of string data that
+ * interning deduplicated.
+ */
+struct rstring_interner
+{
+    struct rstring_arena          arena;
+    struct rstring_interner_slot *slots; /* Open addressing, linear probing */
+    size_t                        nslots;
+    struct rstring_interner_stats stats;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an empty interner.
+ *
+ * No memory is allocated until the first string is interned.
+ *
+ * @param interner Pointer to the interner to initialize.
+ */
+void
+rstring_interner_init(struct rstring_interner *interner);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns the interned rstring with the same contents as an rstring,
+ * interning a copy of it first if there is none.
+ *
+ * The lookup hashes |rs| with `rstring_hash_view` unless it has a cached hash,
+ * then compares the contents of the candidates with the same hash.
+ *
+ * @param interner Pointer to the interner.
+ * @param rs Pointer to the rstring to intern.
+ * @return The handle of the contents of |rs|, or NULL if memory allocation
+ * fails.
+ */
+const struct rstring *
+rstring_intern(struct rstring_interner *interner, const struct rstring *rs);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_intern.
+ */
+const struct rstring *
+rstring_intern_str(struct rstring_interner *interner, const char *str);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_intern.
+ */
+const struct rstring *
+rstring_intern_view(struct rstring_interner *interner,
+                    struct rstring_view      view);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Frees every interned rstring, and the memory owned by an interner.
+ *
+ * Every handle returned by the interner becomes invalid. The interner may be
+ * reused after being initialized again.
+ *
+ * @param interner Pointer to the interner to free.
+ */
+void
+rstring_interner_free(struct rstring_interner *interner);
+
+#endif /* RSTRING_INTERN_H */
@@ -0,0 +1,195 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ *
+ * rstring_internal.h
+ * ------------------
+ * Helpers shared between the library's translation units. Not installed, not
+ * part of the API.
+ */
+
+#ifndef RSTRING_INTERNAL_H
+#define RSTRING_INTERNAL_H
+
+#include <stdbool.h> /* bool */
+#include <stdint.h>  /* uint8_t, uint64_t */
+#include <string.h>  /* memcmp */
+
+#include "rstring.h"
+
+/*
+ * Vectorized kernels are built on x86-64 with GCC-compatible compilers, and
+ * selected at runtime. Defining RSTRING_NO_SIMD keeps the portable code only.
+ */
+#if !defined(RSTRING_NO_SIMD) && defined(__GNUC__) && defined(__x86_64__)
+#    define RSTRING_HAVE_X86_SIMD 1
+#    include <immintrin.h>
+#endif
+
+/*
+ * Runtime-selected kernels are reached through a static function pointer,
+ * which starts at a resolver that stores the selected kernel on first use.
+ * Threads may resolve concurrently - they all store the same value - so the
+ * pointer is only ever accessed atomically. Relaxed ordering is enough, as
+ * every value it holds points at code.
+ */
+#define KERNEL_LOAD(ptr)      __atomic_load_n(&(ptr), __ATOMIC_RELAXED)
+#define KERNEL_STORE(ptr, fn) __atomic_store_n(&(ptr), (fn), __ATOMIC_RELAXED)
+
+/*
+ * Only call ensure_capacity when needed, because calling ensure_capacity
+ * triggers either a malloc or a realloc, which is expensive.
+ */
+#define ENSURE_CAPACITY(rs, newcap)                                            \
+    do                                                                         \
+    {                                                                          \
+        if (newcap > rs->cap)                                                  \
+        {                                                                      \
+            rstring_status_t __temp_rc = rstring_ensure_capacity(rs, newcap);  \
+            if (__temp_rc != RSTRING_OK)                                       \
+            {                                                                  \
+                return __temp_rc;                                              \
+            }                                                                  \
+        }                                                                      \
+    } while (0)
+
+/*
+ * Adds |n| to a counter of `rstring_stats`, when the library keeps them. The
+ * counters are thread-local, and live in rstring_stats.c.
+ */
+#ifdef RSTRING_STATS
+#    include "rstring_stats.h"
+
+extern __thread struct rstring_stats rstring_internal_stats;
+
+#    define STATS_ADD(field, n) ((void) (rstring_internal_stats.field += (n)))
+#else
+#    define STATS_ADD(field, n) ((void) 0)
+#endif
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Makes room for |n| more offsets in |offsets|. Defined in rstring.c.
+ */
+rstring_status_t
+rstring_internal_offsets_reserve(struct rstring_offsets *offsets, size_t n);
+
+/* Appends |offset| to |offsets| */
+static inline rstring_status_t
+rstring_internal_offsets_push(struct rstring_offsets *offsets, size_t offset)
+{
+    if (offsets->len == offsets->cap)
+    {
+        const rstring_status_t rc =
+            rstring_internal_offsets_reserve(offsets, 1);
+        if (rc != RSTRING_OK)
+        {
+            return rc;
+        }
+    }
+
+    offsets->data[offsets->len++] = offset;
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Returns the active buffer of |rs| for the caller to modify. The cached hash,
+ * if any, is dropped, as the contents are about to change.
+ */
+static inline char *
+rstring_internal_data(struct rstring *rs)
+{
+    return rstring_data_mut(rs);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Full 128-bit product of |a| and |b| */
+static inline void
+rstring_internal_mul_64x64(uint64_t a, uint64_t b, uint64_t *hi, uint64_t *lo)
+{
+#if defined(__SIZEOF_INT128__)
+    const unsigned __int128 p = (unsigned __int128) a * b;
+
+    *hi = (uint64_t) (p >> 64);
+    *lo = (uint64_t) p;
+#else
+    const uint64_t a_lo = (uint32_t) a;
+    const uint64_t a_hi = a >> 32;
+    const uint64_t b_lo = (uint32_t) b;
+    const uint64_t b_hi = b >> 32;
+
+    const uint64_t p0  = a_lo * b_lo;
+    const uint64_t p1  = a_lo * b_hi;
+    const uint64_t p2  = a_hi * b_lo;
+    const uint64_t p3  = a_hi * b_hi;
+    const uint64_t mid = (p0 >> 32) + (uint32_t) p1 + (uint32_t) p2;
+
+    *hi = p3 + (p1 >> 32) + (p2 >> 32) + (mid >> 32);
+    *lo = (mid << 32) | (uint32_t) p0;
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* ASCII-only lower case, independent of the current locale */
+static inline uint8_t
+rstring_internal_fold(uint8_t c)
+{
+    return (uint8_t) ((unsigned) (c - 'A') < 26U ? c | 0x20U : c);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* ASCII-only lower case of the 8 bytes of |w|, in parallel */
+static inline uint64_t
+rstring_internal_fold64(uint64_t w)
+{
+    const uint64_t ones  = UINT64_C(0x0101010101010101);
+    const uint64_t highs = ones << 7;
+
+    /* The high bit of each byte of these tells whether its 7 low bits are
+     * above 'Z', and at or above 'A' */
+    const uint64_t low7     = w & ~highs;
+    const uint64_t above_z  = low7 + ones * (0x7F - 'Z');
+    const uint64_t from_a   = low7 + ones * (0x80 - 'A');
+    const uint64_t is_upper = ~w & (above_z ^ from_a) & highs;
+
+    return w | (is_upper >> 2);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* ASCII-only case swap, non-letters are returned as is */
+static inline uint8_t
+rstring_internal_swap_case(uint8_t c)
+{
+    return (uint8_t) ((unsigned) ((c | 0x20U) - 'a') < 26U ? c ^ 0x20U : c);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static inline bool
+rstring_internal_memeq(const uint8_t *a, const uint8_t *b, size_t n,
+                       bool ignore_case)
+{
+    if (!ignore_case)
+    {
+        return memcmp(a, b, n) == 0;
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (rstring_internal_fold(a[i]) != rstring_internal_fold(b[i]))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+#endif /* RSTRING_INTERNAL_H */
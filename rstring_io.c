@@ -0,0 +1,390 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ *
+ * rstring_io.c
+ * ------------
+ * Reading files and descriptors into rstrings, line by line or whole, and
+ * mapping files as views. POSIX only.
+ */
+
+#include <errno.h>  /* errno, EINTR */
+#include <fcntl.h>  /* open */
+#include <stdint.h> /* SIZE_MAX */
+#include <unistd.h> /* read, close, ssize_t */
+
+#include <string.h> /* memcpy, memmove */
+
+#include <sys/mman.h> /* mmap, munmap, madvise */
+#include <sys/stat.h> /* fstat */
+
+#include "rstring.h"
+#include "rstring_internal.h"
+#include "rstring_io.h"
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL MACROS                                                            */
+/*----------------------------------------------------------------------------*/
+
+/* Room made for reads of a descriptor of unknown size */
+#define IO_READ_STEP (64 * 1024)
+
+/* Some systems fail reads of 2 GiB or more */
+#define IO_READ_MAX (1024 * 1024 * 1024)
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL FUNCTIONS                                                         */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Reads |fd| to the end into |rs|, which has room for |expected| more bytes.
+ * Returns with |rs| holding what was read in any case.
+ */
+static rstring_status_t
+rstring_internal_read_fd(struct rstring *rs, int fd, size_t expected)
+{
+    /* Sets up the capacity of a zero-initialized rstring */
+    rstring_status_t rc = rstring_reserve_exact(rs, rs->len + 1);
+    if (rc != RSTRING_OK)
+    {
+        return rc;
+    }
+
+    char *data = rstring_internal_data(rs);
+
+    for (;;)
+    {
+        size_t room = rs->cap - 1 - rs->len;
+
+        if (room == 0)
+        {
+            /*
+             * Full as expected: a read into a small buffer tells the end of
+             * file apart from a file which grew, without growing |rs|.
+             */
+            char    probe[256];
+            ssize_t n;
+
+            do
+            {
+                n = read(fd, probe, sizeof(probe));
+            } while (n < 0 && errno == EINTR);
+
+            if (n <= 0)
+            {
+                return n == 0 ? RSTRING_OK : RSTRING_ERROR_IO;
+            }
+
+            rc = rstring_ensure_capacity(rs,
+                                         rs->len + (size_t) n + IO_READ_STEP);
+            if (rc != RSTRING_OK)
+            {
+                return rc;
+            }
+
+            data = rstring_internal_data(rs);
+            memcpy(data + rs->len, probe, (size_t) n);
+            rs->len += (size_t) n;
+            data[rs->len] = '\0';
+            continue;
+        }
+
+        if (expected == 0 && room < IO_READ_STEP / 2)
+        {
+            rc = rstring_ensure_capacity(rs, rs->len + IO_READ_STEP);
+            if (rc != RSTRING_OK)
+            {
+                return rc;
+            }
+
+            data = rstring_internal_data(rs);
+            room = rs->cap - 1 - rs->len;
+        }
+
+        const ssize_t n =
+            read(fd, data + rs->len, room < IO_READ_MAX ? room : IO_READ_MAX);
+
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return RSTRING_ERROR_IO;
+        }
+
+        if (n == 0)
+        {
+            return RSTRING_OK;
+        }
+
+        rs->len += (size_t) n;
+        data[rs->len] = '\0';
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+/* PUBLIC FUNCTIONS                                                           */
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_read_file(struct rstring *rs, const char *path)
+{
+    rstring_clear(rs);
+
+    int fd;
+    do
+    {
+        fd = open(path, O_RDONLY);
+    } while (fd < 0 && errno == EINTR);
+
+    if (fd < 0)
+    {
+        return RSTRING_ERROR_IO;
+    }
+
+    struct stat      st;
+    rstring_status_t rc = RSTRING_ERROR_IO;
+
+    if (fstat(fd, &st) == 0)
+    {
+        size_t expected = 0;
+
+        /* Special files, such as the ones of /proc, report a size of 0 */
+        if (S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+            expected = (uint64_t) st.st_size < SIZE_MAX
+                         ? (size_t) st.st_size
+                         : SIZE_MAX - 1;
+        }
+
+        rc = rstring_reserve_exact(rs, expected + 1);
+        if (rc == RSTRING_OK)
+        {
+            rc = rstring_internal_read_fd(rs, fd, expected);
+        }
+    }
+
+    /* Keep the errno of the failure rather than one of close */
+    const int saved_errno = errno;
+    close(fd);
+    errno = saved_errno;
+
+    if (rc != RSTRING_OK)
+    {
+        rstring_clear(rs);
+    }
+
+    return rc;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_read_fd_append(struct rstring *rs, int fd)
+{
+    const size_t     old_len = rs->len;
+    rstring_status_t rc      = rstring_internal_read_fd(rs, fd, 0);
+
+    if (rc != RSTRING_OK)
+    {
+        rs->len                             = old_len;
+        rstring_internal_data(rs)[old_len] = '\0';
+    }
+
+    return rc;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_reader_init(struct rstring_reader *reader, int fd, uint8_t delim)
+{
+    rstring_init(&reader->buf);
+    reader->start    = 0;
+    reader->scanned  = 0;
+    reader->fd       = fd;
+    reader->delim    = delim;
+    reader->strip_cr = delim == '\n';
+    reader->eof      = false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_reader_next_view(struct rstring_reader *reader,
+                         struct rstring_view   *line)
+{
+    struct rstring *buf = &reader->buf;
+
+    for (;;)
+    {
+        const struct rstring_view pending = rstring_view_slice(
+            rstring_view_from(buf), reader->start, SIZE_MAX);
+        const size_t end = rstring_view_find_first_byte(
+            pending, reader->delim, reader->scanned);
+
+        if (end != RSTRING_NOT_FOUND)
+        {
+            *line = rstring_view_prefix(pending, end);
+            if (reader->strip_cr && line->len > 0
+                && line->ptr[line->len - 1] == '\r')
+            {
+                line->len--;
+            }
+
+            reader->start += end + 1;
+            reader->scanned = 0;
+            return RSTRING_OK;
+        }
+
+        reader->scanned = pending.len;
+
+        if (reader->eof)
+        {
+            if (pending.len == 0)
+            {
+                return RSTRING_NOT_FOUND;
+            }
+
+            *line           = pending;
+            reader->start   = buf->len;
+            reader->scanned = 0;
+            return RSTRING_OK;
+        }
+
+        /* Move the partial line to the front, then read after it */
+        char *data = rstring_internal_data(buf);
+
+        if (reader->start > 0)
+        {
+            memmove(data, data + reader->start, pending.len);
+            buf->len      = pending.len;
+            reader->start = 0;
+        }
+
+        if (buf->cap - buf->len <= RSTRING_READER_BUFFER / 2)
+        {
+            rstring_status_t rc =
+                rstring_ensure_capacity(buf, buf->len + RSTRING_READER_BUFFER);
+            if (rc != RSTRING_OK)
+            {
+                return rc;
+            }
+
+            data = rstring_internal_data(buf);
+        }
+
+        const size_t  room = buf->cap - 1 - buf->len;
+        const ssize_t n =
+            read(reader->fd, data + buf->len, room < IO_READ_MAX ? room
+                                                                 : IO_READ_MAX);
+
+        if (n < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return RSTRING_ERROR_IO;
+        }
+
+        reader->eof = n == 0;
+        buf->len += (size_t) n;
+        data[buf->len] = '\0';
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_reader_next(struct rstring_reader *reader, struct rstring *line)
+{
+    struct rstring_view view;
+    rstring_status_t    rc = rstring_reader_next_view(reader, &view);
+
+    if (rc != RSTRING_OK)
+    {
+        return rc;
+    }
+
+    rstring_clear(line);
+    return rstring_push_view(line, view);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_reader_free(struct rstring_reader *reader)
+{
+    rstring_free(&reader->buf);
+    reader->start   = 0;
+    reader->scanned = 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_mmap_open(struct rstring_mmap *mm, const char *path)
+{
+    mm->view = rstring_view_from_buf("", 0);
+
+    int fd;
+    do
+    {
+        fd = open(path, O_RDONLY);
+    } while (fd < 0 && errno == EINTR);
+
+    if (fd < 0)
+    {
+        return RSTRING_ERROR_IO;
+    }
+
+    struct stat      st;
+    rstring_status_t rc = RSTRING_ERROR_IO;
+
+    if (fstat(fd, &st) == 0)
+    {
+        if (st.st_size == 0)
+        {
+            rc = RSTRING_OK;
+        }
+        else if ((uint64_t) st.st_size > SIZE_MAX)
+        {
+            errno = EFBIG;
+        }
+        else
+        {
+            const size_t size = (size_t) st.st_size;
+            void *addr = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+            if (addr != MAP_FAILED)
+            {
+                /* A hint, whose failure does not matter */
+                madvise(addr, size, MADV_SEQUENTIAL);
+                mm->view = rstring_view_from_buf(addr, size);
+                rc       = RSTRING_OK;
+            }
+        }
+    }
+
+    /* The mapping outlives the descriptor */
+    const int saved_errno = errno;
+    close(fd);
+    errno = saved_errno;
+
+    return rc;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_mmap_close(struct rstring_mmap *mm)
+{
+    if (mm->view.len > 0)
+    {
+        munmap((void *) mm->view.ptr, mm->view.len);
+    }
+
+    mm->view = rstring_view_from_buf("", 0);
+}
@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef RSTRING_IO_H
+#define RSTRING_IO_H
+
+#include <stdbool.h> /* bool */
+#include <stdint.h>  /* uint8_t */
+
+#include "rstring.h"
+
+/*
+ * Size of the refill buffer of a reader. Lines longer than that grow it.
+ */
+#define RSTRING_READER_BUFFER (64 * 1024)
+
+/*
+ * Splits the contents of a file descriptor into lines, see
+ * `rstring_reader_next_view`.
+ *
+ * Fields are private to the library, except for |delim| and |strip_cr|,
+ * which may be changed between lines.
+ */
+struct rstring_reader
+{
+    struct rstring buf;      /* Refill buffer */
+    size_t         start;    /* Offset of the unreturned bytes in |buf| */
+    size_t         scanned;  /* Unreturned bytes known not to hold |delim| */
+    int            fd;       /* Descriptor read from, not owned */
+    uint8_t        delim;    /* Byte which ends a line */
+    bool           strip_cr; /* Drop a '\r' right before |delim| */
+    bool           eof;      /* A read returned 0 */
+};
+
+/*
+ * A file mapped into memory, read-only, see `rstring_mmap_open`.
+ */
+struct rstring_mmap
+{
+    struct rstring_view view; /* The contents of the file */
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Replaces the contents of an rstring with those of a file.
+ *
+ * The size of a regular file is taken from fstat, and the rstring grows once
+ * to exactly that size before the contents are read into it directly, with
+ * no intermediate buffer. Files which do not report their size, or which grow
+ * while being read, are read to the end all the same.
+ *
+ * @param rs Pointer to the rstring to read into.
+ * @param path Path of the file to read.
+ * @return RSTRING_OK on success, RSTRING_ERROR_ALLOC if memory allocation
+ * fails, or RSTRING_ERROR_IO if a system call fails, with errno telling why.
+ * On failure, |rs| is left empty.
+ */
+rstring_status_t
+rstring_read_file(struct rstring *rs, const char *path);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Reads from a file descriptor until the end of file, appending what
+ * is read to an rstring.
+ *
+ * Reads go straight into the spare capacity of |rs|, which grows by
+ * `rstring_ensure_capacity` as needed; meant for pipes and sockets, as well
+ * as files. Reads interrupted by a signal are retried. The descriptor is not
+ * closed.
+ *
+ * @param rs Pointer to the rstring to append to.
+ * @param fd The file descriptor to read from, in blocking mode.
+ * @return RSTRING_OK on success, RSTRING_ERROR_ALLOC if memory allocation
+ * fails, or RSTRING_ERROR_IO if a read fails, with errno telling why. On
+ * failure, the contents of |rs| are unchanged, the bytes read being dropped.
+ */
+rstring_status_t
+rstring_read_fd_append(struct rstring *rs, int fd);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Maps a file into memory, read-only, and exposes it as a view.
+ *
+ * Nothing is copied: pages of the file are read by the kernel as the view is
+ * accessed, and the kernel is advised that they will be accessed in order.
+ * The view may be passed to any function which takes one, but is not
+ * null-terminated. It remains valid until `rstring_mmap_close`; changes to
+ * the file while it is mapped may be visible through it.
+ *
+ * @param mm Pointer to the mapping to initialize.
+ * @param path Path of the file to map. An empty file gives an empty view.
+ * @return RSTRING_OK on success, or RSTRING_ERROR_IO if a system call fails,
+ * with errno telling why.
+ */
+rstring_status_t
+rstring_mmap_open(struct rstring_mmap *mm, const char *path);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Unmaps a file mapped by rstring_mmap_open.
+ *
+ * @param mm Pointer to the mapping, whose view becomes empty.
+ */
+void
+rstring_mmap_close(struct rstring_mmap *mm);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes a reader of the lines of a file descriptor.
+ *
+ * Lines end with |delim|. If it is '\n', lines ending with "\r\n" are also
+ * returned without the '\r', see |strip_cr|. No memory is allocated until the
+ * first line is read.
+ *
+ * @param reader Pointer to the reader to initialize.
+ * @param fd The file descriptor to read from, in blocking mode. The reader
+ * does not close it.
+ * @param delim The byte which ends a line.
+ */
+void
+rstring_reader_init(struct rstring_reader *reader, int fd, uint8_t delim);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns the next line of a reader as a view of its buffer, without
+ * copying it.
+ *
+ * Delimiters are found with the vectorized search of
+ * `rstring_view_find_first_byte`, and bytes already searched are not searched
+ * again after a refill. The line does not include its delimiter. The last
+ * line of the input is returned even if no delimiter ends it.
+ *
+ * @param reader Pointer to the reader.
+ * @param line Pointer to the view to set to the line, valid until the next
+ * call with |reader|.
+ * @return RSTRING_OK if a line was read, RSTRING_NOT_FOUND at the end of the
+ * input, RSTRING_ERROR_ALLOC if memory allocation fails, or RSTRING_ERROR_IO
+ * if a read fails, with errno telling why.
+ */
+rstring_status_t
+rstring_reader_next_view(struct rstring_reader *reader,
+                         struct rstring_view   *line);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Copies the next line of a reader into an rstring, replacing its
+ * contents.
+ *
+ * The same rstring may be passed for every line: once it has grown to the
+ * length of the longest line, reading more lines does not allocate.
+ *
+ * @param reader Pointer to the reader.
+ * @param line Pointer to the rstring to store the line in.
+ * @return As rstring_reader_next_view.
+ */
+rstring_status_t
+rstring_reader_next(struct rstring_reader *reader, struct rstring *line);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Frees the buffer of a reader. The file descriptor is not closed.
+ *
+ * @param reader Pointer to the reader to free.
+ */
+void
+rstring_reader_free(struct rstring_reader *reader);
+
+#endif /* RSTRING_IO_H */
@@ -0,0 +1,506 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ *
+ * rstring_map.c
+ * -------------
+ * Hash map keyed by rstrings: open addressing over groups of 16 slots, with a
+ * byte of metadata per slot which is searched a group at a time.
+ */
+
+#include <stdint.h> /* uint8_t, uint64_t, SIZE_MAX */
+#include <stdlib.h> /* malloc, free */
+
+#include <string.h> /* memset */
+
+#include "rstring.h"
+#include "rstring_internal.h"
+#include "rstring_map.h"
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL MACROS                                                            */
+/*----------------------------------------------------------------------------*/
+
+/* Slots per group, the width of a control byte comparison */
+#define MAP_GROUP 16
+
+/*
+ * Control bytes. A full slot holds the low 7 bits of the hash of its key, so
+ * the markers are the ones with the high bit set.
+ */
+#define MAP_EMPTY   0x80
+#define MAP_DELETED 0xFE
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL FUNCTIONS                                                         */
+/*----------------------------------------------------------------------------*/
+
+/* Bit i is set iff byte i of the group at |ctrl| equals |byte| */
+static inline uint32_t
+rstring_internal_map_match(const uint8_t *ctrl, uint8_t byte)
+{
+#ifdef RSTRING_HAVE_X86_SIMD
+    const __m128i group = _mm_loadu_si128((const __m128i *) ctrl);
+    return (uint32_t) _mm_movemask_epi8(
+        _mm_cmpeq_epi8(group, _mm_set1_epi8((char) byte)));
+#else
+    uint32_t mask = 0;
+
+    for (int i = 0; i < MAP_GROUP; ++i)
+    {
+        mask |= (uint32_t) (ctrl[i] == byte) << i;
+    }
+
+    return mask;
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Bit i is set iff slot i of the group at |ctrl| is empty or deleted */
+static inline uint32_t
+rstring_internal_map_match_free(const uint8_t *ctrl)
+{
+#ifdef RSTRING_HAVE_X86_SIMD
+    return (uint32_t) _mm_movemask_epi8(
+        _mm_loadu_si128((const __m128i *) ctrl));
+#else
+    uint32_t mask = 0;
+
+    for (int i = 0; i < MAP_GROUP; ++i)
+    {
+        mask |= (uint32_t) (ctrl[i] >> 7) << i;
+    }
+
+    return mask;
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
+
+static inline uint64_t
+rstring_internal_map_hash(const struct rstring_map *map,
+                          struct rstring_view       key)
+{
+    return map->ignore_case ? rstring_hash_view_ignore_case(key, 0)
+                            : rstring_hash_view(key, 0);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Number of entries a table of |nslots| slots holds, 7/8 of them */
+static inline size_t
+rstring_internal_map_capacity(size_t nslots)
+{
+    return nslots - nslots / 8;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Index of the first group of the probe sequence of |hash|. Its low 7 bits are
+ * left for the control bytes, which keeps them independent of the position.
+ */
+static inline size_t
+rstring_internal_map_start(const struct rstring_map *map, uint64_t hash)
+{
+    return (size_t) (hash >> 7) & (map->nslots - 1)
+           & ~(size_t) (MAP_GROUP - 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Index of the first free slot on the probe sequence of |hash|. Groups are
+ * aligned, and visited in triangular steps, which reaches every group of a
+ * power-of-two table.
+ */
+static size_t
+rstring_internal_map_find_free(const struct rstring_map *map, uint64_t hash)
+{
+    const size_t mask = map->nslots - 1;
+    size_t       pos  = rstring_internal_map_start(map, hash);
+
+    for (size_t step = MAP_GROUP;; step += MAP_GROUP)
+    {
+        const uint32_t slots = rstring_internal_map_match_free(map->ctrl + pos);
+
+        if (slots)
+        {
+            return pos + (size_t) __builtin_ctz(slots);
+        }
+
+        pos = (pos + step) & mask;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Index of the entry of |key|, or SIZE_MAX */
+static size_t
+rstring_internal_map_find(const struct rstring_map *map,
+                          struct rstring_view key, uint64_t hash)
+{
+    if (map->nslots == 0)
+    {
+        return SIZE_MAX;
+    }
+
+    const size_t  mask = map->nslots - 1;
+    const uint8_t tag  = (uint8_t) (hash & 0x7F);
+    size_t        pos  = rstring_internal_map_start(map, hash);
+
+    for (size_t step = MAP_GROUP;; step += MAP_GROUP)
+    {
+        const uint8_t *group = map->ctrl + pos;
+
+        for (uint32_t match = rstring_internal_map_match(group, tag); match;
+             match &= match - 1)
+        {
+            const size_t i = pos + (size_t) __builtin_ctz(match);
+            const struct rstring_map_entry *entry = &map->entries[i];
+
+            if (entry->hash == hash && entry->key.len == key.len
+                && rstring_internal_memeq(
+                    (const uint8_t *) rstring_data(&entry->key),
+                    (const uint8_t *) key.ptr, key.len, map->ignore_case))
+            {
+                return i;
+            }
+        }
+
+        /* Insertions fill the first free slot, so the key would be here */
+        if (rstring_internal_map_match(group, MAP_EMPTY))
+        {
+            return SIZE_MAX;
+        }
+
+        pos = (pos + step) & mask;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Moves every entry to a new table of |nslots| slots, dropping tombstones */
+static rstring_status_t
+rstring_internal_map_rehash(struct rstring_map *map, size_t nslots)
+{
+    const size_t entry_size = sizeof(struct rstring_map_entry) + 1;
+
+    if (nslots > SIZE_MAX / entry_size)
+    {
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    /* Entries and control bytes share one allocation */
+    struct rstring_map_entry *entries = malloc(nslots * entry_size);
+
+    if (!entries)
+    {
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    struct rstring_map old = *map;
+
+    map->entries = entries;
+    map->ctrl    = (uint8_t *) (entries + nslots);
+    map->nslots  = nslots;
+    memset(map->ctrl, MAP_EMPTY, nslots);
+
+    for (size_t i = 0; i < old.nslots; ++i)
+    {
+        if (old.ctrl[i] & 0x80)
+        {
+            continue;
+        }
+
+        /* Entries keep their hash, so keys are never hashed again */
+        const struct rstring_map_entry *entry = &old.entries[i];
+        const size_t j = rstring_internal_map_find_free(map, entry->hash);
+
+        map->entries[j] = *entry;
+        map->ctrl[j]    = (uint8_t) (entry->hash & 0x7F);
+    }
+
+    map->growth_left = rstring_internal_map_capacity(nslots) - map->count;
+    free(old.entries);
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static rstring_status_t
+rstring_internal_map_put(struct rstring_map *map, struct rstring_view key,
+                         uint64_t hash, void *value)
+{
+    const size_t found = rstring_internal_map_find(map, key, hash);
+
+    if (found != SIZE_MAX)
+    {
+        map->entries[found].value = value;
+        return RSTRING_OK;
+    }
+
+    if (map->growth_left == 0)
+    {
+        size_t nslots = map->nslots ? map->nslots : MAP_GROUP;
+
+        /* Tombstones alone may have used up the room: then keep the size */
+        if (map->nslots
+            && map->count >= rstring_internal_map_capacity(map->nslots) / 2)
+        {
+            if (nslots > SIZE_MAX / 2)
+            {
+                return RSTRING_ERROR_ALLOC;
+            }
+            nslots *= 2;
+        }
+
+        rstring_status_t rc = rstring_internal_map_rehash(map, nslots);
+        if (rc != RSTRING_OK)
+        {
+            return rc;
+        }
+    }
+
+    const size_t i = rstring_internal_map_find_free(map, hash);
+
+    rstring_init(&map->entries[i].key);
+
+    rstring_status_t rc = rstring_push_view(&map->entries[i].key, key);
+    if (rc != RSTRING_OK)
+    {
+        rstring_free(&map->entries[i].key);
+        return rc;
+    }
+
+    /* Reusing a tombstone leaves the room for growth as is */
+    map->growth_left -= map->ctrl[i] == MAP_EMPTY;
+    map->ctrl[i]          = (uint8_t) (hash & 0x7F);
+    map->entries[i].value = value;
+    map->entries[i].hash  = hash;
+    map->count++;
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static bool
+rstring_internal_map_remove(struct rstring_map *map, struct rstring_view key,
+                            uint64_t hash)
+{
+    const size_t i = rstring_internal_map_find(map, key, hash);
+
+    if (i == SIZE_MAX)
+    {
+        return false;
+    }
+
+    rstring_free(&map->entries[i].key);
+    map->count--;
+
+    /*
+     * Lookups stop at the first group with an empty slot, so a slot may only
+     * become empty again if its group already stops them.
+     */
+    const uint8_t *group = map->ctrl + (i & ~(size_t) (MAP_GROUP - 1));
+
+    if (rstring_internal_map_match(group, MAP_EMPTY))
+    {
+        map->ctrl[i] = MAP_EMPTY;
+        map->growth_left++;
+    }
+    else
+    {
+        map->ctrl[i] = MAP_DELETED;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Hash of an rstring key, its cached one if the map allows it */
+static inline uint64_t
+rstring_internal_map_hash_rstring(const struct rstring_map *map,
+                                  const struct rstring     *key)
+{
+#ifdef RSTRING_CACHED_HASH
+    if (!map->ignore_case && key->hash)
+    {
+        return key->hash;
+    }
+#endif
+
+    return rstring_internal_map_hash(map, rstring_view_from(key));
+}
+
+/*----------------------------------------------------------------------------*/
+/* PUBLIC FUNCTIONS                                                           */
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_map_init(struct rstring_map *map)
+{
+    map->ctrl        = NULL;
+    map->entries     = NULL;
+    map->nslots      = 0;
+    map->count       = 0;
+    map->growth_left = 0;
+    map->ignore_case = false;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_map_init_ignore_case(struct rstring_map *map)
+{
+    rstring_map_init(map);
+    map->ignore_case = true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_map_reserve(struct rstring_map *map, size_t count)
+{
+    if (count <= map->count + map->growth_left)
+    {
+        return RSTRING_OK;
+    }
+
+    size_t nslots = MAP_GROUP;
+    while (rstring_internal_map_capacity(nslots) < count)
+    {
+        if (nslots > SIZE_MAX / 2)
+        {
+            return RSTRING_ERROR_ALLOC;
+        }
+        nslots *= 2;
+    }
+
+    return rstring_internal_map_rehash(map, nslots);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_map_put(struct rstring_map *map, const struct rstring *key,
+                void *value)
+{
+    return rstring_internal_map_put(map,
+                                    rstring_view_from(key),
+                                    rstring_internal_map_hash_rstring(map, key),
+                                    value);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_map_put_str(struct rstring_map *map, const char *key, void *value)
+{
+    return rstring_map_put_view(map, rstring_view_from_str(key), value);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_map_put_view(struct rstring_map *map, struct rstring_view key,
+                     void *value)
+{
+    return rstring_internal_map_put(
+        map, key, rstring_internal_map_hash(map, key), value);
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct rstring_map_entry *
+rstring_map_get(const struct rstring_map *map, const struct rstring *key)
+{
+    const size_t i = rstring_internal_map_find(
+        map, rstring_view_from(key),
+        rstring_internal_map_hash_rstring(map, key));
+
+    return i == SIZE_MAX ? NULL : &map->entries[i];
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct rstring_map_entry *
+rstring_map_get_str(const struct rstring_map *map, const char *key)
+{
+    return rstring_map_get_view(map, rstring_view_from_str(key));
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct rstring_map_entry *
+rstring_map_get_view(const struct rstring_map *map, struct rstring_view key)
+{
+    const size_t i = rstring_internal_map_find(
+        map, key, rstring_internal_map_hash(map, key));
+
+    return i == SIZE_MAX ? NULL : &map->entries[i];
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool
+rstring_map_remove(struct rstring_map *map, const struct rstring *key)
+{
+    return rstring_internal_map_remove(
+        map, rstring_view_from(key),
+        rstring_internal_map_hash_rstring(map, key));
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool
+rstring_map_remove_str(struct rstring_map *map, const char *key)
+{
+    return rstring_map_remove_view(map, rstring_view_from_str(key));
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool
+rstring_map_remove_view(struct rstring_map *map, struct rstring_view key)
+{
+    return rstring_internal_map_remove(
+        map, key, rstring_internal_map_hash(map, key));
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct rstring_map_entry *
+rstring_map_next(const struct rstring_map *map, size_t *pos)
+{
+    for (size_t i = *pos; i < map->nslots; ++i)
+    {
+        if (!(map->ctrl[i] & 0x80))
+        {
+            *pos = i + 1;
+            return &map->entries[i];
+        }
+    }
+
+    *pos = map->nslots;
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_map_free(struct rstring_map *map)
+{
+    for (size_t i = 0; i < map->nslots; ++i)
+    {
+        if (!(map->ctrl[i] & 0x80))
+        {
+            rstring_free(&map->entries[i].key);
+        }
+    }
+
+    free(map->entries);
+    rstring_map_init(map);
+}
@@ -0,0 +1,219 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef RSTRING_MAP_H
+#define RSTRING_MAP_H
+
+#include <stdbool.h> /* bool */
+#include <stddef.h>  /* size_t */
+#include <stdint.h>  /* uint8_t, uint64_t */
+
+#include "rstring.h"
+
+/*
+ * A key-value pair stored in a map. The key is owned by the map and must not
+ * be modified; the value may be. |hash| is private to the map.
+ */
+struct rstring_map_entry
+{
+    struct rstring key;
+    void          *value;
+    uint64_t       hash; /* Of |key|, as the map hashes it */
+};
+
+/*
+ * A hash map from rstrings to pointers, with open addressing.
+ *
+ * Slots are grouped by 16, and every slot has a control byte, kept apart from
+ * the entries: the low 7 bits of the hash of its key, or a marker for an empty
+ * or deleted slot. A lookup compares all 16 control bytes of a group with the
+ * 7 bits of the hash at once, with SSE2 on x86-64, and only reads the entries
+ * whose byte matches, so a miss rarely touches a key at all. Groups are probed
+ * in a triangular sequence, and the table grows at 7/8 of its capacity.
+ *
+ * Lookups take rstrings, C strings or views, so a key need not be copied into
+ * an rstring to be looked up. A case-insensitive map, see
+ * `rstring_map_init_ignore_case`, treats keys which only differ in the case of
+ * ASCII letters as equal, as HTTP header names are.
+ *
+ * Fields are private to the library, except for |count|, the number of
+ * entries. Pointers to entries are invalidated by the next insertion or
+ * removal.
+ */
+struct rstring_map
+{
+    uint8_t                  *ctrl; /* nslots control bytes */
+    struct rstring_map_entry *entries;
+    size_t                    nslots; /* 0, or a power of two >= 16 */
+    size_t                    count;
+    size_t                    growth_left; /* Insertions before a rehash */
+    bool                      ignore_case;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an empty map, which compares keys byte by byte.
+ *
+ * No memory is allocated until the first insertion.
+ *
+ * @param map Pointer to the map to initialize.
+ */
+void
+rstring_map_init(struct rstring_map *map);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an empty map, which ignores the case of ASCII letters in
+ * keys.
+ *
+ * Keys are stored as inserted, and hashed with
+ * `rstring_hash_view_ignore_case`.
+ *
+ * @param map Pointer to the map to initialize.
+ */
+void
+rstring_map_init_ignore_case(struct rstring_map *map);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Ensures a map holds a given number of entries without rehashing.
+ *
+ * @param map Pointer to the map.
+ * @param count The number of entries to make room for.
+ * @return RSTRING_OK on success, or RSTRING_ERROR_ALLOC if memory allocation
+ * fails.
+ */
+rstring_status_t
+rstring_map_reserve(struct rstring_map *map, size_t count);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Associates a value with a key, replacing the value of an existing
+ * entry with an equal key.
+ *
+ * A new entry gets its own copy of |key|, which the caller keeps ownership of.
+ * An existing entry keeps its key.
+ *
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @param value The value to store.
+ * @return RSTRING_OK on success, or RSTRING_ERROR_ALLOC if memory allocation
+ * fails, in which case the map is unchanged.
+ */
+rstring_status_t
+rstring_map_put(struct rstring_map *map, const struct rstring *key,
+                void *value);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_map_put.
+ */
+rstring_status_t
+rstring_map_put_str(struct rstring_map *map, const char *key, void *value);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_map_put.
+ */
+rstring_status_t
+rstring_map_put_view(struct rstring_map *map, struct rstring_view key,
+                     void *value);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the entry of a key.
+ *
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @return Pointer to the entry with a key equal to |key|, or NULL if there is
+ * none.
+ */
+struct rstring_map_entry *
+rstring_map_get(const struct rstring_map *map, const struct rstring *key);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_map_get.
+ */
+struct rstring_map_entry *
+rstring_map_get_str(const struct rstring_map *map, const char *key);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_map_get.
+ */
+struct rstring_map_entry *
+rstring_map_get_view(const struct rstring_map *map, struct rstring_view key);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Removes the entry of a key, freeing its key.
+ *
+ * @param map Pointer to the map.
+ * @param key Pointer to the key.
+ * @return true if an entry was removed, false if there was none.
+ */
+bool
+rstring_map_remove(struct rstring_map *map, const struct rstring *key);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_map_remove.
+ */
+bool
+rstring_map_remove_str(struct rstring_map *map, const char *key);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_map_remove.
+ */
+bool
+rstring_map_remove_view(struct rstring_map *map, struct rstring_view key);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Iterates over the entries of a map, in no particular order.
+ *
+ * Start with |*pos| set to 0, and call until NULL is returned:
+ *
+ *     size_t pos = 0;
+ *     struct rstring_map_entry *entry;
+ *     while ((entry = rstring_map_next(&map, &pos)))
+ *
+ * The map must not be modified during the iteration, except for values.
+ *
+ * @param map Pointer to the map.
+ * @param pos Pointer to the position of the iteration, advanced by the call.
+ * @return Pointer to the next entry, or NULL at the end of the iteration.
+ */
+struct rstring_map_entry *
+rstring_map_next(const struct rstring_map *map, size_t *pos);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Frees every key, and the memory owned by a map.
+ *
+ * Values are not freed. The map may be reused after being initialized again.
+ *
+ * @param map Pointer to the map to free.
+ */
+void
+rstring_map_free(struct rstring_map *map);
+
+#endif /* RSTRING_MAP_H */
@@ -0,0 +1,740 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ *
+ * rstring_matcher.c
+ * -----------------
+ * Multi-pattern search over rstrings: Teddy for small pattern sets,
+ * Aho-Corasick for large ones.
+ */
+
+#include <stdlib.h> /* malloc, calloc, free */
+
+#include <string.h> /* memcpy, memset, strlen */
+
+#include "rstring.h"
+#include "rstring_internal.h"
+#include "rstring_matcher.h"
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL MACROS                                                            */
+/*----------------------------------------------------------------------------*/
+
+/* Marks a missing pattern or state in the automaton's arrays */
+#define NONE UINT32_MAX
+
+/* Number of Teddy buckets, one bit each in the nibble masks */
+#define TEDDY_BUCKETS 8
+
+/* Maximal number of leading pattern bytes Teddy fingerprints */
+#define TEDDY_MAX_FINGERPRINT 3
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL FUNCTIONS                                                         */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Reports a match to |fn|, and counts it. Returns whether the search should go
+ * on.
+ */
+static inline bool
+rstring_internal_report(size_t offset, size_t len, size_t pattern,
+                        rstring_match_fn fn, void *ctx, size_t *count)
+{
+    const struct rstring_match match = {
+        .offset  = offset,
+        .len     = len,
+        .pattern = pattern,
+    };
+
+    ++*count;
+    return fn(&match, ctx);
+}
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef RSTRING_HAVE_X86_SIMD
+/*
+ * Verifies the patterns of every bucket set in |buckets| at |pos|, reporting
+ * matches by increasing pattern index.
+ */
+static bool
+rstring_internal_teddy_verify(const struct rstring_matcher *matcher,
+                              const uint8_t *hay, size_t hay_len, size_t pos,
+                              uint8_t buckets, rstring_match_fn fn, void *ctx,
+                              size_t *count)
+{
+    uint32_t candidates = 0;
+
+    for (size_t b = 0; b < TEDDY_BUCKETS; ++b)
+    {
+        if (buckets & (1U << b))
+        {
+            candidates |= matcher->teddy_buckets[b];
+        }
+    }
+
+    while (candidates)
+    {
+        const size_t          p       = (size_t) __builtin_ctz(candidates);
+        const struct rstring *pattern = &matcher->patterns[p];
+
+        candidates &= candidates - 1;
+
+        if (pattern->len == 0 || pattern->len > hay_len - pos)
+        {
+            continue;
+        }
+
+        if (rstring_internal_memeq(hay + pos,
+                                   (const uint8_t *) rstring_data(pattern),
+                                   pattern->len,
+                                   matcher->ignore_case) &&
+            !rstring_internal_report(pos, pattern->len, p, fn, ctx, count))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+rstring_internal_teddy_compile(struct rstring_matcher *matcher)
+{
+    size_t min_len = SIZE_MAX;
+
+    for (size_t p = 0; p < matcher->npatterns; ++p)
+    {
+        const size_t len = matcher->patterns[p].len;
+        if (len > 0 && len < min_len)
+        {
+            min_len = len;
+        }
+    }
+
+    matcher->fingerprint_len =
+        min_len < TEDDY_MAX_FINGERPRINT ? min_len : TEDDY_MAX_FINGERPRINT;
+
+    memset(matcher->teddy_lo, 0, sizeof(matcher->teddy_lo));
+    memset(matcher->teddy_hi, 0, sizeof(matcher->teddy_hi));
+    memset(matcher->teddy_buckets, 0, sizeof(matcher->teddy_buckets));
+
+    for (size_t p = 0; p < matcher->npatterns; ++p)
+    {
+        const struct rstring *pattern = &matcher->patterns[p];
+        const uint8_t *bytes = (const uint8_t *) rstring_data(pattern);
+        const uint8_t  bit   = (uint8_t) (1U << (p % TEDDY_BUCKETS));
+
+        if (pattern->len == 0)
+        {
+            continue;
+        }
+
+        matcher->teddy_buckets[p % TEDDY_BUCKETS] |= 1U << p;
+
+        for (size_t k = 0; k < matcher->fingerprint_len; ++k)
+        {
+            const uint8_t c     = bytes[k];
+            const uint8_t other = matcher->ignore_case
+                                      ? rstring_internal_swap_case(c)
+                                      : c;
+
+            matcher->teddy_lo[k][c & 0xFU] |= bit;
+            matcher->teddy_hi[k][c >> 4U] |= bit;
+            matcher->teddy_lo[k][other & 0xFU] |= bit;
+            matcher->teddy_hi[k][other >> 4U] |= bit;
+        }
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Every haystack byte is split into its nibbles, which are looked up (with
+ * pshufb) in per-position tables of the buckets whose patterns have that
+ * nibble there. A position is a candidate for the buckets which survive the
+ * AND of all lookups, over the first |fingerprint_len| bytes.
+ */
+__attribute__((target("ssse3"))) static size_t
+rstring_internal_teddy_scan(const struct rstring_matcher *matcher,
+                            const uint8_t *hay, size_t hay_len, size_t from,
+                            rstring_match_fn fn, void *ctx)
+{
+    const size_t  f      = matcher->fingerprint_len;
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i zero   = _mm_setzero_si128();
+    __m128i       lo[TEDDY_MAX_FINGERPRINT];
+    __m128i       hi[TEDDY_MAX_FINGERPRINT];
+    uint8_t       padded[16 + TEDDY_MAX_FINGERPRINT];
+    size_t        count = 0;
+    size_t        i     = from;
+
+    for (size_t k = 0; k < f; ++k)
+    {
+        lo[k] = _mm_loadu_si128((const __m128i *) matcher->teddy_lo[k]);
+        hi[k] = _mm_loadu_si128((const __m128i *) matcher->teddy_hi[k]);
+    }
+
+    while (i < hay_len)
+    {
+        const uint8_t *block = hay + i;
+        uint32_t       valid = 0xFFFFU;
+
+        /* The tail is fingerprinted out of a zero-padded copy */
+        if (i + 16 + f - 1 > hay_len)
+        {
+            const size_t left = hay_len - i;
+
+            memset(padded, 0, sizeof(padded));
+            memcpy(padded, hay + i, left);
+            block = padded;
+            valid = left < 16 ? (1U << left) - 1 : 0xFFFFU;
+        }
+
+        __m128i res = _mm_set1_epi8(-1);
+
+        for (size_t k = 0; k < f; ++k)
+        {
+            const __m128i c = _mm_loadu_si128((const __m128i *) (block + k));
+            const __m128i l = _mm_shuffle_epi8(lo[k], _mm_and_si128(c, nibble));
+            const __m128i h = _mm_shuffle_epi8(
+                hi[k], _mm_and_si128(_mm_srli_epi16(c, 4), nibble));
+
+            res = _mm_and_si128(res, _mm_and_si128(l, h));
+        }
+
+        const uint32_t empty =
+            (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(res, zero));
+        uint32_t mask = ~empty & valid;
+
+        if (mask != 0)
+        {
+            uint8_t buckets[16];
+            _mm_storeu_si128((__m128i *) buckets, res);
+
+            while (mask)
+            {
+                const size_t j = (size_t) __builtin_ctz(mask);
+
+                if (!rstring_internal_teddy_verify(matcher,
+                                                   hay,
+                                                   hay_len,
+                                                   i + j,
+                                                   buckets[j],
+                                                   fn,
+                                                   ctx,
+                                                   &count))
+                {
+                    return count;
+                }
+
+                mask &= mask - 1;
+            }
+        }
+
+        i += 16;
+    }
+
+    return count;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Keeps the first match reported, then stops the search */
+static bool
+rstring_internal_keep_first(const struct rstring_match *match, void *ctx)
+{
+    *(struct rstring_match *) ctx = *match;
+    return false;
+}
+#endif /* RSTRING_HAVE_X86_SIMD */
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Builds the trie of the patterns over byte classes, then turns it into a DFA
+ * breadth-first: every missing transition of a state is taken from its failure
+ * state, which is shallower and therefore already complete.
+ */
+static rstring_status_t
+rstring_internal_aho_corasick_compile(struct rstring_matcher *matcher)
+{
+    bool     present[256] = {false};
+    size_t   npresent     = 0;
+    size_t   max_states   = 1;
+    uint32_t next_class   = 0;
+
+    for (size_t p = 0; p < matcher->npatterns; ++p)
+    {
+        const struct rstring *pattern = &matcher->patterns[p];
+        const uint8_t *bytes = (const uint8_t *) rstring_data(pattern);
+
+        max_states += pattern->len;
+        for (size_t i = 0; i < pattern->len; ++i)
+        {
+            npresent += !present[bytes[i]];
+            present[bytes[i]] = true;
+        }
+    }
+
+    /* Class 0 gathers every byte no pattern contains, if there are any */
+    next_class = npresent == 256 ? 0 : 1;
+    memset(matcher->classes, 0, sizeof(matcher->classes));
+    for (size_t c = 0; c < 256; ++c)
+    {
+        if (present[c])
+        {
+            matcher->classes[c] = (uint8_t) next_class++;
+        }
+    }
+
+    if (matcher->ignore_case)
+    {
+        for (size_t c = 'A'; c <= 'Z'; ++c)
+        {
+            matcher->classes[c] = matcher->classes[c | 0x20U];
+        }
+    }
+
+    const size_t nc    = next_class;
+    uint32_t    *fail  = malloc(max_states * sizeof(uint32_t));
+    uint32_t    *queue = malloc(max_states * sizeof(uint32_t));
+
+    matcher->nclasses      = nc;
+    matcher->delta         = calloc(max_states * nc, sizeof(uint32_t));
+    matcher->state_pattern = malloc(max_states * sizeof(uint32_t));
+    matcher->state_out     = malloc(max_states * sizeof(uint32_t));
+    matcher->state_link    = malloc(max_states * sizeof(uint32_t));
+    matcher->pattern_next  = calloc(matcher->npatterns + 1, sizeof(uint32_t));
+
+    if (!matcher->delta || !matcher->state_pattern || !matcher->state_out ||
+        !matcher->state_link || !matcher->pattern_next || !fail || !queue)
+    {
+        free(fail);
+        free(queue);
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    memset(matcher->state_pattern, 0xFF, max_states * sizeof(uint32_t));
+    memset(matcher->pattern_next, 0xFF, matcher->npatterns * sizeof(uint32_t));
+
+    /* Trie */
+    size_t nstates = 1;
+    for (size_t p = 0; p < matcher->npatterns; ++p)
+    {
+        const struct rstring *pattern = &matcher->patterns[p];
+        const uint8_t *bytes = (const uint8_t *) rstring_data(pattern);
+        uint32_t       s     = 0;
+
+        if (pattern->len == 0)
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i < pattern->len; ++i)
+        {
+            uint32_t *t = &matcher->delta[s * nc + matcher->classes[bytes[i]]];
+            if (*t == 0)
+            {
+                *t = (uint32_t) nstates++;
+            }
+            s = *t;
+        }
+
+        /* Keep identical patterns chained by increasing index */
+        uint32_t *tail = &matcher->state_pattern[s];
+        while (*tail != NONE)
+        {
+            tail = &matcher->pattern_next[*tail];
+        }
+        *tail = (uint32_t) p;
+    }
+
+    /* Failure links, breadth-first */
+    size_t head = 0;
+    size_t end  = 0;
+
+    fail[0]                = 0;
+    matcher->state_out[0]  = NONE;
+    matcher->state_link[0] = NONE;
+
+    for (size_t c = 0; c < nc; ++c)
+    {
+        const uint32_t t = matcher->delta[c];
+        if (t != 0)
+        {
+            fail[t]      = 0;
+            queue[end++] = t;
+        }
+    }
+
+    while (head < end)
+    {
+        const uint32_t s = queue[head++];
+
+        matcher->state_link[s] = matcher->state_out[fail[s]];
+        matcher->state_out[s]  = matcher->state_pattern[s] != NONE
+                                     ? s
+                                     : matcher->state_out[fail[s]];
+
+        for (size_t c = 0; c < nc; ++c)
+        {
+            uint32_t      *t = &matcher->delta[s * nc + c];
+            const uint32_t f = matcher->delta[fail[s] * nc + c];
+
+            if (*t != 0)
+            {
+                fail[*t]     = f;
+                queue[end++] = *t;
+            }
+            else
+            {
+                *t = f;
+            }
+        }
+    }
+
+    free(fail);
+    free(queue);
+
+    matcher->nstates = nstates;
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_aho_corasick_scan(const struct rstring_matcher *matcher,
+                                   const uint8_t *hay, size_t hay_len,
+                                   size_t from, rstring_match_fn fn, void *ctx)
+{
+    const size_t nc    = matcher->nclasses;
+    uint32_t     state = 0;
+    size_t       count = 0;
+
+    for (size_t i = from; i < hay_len; ++i)
+    {
+        state = matcher->delta[state * nc + matcher->classes[hay[i]]];
+
+        for (uint32_t st = matcher->state_out[state]; st != NONE;
+             st          = matcher->state_link[st])
+        {
+            for (uint32_t p = matcher->state_pattern[st]; p != NONE;
+                 p          = matcher->pattern_next[p])
+            {
+                const size_t len = matcher->patterns[p].len;
+
+                if (!rstring_internal_report(
+                        i + 1 - len, len, p, fn, ctx, &count))
+                {
+                    return count;
+                }
+            }
+        }
+    }
+
+    return count;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_aho_corasick_find(const struct rstring_matcher *matcher,
+                                   const uint8_t *hay, size_t hay_len,
+                                   size_t from, size_t *pattern)
+{
+    const size_t nc    = matcher->nclasses;
+    uint32_t     state = 0;
+    size_t       best  = RSTRING_NOT_FOUND;
+    uint32_t     win   = NONE;
+
+    for (size_t i = from; i < hay_len; ++i)
+    {
+        state = matcher->delta[state * nc + matcher->classes[hay[i]]];
+
+        for (uint32_t st = matcher->state_out[state]; st != NONE;
+             st          = matcher->state_link[st])
+        {
+            for (uint32_t p = matcher->state_pattern[st]; p != NONE;
+                 p          = matcher->pattern_next[p])
+            {
+                const size_t start = i + 1 - matcher->patterns[p].len;
+
+                if (start < best || (start == best && p < win))
+                {
+                    best = start;
+                    win  = p;
+                }
+            }
+        }
+
+        /* No match starting at or before |best| can end past this byte */
+        if (best != RSTRING_NOT_FOUND && i + 1 >= best + matcher->max_len)
+        {
+            break;
+        }
+    }
+
+    if (pattern && best != RSTRING_NOT_FOUND)
+    {
+        *pattern = win;
+    }
+
+    return best;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static rstring_status_t
+rstring_internal_matcher_begin(struct rstring_matcher *matcher,
+                               size_t npatterns, bool ignore_case)
+{
+    memset(matcher, 0, sizeof(*matcher));
+
+    matcher->npatterns   = npatterns;
+    matcher->ignore_case = ignore_case;
+    matcher->engine      = RSTRING_MATCHER_AHO_CORASICK;
+    matcher->patterns    = calloc(npatterns + 1, sizeof(struct rstring));
+
+    if (!matcher->patterns)
+    {
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    for (size_t p = 0; p < npatterns; ++p)
+    {
+        rstring_init(&matcher->patterns[p]);
+    }
+
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static rstring_status_t
+rstring_internal_matcher_add(struct rstring_matcher *matcher, size_t p,
+                             const char *bytes, size_t len)
+{
+    struct rstring  *pattern = &matcher->patterns[p];
+    rstring_status_t rc      = RSTRING_OK;
+
+    for (size_t i = 0; i < len && rc == RSTRING_OK; ++i)
+    {
+        const uint8_t c = (uint8_t) bytes[i];
+        rc              = rstring_push_byte(
+            pattern, matcher->ignore_case ? rstring_internal_fold(c) : c);
+    }
+
+    if (len > matcher->max_len)
+    {
+        matcher->max_len = len;
+    }
+
+    return rc;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static rstring_status_t
+rstring_internal_matcher_finish(struct rstring_matcher *matcher,
+                                rstring_status_t        rc)
+{
+    if (rc == RSTRING_OK)
+    {
+#ifdef RSTRING_HAVE_X86_SIMD
+        __builtin_cpu_init();
+        if (matcher->npatterns <= RSTRING_MATCHER_TEDDY_MAX_PATTERNS &&
+            matcher->max_len > 0 && __builtin_cpu_supports("ssse3"))
+        {
+            matcher->engine = RSTRING_MATCHER_TEDDY;
+            rstring_internal_teddy_compile(matcher);
+            return RSTRING_OK;
+        }
+#endif
+
+        rc = rstring_internal_aho_corasick_compile(matcher);
+    }
+
+    if (rc != RSTRING_OK)
+    {
+        rstring_matcher_free(matcher);
+    }
+
+    return rc;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static rstring_status_t
+rstring_internal_matcher_compile(struct rstring_matcher *matcher,
+                                 const struct rstring   *patterns,
+                                 size_t npatterns, bool ignore_case)
+{
+    rstring_status_t rc =
+        rstring_internal_matcher_begin(matcher, npatterns, ignore_case);
+
+    for (size_t p = 0; p < npatterns && rc == RSTRING_OK; ++p)
+    {
+        rc = rstring_internal_matcher_add(
+            matcher, p, rstring_data(&patterns[p]), patterns[p].len);
+    }
+
+    return rstring_internal_matcher_finish(matcher, rc);
+}
+
+/*----------------------------------------------------------------------------*/
+
+static rstring_status_t
+rstring_internal_matcher_compile_str(struct rstring_matcher *matcher,
+                                     const char *const      *patterns,
+                                     size_t npatterns, bool ignore_case)
+{
+    rstring_status_t rc =
+        rstring_internal_matcher_begin(matcher, npatterns, ignore_case);
+
+    for (size_t p = 0; p < npatterns && rc == RSTRING_OK; ++p)
+    {
+        rc = rstring_internal_matcher_add(
+            matcher, p, patterns[p], strlen(patterns[p]));
+    }
+
+    return rstring_internal_matcher_finish(matcher, rc);
+}
+
+/*----------------------------------------------------------------------------*/
+/* PUBLIC FUNCTIONS                                                           */
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_matcher_compile(struct rstring_matcher *matcher,
+                        const struct rstring *patterns, size_t npatterns)
+{
+    return rstring_internal_matcher_compile(
+        matcher, patterns, npatterns, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_matcher_compile_str(struct rstring_matcher *matcher,
+                            const char *const *patterns, size_t npatterns)
+{
+    return rstring_internal_matcher_compile_str(
+        matcher, patterns, npatterns, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_matcher_compile_ignore_case(struct rstring_matcher *matcher,
+                                    const struct rstring   *patterns,
+                                    size_t                  npatterns)
+{
+    return rstring_internal_matcher_compile(
+        matcher, patterns, npatterns, true);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_matcher_compile_str_ignore_case(struct rstring_matcher *matcher,
+                                        const char *const      *patterns,
+                                        size_t                  npatterns)
+{
+    return rstring_internal_matcher_compile_str(
+        matcher, patterns, npatterns, true);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_matcher_find(const struct rstring_matcher *matcher,
+                     const struct rstring *haystack, size_t from,
+                     size_t *pattern)
+{
+    const uint8_t *hay = (const uint8_t *) rstring_data(haystack);
+
+    if (from > haystack->len)
+    {
+        return RSTRING_NOT_FOUND;
+    }
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    if (matcher->engine == RSTRING_MATCHER_TEDDY)
+    {
+        /* Teddy reports by increasing offset, then pattern index */
+        struct rstring_match first;
+
+        if (rstring_internal_teddy_scan(matcher,
+                                        hay,
+                                        haystack->len,
+                                        from,
+                                        rstring_internal_keep_first,
+                                        &first) == 0)
+        {
+            return RSTRING_NOT_FOUND;
+        }
+
+        if (pattern)
+        {
+            *pattern = first.pattern;
+        }
+
+        return first.offset;
+    }
+#endif
+
+    return rstring_internal_aho_corasick_find(
+        matcher, hay, haystack->len, from, pattern);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_matcher_find_all(const struct rstring_matcher *matcher,
+                         const struct rstring *haystack, size_t from,
+                         rstring_match_fn fn, void *ctx)
+{
+    const uint8_t *hay = (const uint8_t *) rstring_data(haystack);
+
+    if (from > haystack->len)
+    {
+        return 0;
+    }
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    if (matcher->engine == RSTRING_MATCHER_TEDDY)
+    {
+        return rstring_internal_teddy_scan(
+            matcher, hay, haystack->len, from, fn, ctx);
+    }
+#endif
+
+    return rstring_internal_aho_corasick_scan(
+        matcher, hay, haystack->len, from, fn, ctx);
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_matcher_free(struct rstring_matcher *matcher)
+{
+    if (matcher->patterns)
+    {
+        for (size_t p = 0; p < matcher->npatterns; ++p)
+        {
+            rstring_free(&matcher->patterns[p]);
+        }
+    }
+
+    free(matcher->patterns);
+    free(matcher->delta);
+    free(matcher->state_pattern);
+    free(matcher->state_out);
+    free(matcher->state_link);
+    free(matcher->pattern_next);
+    memset(matcher, 0, sizeof(*matcher));
+}
@@ -0,0 +1,183 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef RSTRING_MATCHER_H
+#define RSTRING_MATCHER_H
+
+#include <stdbool.h> /* bool */
+#include <stddef.h>  /* size_t */
+#include <stdint.h>  /* uint8_t, uint32_t */
+
+#include "rstring.h"
+
+/*
+ * Pattern sets of up to this many patterns are searched with Teddy, a
+ * vectorized fingerprint prefilter, when the CPU supports it.
+ */
+#define RSTRING_MATCHER_TEDDY_MAX_PATTERNS 32
+
+/*
+ * Engines a matcher may pick, see `rstring_matcher_compile`.
+ */
+enum rstring_matcher_engine
+{
+    RSTRING_MATCHER_TEDDY,
+    RSTRING_MATCHER_AHO_CORASICK,
+};
+
+/*
+ * A single match, as reported by the matcher.
+ */
+struct rstring_match
+{
+    size_t offset;  /* Offset from the haystack's data the match starts at */
+    size_t len;     /* Length of the matching pattern */
+    size_t pattern; /* Index of the matching pattern */
+};
+
+/*
+ * Called for every match found by `rstring_matcher_find_all`. Returning
+ * `false` stops the search.
+ */
+typedef bool (*rstring_match_fn)(const struct rstring_match *match, void *ctx);
+
+/*
+ * A set of patterns which was preprocessed once, to be searched for in many
+ * haystacks at once.
+ *
+ * Fields are private to the library, except for |engine| and |npatterns|,
+ * which may be inspected.
+ */
+struct rstring_matcher
+{
+    struct rstring             *patterns; /* Case-folded when ignoring case */
+    size_t                      npatterns;
+    size_t                      max_len;
+    bool                        ignore_case;
+    enum rstring_matcher_engine engine;
+
+    /* Teddy: nibble masks of the first |fingerprint_len| pattern bytes */
+    size_t   fingerprint_len;
+    uint8_t  teddy_lo[3][16];
+    uint8_t  teddy_hi[3][16];
+    uint32_t teddy_buckets[8]; /* Bitset of the patterns in each bucket */
+
+    /* Aho-Corasick: DFA over byte equivalence classes */
+    uint8_t   classes[256];
+    size_t    nclasses;
+    size_t    nstates;
+    uint32_t *delta;
+    uint32_t *state_pattern; /* Pattern ending at a state */
+    uint32_t *state_out;     /* First state with a pattern on the fail chain */
+    uint32_t *state_link;    /* Next such state, after this one */
+    uint32_t *pattern_next;  /* Next pattern identical to this one */
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Compiles a set of rstrings into a matcher.
+ *
+ * The patterns are copied. A pattern's index in |patterns| is its ID in the
+ * reported matches. Empty patterns never match.
+ *
+ * Sets of up to `RSTRING_MATCHER_TEDDY_MAX_PATTERNS` patterns use Teddy when
+ * the CPU supports SSSE3: the first (up to 3) bytes of each pattern are
+ * fingerprinted into nibble lookup tables, and 16 haystack positions are
+ * tested against all patterns at once. Larger sets use an Aho-Corasick
+ * automaton, which visits every haystack byte once regardless of the number
+ * of patterns.
+ *
+ * @param matcher Pointer to the matcher to initialize.
+ * @param patterns Array of the rstrings to search for.
+ * @param npatterns Number of elements in |patterns|.
+ * @return `RSTRING_OK` on success, error code if memory allocation fails.
+ */
+rstring_status_t
+rstring_matcher_compile(struct rstring_matcher *matcher,
+                        const struct rstring *patterns, size_t npatterns);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C strings variant of rstring_matcher_compile.
+ */
+rstring_status_t
+rstring_matcher_compile_str(struct rstring_matcher *matcher,
+                            const char *const *patterns, size_t npatterns);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_matcher_compile.
+ */
+rstring_status_t
+rstring_matcher_compile_ignore_case(struct rstring_matcher *matcher,
+                                    const struct rstring   *patterns,
+                                    size_t                  npatterns);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief ASCII case-insensitive variant of rstring_matcher_compile_str.
+ */
+rstring_status_t
+rstring_matcher_compile_str_ignore_case(struct rstring_matcher *matcher,
+                                        const char *const      *patterns,
+                                        size_t                  npatterns);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the first match of any pattern inside an rstring, from a given
+ * offset.
+ *
+ * The first match is the one that starts first. Among patterns that match at
+ * the same offset, the one with the lowest index wins.
+ *
+ * @param matcher Pointer to the compiled matcher.
+ * @param haystack Pointer to the rstring to search in.
+ * @param from The offset to start searching from.
+ * @param pattern If not NULL, receives the index of the matching pattern.
+ * @return The offset in |haystack| of the match, else
+ * `RSTRING_NOT_FOUND`.
+ */
+size_t
+rstring_matcher_find(const struct rstring_matcher *matcher,
+                     const struct rstring *haystack, size_t from,
+                     size_t *pattern);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Reports every match of every pattern inside an rstring, from a given
+ * offset, in a single pass.
+ *
+ * Overlapping matches are all reported, each (offset, pattern) pair exactly
+ * once. The order in which matches are reported is unspecified.
+ *
+ * @param matcher Pointer to the compiled matcher.
+ * @param haystack Pointer to the rstring to search in.
+ * @param from The offset to start searching from.
+ * @param fn Callback invoked for every match, may stop the search.
+ * @param ctx Opaque pointer passed to |fn|.
+ * @return The number of matches reported.
+ */
+size_t
+rstring_matcher_find_all(const struct rstring_matcher *matcher,
+                         const struct rstring *haystack, size_t from,
+                         rstring_match_fn fn, void *ctx);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Frees the memory owned by a matcher.
+ *
+ * @param matcher Pointer to the matcher to free.
+ */
+void
+rstring_matcher_free(struct rstring_matcher *matcher);
+
+#endif /* RSTRING_MATCHER_H */
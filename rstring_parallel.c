@@ -0,0 +1,462 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ *
+ * rstring_parallel.c
+ * ------------------
+ * Searching large haystacks in chunks, with a pool of threads. POSIX only.
+ */
+
+#include <pthread.h> /* pthread_create, pthread_join, ... */
+#include <stdbool.h> /* bool */
+#include <stdlib.h>  /* malloc, calloc, free */
+#include <unistd.h>  /* sysconf */
+
+#include <string.h> /* memcpy */
+
+#include "rstring.h"
+#include "rstring_internal.h"
+#include "rstring_parallel.h"
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL TYPES                                                             */
+/*----------------------------------------------------------------------------*/
+
+enum rstring_internal_scan_kind
+{
+    RSTRING_INTERNAL_SCAN_FIRST,
+    RSTRING_INTERNAL_SCAN_ALL,
+    RSTRING_INTERNAL_SCAN_COUNT,
+};
+
+/*
+ * A search split into chunks of match positions, which the threads of a pool
+ * take in increasing order. Fields marked atomic are shared while searching.
+ */
+struct rstring_internal_scan
+{
+    enum rstring_internal_scan_kind kind;
+    struct rstring_view             hay;  /* From the first position on */
+    struct rstring_view             needle;
+    size_t                          base; /* Offset of |hay| in the haystack */
+    size_t                          positions; /* Where a match may start */
+    size_t                          chunk;     /* Positions per chunk */
+    size_t                          nchunks;
+    size_t                          next;  /* Next chunk to take, atomic */
+    size_t                          first; /* Lowest match found, atomic */
+    size_t                          count; /* Matches counted, atomic */
+    bool                            failed; /* An allocation failed, atomic */
+    struct rstring_offsets         *found;  /* Offsets found, by chunk */
+};
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL FUNCTIONS                                                         */
+/*----------------------------------------------------------------------------*/
+
+/* Waits for jobs, and runs them, until the pool stops */
+static void *
+rstring_internal_worker(void *arg)
+{
+    struct rstring_workers *workers = arg;
+    unsigned long           seen    = 0;
+
+    pthread_mutex_lock(&workers->lock);
+    for (;;)
+    {
+        while (!workers->stop && workers->generation == seen)
+        {
+            pthread_cond_wait(&workers->wake, &workers->lock);
+        }
+
+        if (workers->stop)
+        {
+            break;
+        }
+
+        void (*run)(void *) = workers->run;
+        void *job           = workers->job;
+
+        seen = workers->generation;
+        pthread_mutex_unlock(&workers->lock);
+
+        run(job);
+
+        pthread_mutex_lock(&workers->lock);
+        if (--workers->busy == 0)
+        {
+            pthread_cond_signal(&workers->idle);
+        }
+    }
+    pthread_mutex_unlock(&workers->lock);
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Runs |run| on |job| in every thread of the pool and in the calling one, and
+ * returns once all of them are done with it.
+ */
+static void
+rstring_internal_workers_run(struct rstring_workers *workers,
+                             void (*run)(void *), void *job)
+{
+    const size_t helpers = workers->nthreads - 1;
+
+    if (helpers > 0)
+    {
+        pthread_mutex_lock(&workers->lock);
+        workers->run  = run;
+        workers->job  = job;
+        workers->busy = helpers;
+        workers->generation++;
+        pthread_cond_broadcast(&workers->wake);
+        pthread_mutex_unlock(&workers->lock);
+    }
+
+    run(job);
+
+    if (helpers > 0)
+    {
+        /* Workers may still be on their last chunk, or not awake yet */
+        pthread_mutex_lock(&workers->lock);
+        while (workers->busy > 0)
+        {
+            pthread_cond_wait(&workers->idle, &workers->lock);
+        }
+        pthread_mutex_unlock(&workers->lock);
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Lowers the atomic |*dst| to |value|, if it is lower */
+static void
+rstring_internal_atomic_min(size_t *dst, size_t value)
+{
+    size_t seen = __atomic_load_n(dst, __ATOMIC_RELAXED);
+
+    while (value < seen
+           && !__atomic_compare_exchange_n(
+               dst, &seen, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Takes and searches chunks of a scan until there are none left */
+static void
+rstring_internal_scan_run(void *arg)
+{
+    struct rstring_internal_scan *scan  = arg;
+    size_t                        count = 0;
+
+    for (;;)
+    {
+        const size_t c = __atomic_fetch_add(&scan->next, 1, __ATOMIC_RELAXED);
+        if (c >= scan->nchunks)
+        {
+            break;
+        }
+
+        /* Chunks are taken in order, so none of the next ones can do better */
+        const size_t start = c * scan->chunk;
+        if (scan->kind == RSTRING_INTERNAL_SCAN_FIRST
+            && __atomic_load_n(&scan->first, __ATOMIC_RELAXED) < start)
+        {
+            break;
+        }
+
+        /* The positions of the chunk, and the bytes of its last match */
+        const size_t n = scan->positions - start < scan->chunk
+                           ? scan->positions - start
+                           : scan->chunk;
+        const struct rstring_view window = rstring_view_from_buf(
+            scan->hay.ptr + start, n + scan->needle.len - 1);
+
+        if (scan->kind == RSTRING_INTERNAL_SCAN_FIRST)
+        {
+            const size_t pos = rstring_view_find_first(window, scan->needle, 0);
+            if (pos != RSTRING_NOT_FOUND)
+            {
+                rstring_internal_atomic_min(&scan->first, start + pos);
+            }
+            continue;
+        }
+
+        if (scan->kind == RSTRING_INTERNAL_SCAN_COUNT)
+        {
+            count += rstring_view_count(
+                window, scan->needle, 0, RSTRING_OVERLAPPING);
+            continue;
+        }
+
+        struct rstring_offsets *found = &scan->found[c];
+        if (rstring_view_find_all(
+                window, scan->needle, 0, RSTRING_OVERLAPPING, found)
+            != RSTRING_OK)
+        {
+            __atomic_store_n(&scan->failed, true, __ATOMIC_RELAXED);
+            continue;
+        }
+
+        /* Offsets into the window, to offsets into the haystack */
+        for (size_t i = 0; i < found->len; ++i)
+        {
+            found->data[i] += scan->base + start;
+        }
+    }
+
+    __atomic_fetch_add(&scan->count, count, __ATOMIC_RELAXED);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Splits a search for |needle| in |haystack| from |from| into chunks.
+ * Returns false if |needle| is empty or cannot fit, which leaves nothing to
+ * search.
+ */
+static bool
+rstring_internal_scan_init(struct rstring_internal_scan   *scan,
+                           enum rstring_internal_scan_kind kind,
+                           const struct rstring           *haystack,
+                           const struct rstring *needle, size_t from)
+{
+    if (needle->len == 0 || needle->len > haystack->len
+        || from > haystack->len - needle->len)
+    {
+        return false;
+    }
+
+    scan->kind   = kind;
+    scan->hay    = rstring_view_slice(rstring_view_from(haystack), from,
+                                   haystack->len - from);
+    scan->needle = rstring_view_from(needle);
+    scan->base   = from;
+
+    scan->positions = scan->hay.len - needle->len + 1;
+    scan->chunk     = RSTRING_PARALLEL_CHUNK;
+    if (scan->chunk / 16 < needle->len)
+    {
+        /* Keeps the bytes chunks search twice a small share */
+        scan->chunk = needle->len * 16;
+    }
+
+    scan->nchunks = (scan->positions + scan->chunk - 1) / scan->chunk;
+    scan->next    = 0;
+    scan->first   = RSTRING_NOT_FOUND;
+    scan->count   = 0;
+    scan->failed  = false;
+    scan->found   = NULL;
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Runs a scan, with the pool only if it has several chunks */
+static void
+rstring_internal_scan(struct rstring_workers       *workers,
+                      struct rstring_internal_scan *scan)
+{
+    if (scan->nchunks < 2)
+    {
+        rstring_internal_scan_run(scan);
+        return;
+    }
+
+    rstring_internal_workers_run(workers, rstring_internal_scan_run, scan);
+}
+
+/*----------------------------------------------------------------------------*/
+/* PUBLIC FUNCTIONS                                                           */
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_workers_init(struct rstring_workers *workers, size_t nthreads)
+{
+    if (nthreads == 0)
+    {
+        const long online = sysconf(_SC_NPROCESSORS_ONLN);
+        nthreads          = online > 0 ? (size_t) online : 1;
+    }
+
+    workers->threads    = NULL;
+    workers->nthreads   = 1;
+    workers->run        = NULL;
+    workers->job        = NULL;
+    workers->generation = 0;
+    workers->busy       = 0;
+    workers->stop       = false;
+
+    if (nthreads > 1)
+    {
+        workers->threads = malloc((nthreads - 1) * sizeof(pthread_t));
+        if (workers->threads == NULL)
+        {
+            return RSTRING_ERROR_ALLOC;
+        }
+    }
+
+    if (pthread_mutex_init(&workers->lock, NULL) != 0)
+    {
+        free(workers->threads);
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    if (pthread_cond_init(&workers->wake, NULL) != 0)
+    {
+        pthread_mutex_destroy(&workers->lock);
+        free(workers->threads);
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    if (pthread_cond_init(&workers->idle, NULL) != 0)
+    {
+        pthread_cond_destroy(&workers->wake);
+        pthread_mutex_destroy(&workers->lock);
+        free(workers->threads);
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    while (workers->nthreads < nthreads)
+    {
+        if (pthread_create(&workers->threads[workers->nthreads - 1],
+                           NULL,
+                           rstring_internal_worker,
+                           workers)
+            != 0)
+        {
+            rstring_workers_free(workers);
+            return RSTRING_ERROR_ALLOC;
+        }
+
+        workers->nthreads++;
+    }
+
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_workers_free(struct rstring_workers *workers)
+{
+    pthread_mutex_lock(&workers->lock);
+    workers->stop = true;
+    pthread_cond_broadcast(&workers->wake);
+    pthread_mutex_unlock(&workers->lock);
+
+    for (size_t i = 0; i + 1 < workers->nthreads; ++i)
+    {
+        pthread_join(workers->threads[i], NULL);
+    }
+
+    pthread_cond_destroy(&workers->idle);
+    pthread_cond_destroy(&workers->wake);
+    pthread_mutex_destroy(&workers->lock);
+    free(workers->threads);
+
+    workers->threads  = NULL;
+    workers->nthreads = 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_parallel_find_first(struct rstring_workers *workers,
+                            const struct rstring   *haystack,
+                            const struct rstring *needle, size_t from)
+{
+    struct rstring_internal_scan scan;
+
+    if (needle->len == 0)
+    {
+        return from <= haystack->len ? from : RSTRING_NOT_FOUND;
+    }
+
+    if (!rstring_internal_scan_init(
+            &scan, RSTRING_INTERNAL_SCAN_FIRST, haystack, needle, from))
+    {
+        return RSTRING_NOT_FOUND;
+    }
+
+    rstring_internal_scan(workers, &scan);
+
+    return scan.first == RSTRING_NOT_FOUND ? scan.first : scan.first + from;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_parallel_find_all(struct rstring_workers *workers,
+                          const struct rstring   *haystack,
+                          const struct rstring *needle, size_t from,
+                          struct rstring_offsets *out)
+{
+    struct rstring_internal_scan scan;
+
+    if (!rstring_internal_scan_init(
+            &scan, RSTRING_INTERNAL_SCAN_ALL, haystack, needle, from))
+    {
+        return RSTRING_OK;
+    }
+
+    scan.found = calloc(scan.nchunks, sizeof(struct rstring_offsets));
+    if (scan.found == NULL)
+    {
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    rstring_internal_scan(workers, &scan);
+
+    /* Merges the chunks in order, growing |out| once */
+    size_t total = 0;
+    for (size_t c = 0; c < scan.nchunks; ++c)
+    {
+        total += scan.found[c].len;
+    }
+
+    rstring_status_t rc = scan.failed
+                            ? RSTRING_ERROR_ALLOC
+                            : rstring_internal_offsets_reserve(out, total);
+
+    for (size_t c = 0; c < scan.nchunks; ++c)
+    {
+        if (rc == RSTRING_OK && scan.found[c].len > 0)
+        {
+            memcpy(out->data + out->len,
+                   scan.found[c].data,
+                   scan.found[c].len * sizeof(size_t));
+            out->len += scan.found[c].len;
+        }
+
+        rstring_offsets_free(&scan.found[c]);
+    }
+
+    free(scan.found);
+    return rc;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_parallel_count(struct rstring_workers *workers,
+                       const struct rstring   *haystack,
+                       const struct rstring *needle, size_t from)
+{
+    struct rstring_internal_scan scan;
+
+    if (!rstring_internal_scan_init(
+            &scan, RSTRING_INTERNAL_SCAN_COUNT, haystack, needle, from))
+    {
+        return 0;
+    }
+
+    rstring_internal_scan(workers, &scan);
+
+    return scan.count;
+}
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef RSTRING_PARALLEL_H
+#define RSTRING_PARALLEL_H
+
+#include <pthread.h> /* pthread_t, pthread_mutex_t, pthread_cond_t */
+#include <stdbool.h> /* bool */
+#include <stddef.h>  /* size_t */
+
+#include "rstring.h"
+
+/*
+ * Smallest number of match positions a chunk of a parallel search covers.
+ * Haystacks shorter than two chunks are searched by the calling thread alone.
+ */
+#define RSTRING_PARALLEL_CHUNK (1024 * 1024)
+
+/*
+ * A pool of threads which searches the chunks of a haystack together with the
+ * calling thread, see `rstring_parallel_find_first`.
+ *
+ * A pool runs one search at a time: it may be shared by several threads only
+ * if they do not search concurrently.
+ *
+ * Fields are private to the library, except for |nthreads|, which may be
+ * inspected.
+ */
+struct rstring_workers
+{
+    pthread_t      *threads;
+    size_t          nthreads; /* Threads searching, the caller included */
+    pthread_mutex_t lock;
+    pthread_cond_t  wake; /* A job was posted, or the pool is stopping */
+    pthread_cond_t  idle; /* Every worker is done with the job */
+    void (*run)(void *job);
+    void         *job;
+    unsigned long generation; /* Incremented for every job */
+    size_t        busy;       /* Workers not done with the job yet */
+    bool          stop;
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Starts a pool of search threads.
+ *
+ * @param workers Pointer to the pool to initialize.
+ * @param nthreads The number of threads searching, the calling thread
+ * included, which is why `nthreads - 1` threads are started. 0 picks the
+ * number of online CPUs.
+ * @return RSTRING_OK on success, or RSTRING_ERROR_ALLOC if the threads or
+ * their memory could not be created, in which case nothing needs freeing.
+ */
+rstring_status_t
+rstring_workers_init(struct rstring_workers *workers, size_t nthreads);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Stops and joins the threads of a pool, and frees its memory.
+ *
+ * @param workers Pointer to the pool, which must not be searching.
+ */
+void
+rstring_workers_free(struct rstring_workers *workers);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the first occurrence of an rstring inside another one, from a
+ * given offset, with the threads of a pool.
+ *
+ * The positions a match may start at are split into chunks of at least
+ * `RSTRING_PARALLEL_CHUNK`, each searched up to its last position plus the
+ * length of the needle, so that matches across two chunks are found. Threads
+ * take chunks in order; once a match is found, the chunks after it are
+ * skipped.
+ *
+ * @param workers Pointer to the pool to search with.
+ * @param haystack Pointer to the rstring to search in.
+ * @param needle Pointer to the rstring to search for.
+ * @param from The offset to start searching from.
+ * @return As `rstring_find_first`.
+ */
+size_t
+rstring_parallel_find_first(struct rstring_workers *workers,
+                            const struct rstring *haystack,
+                            const struct rstring *needle, size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Collects the offsets of every occurrence of an rstring inside another
+ * one, from a given offset, with the threads of a pool.
+ *
+ * Every occurrence is reported, overlapping ones included, as
+ * `rstring_find_all` does with `RSTRING_OVERLAPPING`. Each chunk collects its
+ * own offsets, which are appended to |out| in increasing order once every
+ * chunk is searched.
+ *
+ * @param workers Pointer to the pool to search with.
+ * @param haystack Pointer to the rstring to search in.
+ * @param needle Pointer to the rstring to search for. An empty needle has no
+ * occurrences.
+ * @param from The offset to start searching from.
+ * @param out Pointer to the array to append the offsets to.
+ * @return RSTRING_OK on success, or RSTRING_ERROR_ALLOC if memory allocation
+ * fails, in which case |out| is not modified.
+ */
+rstring_status_t
+rstring_parallel_find_all(struct rstring_workers *workers,
+                          const struct rstring *haystack,
+                          const struct rstring *needle, size_t from,
+                          struct rstring_offsets *out);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Counts the occurrences of an rstring inside another one, from a given
+ * offset, with the threads of a pool.
+ *
+ * Overlapping occurrences are all counted, see `rstring_parallel_find_all`.
+ *
+ * @param workers Pointer to the pool to search with.
+ * @param haystack Pointer to the rstring to search in.
+ * @param needle Pointer to the rstring to search for. An empty needle has no
+ * occurrences.
+ * @param from The offset to start searching from.
+ * @return The number of occurrences.
+ */
+size_t
+rstring_parallel_count(struct rstring_workers *workers,
+                       const struct rstring *haystack,
+                       const struct rstring *needle, size_t from);
+
+#endif /* RSTRING_PARALLEL_H */
@@ -0,0 +1,655 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ *
+ * rstring_rope.c
+ * --------------
+ * Ropes: long strings kept as a treap of rstring chunks, split and joined at
+ * the edits.
+ */
+
+#include <stdint.h> /* uint64_t, SIZE_MAX */
+#include <stdlib.h> /* malloc, free */
+
+#include <string.h> /* memcmp, memchr */
+
+#include "rstring.h"
+#include "rstring_internal.h"
+#include "rstring_rope.h"
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL FUNCTIONS                                                         */
+/*----------------------------------------------------------------------------*/
+
+static inline size_t
+rstring_internal_rope_size(const struct rstring_rope_node *node)
+{
+    return node ? node->size : 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static inline void
+rstring_internal_rope_update(struct rstring_rope_node *node)
+{
+    node->size = rstring_internal_rope_size(node->left) + node->chunk.len
+               + rstring_internal_rope_size(node->right);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* splitmix64, which is fine with any state, including the 0 of a new rope */
+static uint64_t
+rstring_internal_rope_random(struct rstring_rope *rope)
+{
+    uint64_t z = (rope->seed += UINT64_C(0x9E3779B97F4A7C15));
+
+    z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+    z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+    return z ^ (z >> 31);
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* A single node holding a copy of |view|, which must not be empty */
+static struct rstring_rope_node *
+rstring_internal_rope_node(struct rstring_rope *rope, struct rstring_view view)
+{
+    struct rstring_rope_node *node = malloc(sizeof(struct rstring_rope_node));
+
+    if (!node)
+    {
+        return NULL;
+    }
+
+    rstring_init(&node->chunk);
+    if (rstring_push_view(&node->chunk, view) != RSTRING_OK)
+    {
+        rstring_free(&node->chunk);
+        free(node);
+        return NULL;
+    }
+
+    node->left     = NULL;
+    node->right    = NULL;
+    node->size     = view.len;
+    node->priority = rstring_internal_rope_random(rope);
+    return node;
+}
+
+/*----------------------------------------------------------------------------*/
+
+static void
+rstring_internal_rope_free(struct rstring_rope_node *node)
+{
+    while (node)
+    {
+        struct rstring_rope_node *right = node->right;
+
+        rstring_internal_rope_free(node->left);
+        rstring_free(&node->chunk);
+        free(node);
+        node = right;
+    }
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Joins two trees, every byte of |a| coming before those of |b| */
+static struct rstring_rope_node *
+rstring_internal_rope_merge(struct rstring_rope_node *a,
+                            struct rstring_rope_node *b)
+{
+    if (!a)
+    {
+        return b;
+    }
+
+    if (!b)
+    {
+        return a;
+    }
+
+    if (a->priority > b->priority)
+    {
+        a->right = rstring_internal_rope_merge(a->right, b);
+        rstring_internal_rope_update(a);
+        return a;
+    }
+
+    b->left = rstring_internal_rope_merge(a, b->left);
+    rstring_internal_rope_update(b);
+    return b;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Splits a tree into the bytes before |pos|, in |*left|, and the others, in
+ * |*right|. A chunk which |pos| falls inside of is split in two, which
+ * allocates: on failure, the tree is left as is, and so are the outputs.
+ */
+static rstring_status_t
+rstring_internal_rope_split(struct rstring_rope *rope,
+                            struct rstring_rope_node *node, size_t pos,
+                            struct rstring_rope_node **left,
+                            struct rstring_rope_node **right)
+{
+    struct rstring_rope_node *a, *b;
+    rstring_status_t          rc;
+
+    if (!node)
+    {
+        *left  = NULL;
+        *right = NULL;
+        return RSTRING_OK;
+    }
+
+    const size_t before = rstring_internal_rope_size(node->left);
+
+    if (pos <= before)
+    {
+        rc = rstring_internal_rope_split(rope, node->left, pos, &a, &b);
+        if (rc != RSTRING_OK)
+        {
+            return rc;
+        }
+
+        node->left = b;
+        rstring_internal_rope_update(node);
+        *left  = a;
+        *right = node;
+        return RSTRING_OK;
+    }
+
+    if (pos >= before + node->chunk.len)
+    {
+        rc = rstring_internal_rope_split(
+            rope, node->right, pos - before - node->chunk.len, &a, &b);
+        if (rc != RSTRING_OK)
+        {
+            return rc;
+        }
+
+        node->right = a;
+        rstring_internal_rope_update(node);
+        *left  = node;
+        *right = b;
+        return RSTRING_OK;
+    }
+
+    /* The tail of the chunk moves to a node of its own */
+    const size_t              at   = pos - before;
+    const struct rstring_view rest =
+        rstring_view_slice(rstring_view_from(&node->chunk), at, SIZE_MAX);
+    struct rstring_rope_node *tail = rstring_internal_rope_node(rope, rest);
+
+    if (!tail)
+    {
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    rstring_erase(&node->chunk, at, SIZE_MAX);
+    *right      = rstring_internal_rope_merge(tail, node->right);
+    node->right = NULL;
+    rstring_internal_rope_update(node);
+    *left = node;
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Finds the node holding the byte at |*pos|, making |*pos| relative to it */
+static struct rstring_rope_node *
+rstring_internal_rope_find_node(const struct rstring_rope *rope, size_t *pos)
+{
+    struct rstring_rope_node *node = rope->root;
+
+    while (node)
+    {
+        const size_t before = rstring_internal_rope_size(node->left);
+
+        if (*pos < before)
+        {
+            node = node->left;
+        }
+        else if (*pos < before + node->chunk.len)
+        {
+            *pos -= before;
+            return node;
+        }
+        else
+        {
+            *pos -= before + node->chunk.len;
+            node = node->right;
+        }
+    }
+
+    return NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Inserts |view| in the chunk which |pos| falls inside of or at the end of, if
+ * it has room for it. Returns RSTRING_NOT_FOUND if none has.
+ */
+static rstring_status_t
+rstring_internal_rope_insert_in_place(struct rstring_rope *rope, size_t pos,
+                                      struct rstring_view view)
+{
+    struct rstring_rope_node *node = rope->root;
+    size_t                    at   = pos;
+
+    while (node)
+    {
+        const size_t before = rstring_internal_rope_size(node->left);
+
+        if (at < before)
+        {
+            node = node->left;
+        }
+        else if (at <= before + node->chunk.len)
+        {
+            at -= before;
+            break;
+        }
+        else
+        {
+            at -= before + node->chunk.len;
+            node = node->right;
+        }
+    }
+
+    if (!node || node->chunk.len + view.len > RSTRING_ROPE_CHUNK)
+    {
+        return RSTRING_NOT_FOUND;
+    }
+
+    rstring_status_t rc = rstring_insert_view(&node->chunk, at, view);
+    if (rc != RSTRING_OK)
+    {
+        return rc;
+    }
+
+    /* Walk the same path again, now that nothing can fail */
+    for (struct rstring_rope_node *n = rope->root; n != node;)
+    {
+        const size_t before = rstring_internal_rope_size(n->left);
+
+        n->size += view.len;
+        if (pos < before)
+        {
+            n = n->left;
+        }
+        else
+        {
+            pos -= before + n->chunk.len;
+            n = n->right;
+        }
+    }
+    node->size += view.len;
+
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Builds a tree holding a copy of |view|, in chunks of even sizes */
+static struct rstring_rope_node *
+rstring_internal_rope_build(struct rstring_rope *rope, struct rstring_view view)
+{
+    const size_t nchunks = view.len / RSTRING_ROPE_CHUNK
+                         + (view.len % RSTRING_ROPE_CHUNK != 0);
+    struct rstring_rope_node *tree = NULL;
+    size_t                    done = 0;
+
+    for (size_t i = 0; i < nchunks; ++i)
+    {
+        /* The remaining bytes shared evenly by the remaining chunks */
+        const size_t              n    = (view.len - done) / (nchunks - i);
+        struct rstring_rope_node *node =
+            rstring_internal_rope_node(rope, rstring_view_slice(view, done, n));
+
+        if (!node)
+        {
+            rstring_internal_rope_free(tree);
+            return NULL;
+        }
+
+        tree = rstring_internal_rope_merge(tree, node);
+        done += n;
+    }
+
+    return tree;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Whether the bytes of the rope from |pos| start with |view| */
+static bool
+rstring_internal_rope_matches(const struct rstring_rope *rope, size_t pos,
+                              struct rstring_view view)
+{
+    while (view.len > 0)
+    {
+        const struct rstring_view chunk = rstring_rope_chunk(rope, &pos);
+        const size_t n = chunk.len < view.len ? chunk.len : view.len;
+
+        if (n == 0 || memcmp(chunk.ptr, view.ptr, n) != 0)
+        {
+            return false;
+        }
+
+        view = rstring_view_slice(view, n, SIZE_MAX);
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+/* PUBLIC FUNCTIONS                                                           */
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_rope_init(struct rstring_rope *rope)
+{
+    rope->root = NULL;
+    rope->seed = 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_rope_insert(struct rstring_rope *rope, size_t pos,
+                    const struct rstring *rs)
+{
+    return rstring_rope_insert_view(rope, pos, rstring_view_from(rs));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_rope_insert_str(struct rstring_rope *rope, size_t pos,
+                        const char *str)
+{
+    return rstring_rope_insert_view(rope, pos, rstring_view_from_str(str));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_rope_insert_view(struct rstring_rope *rope, size_t pos,
+                         struct rstring_view view)
+{
+    if (view.len == 0)
+    {
+        return RSTRING_OK;
+    }
+
+    const size_t len = rstring_rope_len(rope);
+
+    if (pos > len)
+    {
+        pos = len;
+    }
+
+    rstring_status_t rc =
+        rstring_internal_rope_insert_in_place(rope, pos, view);
+    if (rc != RSTRING_NOT_FOUND)
+    {
+        return rc;
+    }
+
+    /* Copied first, as |view| may be a part of a chunk which splitting moves */
+    struct rstring_rope_node *middle = rstring_internal_rope_build(rope, view);
+    struct rstring_rope_node *left, *right;
+
+    if (!middle)
+    {
+        return RSTRING_ERROR_ALLOC;
+    }
+
+    rc = rstring_internal_rope_split(rope, rope->root, pos, &left, &right);
+    if (rc != RSTRING_OK)
+    {
+        rstring_internal_rope_free(middle);
+        return rc;
+    }
+
+    rope->root = rstring_internal_rope_merge(
+        rstring_internal_rope_merge(left, middle), right);
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_rope_push(struct rstring_rope *rope, const struct rstring *rs)
+{
+    return rstring_rope_insert_view(rope, SIZE_MAX, rstring_view_from(rs));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_rope_push_str(struct rstring_rope *rope, const char *str)
+{
+    return rstring_rope_insert_view(rope, SIZE_MAX, rstring_view_from_str(str));
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_rope_push_view(struct rstring_rope *rope, struct rstring_view view)
+{
+    return rstring_rope_insert_view(rope, SIZE_MAX, view);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_rope_erase(struct rstring_rope *rope, size_t pos, size_t n)
+{
+    const size_t len = rstring_rope_len(rope);
+
+    if (pos >= len || n == 0)
+    {
+        return RSTRING_OK;
+    }
+
+    if (n > len - pos)
+    {
+        n = len - pos;
+    }
+
+    /* Within a chunk, which keeps some of its bytes: erase in place */
+    size_t                    at   = pos;
+    struct rstring_rope_node *node = rstring_internal_rope_find_node(rope, &at);
+
+    if (n < node->chunk.len && at + n <= node->chunk.len)
+    {
+        rstring_erase(&node->chunk, at, n);
+
+        for (struct rstring_rope_node *p = rope->root; p != node;)
+        {
+            const size_t before = rstring_internal_rope_size(p->left);
+
+            p->size -= n;
+            if (pos < before)
+            {
+                p = p->left;
+            }
+            else
+            {
+                pos -= before + p->chunk.len;
+                p = p->right;
+            }
+        }
+        node->size -= n;
+
+        return RSTRING_OK;
+    }
+
+    struct rstring_rope_node *left, *middle, *right;
+    rstring_status_t          rc =
+        rstring_internal_rope_split(rope, rope->root, pos, &left, &right);
+
+    if (rc != RSTRING_OK)
+    {
+        return rc;
+    }
+
+    rc = rstring_internal_rope_split(rope, right, n, &middle, &right);
+    if (rc != RSTRING_OK)
+    {
+        /* Splitting never reorders the bytes, so joining undoes it */
+        rope->root = rstring_internal_rope_merge(left, right);
+        return rc;
+    }
+
+    rstring_internal_rope_free(middle);
+    rope->root = rstring_internal_rope_merge(left, right);
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_rope_concat(struct rstring_rope *dest, struct rstring_rope *src)
+{
+    dest->root = rstring_internal_rope_merge(dest->root, src->root);
+    src->root  = NULL;
+}
+
+/*----------------------------------------------------------------------------*/
+
+struct rstring_view
+rstring_rope_chunk(const struct rstring_rope *rope, size_t *pos)
+{
+    size_t                          at   = *pos;
+    const struct rstring_rope_node *node =
+        rstring_internal_rope_find_node(rope, &at);
+
+    if (!node)
+    {
+        return rstring_view_from_buf("", 0);
+    }
+
+    const struct rstring_view view =
+        rstring_view_slice(rstring_view_from(&node->chunk), at, SIZE_MAX);
+
+    *pos += view.len;
+    return view;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_rope_find(const struct rstring_rope *rope, const struct rstring *needle,
+                  size_t from)
+{
+    return rstring_rope_find_view(rope, rstring_view_from(needle), from);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_rope_find_str(const struct rstring_rope *rope, const char *needle,
+                      size_t from)
+{
+    return rstring_rope_find_view(rope, rstring_view_from_str(needle), from);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_rope_find_view(const struct rstring_rope *rope,
+                       struct rstring_view needle, size_t from)
+{
+    if (from > rstring_rope_len(rope))
+    {
+        return RSTRING_NOT_FOUND;
+    }
+
+    if (needle.len == 0)
+    {
+        return from;
+    }
+
+    size_t              pos = from;
+    struct rstring_view chunk;
+
+    while ((chunk = rstring_rope_chunk(rope, &pos)).len > 0)
+    {
+        const size_t start = pos - chunk.len;
+        const size_t found = rstring_view_find_first(chunk, needle, 0);
+
+        /* Occurrences within the chunk start before any which cross its end */
+        if (found != RSTRING_NOT_FOUND)
+        {
+            return start + found;
+        }
+
+        /* Others start in its last needle.len - 1 bytes, with the same byte */
+        size_t i = chunk.len >= needle.len ? chunk.len - needle.len + 1 : 0;
+
+        while (i < chunk.len)
+        {
+            const char *p = memchr(chunk.ptr + i, needle.ptr[0], chunk.len - i);
+
+            if (!p)
+            {
+                break;
+            }
+
+            i = (size_t) (p - chunk.ptr);
+
+            const size_t head = chunk.len - i;
+            if (memcmp(p, needle.ptr, head) == 0
+                && rstring_internal_rope_matches(
+                    rope, pos, rstring_view_slice(needle, head, SIZE_MAX)))
+            {
+                return start + i;
+            }
+
+            i++;
+        }
+    }
+
+    return RSTRING_NOT_FOUND;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_rope_flatten(const struct rstring_rope *rope, struct rstring *out)
+{
+    const size_t len = rstring_rope_len(rope);
+
+    if (len == 0)
+    {
+        return RSTRING_OK;
+    }
+
+    ENSURE_CAPACITY(out, out->len + len + 1);
+
+    size_t              pos = 0;
+    struct rstring_view chunk;
+
+    while ((chunk = rstring_rope_chunk(rope, &pos)).len > 0)
+    {
+        rstring_push_view(out, chunk);
+    }
+
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_rope_free(struct rstring_rope *rope)
+{
+    rstring_internal_rope_free(rope->root);
+    rope->root = NULL;
+}
@@ -0,0 +1,249 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef RSTRING_ROPE_H
+#define RSTRING_ROPE_H
+
+#include <stddef.h> /* size_t */
+#include <stdint.h> /* uint64_t */
+
+#include "rstring.h"
+
+/*
+ * Chunks never hold more than this many bytes. Edits within a chunk move at
+ * most this many bytes.
+ */
+#define RSTRING_ROPE_CHUNK 4096
+
+/*
+ * A node of a rope: a chunk of the text, and the subtrees of the text before
+ * and after it.
+ */
+struct rstring_rope_node
+{
+    struct rstring_rope_node *left;
+    struct rstring_rope_node *right;
+    size_t                    size;     /* Bytes in the subtree */
+    uint64_t                  priority; /* Larger than those of the subtrees */
+    struct rstring            chunk;    /* Never empty */
+};
+
+/*
+ * A long string stored as a sequence of chunks of up to `RSTRING_ROPE_CHUNK`
+ * bytes, each one an rstring, arranged in a balanced tree.
+ *
+ * The tree is a treap: it is ordered by position, and heap-ordered by random
+ * node priorities, which keeps it balanced with high probability whatever the
+ * edits are. Inserting, erasing and concatenating cost O(log n) tree
+ * operations plus the bytes copied, rather than a move of the whole tail as
+ * with a single rstring: an edit which fits in a chunk is made in place, and
+ * larger ones split the tree at the edit and join the pieces back.
+ *
+ * Fields are private to the library. A zero-initialized rope is valid and
+ * empty. Views of the chunks are invalidated by any modification.
+ */
+struct rstring_rope
+{
+    struct rstring_rope_node *root;
+    uint64_t                  seed; /* State of the priority generator */
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Initializes an empty rope.
+ *
+ * @param rope Pointer to the rope to initialize.
+ */
+void
+rstring_rope_init(struct rstring_rope *rope);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns the length of a rope, in bytes.
+ */
+static inline size_t
+rstring_rope_len(const struct rstring_rope *rope)
+{
+    return rope->root ? rope->root->size : 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Inserts the contents of an rstring into a rope at a given offset.
+ *
+ * @param rope Pointer to the rope to insert into.
+ * @param pos Offset to insert at, clamped to the length of the rope.
+ * @param rs Pointer to the rstring to insert.
+ * @return RSTRING_OK on success, or RSTRING_ERROR_ALLOC if memory allocation
+ * fails, in which case the rope is unchanged.
+ */
+rstring_status_t
+rstring_rope_insert(struct rstring_rope *rope, size_t pos,
+                    const struct rstring *rs);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_rope_insert.
+ */
+rstring_status_t
+rstring_rope_insert_str(struct rstring_rope *rope, size_t pos,
+                        const char *str);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_rope_insert.
+ *
+ * |view| may refer to a chunk of the rope itself.
+ */
+rstring_status_t
+rstring_rope_insert_view(struct rstring_rope *rope, size_t pos,
+                         struct rstring_view view);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Appends the contents of an rstring to a rope.
+ *
+ * @return RSTRING_OK on success, or RSTRING_ERROR_ALLOC if memory allocation
+ * fails, in which case the rope is unchanged.
+ */
+rstring_status_t
+rstring_rope_push(struct rstring_rope *rope, const struct rstring *rs);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_rope_push.
+ */
+rstring_status_t
+rstring_rope_push_str(struct rstring_rope *rope, const char *str);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_rope_push.
+ */
+rstring_status_t
+rstring_rope_push_view(struct rstring_rope *rope, struct rstring_view view);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Removes a range of bytes from a rope.
+ *
+ * The range is clamped to the rope. Erasing within a chunk never allocates;
+ * a range which starts or ends inside a chunk may, to split it.
+ *
+ * @param rope Pointer to the rope to erase from.
+ * @param pos Offset of the first byte to remove.
+ * @param n Number of bytes to remove.
+ * @return RSTRING_OK on success, or RSTRING_ERROR_ALLOC if memory allocation
+ * fails, in which case the rope is unchanged.
+ */
+rstring_status_t
+rstring_rope_erase(struct rstring_rope *rope, size_t pos, size_t n);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Moves the contents of a rope to the end of another one.
+ *
+ * No bytes are copied, and nothing is allocated.
+ *
+ * @param dest Pointer to the rope to append to.
+ * @param src Pointer to the rope to append, which is left empty.
+ */
+void
+rstring_rope_concat(struct rstring_rope *dest, struct rstring_rope *src);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Returns the part of a chunk of a rope from a given offset to the end
+ * of the chunk, and advances the offset past it.
+ *
+ * Iterates over the contents of a rope, in order, without copying them:
+ *
+ *     size_t pos = 0;
+ *     struct rstring_view chunk;
+ *     while ((chunk = rstring_rope_chunk(&rope, &pos)).len > 0)
+ *
+ * @param rope Pointer to the rope.
+ * @param pos Pointer to the offset, advanced by the length of the view.
+ * @return A view of the bytes from |*pos| to the end of their chunk, or an
+ * empty view if |*pos| is at or past the end of the rope.
+ */
+struct rstring_view
+rstring_rope_chunk(const struct rstring_rope *rope, size_t *pos);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Finds the first occurrence of an rstring in a rope, from a given
+ * offset.
+ *
+ * Each chunk is searched with `rstring_view_find_first`; occurrences which
+ * cross from a chunk to the next are found by comparing the candidates at the
+ * end of the chunk with the following bytes.
+ *
+ * @param rope Pointer to the rope to search in.
+ * @param needle Pointer to the rstring to search for.
+ * @param from Offset to start the search from.
+ * @return The offset of the occurrence in the rope, else `RSTRING_NOT_FOUND`.
+ * An empty |needle| is found at |from| if it is within the rope.
+ */
+size_t
+rstring_rope_find(const struct rstring_rope *rope, const struct rstring *needle,
+                  size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Null-terminated C string variant of rstring_rope_find.
+ */
+size_t
+rstring_rope_find_str(const struct rstring_rope *rope, const char *needle,
+                      size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_rope_find.
+ */
+size_t
+rstring_rope_find_view(const struct rstring_rope *rope,
+                       struct rstring_view needle, size_t from);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Appends the contents of a rope to an rstring.
+ *
+ * |out| grows at most once.
+ *
+ * @param rope Pointer to the rope.
+ * @param out Pointer to the rstring to append to.
+ * @return RSTRING_OK on success, or RSTRING_ERROR_ALLOC if memory allocation
+ * fails, in which case |out| is unchanged.
+ */
+rstring_status_t
+rstring_rope_flatten(const struct rstring_rope *rope, struct rstring *out);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Frees the memory owned by a rope, leaving it empty.
+ *
+ * @param rope Pointer to the rope to free.
+ */
+void
+rstring_rope_free(struct rstring_rope *rope);
+
+#endif /* RSTRING_ROPE_H */
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ *
+ * rstring_stats.c
+ * ---------------
+ * Thread-local counters of heap buffers and searches, kept when the library is
+ * built with RSTRING_STATS.
+ */
+
+#include <stdbool.h> /* bool */
+#include <string.h>  /* memset */
+
+#include "rstring.h"
+#include "rstring_internal.h"
+#include "rstring_stats.h"
+
+#ifdef RSTRING_STATS
+__thread struct rstring_stats rstring_internal_stats;
+#endif
+
+/*----------------------------------------------------------------------------*/
+
+bool
+rstring_stats_enabled(void)
+{
+#ifdef RSTRING_STATS
+    return true;
+#else
+    return false;
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_stats_snapshot(struct rstring_stats *stats)
+{
+#ifdef RSTRING_STATS
+    *stats = rstring_internal_stats;
+#else
+    memset(stats, 0, sizeof(*stats));
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_stats_reset(void)
+{
+#ifdef RSTRING_STATS
+    memset(&rstring_internal_stats, 0, sizeof(rstring_internal_stats));
+#endif
+}
+
+/*----------------------------------------------------------------------------*/
+
+void
+rstring_stats_sample(const struct rstring *rs)
+{
+    if (rstring_is_inline(rs))
+    {
+        return;
+    }
+
+    STATS_ADD(unused_bytes, rs->cap - rs->len);
+    STATS_ADD(fill[rs->len * RSTRING_STATS_FILL_BUCKETS / rs->cap], 1);
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_stats_dump(struct rstring *rs, const struct rstring_stats *stats)
+{
+    rstring_status_t rc = rstring_push_fmt(rs,
+                                           "allocs %zu\n"
+                                           "reallocs %zu\n"
+                                           "realloc_bytes %zu\n"
+                                           "frees %zu\n"
+                                           "unused_bytes %zu\n"
+                                           "finds %zu\n"
+                                           "find_bytes %zu\n",
+                                           stats->allocs,
+                                           stats->reallocs,
+                                           stats->realloc_bytes,
+                                           stats->frees,
+                                           stats->unused_bytes,
+                                           stats->finds,
+                                           stats->find_bytes);
+
+    for (int i = 0; rc == RSTRING_OK && i < RSTRING_STATS_FILL_BUCKETS; ++i)
+    {
+        rc = rstring_push_fmt(rs,
+                              "fill_%d %zu\n",
+                              i * 100 / RSTRING_STATS_FILL_BUCKETS,
+                              stats->fill[i]);
+    }
+
+    return rc;
+}
@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef RSTRING_STATS_H
+#define RSTRING_STATS_H
+
+#include <stdbool.h> /* bool */
+#include <stddef.h>  /* size_t */
+
+#include "rstring.h"
+
+/*
+ * Number of buckets of `rstring_stats.fill`.
+ */
+#define RSTRING_STATS_FILL_BUCKETS 8
+
+/*
+ * Counters of the heap buffers and searches of the rstrings of a thread, see
+ * `rstring_stats_snapshot`.
+ *
+ * Only heap buffers are counted: inline rstrings never allocate.
+ */
+struct rstring_stats
+{
+    size_t allocs;        /* Heap buffers allocated, moving out of inline */
+    size_t reallocs;      /* Heap buffers resized */
+    size_t realloc_bytes; /* Bytes the reallocs carried over */
+    size_t frees;         /* Heap buffers released */
+    size_t unused_bytes;  /* Capacity left unused by the buffers in `fill` */
+    size_t finds;         /* Calls to the search functions */
+    size_t find_bytes;    /* Bytes of haystack they went through */
+
+    /*
+     * Heap buffers by how full they were when released, or when passed to
+     * `rstring_stats_sample`: bucket i counts those whose length was at least
+     * i / RSTRING_STATS_FILL_BUCKETS of their capacity, and under
+     * (i + 1) / RSTRING_STATS_FILL_BUCKETS of it. Rstrings which live on are
+     * only covered once sampled.
+     */
+    size_t fill[RSTRING_STATS_FILL_BUCKETS];
+};
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks whether the library was built to keep statistics.
+ *
+ * Counting is enabled at compile time, by defining RSTRING_STATS when building
+ * the library (the RSTRING_STATS CMake option). Otherwise, the counting code
+ * is compiled out and every counter stays at zero.
+ *
+ * @return true if the counters are kept.
+ */
+bool
+rstring_stats_enabled(void);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Copies the counters of the calling thread.
+ *
+ * Counters are thread-local, so that counting needs no synchronization: each
+ * thread sees what its own calls did, since it started or since its last
+ * `rstring_stats_reset`.
+ *
+ * @param stats Pointer to the structure to fill.
+ */
+void
+rstring_stats_snapshot(struct rstring_stats *stats);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Zeroes the counters of the calling thread.
+ */
+void
+rstring_stats_reset(void);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Counts how full the heap buffer of a live rstring is.
+ *
+ * Adds the rstring to `fill` and `unused_bytes`, as if it were released, so
+ * that the histogram also covers the rstrings which are never freed, or not
+ * before the snapshot is taken. Inline rstrings are not counted.
+ *
+ * @param rs Pointer to the rstring to sample.
+ */
+void
+rstring_stats_sample(const struct rstring *rs);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Appends a snapshot to an rstring, as one "name value" line per
+ * counter.
+ *
+ * The fill buckets are named after the percentage they start at, as in
+ * "fill_25 3".
+ *
+ * @param rs Pointer to the rstring to append to.
+ * @param stats Pointer to the counters, as filled by `rstring_stats_snapshot`.
+ * @return RSTRING_OK on success, or RSTRING_ERROR_ALLOC if memory allocation
+ * fails.
+ */
+rstring_status_t
+rstring_stats_dump(struct rstring *rs, const struct rstring_stats *stats);
+
+#endif /* RSTRING_STATS_H */
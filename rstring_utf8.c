@@ -0,0 +1,1269 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ *
+ * rstring_utf8.c
+ * --------------
+ * UTF-8 validation, counting and conversion to and from UTF-16 and UTF-32,
+ * and Unicode lower case.
+ *
+ * The vectorized validation is the lookup algorithm of Keiser and Lemire,
+ * "Validating UTF-8 In Less Than One Instruction Per Byte" (2021): every
+ * error in a 2-byte window is found by looking up the high and low nibble of
+ * the first byte and the high nibble of the second byte in three 16-entry
+ * tables, and checking that the three results have no bit in common.
+ */
+
+#include <stdint.h> /* uint8_t, uint16_t, uint32_t, uint64_t */
+
+#include <string.h> /* memcpy, memset */
+
+#include "rstring.h"
+#include "rstring_internal.h"
+#include "rstring_utf8.h"
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL MACROS                                                            */
+/*----------------------------------------------------------------------------*/
+
+#define UTF8_ONES  UINT64_C(0x0101010101010101)
+#define UTF8_HIGHS (UTF8_ONES << 7)
+
+/*
+ * Error classes of the lookup tables, named after the first two bytes of the
+ * sequences they stand for. TOO_LARGE_1000 and OVERLONG_4 share a bit, since
+ * they never apply to the same first byte.
+ */
+#define UTF8_TOO_SHORT      0x01 /* 11______ 0_______, 11______ 11______ */
+#define UTF8_TOO_LONG       0x02 /* 0_______ 10______ */
+#define UTF8_OVERLONG_3     0x04 /* 11100000 100_____ */
+#define UTF8_TOO_LARGE      0x08 /* 11110100+ 1001____, 11110100+ 101_____ */
+#define UTF8_SURROGATE      0x10 /* 11101101 101_____ */
+#define UTF8_OVERLONG_2     0x20 /* 1100000_ 10______ */
+#define UTF8_TOO_LARGE_1000 0x40 /* 11110101+ 1000____ */
+#define UTF8_OVERLONG_4     0x40 /* 11110000 1000____ */
+#define UTF8_TWO_CONTS      0x80 /* 10______ 10______ */
+
+/* Classes which do not depend on the low nibble of the first byte */
+#define UTF8_CARRY (UTF8_TOO_SHORT | UTF8_TOO_LONG | UTF8_TWO_CONTS)
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL TYPES                                                             */
+/*----------------------------------------------------------------------------*/
+
+typedef bool (*rstring_internal_validate_fn)(const uint8_t *p, size_t n);
+
+typedef size_t (*rstring_internal_count_fn)(const uint8_t *p, size_t n,
+                                            bool utf16);
+
+/*
+ * Code points |first| to |last|, every |stride| of them, which map to lower
+ * case by adding |delta|.
+ */
+struct rstring_internal_lower_run
+{
+    uint32_t first;
+    uint32_t last;
+    int32_t  delta;
+    uint32_t stride;
+};
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL DATA                                                              */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * The simple lower case mappings of Unicode 14.0 outside of ASCII, from
+ * UnicodeData.txt, grouped in runs: upper and lower case letters alternate in
+ * many blocks, which makes runs with a stride of 2.
+ */
+static const struct rstring_internal_lower_run rstring_internal_lower_runs[] = {
+    {0x00C0, 0x00D6, 32, 1}, {0x00D8, 0x00DE, 32, 1}, {0x0100, 0x012E, 1, 2},
+    {0x0130, 0x0130, -199, 1}, {0x0132, 0x0136, 1, 2}, {0x0139, 0x0147, 1, 2},
+    {0x014A, 0x0176, 1, 2}, {0x0178, 0x0178, -121, 1}, {0x0179, 0x017D, 1, 2},
+    {0x0181, 0x0181, 210, 1}, {0x0182, 0x0184, 1, 2}, {0x0186, 0x0186, 206, 1},
+    {0x0187, 0x0187, 1, 1}, {0x0189, 0x018A, 205, 1}, {0x018B, 0x018B, 1, 1},
+    {0x018E, 0x018E, 79, 1}, {0x018F, 0x018F, 202, 1}, {0x0190, 0x0190, 203, 1},
+    {0x0191, 0x0191, 1, 1}, {0x0193, 0x0193, 205, 1}, {0x0194, 0x0194, 207, 1},
+    {0x0196, 0x0196, 211, 1}, {0x0197, 0x0197, 209, 1}, {0x0198, 0x0198, 1, 1},
+    {0x019C, 0x019C, 211, 1}, {0x019D, 0x019D, 213, 1},
+    {0x019F, 0x019F, 214, 1}, {0x01A0, 0x01A4, 1, 2}, {0x01A6, 0x01A6, 218, 1},
+    {0x01A7, 0x01A7, 1, 1}, {0x01A9, 0x01A9, 218, 1}, {0x01AC, 0x01AC, 1, 1},
+    {0x01AE, 0x01AE, 218, 1}, {0x01AF, 0x01AF, 1, 1}, {0x01B1, 0x01B2, 217, 1},
+    {0x01B3, 0x01B5, 1, 2}, {0x01B7, 0x01B7, 219, 1}, {0x01B8, 0x01B8, 1, 1},
+    {0x01BC, 0x01BC, 1, 1}, {0x01C4, 0x01C4, 2, 1}, {0x01C5, 0x01C5, 1, 1},
+    {0x01C7, 0x01C7, 2, 1}, {0x01C8, 0x01C8, 1, 1}, {0x01CA, 0x01CA, 2, 1},
+    {0x01CB, 0x01DB, 1, 2}, {0x01DE, 0x01EE, 1, 2}, {0x01F1, 0x01F1, 2, 1},
+    {0x01F2, 0x01F4, 1, 2}, {0x01F6, 0x01F6, -97, 1}, {0x01F7, 0x01F7, -56, 1},
+    {0x01F8, 0x021E, 1, 2}, {0x0220, 0x0220, -130, 1}, {0x0222, 0x0232, 1, 2},
+    {0x023A, 0x023A, 10795, 1}, {0x023B, 0x023B, 1, 1},
+    {0x023D, 0x023D, -163, 1}, {0x023E, 0x023E, 10792, 1},
+    {0x0241, 0x0241, 1, 1}, {0x0243, 0x0243, -195, 1}, {0x0244, 0x0244, 69, 1},
+    {0x0245, 0x0245, 71, 1}, {0x0246, 0x024E, 1, 2}, {0x0370, 0x0372, 1, 2},
+    {0x0376, 0x0376, 1, 1}, {0x037F, 0x037F, 116, 1}, {0x0386, 0x0386, 38, 1},
+    {0x0388, 0x038A, 37, 1}, {0x038C, 0x038C, 64, 1}, {0x038E, 0x038F, 63, 1},
+    {0x0391, 0x03A1, 32, 1}, {0x03A3, 0x03AB, 32, 1}, {0x03CF, 0x03CF, 8, 1},
+    {0x03D8, 0x03EE, 1, 2}, {0x03F4, 0x03F4, -60, 1}, {0x03F7, 0x03F7, 1, 1},
+    {0x03F9, 0x03F9, -7, 1}, {0x03FA, 0x03FA, 1, 1}, {0x03FD, 0x03FF, -130, 1},
+    {0x0400, 0x040F, 80, 1}, {0x0410, 0x042F, 32, 1}, {0x0460, 0x0480, 1, 2},
+    {0x048A, 0x04BE, 1, 2}, {0x04C0, 0x04C0, 15, 1}, {0x04C1, 0x04CD, 1, 2},
+    {0x04D0, 0x052E, 1, 2}, {0x0531, 0x0556, 48, 1}, {0x10A0, 0x10C5, 7264, 1},
+    {0x10C7, 0x10C7, 7264, 1}, {0x10CD, 0x10CD, 7264, 1},
+    {0x13A0, 0x13EF, 38864, 1}, {0x13F0, 0x13F5, 8, 1},
+    {0x1C90, 0x1CBA, -3008, 1}, {0x1CBD, 0x1CBF, -3008, 1},
+    {0x1E00, 0x1E94, 1, 2}, {0x1E9E, 0x1E9E, -7615, 1}, {0x1EA0, 0x1EFE, 1, 2},
+    {0x1F08, 0x1F0F, -8, 1}, {0x1F18, 0x1F1D, -8, 1}, {0x1F28, 0x1F2F, -8, 1},
+    {0x1F38, 0x1F3F, -8, 1}, {0x1F48, 0x1F4D, -8, 1}, {0x1F59, 0x1F5F, -8, 2},
+    {0x1F68, 0x1F6F, -8, 1}, {0x1F88, 0x1F8F, -8, 1}, {0x1F98, 0x1F9F, -8, 1},
+    {0x1FA8, 0x1FAF, -8, 1}, {0x1FB8, 0x1FB9, -8, 1}, {0x1FBA, 0x1FBB, -74, 1},
+    {0x1FBC, 0x1FBC, -9, 1}, {0x1FC8, 0x1FCB, -86, 1}, {0x1FCC, 0x1FCC, -9, 1},
+    {0x1FD8, 0x1FD9, -8, 1}, {0x1FDA, 0x1FDB, -100, 1}, {0x1FE8, 0x1FE9, -8, 1},
+    {0x1FEA, 0x1FEB, -112, 1}, {0x1FEC, 0x1FEC, -7, 1},
+    {0x1FF8, 0x1FF9, -128, 1}, {0x1FFA, 0x1FFB, -126, 1},
+    {0x1FFC, 0x1FFC, -9, 1}, {0x2126, 0x2126, -7517, 1},
+    {0x212A, 0x212A, -8383, 1}, {0x212B, 0x212B, -8262, 1},
+    {0x2132, 0x2132, 28, 1}, {0x2160, 0x216F, 16, 1}, {0x2183, 0x2183, 1, 1},
+    {0x24B6, 0x24CF, 26, 1}, {0x2C00, 0x2C2F, 48, 1}, {0x2C60, 0x2C60, 1, 1},
+    {0x2C62, 0x2C62, -10743, 1}, {0x2C63, 0x2C63, -3814, 1},
+    {0x2C64, 0x2C64, -10727, 1}, {0x2C67, 0x2C6B, 1, 2},
+    {0x2C6D, 0x2C6D, -10780, 1}, {0x2C6E, 0x2C6E, -10749, 1},
+    {0x2C6F, 0x2C6F, -10783, 1}, {0x2C70, 0x2C70, -10782, 1},
+    {0x2C72, 0x2C72, 1, 1}, {0x2C75, 0x2C75, 1, 1}, {0x2C7E, 0x2C7F, -10815, 1},
+    {0x2C80, 0x2CE2, 1, 2}, {0x2CEB, 0x2CED, 1, 2}, {0x2CF2, 0x2CF2, 1, 1},
+    {0xA640, 0xA66C, 1, 2}, {0xA680, 0xA69A, 1, 2}, {0xA722, 0xA72E, 1, 2},
+    {0xA732, 0xA76E, 1, 2}, {0xA779, 0xA77B, 1, 2}, {0xA77D, 0xA77D, -35332, 1},
+    {0xA77E, 0xA786, 1, 2}, {0xA78B, 0xA78B, 1, 1}, {0xA78D, 0xA78D, -42280, 1},
+    {0xA790, 0xA792, 1, 2}, {0xA796, 0xA7A8, 1, 2}, {0xA7AA, 0xA7AA, -42308, 1},
+    {0xA7AB, 0xA7AB, -42319, 1}, {0xA7AC, 0xA7AC, -42315, 1},
+    {0xA7AD, 0xA7AD, -42305, 1}, {0xA7AE, 0xA7AE, -42308, 1},
+    {0xA7B0, 0xA7B0, -42258, 1}, {0xA7B1, 0xA7B1, -42282, 1},
+    {0xA7B2, 0xA7B2, -42261, 1}, {0xA7B3, 0xA7B3, 928, 1},
+    {0xA7B4, 0xA7C2, 1, 2}, {0xA7C4, 0xA7C4, -48, 1},
+    {0xA7C5, 0xA7C5, -42307, 1}, {0xA7C6, 0xA7C6, -35384, 1},
+    {0xA7C7, 0xA7C9, 1, 2}, {0xA7D0, 0xA7D0, 1, 1}, {0xA7D6, 0xA7D8, 1, 2},
+    {0xA7F5, 0xA7F5, 1, 1}, {0xFF21, 0xFF3A, 32, 1}, {0x10400, 0x10427, 40, 1},
+    {0x104B0, 0x104D3, 40, 1}, {0x10570, 0x1057A, 39, 1},
+    {0x1057C, 0x1058A, 39, 1}, {0x1058C, 0x10592, 39, 1},
+    {0x10594, 0x10595, 39, 1}, {0x10C80, 0x10CB2, 64, 1},
+    {0x118A0, 0x118BF, 32, 1}, {0x16E40, 0x16E5F, 32, 1},
+    {0x1E900, 0x1E921, 34, 1},
+};
+
+/*
+ * Bit k is set iff some code point of U+kk00 - U+kkFF has a mapping above, so
+ * that most code points without case, such as CJK ones, skip the search.
+ */
+static const uint64_t rstring_internal_lower_blocks[8] = {
+    UINT64_C(0x00001012D009003F),
+    UINT64_C(0x0000000000000000),
+    UINT64_C(0x000000C000000000),
+    UINT64_C(0x8000000000000000),
+    UINT64_C(0x0000000001001030),
+    UINT64_C(0x0000400000000000),
+    UINT64_C(0x0000000000000000),
+    UINT64_C(0x0000020000000000),
+};
+
+/*----------------------------------------------------------------------------*/
+/* INTERNAL FUNCTIONS                                                         */
+/*----------------------------------------------------------------------------*/
+
+static inline uint64_t
+rstring_internal_utf8_read64(const uint8_t *p)
+{
+    uint64_t w;
+    memcpy(&w, p, sizeof(w));
+    return w;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Decodes the code point at |p|, of which |n| > 0 bytes are readable, checking
+ * the bytes against table 3-7 of the Unicode standard. Returns the length of
+ * the sequence, or 0 if it is not well-formed.
+ */
+static inline size_t
+rstring_internal_utf8_decode(const uint8_t *p, size_t n, uint32_t *cp)
+{
+    const uint8_t c = p[0];
+
+    if (c < 0x80)
+    {
+        *cp = c;
+        return 1;
+    }
+
+    if (c < 0xC2)
+    {
+        return 0;
+    }
+
+    if (c < 0xE0)
+    {
+        if (n < 2 || (p[1] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+
+        *cp = (uint32_t) (c & 0x1F) << 6 | (p[1] & 0x3F);
+        return 2;
+    }
+
+    if (c < 0xF0)
+    {
+        /* No overlong encodings, no surrogates */
+        const uint8_t lo = c == 0xE0 ? 0xA0 : 0x80;
+        const uint8_t hi = c == 0xED ? 0x9F : 0xBF;
+
+        if (n < 3 || p[1] < lo || p[1] > hi || (p[2] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+
+        *cp = (uint32_t) (c & 0x0F) << 12 | (uint32_t) (p[1] & 0x3F) << 6
+            | (p[2] & 0x3F);
+        return 3;
+    }
+
+    if (c < 0xF5)
+    {
+        /* No overlong encodings, nothing above U+10FFFF */
+        const uint8_t lo = c == 0xF0 ? 0x90 : 0x80;
+        const uint8_t hi = c == 0xF4 ? 0x8F : 0xBF;
+
+        if (n < 4 || p[1] < lo || p[1] > hi || (p[2] & 0xC0) != 0x80
+            || (p[3] & 0xC0) != 0x80)
+        {
+            return 0;
+        }
+
+        *cp = (uint32_t) (c & 0x07) << 18 | (uint32_t) (p[1] & 0x3F) << 12
+            | (uint32_t) (p[2] & 0x3F) << 6 | (p[3] & 0x3F);
+        return 4;
+    }
+
+    return 0;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Number of bytes of the UTF-8 encoding of |cp| */
+static inline size_t
+rstring_internal_utf8_len(uint32_t cp)
+{
+    return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Writes the UTF-8 encoding of |cp| to |out|, returns its length */
+static inline size_t
+rstring_internal_utf8_encode(uint32_t cp, uint8_t *out)
+{
+    if (cp < 0x80)
+    {
+        out[0] = (uint8_t) cp;
+        return 1;
+    }
+
+    if (cp < 0x800)
+    {
+        out[0] = (uint8_t) (0xC0 | cp >> 6);
+        out[1] = (uint8_t) (0x80 | (cp & 0x3F));
+        return 2;
+    }
+
+    if (cp < 0x10000)
+    {
+        out[0] = (uint8_t) (0xE0 | cp >> 12);
+        out[1] = (uint8_t) (0x80 | (cp >> 6 & 0x3F));
+        out[2] = (uint8_t) (0x80 | (cp & 0x3F));
+        return 3;
+    }
+
+    out[0] = (uint8_t) (0xF0 | cp >> 18);
+    out[1] = (uint8_t) (0x80 | (cp >> 12 & 0x3F));
+    out[2] = (uint8_t) (0x80 | (cp >> 6 & 0x3F));
+    out[3] = (uint8_t) (0x80 | (cp & 0x3F));
+    return 4;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* Simple lower case mapping of |cp|, which is not ASCII */
+static uint32_t
+rstring_internal_utf8_lower(uint32_t cp)
+{
+    const size_t n = sizeof(rstring_internal_lower_runs)
+                   / sizeof(rstring_internal_lower_runs[0]);
+    size_t       lo = 0;
+    size_t       hi = n;
+
+    const uint32_t block = cp >> 8;
+
+    if (block >= 8 * 64
+        || !(rstring_internal_lower_blocks[block / 64] >> (block % 64) & 1))
+    {
+        return cp;
+    }
+
+    /* The last run starting at or before |cp| */
+    while (hi - lo > 1)
+    {
+        const size_t mid = lo + (hi - lo) / 2;
+
+        if (rstring_internal_lower_runs[mid].first <= cp)
+        {
+            lo = mid;
+        }
+        else
+        {
+            hi = mid;
+        }
+    }
+
+    const struct rstring_internal_lower_run *run =
+        &rstring_internal_lower_runs[lo];
+
+    if (cp < run->first || cp > run->last
+        || (cp - run->first) % run->stride != 0)
+    {
+        return cp;
+    }
+
+    return (uint32_t) ((int32_t) cp + run->delta);
+}
+
+/*----------------------------------------------------------------------------*/
+/* VALIDATION KERNELS                                                         */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Every kernel takes |n| bytes at |p| and returns whether they are valid
+ * UTF-8. The scalar kernel decodes code point by code point, after skipping
+ * ASCII 8 bytes at a time.
+ */
+static bool
+rstring_internal_validate_scalar(const uint8_t *p, size_t n)
+{
+    size_t i = 0;
+
+    while (i < n)
+    {
+        if (i + 8 <= n
+            && (rstring_internal_utf8_read64(p + i) & UTF8_HIGHS) == 0)
+        {
+            i += 8;
+            continue;
+        }
+
+        uint32_t     cp;
+        const size_t len = rstring_internal_utf8_decode(p + i, n - i, &cp);
+
+        if (len == 0)
+        {
+            return false;
+        }
+
+        i += len;
+    }
+
+    return true;
+}
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef RSTRING_HAVE_X86_SIMD
+
+/* Indexed by the high nibble of the first byte of a pair */
+static const uint8_t rstring_internal_utf8_byte_1_high[16] = {
+    /* 0_______: ASCII */
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG, UTF8_TOO_LONG,
+    /* 10______: continuation */
+    UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS, UTF8_TWO_CONTS,
+    /* 1100____, 1101____: 2-byte lead */
+    UTF8_TOO_SHORT | UTF8_OVERLONG_2,
+    UTF8_TOO_SHORT,
+    /* 1110____: 3-byte lead */
+    UTF8_TOO_SHORT | UTF8_OVERLONG_3 | UTF8_SURROGATE,
+    /* 1111____: 4-byte lead */
+    UTF8_TOO_SHORT | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+};
+
+/* Indexed by the low nibble of the first byte of a pair */
+static const uint8_t rstring_internal_utf8_byte_1_low[16] = {
+    UTF8_CARRY | UTF8_OVERLONG_3 | UTF8_OVERLONG_2 | UTF8_OVERLONG_4,
+    UTF8_CARRY | UTF8_OVERLONG_2,
+    UTF8_CARRY,
+    UTF8_CARRY,
+    UTF8_CARRY | UTF8_TOO_LARGE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000 | UTF8_SURROGATE,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+    UTF8_CARRY | UTF8_TOO_LARGE | UTF8_TOO_LARGE_1000,
+};
+
+/* Indexed by the high nibble of the second byte of a pair */
+static const uint8_t rstring_internal_utf8_byte_2_high[16] = {
+    /* 0_______: ASCII */
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+    /* 1000____ */
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3
+        | UTF8_TOO_LARGE_1000 | UTF8_OVERLONG_4,
+    /* 1001____ */
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_OVERLONG_3
+        | UTF8_TOO_LARGE,
+    /* 101_____ */
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE
+        | UTF8_TOO_LARGE,
+    UTF8_TOO_LONG | UTF8_OVERLONG_2 | UTF8_TWO_CONTS | UTF8_SURROGATE
+        | UTF8_TOO_LARGE,
+    /* 11______: lead */
+    UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT, UTF8_TOO_SHORT,
+};
+
+/*
+ * Subtracted with saturation from the last bytes of a block, leaves a non-zero
+ * byte iff a sequence starting there does not end in the block.
+ */
+static const uint8_t rstring_internal_utf8_incomplete[32] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF,
+};
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * State carried from block to block: the previous block, which supplies the
+ * bytes before the first ones of a block, and whether it ended in the middle
+ * of a sequence. Errors accumulate in |error|, checked once at the end.
+ */
+struct rstring_internal_utf8_state_sse
+{
+    __m128i prev;
+    __m128i prev_incomplete;
+    __m128i error;
+};
+
+__attribute__((target("ssse3"), always_inline)) static inline void
+rstring_internal_utf8_block_ssse3(struct rstring_internal_utf8_state_sse *st,
+                                  __m128i input)
+{
+    if (_mm_movemask_epi8(input) == 0)
+    {
+        /* An ASCII block is only wrong if the previous block was cut short */
+        st->error           = _mm_or_si128(st->error, st->prev_incomplete);
+        st->prev_incomplete = _mm_setzero_si128();
+        st->prev            = input;
+        return;
+    }
+
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i prev1  = _mm_alignr_epi8(input, st->prev, 15);
+    const __m128i prev2  = _mm_alignr_epi8(input, st->prev, 14);
+    const __m128i prev3  = _mm_alignr_epi8(input, st->prev, 13);
+
+    /* Errors within each pair of bytes */
+    const __m128i byte_1_high = _mm_shuffle_epi8(
+        _mm_loadu_si128((const __m128i *) rstring_internal_utf8_byte_1_high),
+        _mm_and_si128(_mm_srli_epi16(prev1, 4), nibble));
+    const __m128i byte_1_low = _mm_shuffle_epi8(
+        _mm_loadu_si128((const __m128i *) rstring_internal_utf8_byte_1_low),
+        _mm_and_si128(prev1, nibble));
+    const __m128i byte_2_high = _mm_shuffle_epi8(
+        _mm_loadu_si128((const __m128i *) rstring_internal_utf8_byte_2_high),
+        _mm_and_si128(_mm_srli_epi16(input, 4), nibble));
+    const __m128i special =
+        _mm_and_si128(_mm_and_si128(byte_1_high, byte_1_low), byte_2_high);
+
+    /*
+     * Pairs of continuations are errors, unless a 3-byte lead is 2 bytes back
+     * or a 4-byte lead 3 bytes back: the high bit of |must23| says so, and
+     * both cancel out. One without the other is an error.
+     */
+    const __m128i must23 =
+        _mm_or_si128(_mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80)),
+                     _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80)));
+    const __m128i must23_80 = _mm_and_si128(must23, _mm_set1_epi8((char) 0x80));
+
+    st->error = _mm_or_si128(st->error, _mm_xor_si128(must23_80, special));
+    st->prev_incomplete = _mm_subs_epu8(
+        input,
+        _mm_loadu_si128(
+            (const __m128i *) (rstring_internal_utf8_incomplete + 16)));
+    st->prev = input;
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("ssse3"))) static bool
+rstring_internal_validate_ssse3(const uint8_t *p, size_t n)
+{
+    struct rstring_internal_utf8_state_sse st;
+    size_t                                 i = 0;
+
+    st.prev            = _mm_setzero_si128();
+    st.prev_incomplete = _mm_setzero_si128();
+    st.error           = _mm_setzero_si128();
+
+    for (; i + 16 <= n; i += 16)
+    {
+        rstring_internal_utf8_block_ssse3(
+            &st, _mm_loadu_si128((const __m128i *) (p + i)));
+    }
+
+    /* The tail is padded with zeros, which end any sequence cut short */
+    if (i < n)
+    {
+        uint8_t tail[16];
+
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, p + i, n - i);
+        rstring_internal_utf8_block_ssse3(
+            &st, _mm_loadu_si128((const __m128i *) tail));
+    }
+
+    const __m128i error = _mm_or_si128(st.error, st.prev_incomplete);
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128()))
+        == 0xFFFF;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* The SSSE3 block kernel on 32 bytes, see there */
+struct rstring_internal_utf8_state_avx
+{
+    __m256i prev;
+    __m256i prev_incomplete;
+    __m256i error;
+};
+
+__attribute__((target("avx2"), always_inline)) static inline void
+rstring_internal_utf8_block_avx2(struct rstring_internal_utf8_state_avx *st,
+                                 __m256i input)
+{
+    if (_mm256_movemask_epi8(input) == 0)
+    {
+        st->error = _mm256_or_si256(st->error, st->prev_incomplete);
+        st->prev_incomplete = _mm256_setzero_si256();
+        st->prev            = input;
+        return;
+    }
+
+    /*
+     * Shuffles only work within 128-bit lanes: the bytes before the high lane
+     * are the low lane of |input|, the ones before the low lane the high lane
+     * of the previous block.
+     */
+    const __m256i nibble = _mm256_set1_epi8(0x0F);
+    const __m256i before = _mm256_permute2x128_si256(st->prev, input, 0x21);
+    const __m256i prev1  = _mm256_alignr_epi8(input, before, 15);
+    const __m256i prev2  = _mm256_alignr_epi8(input, before, 14);
+    const __m256i prev3  = _mm256_alignr_epi8(input, before, 13);
+
+    const __m256i byte_1_high = _mm256_shuffle_epi8(
+        _mm256_broadcastsi128_si256(_mm_loadu_si128(
+            (const __m128i *) rstring_internal_utf8_byte_1_high)),
+        _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble));
+    const __m256i byte_1_low = _mm256_shuffle_epi8(
+        _mm256_broadcastsi128_si256(_mm_loadu_si128(
+            (const __m128i *) rstring_internal_utf8_byte_1_low)),
+        _mm256_and_si256(prev1, nibble));
+    const __m256i byte_2_high = _mm256_shuffle_epi8(
+        _mm256_broadcastsi128_si256(_mm_loadu_si128(
+            (const __m128i *) rstring_internal_utf8_byte_2_high)),
+        _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble));
+    const __m256i special = _mm256_and_si256(
+        _mm256_and_si256(byte_1_high, byte_1_low), byte_2_high);
+
+    const __m256i must23 = _mm256_or_si256(
+        _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xE0 - 0x80)),
+        _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xF0 - 0x80)));
+    const __m256i must23_80 =
+        _mm256_and_si256(must23, _mm256_set1_epi8((char) 0x80));
+
+    st->error =
+        _mm256_or_si256(st->error, _mm256_xor_si256(must23_80, special));
+    st->prev_incomplete = _mm256_subs_epu8(
+        input,
+        _mm256_loadu_si256((const __m256i *) rstring_internal_utf8_incomplete));
+    st->prev = input;
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("avx2"))) static bool
+rstring_internal_validate_avx2(const uint8_t *p, size_t n)
+{
+    struct rstring_internal_utf8_state_avx st;
+    size_t                                 i = 0;
+
+    st.prev            = _mm256_setzero_si256();
+    st.prev_incomplete = _mm256_setzero_si256();
+    st.error           = _mm256_setzero_si256();
+
+    for (; i + 32 <= n; i += 32)
+    {
+        rstring_internal_utf8_block_avx2(
+            &st, _mm256_loadu_si256((const __m256i *) (p + i)));
+    }
+
+    if (i < n)
+    {
+        uint8_t tail[32];
+
+        memset(tail, 0, sizeof(tail));
+        memcpy(tail, p + i, n - i);
+        rstring_internal_utf8_block_avx2(
+            &st, _mm256_loadu_si256((const __m256i *) tail));
+    }
+
+    const __m256i error = _mm256_or_si256(st.error, st.prev_incomplete);
+    return _mm256_testz_si256(error, error);
+}
+#endif /* RSTRING_HAVE_X86_SIMD */
+
+/*----------------------------------------------------------------------------*/
+
+static bool
+rstring_internal_validate_resolve(const uint8_t *p, size_t n);
+
+/* Selected on first use, like the search kernels of rstring.c */
+static rstring_internal_validate_fn rstring_internal_validate =
+    rstring_internal_validate_resolve;
+
+static bool
+rstring_internal_validate_resolve(const uint8_t *p, size_t n)
+{
+    rstring_internal_validate_fn fn = rstring_internal_validate_scalar;
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+    {
+        fn = rstring_internal_validate_avx2;
+    }
+    else if (__builtin_cpu_supports("ssse3"))
+    {
+        fn = rstring_internal_validate_ssse3;
+    }
+#endif
+
+    KERNEL_STORE(rstring_internal_validate, fn);
+    return fn(p, n);
+}
+
+/*----------------------------------------------------------------------------*/
+/* COUNTING KERNELS                                                           */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Every kernel counts the bytes of |p| which are not continuation bytes, one
+ * per code point; with |utf16|, also the 4-byte leads, whose code points take
+ * two UTF-16 units.
+ */
+static size_t
+rstring_internal_count_scalar(const uint8_t *p, size_t n, bool utf16)
+{
+    size_t count = 0;
+    size_t i     = 0;
+
+    for (; i + 8 <= n; i += 8)
+    {
+        const uint64_t w = rstring_internal_utf8_read64(p + i);
+
+        /* The low bit of each byte tells whether it is 10______, or 1111____.
+         * Multiplying by UTF8_ONES sums the bytes into the top one. */
+        const uint64_t conts = (w >> 7) & ~(w >> 6) & UTF8_ONES;
+        count += 8 - (size_t) ((conts * UTF8_ONES) >> 56);
+
+        if (utf16)
+        {
+            const uint64_t leads =
+                (w >> 7) & (w >> 6) & (w >> 5) & (w >> 4) & UTF8_ONES;
+            count += (size_t) ((leads * UTF8_ONES) >> 56);
+        }
+    }
+
+    for (; i < n; ++i)
+    {
+        count += (p[i] & 0xC0) != 0x80;
+        count += utf16 && p[i] >= 0xF0;
+    }
+
+    return count;
+}
+
+/*----------------------------------------------------------------------------*/
+
+#ifdef RSTRING_HAVE_X86_SIMD
+/*
+ * Bytes above -65 as signed are the ones which are not 10______. Matches are
+ * subtracted from byte counters, which are summed by sad_epu8 before they
+ * overflow, every 255 blocks.
+ */
+static size_t
+rstring_internal_count_sse2(const uint8_t *p, size_t n, bool utf16)
+{
+    const __m128i cont  = _mm_set1_epi8(-65);
+    const __m128i lead4 = _mm_set1_epi8((char) 0xF0);
+    const __m128i zero  = _mm_setzero_si128();
+    size_t        count = 0;
+    size_t        i     = 0;
+
+    while (n - i >= 16)
+    {
+        const size_t blocks = (n - i) / 16 < 255 ? (n - i) / 16 : 255;
+        __m128i      acc    = zero;
+
+        for (size_t b = 0; b < blocks; ++b, i += 16)
+        {
+            const __m128i c = _mm_loadu_si128((const __m128i *) (p + i));
+
+            acc = _mm_sub_epi8(acc, _mm_cmpgt_epi8(c, cont));
+            if (utf16)
+            {
+                acc = _mm_sub_epi8(
+                    acc, _mm_cmpeq_epi8(_mm_max_epu8(c, lead4), c));
+            }
+        }
+
+        const __m128i sums = _mm_sad_epu8(acc, zero);
+        count += (size_t) _mm_cvtsi128_si64(sums)
+               + (size_t) _mm_cvtsi128_si64(_mm_unpackhi_epi64(sums, sums));
+    }
+
+    return count + rstring_internal_count_scalar(p + i, n - i, utf16);
+}
+
+/*----------------------------------------------------------------------------*/
+
+__attribute__((target("avx2"))) static size_t
+rstring_internal_count_avx2(const uint8_t *p, size_t n, bool utf16)
+{
+    const __m256i cont  = _mm256_set1_epi8(-65);
+    const __m256i lead4 = _mm256_set1_epi8((char) 0xF0);
+    const __m256i zero  = _mm256_setzero_si256();
+    size_t        count = 0;
+    size_t        i     = 0;
+
+    while (n - i >= 32)
+    {
+        const size_t blocks = (n - i) / 32 < 255 ? (n - i) / 32 : 255;
+        __m256i      acc    = zero;
+
+        for (size_t b = 0; b < blocks; ++b, i += 32)
+        {
+            const __m256i c = _mm256_loadu_si256((const __m256i *) (p + i));
+
+            acc = _mm256_sub_epi8(acc, _mm256_cmpgt_epi8(c, cont));
+            if (utf16)
+            {
+                acc = _mm256_sub_epi8(
+                    acc, _mm256_cmpeq_epi8(_mm256_max_epu8(c, lead4), c));
+            }
+        }
+
+        const __m256i sums = _mm256_sad_epu8(acc, zero);
+        count += (size_t) _mm256_extract_epi64(sums, 0)
+               + (size_t) _mm256_extract_epi64(sums, 1)
+               + (size_t) _mm256_extract_epi64(sums, 2)
+               + (size_t) _mm256_extract_epi64(sums, 3);
+    }
+
+    /* Leaving AVX before the SSE2 kernel avoids stalling on the transition */
+    _mm256_zeroupper();
+    return count + rstring_internal_count_sse2(p + i, n - i, utf16);
+}
+#endif /* RSTRING_HAVE_X86_SIMD */
+
+/*----------------------------------------------------------------------------*/
+
+static size_t
+rstring_internal_count_resolve(const uint8_t *p, size_t n, bool utf16);
+
+/* Selected on first use, like rstring_internal_validate */
+static rstring_internal_count_fn rstring_internal_count =
+    rstring_internal_count_resolve;
+
+static size_t
+rstring_internal_count_resolve(const uint8_t *p, size_t n, bool utf16)
+{
+    rstring_internal_count_fn fn = rstring_internal_count_scalar;
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    __builtin_cpu_init();
+    fn = __builtin_cpu_supports("avx2") ? rstring_internal_count_avx2
+                                        : rstring_internal_count_sse2;
+#endif
+
+    KERNEL_STORE(rstring_internal_count, fn);
+    return fn(p, n, utf16);
+}
+
+/*----------------------------------------------------------------------------*/
+/* CONVERSIONS                                                                */
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Number of ASCII bytes at the start of |p|, of |n| bytes, counted 16 at a
+ * time; the byte after them, if any, may still be ASCII.
+ */
+static inline size_t
+rstring_internal_utf8_ascii_blocks(const uint8_t *p, size_t n)
+{
+    size_t i = 0;
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    while (i + 16 <= n
+           && _mm_movemask_epi8(_mm_loadu_si128((const __m128i *) (p + i)))
+                  == 0)
+    {
+        i += 16;
+    }
+#else
+    while (i + 8 <= n
+           && (rstring_internal_utf8_read64(p + i) & UTF8_HIGHS) == 0)
+    {
+        i += 8;
+    }
+#endif
+
+    return i;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Widen the ASCII bytes at the start of |p|, of |n| bytes, to |out|, a block
+ * at a time. Returns how many were written; the byte after them, if any, may
+ * still be ASCII.
+ */
+static inline size_t
+rstring_internal_ascii_to_utf16(const uint8_t *p, size_t n, uint16_t *out)
+{
+    size_t i = 0;
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i c = _mm_loadu_si128((const __m128i *) (p + i));
+
+        if (_mm_movemask_epi8(c) != 0)
+        {
+            break;
+        }
+
+        _mm_storeu_si128((__m128i *) (out + i),
+                         _mm_unpacklo_epi8(c, _mm_setzero_si128()));
+        _mm_storeu_si128((__m128i *) (out + i + 8),
+                         _mm_unpackhi_epi8(c, _mm_setzero_si128()));
+    }
+#else
+    for (; i + 8 <= n
+           && (rstring_internal_utf8_read64(p + i) & UTF8_HIGHS) == 0;
+         i += 8)
+    {
+        for (size_t k = 0; k < 8; ++k)
+        {
+            out[i + k] = p[i + k];
+        }
+    }
+#endif
+
+    return i;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/* UTF-32 variant of rstring_internal_ascii_to_utf16 */
+static inline size_t
+rstring_internal_ascii_to_utf32(const uint8_t *p, size_t n, uint32_t *out)
+{
+    size_t i = 0;
+
+#ifdef RSTRING_HAVE_X86_SIMD
+    for (; i + 16 <= n; i += 16)
+    {
+        const __m128i c = _mm_loadu_si128((const __m128i *) (p + i));
+        const __m128i z = _mm_setzero_si128();
+
+        if (_mm_movemask_epi8(c) != 0)
+        {
+            break;
+        }
+
+        const __m128i lo = _mm_unpacklo_epi8(c, z);
+        const __m128i hi = _mm_unpackhi_epi8(c, z);
+
+        _mm_storeu_si128((__m128i *) (out + i), _mm_unpacklo_epi16(lo, z));
+        _mm_storeu_si128((__m128i *) (out + i + 4), _mm_unpackhi_epi16(lo, z));
+        _mm_storeu_si128((__m128i *) (out + i + 8), _mm_unpacklo_epi16(hi, z));
+        _mm_storeu_si128((__m128i *) (out + i + 12),
+                         _mm_unpackhi_epi16(hi, z));
+    }
+#else
+    for (; i + 8 <= n
+           && (rstring_internal_utf8_read64(p + i) & UTF8_HIGHS) == 0;
+         i += 8)
+    {
+        for (size_t k = 0; k < 8; ++k)
+        {
+            out[i + k] = p[i + k];
+        }
+    }
+#endif
+
+    return i;
+}
+
+/*----------------------------------------------------------------------------*/
+
+/*
+ * Writes |cp| to |out| as UTF-16, returns the number of units. Code points
+ * above U+FFFF take a pair of surrogates.
+ */
+static inline size_t
+rstring_internal_utf16_encode(uint32_t cp, uint16_t *out)
+{
+    if (cp < 0x10000)
+    {
+        out[0] = (uint16_t) cp;
+        return 1;
+    }
+
+    cp -= 0x10000;
+    out[0] = (uint16_t) (0xD800 | cp >> 10);
+    out[1] = (uint16_t) (0xDC00 | (cp & 0x3FF));
+    return 2;
+}
+
+/*----------------------------------------------------------------------------*/
+/* PUBLIC FUNCTIONS                                                           */
+/*----------------------------------------------------------------------------*/
+
+bool
+rstring_utf8_validate(const struct rstring *rs)
+{
+    return rstring_utf8_validate_view(rstring_view_from(rs));
+}
+
+/*----------------------------------------------------------------------------*/
+
+bool
+rstring_utf8_validate_view(struct rstring_view view)
+{
+    return KERNEL_LOAD(rstring_internal_validate)(
+        (const uint8_t *) view.ptr, view.len);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_utf8_count(const struct rstring *rs)
+{
+    return rstring_utf8_count_view(rstring_view_from(rs));
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_utf8_count_view(struct rstring_view view)
+{
+    return KERNEL_LOAD(rstring_internal_count)(
+        (const uint8_t *) view.ptr, view.len, false);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_utf8_count_utf16(const struct rstring *rs)
+{
+    return rstring_utf8_count_utf16_view(rstring_view_from(rs));
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_utf8_count_utf16_view(struct rstring_view view)
+{
+    return KERNEL_LOAD(rstring_internal_count)(
+        (const uint8_t *) view.ptr, view.len, true);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_utf8_to_utf16(const struct rstring *rs, uint16_t *out)
+{
+    return rstring_utf8_to_utf16_view(rstring_view_from(rs), out);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_utf8_to_utf16_view(struct rstring_view view, uint16_t *out)
+{
+    const uint8_t *p       = (const uint8_t *) view.ptr;
+    size_t         i       = 0;
+    size_t         written = 0;
+
+    while (i < view.len)
+    {
+        if (p[i] < 0x80)
+        {
+            const size_t ascii = rstring_internal_ascii_to_utf16(
+                p + i, view.len - i, out + written);
+
+            written += ascii;
+            i += ascii;
+            if (ascii > 0)
+            {
+                continue;
+            }
+        }
+
+        uint32_t     cp;
+        const size_t len =
+            rstring_internal_utf8_decode(p + i, view.len - i, &cp);
+
+        if (len == 0)
+        {
+            return RSTRING_UTF8_INVALID;
+        }
+
+        written += rstring_internal_utf16_encode(cp, out + written);
+        i += len;
+    }
+
+    return written;
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_utf8_to_utf32(const struct rstring *rs, uint32_t *out)
+{
+    return rstring_utf8_to_utf32_view(rstring_view_from(rs), out);
+}
+
+/*----------------------------------------------------------------------------*/
+
+size_t
+rstring_utf8_to_utf32_view(struct rstring_view view, uint32_t *out)
+{
+    const uint8_t *p       = (const uint8_t *) view.ptr;
+    size_t         i       = 0;
+    size_t         written = 0;
+
+    while (i < view.len)
+    {
+        if (p[i] < 0x80)
+        {
+            const size_t ascii = rstring_internal_ascii_to_utf32(
+                p + i, view.len - i, out + written);
+
+            written += ascii;
+            i += ascii;
+            if (ascii > 0)
+            {
+                continue;
+            }
+        }
+
+        uint32_t     cp;
+        const size_t len =
+            rstring_internal_utf8_decode(p + i, view.len - i, &cp);
+
+        if (len == 0)
+        {
+            return RSTRING_UTF8_INVALID;
+        }
+
+        out[written++] = cp;
+        i += len;
+    }
+
+    return written;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_utf16(struct rstring *rs, const uint16_t *units, size_t n)
+{
+    /* Validates and measures, so that |rs| is only touched on success */
+    size_t total = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const uint16_t u = units[i];
+
+        if ((unsigned) (u - 0xD800) >= 0x800)
+        {
+            total += u < 0x80 ? 1 : u < 0x800 ? 2 : 3;
+        }
+        else if (u < 0xDC00 && i + 1 < n
+                 && (unsigned) (units[i + 1] - 0xDC00) < 0x400)
+        {
+            total += 4;
+            ++i;
+        }
+        else
+        {
+            return RSTRING_ERROR_ENCODING;
+        }
+    }
+
+    ENSURE_CAPACITY(rs, rs->len + total + 1);
+
+    uint8_t *out = (uint8_t *) rstring_internal_data(rs) + rs->len;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        uint32_t cp = units[i];
+
+        if ((unsigned) (cp - 0xD800) < 0x800)
+        {
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (units[++i] - 0xDC00U);
+        }
+
+        out += rstring_internal_utf8_encode(cp, out);
+    }
+
+    rs->len += total;
+    *out = '\0';
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_push_utf32(struct rstring *rs, const uint32_t *cps, size_t n)
+{
+    size_t total = 0;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (cps[i] > 0x10FFFF || (cps[i] - 0xD800U) < 0x800)
+        {
+            return RSTRING_ERROR_ENCODING;
+        }
+
+        total += rstring_internal_utf8_len(cps[i]);
+    }
+
+    ENSURE_CAPACITY(rs, rs->len + total + 1);
+
+    uint8_t *out = (uint8_t *) rstring_internal_data(rs) + rs->len;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        out += rstring_internal_utf8_encode(cps[i], out);
+    }
+
+    rs->len += total;
+    *out = '\0';
+    return RSTRING_OK;
+}
+
+/*----------------------------------------------------------------------------*/
+
+rstring_status_t
+rstring_utf8_tolower(struct rstring *rs)
+{
+    rstring_tolower(rs);
+
+    uint8_t *data = (uint8_t *) rstring_internal_data(rs);
+    size_t   i    = 0;
+
+    /* Same-length mappings are written over the original bytes */
+    while (i < rs->len)
+    {
+        i += rstring_internal_utf8_ascii_blocks(data + i, rs->len - i);
+        if (i == rs->len)
+        {
+            break;
+        }
+
+        uint32_t     cp;
+        const size_t len = rstring_internal_utf8_decode(data + i, rs->len - i,
+                                                        &cp);
+
+        if (len <= 1)
+        {
+            /* ASCII, done already, or an invalid byte kept as is */
+            i++;
+            continue;
+        }
+
+        const uint32_t lower = rstring_internal_utf8_lower(cp);
+
+        if (rstring_internal_utf8_len(lower) != len)
+        {
+            break;
+        }
+
+        rstring_internal_utf8_encode(lower, data + i);
+        i += len;
+    }
+
+    if (i == rs->len)
+    {
+        return RSTRING_OK;
+    }
+
+    /*
+     * The rest goes to a new buffer. Only 2-byte code points grow, to 3 bytes,
+     * which bounds the size of the result.
+     */
+    struct rstring out;
+    const size_t   rest = rs->len - i;
+
+    rstring_init_with_allocator(&out, rs->allocator);
+    rstring_status_t rc = rstring_reserve_exact(&out, i + rest + rest / 2 + 1);
+    if (rc != RSTRING_OK)
+    {
+        return rc;
+    }
+
+    uint8_t *dst = (uint8_t *) rstring_internal_data(&out);
+    size_t   o   = i;
+
+    memcpy(dst, data, i);
+
+    while (i < rs->len)
+    {
+        uint32_t     cp;
+        const size_t len = rstring_internal_utf8_decode(data + i, rs->len - i,
+                                                        &cp);
+
+        if (len <= 1)
+        {
+            dst[o++] = data[i++];
+            continue;
+        }
+
+        o += rstring_internal_utf8_encode(rstring_internal_utf8_lower(cp),
+                                          dst + o);
+        i += len;
+    }
+
+    dst[o]  = '\0';
+    out.len = o;
+
+    rstring_free(rs);
+    *rs = out;
+    return RSTRING_OK;
+}
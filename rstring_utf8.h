@@ -0,0 +1,191 @@
+/*
+ * Copyright (c) 2025, Ron Shabi <ron@ronsh.net>
+ * SPDX-License-Identifier: MIT
+ */
+
+#ifndef RSTRING_UTF8_H
+#define RSTRING_UTF8_H
+
+#include <stdbool.h> /* bool */
+#include <stdint.h>  /* uint16_t, uint32_t, SIZE_MAX */
+
+#include "rstring.h"
+
+/*
+ * Returned by the conversions from UTF-8 when the input is not valid UTF-8.
+ */
+#define RSTRING_UTF8_INVALID (SIZE_MAX)
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Checks whether the contents of an rstring are valid UTF-8.
+ *
+ * Valid means well-formed as defined by Unicode: no overlong encodings, no
+ * surrogates, nothing above U+10FFFF and no truncated sequences. On x86-64,
+ * an SSSE3 or AVX2 kernel is selected at runtime, which checks a whole block
+ * of bytes at once with nibble lookup tables, and skips ASCII blocks.
+ *
+ * @param rs Pointer to the rstring to check.
+ * @return true if the contents are valid UTF-8. An empty rstring is.
+ */
+bool
+rstring_utf8_validate(const struct rstring *rs);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_utf8_validate.
+ */
+bool
+rstring_utf8_validate_view(struct rstring_view view);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Counts the code points of valid UTF-8 contents.
+ *
+ * Every byte which is not a continuation byte starts a code point. The input
+ * is not validated: invalid UTF-8 gives a count which is meaningless, but
+ * harmless.
+ *
+ * @param rs Pointer to the rstring holding UTF-8.
+ * @return The number of code points.
+ */
+size_t
+rstring_utf8_count(const struct rstring *rs);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_utf8_count.
+ */
+size_t
+rstring_utf8_count_view(struct rstring_view view);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Counts the UTF-16 code units valid UTF-8 contents convert to.
+ *
+ * Meant to size the output of `rstring_utf8_to_utf16`; code points above
+ * U+FFFF take two units. The input is not validated, see
+ * `rstring_utf8_count`.
+ *
+ * @param rs Pointer to the rstring holding UTF-8.
+ * @return The number of UTF-16 code units.
+ */
+size_t
+rstring_utf8_count_utf16(const struct rstring *rs);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_utf8_count_utf16.
+ */
+size_t
+rstring_utf8_count_utf16_view(struct rstring_view view);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Converts UTF-8 contents to UTF-16, in the byte order of the host.
+ *
+ * The input is validated as it is converted, with runs of ASCII widened 16
+ * bytes at a time. No byte order mark is written.
+ *
+ * @param rs Pointer to the rstring holding UTF-8.
+ * @param out Buffer of at least `rstring_utf8_count_utf16` units; `rs->len`
+ * units are always enough.
+ * @return The number of code units written, or RSTRING_UTF8_INVALID if the
+ * contents are not valid UTF-8, in which case |out| holds a part of the
+ * result.
+ */
+size_t
+rstring_utf8_to_utf16(const struct rstring *rs, uint16_t *out);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_utf8_to_utf16.
+ */
+size_t
+rstring_utf8_to_utf16_view(struct rstring_view view, uint16_t *out);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Converts UTF-8 contents to UTF-32, in the byte order of the host.
+ *
+ * @param rs Pointer to the rstring holding UTF-8.
+ * @param out Buffer of at least `rstring_utf8_count` code points; `rs->len`
+ * code points are always enough.
+ * @return The number of code points written, or RSTRING_UTF8_INVALID, as
+ * rstring_utf8_to_utf16.
+ */
+size_t
+rstring_utf8_to_utf32(const struct rstring *rs, uint32_t *out);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief View variant of rstring_utf8_to_utf32.
+ */
+size_t
+rstring_utf8_to_utf32_view(struct rstring_view view, uint32_t *out);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Appends UTF-16 text to an rstring, converted to UTF-8.
+ *
+ * The length of the result is computed first, so that |rs| grows at most
+ * once.
+ *
+ * @param rs Pointer to the rstring to append to.
+ * @param units The UTF-16 code units, in the byte order of the host.
+ * @param n The number of code units.
+ * @return RSTRING_OK on success, RSTRING_ERROR_ENCODING if |units| holds an
+ * unpaired surrogate, or RSTRING_ERROR_ALLOC if memory allocation fails. On
+ * failure, |rs| is not modified.
+ */
+rstring_status_t
+rstring_push_utf16(struct rstring *rs, const uint16_t *units, size_t n);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Appends UTF-32 text to an rstring, converted to UTF-8.
+ *
+ * @param rs Pointer to the rstring to append to.
+ * @param cps The code points.
+ * @param n The number of code points.
+ * @return RSTRING_OK on success, RSTRING_ERROR_ENCODING if |cps| holds a
+ * surrogate or a value above U+10FFFF, or RSTRING_ERROR_ALLOC if memory
+ * allocation fails. On failure, |rs| is not modified.
+ */
+rstring_status_t
+rstring_push_utf32(struct rstring *rs, const uint32_t *cps, size_t n);
+
+/*----------------------------------------------------------------------------*/
+
+/**
+ * @brief Converts UTF-8 contents to lower case, in place.
+ *
+ * ASCII letters are converted first by `rstring_tolower`; every other code
+ * point is mapped with the simple lower case mappings of Unicode 14.0, which
+ * do not depend on the locale or on the surrounding text (so 'Σ' always
+ * becomes 'σ'). Bytes which are not valid UTF-8 are kept as is.
+ *
+ * A few mappings change the number of bytes of a code point, such as U+212A
+ * KELVIN SIGN to 'k'; only then is the string rebuilt into a new buffer.
+ *
+ * @param rs Pointer to the rstring to convert.
+ * @return RSTRING_OK on success, or RSTRING_ERROR_ALLOC if memory allocation
+ * fails, in which case |rs| holds valid contents of which only a part was
+ * converted.
+ */
+rstring_status_t
+rstring_utf8_tolower(struct rstring *rs);
+
+#endif /* RSTRING_UTF8_H */
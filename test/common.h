@@ -4,6 +4,7 @@
 #include <stdlib.h>
 
 #include <stdarg.h>
+#include <string.h>
 #include "../rstring.h"
 
 // Common function every test is most likely to use
@@ -23,3 +24,115 @@ test_fail(const char *testname, const char *fmt, ...)    // NOLINT
     printf("\n");
     exit(1);    // NOLINT (exit is not thread safe)
 }
+
+/* Replaces the contents of |rs| with |len| bytes picked from |alphabet| */
+static inline void
+random_fill(struct rstring *rs, const char *alphabet, size_t len)
+{
+    const size_t alphabet_len = strlen(alphabet);
+
+    rstring_clear(rs);
+    for (size_t i = 0; i < len; ++i)
+    {
+        const size_t pick = (size_t) rand() % alphabet_len;
+        rstring_push_byte(rs, (uint8_t) alphabet[pick]);
+    }
+}
+
+/*
+ * Calls received by a counting allocator, see COUNTING_ALLOCATOR, and the
+ * bytes it handed out which are not freed yet
+ */
+struct counting_allocator
+{
+    size_t allocs;
+    size_t reallocs;
+    size_t frees;
+    size_t live_bytes;
+};
+
+static inline void *
+counting_alloc(void *ctx, size_t size)
+{
+    struct counting_allocator *c = (struct counting_allocator *) ctx;
+
+    c->allocs++;
+    c->live_bytes += size;
+    return malloc(size);
+}
+
+static inline void *
+counting_realloc(void *ctx, void *ptr, size_t old_size, size_t new_size)
+{
+    struct counting_allocator *c = (struct counting_allocator *) ctx;
+
+    /* The library must give back the size it was handed */
+    if (old_size > c->live_bytes)
+    {
+        test_fail(__FUNCTION__, "realloc of %zu bytes, only %zu are live",
+                  old_size, c->live_bytes);
+    }
+
+    c->reallocs++;
+    c->live_bytes += new_size - old_size;
+    return realloc(ptr, new_size);
+}
+
+static inline void
+counting_free(void *ctx, void *ptr, size_t size)
+{
+    struct counting_allocator *c = (struct counting_allocator *) ctx;
+
+    c->frees++;
+    c->live_bytes -= size;
+    free(ptr);
+}
+
+/*
+ * Initializer of an rstring_allocator which forwards to the C library, and
+ * counts its calls in the struct counting_allocator |counts| points at
+ */
+#define COUNTING_ALLOCATOR(counts)                                             \
+    {                                                                          \
+        counting_alloc, counting_realloc, counting_free, (counts)              \
+    }
+
+/* Fails unless |rs| holds exactly |expected|, null-terminated */
+static inline void
+check_contents(const char *test_name, const struct rstring *rs,
+               const char *expected)
+{
+    if (rs == NULL)
+    {
+        test_fail(test_name, "no rstring, expected '%s'", expected);
+    }
+
+    if (rs->len != strlen(expected)
+        || memcmp(rstring_data(rs), expected, rs->len) != 0
+        || rstring_data(rs)[rs->len] != '\0')
+    {
+        test_fail(test_name,
+                  "contents are '%s' (len %zu), expected '%s'",
+                  rstring_data(rs),
+                  rs->len,
+                  expected);
+    }
+}
+
+/* Fails unless |rs| holds |len| bytes of the alphabet, repeated */
+static inline void
+check_alphabet(const char *test_name, const struct rstring *rs, size_t len)
+{
+    if (rs->len != len || rstring_data(rs)[len] != '\0')
+    {
+        test_fail(test_name, "length %zu, expected %zu", rs->len, len);
+    }
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        if (rstring_data(rs)[i] != (char) ('a' + i % 26))
+        {
+            test_fail(test_name, "wrong byte at offset %zu", i);
+        }
+    }
+}
@@ -16,11 +16,11 @@ main()
     rstring_push_byte(&x, 'l');
     rstring_push_byte(&x, 'o');
 
-    printf("rstring_push_byte: (%s)\n", x.data);
+    printf("rstring_push_byte: (%s)\n", rstring_data(&x));
 
     rstring_push_str(&x, " world!");
 
-    printf("rstring_push_str: (%s)\n", x.data);
+    printf("rstring_push_str: (%s)\n", rstring_data(&x));
 
     rstring_init(&y);
     rstring_push_str(&y, "hello world!");
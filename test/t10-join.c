@@ -0,0 +1,191 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static struct counting_allocator      counts;
+static const struct rstring_allocator counting = COUNTING_ALLOCATOR(&counts);
+
+static void
+push_many_test(void)
+{
+    const char *const words[] = {
+        "HTTP/1.1 200 OK\r\n", "Content-Type: text/plain\r\n", "\r\n", "body"};
+    struct rstring_view views[4];
+    struct rstring      pieces[4];
+    struct rstring      rs;
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        views[i] = rstring_view_from_str(words[i]);
+        rstring_init(&pieces[i]);
+        rstring_push_str(&pieces[i], words[i]);
+    }
+
+    const char *expected =
+        "HTTP/1.1 200 OK\r\nContent-Type: text/plain\r\n\r\nbody";
+    const size_t growths = strlen(expected) >= RSTRING_SSO_CAPACITY;
+
+    /* Each variant grows the string once, unless it fits inline */
+    rstring_init_with_allocator(&rs, &counting);
+    counts.allocs   = 0;
+    counts.reallocs = 0;
+    rstring_push_many_str(&rs, words, 4);
+    check_contents(__FUNCTION__, &rs, expected);
+    if (counts.allocs + counts.reallocs != growths)
+    {
+        test_fail(__FUNCTION__, "%zu allocations, expected %zu",
+                  counts.allocs + counts.reallocs, growths);
+    }
+    rstring_free(&rs);
+
+    counts.allocs   = 0;
+    counts.reallocs = 0;
+    rstring_push_many_view(&rs, views, 4);
+    check_contents(__FUNCTION__, &rs, expected);
+    rstring_free(&rs);
+
+    rstring_push_many(&rs, pieces, 4);
+    check_contents(__FUNCTION__, &rs, expected);
+    if (counts.allocs + counts.reallocs != 2 * growths)
+    {
+        test_fail(__FUNCTION__, "%zu allocations, expected %zu",
+                  counts.allocs + counts.reallocs, 2 * growths);
+    }
+
+    /* Appending nothing */
+    rstring_push_many(&rs, pieces, 0);
+    check_contents(__FUNCTION__, &rs, expected);
+    rstring_free(&rs);
+
+    /* More C strings than are measured on the stack, still one allocation */
+    const char *many[40];
+    char        many_expected[600] = "";
+    for (size_t i = 0; i < 40; ++i)
+    {
+        many[i] = words[i % 4];
+        strcat(many_expected, many[i]);
+    }
+    counts.allocs   = 0;
+    counts.reallocs = 0;
+    rstring_push_many_str(&rs, many, 40);
+    check_contents(__FUNCTION__, &rs, many_expected);
+    if (counts.allocs + counts.reallocs != 1)
+    {
+        test_fail(__FUNCTION__, "%zu allocations, expected 1",
+                  counts.allocs + counts.reallocs);
+    }
+    rstring_free(&rs);
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        rstring_free(&pieces[i]);
+    }
+}
+
+static void
+join_test(void)
+{
+    const char *const   words[] = {"alpha", "", "gamma"};
+    struct rstring_view views[3];
+    struct rstring      pieces[3];
+    struct rstring      sep = {0};
+    struct rstring      rs  = {0};
+
+    for (size_t i = 0; i < 3; ++i)
+    {
+        views[i] = rstring_view_from_str(words[i]);
+        rstring_init(&pieces[i]);
+        rstring_push_str(&pieces[i], words[i]);
+    }
+    rstring_push_str(&sep, ", ");
+
+    rstring_push_str(&rs, "[");
+    rstring_join_str(&rs, ", ", words, 3);
+    check_contents(__FUNCTION__, &rs, "[alpha, , gamma");
+    rstring_clear(&rs);
+
+    rstring_join(&rs, &sep, pieces, 3);
+    check_contents(__FUNCTION__, &rs, "alpha, , gamma");
+    rstring_clear(&rs);
+
+    rstring_join_view(&rs, rstring_view_from_str("--"), views, 3);
+    check_contents(__FUNCTION__, &rs, "alpha----gamma");
+    rstring_clear(&rs);
+
+    /* No separator around a single piece, nothing for no pieces */
+    rstring_join_str(&rs, ", ", words, 1);
+    rstring_join_str(&rs, ", ", words, 0);
+    check_contents(__FUNCTION__, &rs, "alpha");
+
+    rstring_free(&rs);
+    rstring_free(&sep);
+    for (size_t i = 0; i < 3; ++i)
+    {
+        rstring_free(&pieces[i]);
+    }
+}
+
+static void
+aliasing_test(void)
+{
+    struct rstring      rs = {0};
+    struct rstring      self[2];
+    struct rstring_view slices[2];
+    const char         *strs[40];
+
+    /* Joining a string with itself, while it moves from inline to the heap */
+    rstring_push_str(&rs, "0123456789");
+    self[0] = rs;
+    self[1] = rs;
+    rstring_join(&rs, &rs, self, 2);
+    check_contents(
+        __FUNCTION__, &rs, "0123456789012345678901234567890123456789");
+
+    slices[0] = rstring_slice(&rs, 0, 3);
+    slices[1] = rstring_slice(&rs, 37, 3);
+    rstring_push_many_view(&rs, slices, 2);
+    check_contents(
+        __FUNCTION__, &rs, "0123456789012345678901234567890123456789012789");
+
+    /* A heap string appended to itself, through a reallocation */
+    rstring_clear(&rs);
+    rstring_push_str(&rs, "0123456789012345678901234567890123456789");
+    rstring_push_many(&rs, &rs, 1);
+    check_contents(__FUNCTION__,
+                   &rs,
+                   "0123456789012345678901234567890123456789"
+                   "0123456789012345678901234567890123456789");
+
+    /* C strings ending at the terminator of |rs|, which the copy overwrites */
+    rstring_free(&rs);
+    rstring_push_str(&rs, "0123456789");
+    strs[0] = rstring_data(&rs) + 4;
+    strs[1] = rstring_data(&rs);
+    strs[2] = "x";
+    rstring_join_str(&rs, rstring_data(&rs) + 8, strs, 3);
+    check_contents(__FUNCTION__, &rs, "012345678945678989012345678989x");
+
+    /* More pieces than are measured on the stack */
+    struct rstring expected = {0};
+    rstring_push_str(&expected, rstring_data(&rs));
+    for (size_t i = 0; i < 40; ++i)
+    {
+        strs[i] = rstring_data(&rs) + rs.len - 3;
+        rstring_push_str(&expected, "89x");
+    }
+    rstring_push_many_str(&rs, strs, 40);
+    check_contents(__FUNCTION__, &rs, rstring_data(&expected));
+
+    rstring_free(&expected);
+    rstring_free(&rs);
+}
+
+int
+main()
+{
+    push_many_test();
+    join_test();
+    aliasing_test();
+    return 0;
+}
@@ -0,0 +1,304 @@
+#include <inttypes.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+static struct counting_allocator      counts;
+static const struct rstring_allocator counting = COUNTING_ALLOCATOR(&counts);
+
+static uint64_t
+random_u64(void)
+{
+    uint64_t v = 0;
+
+    for (int i = 0; i < 4; ++i)
+    {
+        v = (v << 16) ^ (uint64_t) (rand() & 0xFFFF);
+    }
+
+    return v;
+}
+
+static void
+fmt_test(void)
+{
+    struct rstring rs;
+    char           expected[512];
+
+    /* Fits in the inline buffer, unless it was configured smaller */
+    rstring_init(&rs);
+    rstring_push_str(&rs, "id=");
+    rstring_push_fmt(&rs, "%d,%s", 42, "ok");
+    check_contents(__FUNCTION__, &rs, "id=42,ok");
+    if (rs.len < RSTRING_SSO_CAPACITY && !rstring_is_inline(&rs))
+    {
+        test_fail(__FUNCTION__, "short text moved the rstring to the heap");
+    }
+
+    /* Outgrows it, and grows exactly once */
+    rstring_free(&rs);
+    rstring_init_with_allocator(&rs, &counting);
+    rstring_push_str(&rs, "metrics: ");
+    counts.allocs   = 0;
+    counts.reallocs = 0;
+    rstring_push_fmt(&rs, "%0300d|%s", 7, "end");
+    snprintf(expected, sizeof(expected), "metrics: %0300d|%s", 7, "end");
+    check_contents(__FUNCTION__, &rs, expected);
+    if (counts.allocs + counts.reallocs != 1)
+    {
+        test_fail(__FUNCTION__, "%zu allocations, expected 1",
+                  counts.allocs + counts.reallocs);
+    }
+
+    /* Fits in the spare capacity of a heap rstring, without growing */
+    rstring_clear(&rs);
+    counts.allocs   = 0;
+    counts.reallocs = 0;
+    rstring_push_fmt(&rs, "%s=%.3f", "load", 0.25);
+    check_contents(__FUNCTION__, &rs, "load=0.250");
+    if (counts.allocs + counts.reallocs != 0)
+    {
+        test_fail(__FUNCTION__, "%zu allocations, expected 0",
+                  counts.allocs + counts.reallocs);
+    }
+    rstring_free(&rs);
+
+    /* A zero-initialized rstring is valid */
+    struct rstring zero = {0};
+    rstring_push_fmt(&zero, "%s", "");
+    check_contents(__FUNCTION__, &zero, "");
+    rstring_push_fmt(&zero, "%c%c", 'a', 'b');
+    check_contents(__FUNCTION__, &zero, "ab");
+    rstring_free(&zero);
+
+    /* Many appends, crossing the capacity at every possible offset */
+    rstring_init(&rs);
+    size_t len = 0;
+    for (int i = 0; i < 200; ++i)
+    {
+        len += (size_t) snprintf(expected + len, sizeof(expected) - len,
+                                 "%d,", i * 7);
+        if (len >= 256)
+        {
+            break;
+        }
+        rstring_push_fmt(&rs, "%d,", i * 7);
+        check_contents(__FUNCTION__, &rs, expected);
+    }
+    rstring_free(&rs);
+}
+
+static void
+integer_test(void)
+{
+    static const uint64_t u64s[] = {
+        0, 1, 9, 10, 99, 100, 999, 1000, 9999, 10000, 123456789,
+        UINT32_MAX, (uint64_t) UINT32_MAX + 1, 9999999999999999999U,
+        10000000000000000000U, UINT64_MAX};
+    static const int64_t i64s[] = {
+        0, 1, -1, 9, -10, 100, -999, INT32_MIN, INT32_MAX, INT64_MAX,
+        INT64_MIN, INT64_MIN + 1};
+    char expected[64];
+
+    for (size_t i = 0; i < sizeof(u64s) / sizeof(u64s[0]); ++i)
+    {
+        struct rstring rs;
+        rstring_init(&rs);
+
+        rstring_push_u64(&rs, u64s[i]);
+        snprintf(expected, sizeof(expected), "%" PRIu64, u64s[i]);
+        check_contents(__FUNCTION__, &rs, expected);
+
+        rstring_clear(&rs);
+        rstring_push_hex(&rs, u64s[i]);
+        snprintf(expected, sizeof(expected), "%" PRIx64, u64s[i]);
+        check_contents(__FUNCTION__, &rs, expected);
+
+        rstring_free(&rs);
+    }
+
+    for (size_t i = 0; i < sizeof(i64s) / sizeof(i64s[0]); ++i)
+    {
+        struct rstring rs;
+        rstring_init(&rs);
+
+        rstring_push_i64(&rs, i64s[i]);
+        snprintf(expected, sizeof(expected), "%" PRId64, i64s[i]);
+        check_contents(__FUNCTION__, &rs, expected);
+
+        rstring_free(&rs);
+    }
+
+    /* Random values of every magnitude, appended after each other */
+    struct rstring rs;
+    char           all[4096];
+    size_t         len = 0;
+
+    rstring_init(&rs);
+    for (int i = 0; i < 64; ++i)
+    {
+        const uint64_t v = random_u64() >> (i % 64);
+
+        rstring_push_u64(&rs, v);
+        rstring_push_byte(&rs, ' ');
+        rstring_push_i64(&rs, (int64_t) v);
+        rstring_push_byte(&rs, ' ');
+        rstring_push_hex(&rs, v);
+        rstring_push_byte(&rs, '\n');
+        len += (size_t) snprintf(all + len, sizeof(all) - len,
+                                 "%" PRIu64 " %" PRId64 " %" PRIx64 "\n",
+                                 v, (int64_t) v, v);
+    }
+    check_contents(__FUNCTION__, &rs, all);
+    rstring_free(&rs);
+}
+
+static void
+double_test(void)
+{
+    static const struct
+    {
+        double      value;
+        const char *expected;
+    } cases[] = {
+        {0.0, "0"},
+        {-0.0, "-0"},
+        {1.0, "1"},
+        {-1.5, "-1.5"},
+        {0.1, "0.1"},
+        {0.3, "0.3"},
+        {0.1 + 0.2, "0.30000000000000004"},
+        {100.0, "100"},
+        {123456.789, "123456.789"},
+        {1e20, "100000000000000000000"},
+        {1e21, "1e+21"},
+        {1.5e300, "1.5e+300"},
+        {0.000001, "0.000001"},
+        {0.0000015, "0.0000015"},
+        {1e-7, "1e-7"},
+        {-2.5e-7, "-2.5e-7"},
+        {9007199254740992.0, "9007199254740992"},
+        {0x1p65, "36893488147419103000"},
+        {9007199254740994.0, "9007199254740994"},
+        {1.7976931348623157e308, "1.7976931348623157e+308"},
+        {2.2250738585072014e-308, "2.2250738585072014e-308"},
+        {5e-324, "5e-324"},
+        {INFINITY, "inf"},
+        {-INFINITY, "-inf"},
+        {NAN, "nan"},
+    };
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        struct rstring rs;
+        rstring_init(&rs);
+        rstring_push_double(&rs, cases[i].value);
+        check_contents(__FUNCTION__, &rs, cases[i].expected);
+        rstring_free(&rs);
+    }
+}
+
+/*
+ * Number of significant digits of the shortest correctly rounded %e output that
+ * reads back. The shortest decimal overall may have fewer: below powers of 2,
+ * the rounding interval is narrower, and the closest decimal with that many
+ * digits may fall outside of it while another one is inside.
+ */
+static int
+shortest_digits(double value)
+{
+    char buf[64];
+
+    for (int precision = 1; precision < 17; ++precision)
+    {
+        snprintf(buf, sizeof(buf), "%.*e", precision - 1, value);
+        if (strtod(buf, NULL) == value)
+        {
+            return precision;
+        }
+    }
+
+    return 17;
+}
+
+static void
+double_random_test(void)
+{
+    for (int i = 0; i < 200000; ++i)
+    {
+        uint64_t bits = random_u64();
+        double   value;
+
+        /* Also cover short decimals, which most doubles in practice are */
+        if (i % 3 == 1)
+        {
+            value = (double) (int) (bits % 2000000) / 1000.0;
+        }
+        else if (i % 3 == 2)
+        {
+            value = ldexp(1.0, (int) (bits % 2098) - 1074);
+        }
+        else
+        {
+            memcpy(&value, &bits, sizeof(value));
+        }
+
+        if (!isfinite(value))
+        {
+            continue;
+        }
+
+        struct rstring rs;
+        rstring_init(&rs);
+        rstring_push_double(&rs, value);
+
+        const char *s = rstring_data(&rs);
+        if (strtod(s, NULL) != value)
+        {
+            test_fail(__FUNCTION__, "'%s' does not read back as %.17g", s,
+                      value);
+        }
+
+        /* Count significant digits: skip the sign, leading zeros, the point */
+        int digits = 0;
+        int zeros  = 0;
+        for (const char *p = s; *p && *p != 'e'; ++p)
+        {
+            if (*p == '0')
+            {
+                zeros += digits > 0;
+            }
+            else if (*p >= '1' && *p <= '9')
+            {
+                digits += zeros + 1;
+                zeros = 0;
+            }
+        }
+
+        if (digits == 0)
+        {
+            digits = 1;
+        }
+
+        if (digits > shortest_digits(value))
+        {
+            test_fail(__FUNCTION__, "'%s' has %d digits, %d is enough", s,
+                      digits, shortest_digits(value));
+        }
+
+        rstring_free(&rs);
+    }
+}
+
+int
+main()
+{
+    fmt_test();
+    integer_test();
+    double_test();
+    double_random_test();
+    return 0;
+}
@@ -0,0 +1,235 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+static struct counting_allocator      counts;
+static const struct rstring_allocator counting = COUNTING_ALLOCATOR(&counts);
+
+static void
+set(struct rstring *rs, const char *str)
+{
+    rstring_clear(rs);
+    rstring_push_str(rs, str);
+}
+
+static void
+insert_erase_test(void)
+{
+    struct rstring rs;
+    struct rstring other;
+
+    rstring_init(&rs);
+    rstring_init(&other);
+
+    set(&rs, "world");
+    rstring_insert_str(&rs, 0, "hello ");
+    check_contents(__FUNCTION__, &rs, "hello world");
+    rstring_insert_str(&rs, 5, ",");
+    check_contents(__FUNCTION__, &rs, "hello, world");
+    rstring_insert_view(&rs, 100, rstring_view_from_str("!"));
+    check_contents(__FUNCTION__, &rs, "hello, world!");
+
+    /* Grows from the inline buffer to the heap */
+    rstring_push_str(&other, " [long enough to leave the inline buffer]");
+    rstring_insert(&rs, 6, &other);
+    check_contents(__FUNCTION__, &rs,
+          "hello, [long enough to leave the inline buffer] world!");
+
+    /* Inserting an rstring into itself */
+    set(&rs, "abc");
+    rstring_insert(&rs, 1, &rs);
+    check_contents(__FUNCTION__, &rs, "aabcbc");
+    rstring_insert_view(
+        &rs, 6, rstring_view_slice(rstring_view_from(&rs), 1, 3));
+    check_contents(__FUNCTION__, &rs, "aabcbcabc");
+
+    rstring_erase(&rs, 0, 1);
+    check_contents(__FUNCTION__, &rs, "abcbcabc");
+    rstring_erase(&rs, 3, 2);
+    check_contents(__FUNCTION__, &rs, "abcabc");
+    rstring_erase(&rs, 4, 100);
+    check_contents(__FUNCTION__, &rs, "abca");
+    rstring_erase(&rs, 4, 1);
+    rstring_erase(&rs, 100, 1);
+    check_contents(__FUNCTION__, &rs, "abca");
+    rstring_erase(&rs, 0, SIZE_MAX);
+    check_contents(__FUNCTION__, &rs, "");
+
+    /* A zero-initialized rstring is valid */
+    struct rstring zero = {0};
+    rstring_erase(&zero, 0, 1);
+    rstring_insert_str(&zero, 0, "x");
+    check_contents(__FUNCTION__, &zero, "x");
+    rstring_free(&zero);
+
+    rstring_free(&rs);
+    rstring_free(&other);
+}
+
+static void
+splice_test(void)
+{
+    struct rstring rs;
+    struct rstring with;
+
+    rstring_init(&rs);
+    rstring_init(&with);
+
+    set(&rs, "Hello, {name}!");
+    rstring_splice_str(&rs, 7, 6, "Ron");
+    check_contents(__FUNCTION__, &rs, "Hello, Ron!");
+    rstring_splice_str(&rs, 0, 5, "Goodbye");
+    check_contents(__FUNCTION__, &rs, "Goodbye, Ron!");
+    rstring_splice_str(&rs, 7, 0, " again");
+    check_contents(__FUNCTION__, &rs, "Goodbye again, Ron!");
+    rstring_splice_str(&rs, 5, 100, "");
+    check_contents(__FUNCTION__, &rs, "Goodb");
+
+    rstring_push_str(&with, "ye for now, and thanks for all the fish");
+    rstring_splice(&rs, 5, 0, &with);
+    check_contents(
+        __FUNCTION__, &rs, "Goodbye for now, and thanks for all the fish");
+
+    /* Replacements taken from the rstring itself */
+    set(&rs, "0123456789");
+    rstring_splice_view(
+        &rs, 2, 3, rstring_view_slice(rstring_view_from(&rs), 6, 4));
+    check_contents(__FUNCTION__, &rs, "01678956789");
+    rstring_free(&rs);
+    rstring_free(&with);
+}
+
+/* Reference implementation, rebuilding the string */
+static void
+naive_replace_all(char *out, const char *in, const char *from, const char *to)
+{
+    const size_t from_len = strlen(from);
+
+    *out = '\0';
+    while (*in)
+    {
+        if (strncmp(in, from, from_len) == 0)
+        {
+            strcat(out, to);
+            in += from_len;
+        }
+        else
+        {
+            strncat(out, in, 1);
+            in++;
+        }
+    }
+}
+
+static void
+replace_all_test(void)
+{
+    struct rstring rs;
+    struct rstring from;
+    struct rstring to;
+
+    rstring_init_with_allocator(&rs, &counting);
+    rstring_init(&from);
+    rstring_init(&to);
+
+    set(&rs, "{{x}} + {{x}} = {{y}}");
+    rstring_replace_all_str(&rs, "{{x}}", "1");
+    check_contents(__FUNCTION__, &rs, "1 + 1 = {{y}}");
+    rstring_replace_all_str(&rs, "{{y}}", "2");
+    check_contents(__FUNCTION__, &rs, "1 + 1 = 2");
+    rstring_replace_all_str(&rs, "1", "one");
+    check_contents(__FUNCTION__, &rs, "one + one = 2");
+    rstring_replace_all_str(&rs, " ", "");
+    check_contents(__FUNCTION__, &rs, "one+one=2");
+    rstring_replace_all_str(&rs, "", "x");
+    rstring_replace_all_str(&rs, "three", "x");
+    rstring_replace_all_str(&rs, "one+one=2 and more", "x");
+    check_contents(__FUNCTION__, &rs, "one+one=2");
+
+    /* Occurrences do not overlap */
+    set(&rs, "aaaaa");
+    rstring_replace_all_str(&rs, "aa", "b");
+    check_contents(__FUNCTION__, &rs, "bba");
+
+    /* Shrinking never allocates, growing allocates at most once */
+    set(&rs, "");
+    for (int i = 0; i < 100; ++i)
+    {
+        rstring_push_str(&rs, "<br>");
+    }
+    counts.allocs   = 0;
+    counts.reallocs = 0;
+    rstring_replace_all_str(&rs, "<br>", "\n");
+    if (counts.allocs + counts.reallocs != 0 || rs.len != 100)
+    {
+        test_fail(__FUNCTION__, "%zu allocations, length %zu",
+                  counts.allocs + counts.reallocs,
+                  rs.len);
+    }
+    rstring_replace_all_str(&rs, "\n", "<br />\n");
+    if (counts.allocs + counts.reallocs != 1 || rs.len != 700)
+    {
+        test_fail(__FUNCTION__, "%zu allocations, length %zu",
+                  counts.allocs + counts.reallocs,
+                  rs.len);
+    }
+
+    /* |from| and |to| referring to the rstring itself */
+    set(&rs, "abcabc");
+    rstring_replace_all_view(&rs,
+                             rstring_view_prefix(rstring_view_from(&rs), 1),
+                             rstring_view_from(&rs));
+    check_contents(__FUNCTION__, &rs, "abcabcbcabcabcbc");
+    set(&rs, "xyxy");
+    rstring_replace_all(&rs, &rs, &rs);
+    check_contents(__FUNCTION__, &rs, "xyxy");
+
+    /* Random strings against the reference */
+    char input[256];
+    char expected[256 * 8];
+
+    for (int round = 0; round < 20000; ++round)
+    {
+        const size_t len      = (size_t) (rand() % 200);
+        const size_t from_len = (size_t) (1 + rand() % 4);
+        const size_t to_len   = (size_t) (rand() % 8);
+
+        for (size_t i = 0; i < len; ++i)
+        {
+            input[i] = (char) ('a' + rand() % 3);
+        }
+        input[len] = '\0';
+
+        rstring_clear(&from);
+        rstring_clear(&to);
+        for (size_t i = 0; i < from_len; ++i)
+        {
+            rstring_push_byte(&from, (uint8_t) ('a' + rand() % 3));
+        }
+        for (size_t i = 0; i < to_len; ++i)
+        {
+            rstring_push_byte(&to, (uint8_t) ('a' + rand() % 4));
+        }
+
+        set(&rs, input);
+        rstring_replace_all(&rs, &from, &to);
+        naive_replace_all(expected, input, rstring_data(&from),
+                          rstring_data(&to));
+        check_contents(__FUNCTION__, &rs, expected);
+    }
+
+    rstring_free(&rs);
+    rstring_free(&from);
+    rstring_free(&to);
+}
+
+int
+main()
+{
+    insert_erase_test();
+    splice_test();
+    replace_all_test();
+    return 0;
+}
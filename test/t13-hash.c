@@ -0,0 +1,258 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+
+static int
+compare_u64(const void *a, const void *b)
+{
+    const uint64_t x = *(const uint64_t *) a;
+    const uint64_t y = *(const uint64_t *) b;
+    return x < y ? -1 : x > y;
+}
+
+static void
+consistency_test(void)
+{
+    struct rstring rs;
+
+    rstring_init(&rs);
+    rstring_push_str(&rs, "Content-Length");
+
+    const uint64_t h = rstring_hash(&rs);
+
+    if (h != rstring_hash_view(rstring_view_from(&rs), 0)
+        || h != rstring_hash_str("Content-Length", 0))
+    {
+        test_fail(__FUNCTION__, "variants hash the same bytes differently");
+    }
+
+#ifdef RSTRING_CACHED_HASH
+    if (rs.hash != h)
+    {
+        test_fail(__FUNCTION__, "hash was not cached");
+    }
+#endif
+
+    if (rstring_hash(&rs) != h)
+    {
+        test_fail(__FUNCTION__, "hashing again changed the hash");
+    }
+
+    if (rstring_hash_str("Content-Length", 1) == h
+        || rstring_hash_str("Content-Length", 2)
+               == rstring_hash_str("Content-Length", 1))
+    {
+        test_fail(__FUNCTION__, "seed does not change the hash");
+    }
+
+    /* Only the bytes in the view are hashed */
+    if (rstring_hash_view(rstring_view_from_buf("Content", 7), 0)
+        != rstring_hash_view(rstring_view_prefix(rstring_view_from(&rs), 7), 0))
+    {
+        test_fail(__FUNCTION__, "prefix hashed differently");
+    }
+
+    rstring_free(&rs);
+}
+
+#ifdef RSTRING_CACHED_HASH
+/* Every mutator must drop the cached hash */
+#define CHECK_INVALIDATES(rs, call)                                            \
+    do                                                                         \
+    {                                                                          \
+        rstring_hash(rs);                                                      \
+        call;                                                                  \
+        if ((rs)->hash != 0                                                    \
+            && (rs)->hash                                                      \
+                   != rstring_hash_view(rstring_view_from(rs), 0))             \
+        {                                                                      \
+            test_fail(__FUNCTION__, "stale hash after %s", #call);             \
+        }                                                                      \
+    } while (0)
+
+static void
+invalidation_test(void)
+{
+    struct rstring rs;
+    struct rstring other;
+    const char    *pieces[] = {"a", "b"};
+
+    rstring_init(&rs);
+    rstring_init(&other);
+    rstring_push_str(&other, "Other");
+
+    CHECK_INVALIDATES(&rs, rstring_push_str(&rs, "Hello"));
+    CHECK_INVALIDATES(&rs, rstring_push(&rs, &other));
+    CHECK_INVALIDATES(&rs, rstring_push_byte(&rs, '!'));
+    CHECK_INVALIDATES(&rs, rstring_push_view(&rs, rstring_view_from_str("?")));
+    CHECK_INVALIDATES(&rs, rstring_push_many_str(&rs, pieces, 2));
+    CHECK_INVALIDATES(&rs, rstring_join_str(&rs, ",", pieces, 2));
+    CHECK_INVALIDATES(&rs, rstring_push_fmt(&rs, "%d", 42));
+    CHECK_INVALIDATES(&rs, rstring_push_u64(&rs, 7));
+    CHECK_INVALIDATES(&rs, rstring_push_i64(&rs, -7));
+    CHECK_INVALIDATES(&rs, rstring_push_hex(&rs, 0xAB));
+    CHECK_INVALIDATES(&rs, rstring_push_double(&rs, 0.5));
+    CHECK_INVALIDATES(&rs, rstring_insert_str(&rs, 0, ">"));
+    CHECK_INVALIDATES(&rs, rstring_erase(&rs, 0, 1));
+    CHECK_INVALIDATES(&rs, rstring_splice_str(&rs, 0, 1, "J"));
+    CHECK_INVALIDATES(&rs, rstring_replace_all_str(&rs, "l", "L"));
+    CHECK_INVALIDATES(&rs, rstring_tolower(&rs));
+    CHECK_INVALIDATES(&rs, rstring_toupper(&rs));
+    CHECK_INVALIDATES(&rs, rstring_tolower_locale(&rs));
+    CHECK_INVALIDATES(&rs, rstring_toupper_locale(&rs));
+    CHECK_INVALIDATES(&rs, rstring_tolower_copy(&rs, &other));
+    CHECK_INVALIDATES(&rs, rstring_toupper_copy(&rs, &other));
+    CHECK_INVALIDATES(&rs, rstring_clear(&rs));
+
+    rstring_push_str(&rs, "x");
+    rstring_hash(&rs);
+    rstring_free(&rs);
+    if (rs.hash != 0)
+    {
+        test_fail(__FUNCTION__, "stale hash after rstring_free");
+    }
+
+    rstring_free(&other);
+}
+#endif /* RSTRING_CACHED_HASH */
+
+static void
+equals_test(void)
+{
+    struct rstring a;
+    struct rstring b;
+
+    rstring_init(&a);
+    rstring_init(&b);
+    rstring_push_str(&a, "session-1234");
+    rstring_push_str(&b, "session-1235");
+
+    rstring_hash(&a);
+    if (rstring_equals(&a, &b) || rstring_equals(&b, &a))
+    {
+        test_fail(__FUNCTION__, "different strings are equal");
+    }
+
+    rstring_hash(&b);
+    if (rstring_equals(&a, &b))
+    {
+        test_fail(__FUNCTION__, "different strings are equal");
+    }
+
+    rstring_clear(&b);
+    rstring_push_str(&b, "session-1234");
+    rstring_hash(&b);
+    if (!rstring_equals(&a, &b))
+    {
+        test_fail(__FUNCTION__, "equal strings are different");
+    }
+
+#ifdef RSTRING_CACHED_HASH
+    /* Cached hashes are trusted: a mismatch rejects without a memcmp */
+    b.hash ^= 1;
+    if (rstring_equals(&a, &b))
+    {
+        test_fail(__FUNCTION__, "hash mismatch did not reject");
+    }
+#endif
+
+    rstring_free(&a);
+    rstring_free(&b);
+}
+
+static void
+quality_test(void)
+{
+    enum
+    {
+        NKEYS = 100000,
+        NBUCKETS = 4096,
+    };
+
+    uint64_t *hashes = malloc(NKEYS * sizeof(uint64_t));
+    char      key[32];
+
+    /* Sequential, similar keys must neither collide nor cluster */
+    for (int i = 0; i < NKEYS; ++i)
+    {
+        snprintf(key, sizeof(key), "user:%d", i);
+        hashes[i] = rstring_hash_str(key, 0);
+    }
+
+    size_t buckets[NBUCKETS] = {0};
+    for (int i = 0; i < NKEYS; ++i)
+    {
+        buckets[hashes[i] % NBUCKETS]++;
+    }
+
+    for (int i = 0; i < NBUCKETS; ++i)
+    {
+        /* 24.4 keys per bucket on average */
+        if (buckets[i] > 60)
+        {
+            test_fail(__FUNCTION__, "bucket %d holds %zu keys", i,
+                      buckets[i]);
+        }
+    }
+
+    qsort(hashes, NKEYS, sizeof(uint64_t), compare_u64);
+    for (int i = 1; i < NKEYS; ++i)
+    {
+        if (hashes[i] == hashes[i - 1])
+        {
+            test_fail(__FUNCTION__, "collision among sequential keys");
+        }
+    }
+
+    /* Flipping any bit of any length of input changes the hash */
+    uint8_t buf[128];
+    for (size_t i = 0; i < sizeof(buf); ++i)
+    {
+        buf[i] = (uint8_t) (i * 37);
+    }
+
+    for (size_t len = 0; len <= sizeof(buf); ++len)
+    {
+        const struct rstring_view view = rstring_view_from_buf((char *) buf,
+                                                               len);
+        const uint64_t            h    = rstring_hash_view(view, 0);
+
+        if (len > 0
+            && h == rstring_hash_view(rstring_view_prefix(view, len - 1), 0))
+        {
+            test_fail(__FUNCTION__, "length %zu hashes like its prefix", len);
+        }
+
+        for (size_t bit = 0; bit < len * 8; ++bit)
+        {
+            buf[bit / 8] ^= (uint8_t) (1U << (bit % 8));
+            const uint64_t flipped = rstring_hash_view(view, 0);
+            buf[bit / 8] ^= (uint8_t) (1U << (bit % 8));
+
+            /* About half of the output bits change */
+            const int changed = __builtin_popcountll(h ^ flipped);
+            if (changed < 8 || changed > 56)
+            {
+                test_fail(__FUNCTION__,
+                          "flipping bit %zu of %zu bytes changed %d bits",
+                          bit, len, changed);
+            }
+        }
+    }
+
+    free(hashes);
+}
+
+int
+main()
+{
+    consistency_test();
+#ifdef RSTRING_CACHED_HASH
+    invalidation_test();
+#endif
+    equals_test();
+    quality_test();
+    return 0;
+}
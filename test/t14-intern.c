@@ -0,0 +1,143 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "../rstring_intern.h"
+
+static void
+intern_test(void)
+{
+    struct rstring_interner interner;
+    struct rstring          rs;
+    const char *long_name = "x-forwarded-for-a-header-name-longer-than-sso";
+
+    rstring_interner_init(&interner);
+    rstring_init(&rs);
+
+    const struct rstring *host  = rstring_intern_str(&interner, "host");
+    const struct rstring *agent = rstring_intern_str(&interner, "user-agent");
+    const struct rstring *empty = rstring_intern_str(&interner, "");
+    const struct rstring *lng   = rstring_intern_str(&interner, long_name);
+
+    check_contents(__FUNCTION__, host, "host");
+    check_contents(__FUNCTION__, agent, "user-agent");
+    check_contents(__FUNCTION__, empty, "");
+    check_contents(__FUNCTION__, lng, long_name);
+
+    if (host == agent || host == empty || agent == lng)
+    {
+        test_fail(__FUNCTION__, "different contents share a handle");
+    }
+
+    /* Every variant maps equal contents to the same handle */
+    rstring_push_str(&rs, "host");
+    if (rstring_intern(&interner, &rs) != host
+        || rstring_intern_view(&interner, rstring_view_from_buf("hostname", 4))
+               != host
+        || rstring_intern_str(&interner, "host") != host
+        || rstring_intern(&interner, host) != host)
+    {
+        test_fail(__FUNCTION__, "equal contents got different handles");
+    }
+
+    /* An rstring with a cached hash, and a handle of the empty string */
+    rstring_hash(&rs);
+    if (rstring_intern(&interner, &rs) != host
+        || rstring_intern_view(&interner, rstring_view_from_buf(NULL, 0))
+               != empty)
+    {
+        test_fail(__FUNCTION__, "equal contents got different handles");
+    }
+
+#ifdef RSTRING_CACHED_HASH
+    if (host->hash != rstring_hash_view(rstring_view_from(host), 0))
+    {
+        test_fail(__FUNCTION__, "handle hash was not cached");
+    }
+#endif
+
+    /* Handles are regular rstrings */
+    if (!rstring_equals(host, &rs)
+        || rstring_find_first_str(lng, "header", 0) != 18)
+    {
+        test_fail(__FUNCTION__, "handles do not behave like rstrings");
+    }
+
+    if (interner.stats.strings != 4 || interner.stats.lookups != 10
+        || interner.stats.hits != 6)
+    {
+        test_fail(__FUNCTION__, "%zu strings, %zu lookups, %zu hits",
+                  interner.stats.strings, interner.stats.lookups,
+                  interner.stats.hits);
+    }
+
+    rstring_free(&rs);
+    rstring_interner_free(&interner);
+}
+
+static void
+many_test(void)
+{
+    enum
+    {
+        NSTRINGS = 20000,
+        ROUNDS   = 5,
+    };
+
+    struct rstring_interner interner;
+    const struct rstring  **handles = malloc(NSTRINGS * sizeof(*handles));
+    char                    name[64];
+    size_t                  bytes = 0;
+
+    rstring_interner_init(&interner);
+
+    /* Handles stay valid and stable while the table grows */
+    for (int round = 0; round < ROUNDS; ++round)
+    {
+        for (int i = 0; i < NSTRINGS; ++i)
+        {
+            const int len = snprintf(name, sizeof(name), "%s.%d",
+                                     i % 2 ? "field" : "a.much.longer.field",
+                                     i);
+            const struct rstring *h = rstring_intern_str(&interner, name);
+
+            check_contents(__FUNCTION__, h, name);
+            if (round == 0)
+            {
+                handles[i] = h;
+                bytes += (size_t) len;
+            }
+            else if (handles[i] != h)
+            {
+                test_fail(__FUNCTION__, "handle of '%s' changed", name);
+            }
+        }
+    }
+
+    const struct rstring_interner_stats *stats = &interner.stats;
+    const size_t                         table =
+        interner.nslots * sizeof(struct rstring_interner_slot);
+
+    if (stats->strings != NSTRINGS
+        || stats->lookups != (size_t) NSTRINGS * ROUNDS
+        || stats->hits != (size_t) NSTRINGS * (ROUNDS - 1)
+        || stats->bytes_stored != bytes
+        || stats->bytes_requested != bytes * ROUNDS
+        || stats->memory != interner.arena.reserved + table
+        || stats->memory < bytes)
+    {
+        test_fail(__FUNCTION__, "unexpected stats");
+    }
+
+    free(handles);
+    rstring_interner_free(&interner);
+}
+
+int
+main()
+{
+    intern_test();
+    many_test();
+    return 0;
+}
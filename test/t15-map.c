@@ -0,0 +1,381 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "../rstring_map.h"
+
+static void
+basic_test(void)
+{
+    struct rstring_map        map;
+    struct rstring            key;
+    struct rstring_map_entry *entry;
+    int                       one = 1, two = 2, three = 3;
+
+    rstring_map_init(&map);
+    rstring_init(&key);
+
+    if (rstring_map_get_str(&map, "missing") || map.count != 0
+        || rstring_map_remove_str(&map, "missing"))
+    {
+        test_fail(__FUNCTION__, "empty map has an entry");
+    }
+
+    rstring_map_put_str(&map, "one", &one);
+    rstring_map_put_view(&map, rstring_view_from_str("two"), &two);
+    rstring_push_str(&key, "a key long enough to leave the inline buffer");
+    rstring_map_put(&map, &key, &three);
+
+    if (map.count != 3)
+    {
+        test_fail(__FUNCTION__, "count is %zu, expected 3", map.count);
+    }
+
+    /* Every variant finds every key, whichever variant inserted it */
+    entry = rstring_map_get_str(&map, "one");
+    if (!entry || entry->value != &one
+        || !rstring_equals_str(&entry->key, "one"))
+    {
+        test_fail(__FUNCTION__, "'one' not found");
+    }
+
+    entry = rstring_map_get_view(
+        &map, rstring_view_prefix(rstring_view_from_str("twofold"), 3));
+    if (!entry || entry->value != &two)
+    {
+        test_fail(__FUNCTION__, "'two' not found by view");
+    }
+
+    entry = rstring_map_get_str(
+        &map, "a key long enough to leave the inline buffer");
+    if (!entry || entry->value != &three || rstring_map_get(&map, &key) != entry)
+    {
+        test_fail(__FUNCTION__, "long key not found");
+    }
+
+    /* The map owns a copy of the key */
+    rstring_clear(&key);
+    rstring_push_str(&key, "one");
+    if (rstring_map_get(&map, &key) != rstring_map_get_str(&map, "one"))
+    {
+        test_fail(__FUNCTION__, "rstring and C string lookups differ");
+    }
+
+    /* Keys are case-sensitive, and compared in full */
+    if (rstring_map_get_str(&map, "ONE") || rstring_map_get_str(&map, "on")
+        || rstring_map_get_str(&map, "one ") || rstring_map_get_str(&map, ""))
+    {
+        test_fail(__FUNCTION__, "found a key which is not in the map");
+    }
+
+    /* Putting an existing key replaces the value */
+    rstring_map_put_str(&map, "one", &two);
+    if (map.count != 3 || rstring_map_get_str(&map, "one")->value != &two)
+    {
+        test_fail(__FUNCTION__, "value not replaced");
+    }
+
+    /* The empty key is a key like any other */
+    rstring_map_put_str(&map, "", NULL);
+    if (!rstring_map_get_str(&map, "") || map.count != 4)
+    {
+        test_fail(__FUNCTION__, "empty key not found");
+    }
+
+    if (!rstring_map_remove_str(&map, "two") || rstring_map_get_str(&map, "two")
+        || rstring_map_remove_str(&map, "two") || map.count != 3)
+    {
+        test_fail(__FUNCTION__, "'two' not removed");
+    }
+
+    rstring_map_free(&map);
+    rstring_free(&key);
+}
+
+static void
+ignore_case_test(void)
+{
+    static const char *headers[] = {
+        "Content-Type", "Content-Length", "Host", "Accept-Encoding",
+        "X-Forwarded-For", "Transfer-Encoding-Which-Is-Longer-Than-48-Bytes!!"};
+    const size_t        nheaders = sizeof(headers) / sizeof(headers[0]);
+    struct rstring_map  map;
+    struct rstring      lower;
+
+    rstring_map_init_ignore_case(&map);
+    rstring_init(&lower);
+
+    for (size_t i = 0; i < nheaders; ++i)
+    {
+        rstring_map_put_str(&map, headers[i], (void *) headers[i]);
+    }
+
+    for (size_t i = 0; i < nheaders; ++i)
+    {
+        rstring_clear(&lower);
+        rstring_push_str(&lower, headers[i]);
+        rstring_tolower(&lower);
+
+        const struct rstring_map_entry *entry = rstring_map_get(&map, &lower);
+
+        /* Found by any case, the stored key keeps the case it was put with */
+        if (!entry || entry->value != headers[i]
+            || !rstring_equals_str(&entry->key, headers[i]))
+        {
+            test_fail(__FUNCTION__, "'%s' not found", rstring_data(&lower));
+        }
+
+        rstring_toupper(&lower);
+        if (rstring_map_get(&map, &lower) != entry)
+        {
+            test_fail(__FUNCTION__, "'%s' not found", rstring_data(&lower));
+        }
+    }
+
+    /* A different case of a key is the same key */
+    rstring_map_put_str(&map, "HOST", NULL);
+    if (map.count != nheaders || rstring_map_get_str(&map, "host")->value)
+    {
+        test_fail(__FUNCTION__, "'HOST' added as a new key");
+    }
+
+    /* Only ASCII letters are folded */
+    if (rstring_map_get_str(&map, "Content_Type")
+        || rstring_map_get_str(&map, "Content\x0DType"))
+    {
+        test_fail(__FUNCTION__, "non-letters compared ignoring case");
+    }
+
+    if (!rstring_map_remove_str(&map, "content-LENGTH")
+        || rstring_map_get_str(&map, "Content-Length"))
+    {
+        test_fail(__FUNCTION__, "'Content-Length' not removed");
+    }
+
+    rstring_map_free(&map);
+    rstring_free(&lower);
+}
+
+static void
+hash_ignore_case_test(void)
+{
+    char mixed[200];
+    char lower[200];
+
+    /* Every length, to cover every load pattern of the hash */
+    for (size_t len = 0; len < sizeof(mixed); ++len)
+    {
+        for (size_t i = 0; i < len; ++i)
+        {
+            /* Bytes on both sides of the letter ranges, and high bytes */
+            static const char alphabet[] = "@AZ[`az{Mm\x80\xC1\xDA\xE1";
+            mixed[i] = alphabet[(i * 7 + len) % (sizeof(alphabet) - 1)];
+            lower[i] = (char) (mixed[i] >= 'A' && mixed[i] <= 'Z'
+                                   ? mixed[i] | 0x20
+                                   : mixed[i]);
+        }
+
+        const struct rstring_view m = rstring_view_from_buf(mixed, len);
+        const struct rstring_view l = rstring_view_from_buf(lower, len);
+
+        if (rstring_hash_view_ignore_case(m, 5)
+                != rstring_hash_view_ignore_case(l, 5)
+            || rstring_hash_view_ignore_case(l, 5) != rstring_hash_view(l, 5))
+        {
+            test_fail(__FUNCTION__, "length %zu hashed differently", len);
+        }
+    }
+
+    if (rstring_hash_str_ignore_case("Host", 0)
+            != rstring_hash_str_ignore_case("hOST", 0)
+        || rstring_hash_str_ignore_case("Host", 0)
+               == rstring_hash_str_ignore_case("Hosts", 0))
+    {
+        test_fail(__FUNCTION__, "C string variant differs");
+    }
+}
+
+static void
+random_test(void)
+{
+    enum
+    {
+        NKEYS   = 4096,
+        NROUNDS = 200000,
+    };
+
+    /* Reference: whether key i is present, and its value */
+    static bool      present[NKEYS];
+    static uintptr_t values[NKEYS];
+    struct rstring_map map;
+    char               key[32];
+    size_t             count = 0;
+
+    rstring_map_init(&map);
+
+    /* Few distinct keys and many removals leave many tombstones */
+    for (int round = 0; round < NROUNDS; ++round)
+    {
+        const int i = rand() % NKEYS;
+        snprintf(key, sizeof(key), "key:%d", i);
+
+        switch (rand() % 3)
+        {
+        case 0:
+            values[i] = (uintptr_t) rand() + 1;
+            if (rstring_map_put_str(&map, key, (void *) values[i])
+                != RSTRING_OK)
+            {
+                test_fail(__FUNCTION__, "put failed");
+            }
+            count += !present[i];
+            present[i] = true;
+            break;
+
+        case 1:
+            if (rstring_map_remove_str(&map, key) != present[i])
+            {
+                test_fail(__FUNCTION__, "removing '%s' returned %d", key,
+                          !present[i]);
+            }
+            count -= present[i];
+            present[i] = false;
+            break;
+
+        default:
+        {
+            const struct rstring_map_entry *entry =
+                rstring_map_get_str(&map, key);
+
+            if (present[i] != (entry != NULL)
+                || (entry && (uintptr_t) entry->value != values[i]))
+            {
+                test_fail(__FUNCTION__, "'%s' lookup is wrong", key);
+            }
+            break;
+        }
+        }
+
+        if (map.count != count)
+        {
+            test_fail(__FUNCTION__, "count is %zu, expected %zu", map.count,
+                      count);
+        }
+    }
+
+    /* Iteration visits every entry once */
+    size_t                    pos     = 0;
+    size_t                    visited = 0;
+    struct rstring_map_entry *entry;
+
+    while ((entry = rstring_map_next(&map, &pos)))
+    {
+        const int i = atoi(rstring_data(&entry->key) + 4);
+
+        if (!present[i] || (uintptr_t) entry->value != values[i])
+        {
+            test_fail(__FUNCTION__, "iteration visited '%s'",
+                      rstring_data(&entry->key));
+        }
+        present[i] = false;
+        visited++;
+    }
+
+    if (visited != count || rstring_map_next(&map, &pos))
+    {
+        test_fail(__FUNCTION__, "iteration visited %zu of %zu entries",
+                  visited, count);
+    }
+
+    rstring_map_free(&map);
+}
+
+static void
+reserve_test(void)
+{
+    struct rstring_map map;
+    char               key[32];
+
+    rstring_map_init(&map);
+    rstring_map_reserve(&map, 100000);
+
+    uint8_t *const ctrl = map.ctrl;
+
+    /* Reserved room is filled without rehashing */
+    for (int i = 0; i < 100000; ++i)
+    {
+        snprintf(key, sizeof(key), "%d", i);
+        rstring_map_put_str(&map, key, NULL);
+    }
+
+    if (map.ctrl != ctrl || map.count != 100000)
+    {
+        test_fail(__FUNCTION__, "rehashed after reserving");
+    }
+
+    for (int i = 0; i < 100000; ++i)
+    {
+        snprintf(key, sizeof(key), "%d", i);
+        if (!rstring_map_get_str(&map, key))
+        {
+            test_fail(__FUNCTION__, "'%s' not found", key);
+        }
+    }
+
+    rstring_map_free(&map);
+}
+
+/* Fails unless the key of |entry| holds exactly |expected| */
+static void
+check_key(const char *test_name, const struct rstring_map_entry *entry,
+          const char *expected)
+{
+    if (!entry || !rstring_equals_str(&entry->key, expected)
+        || rstring_data(&entry->key)[entry->key.len] != '\0')
+    {
+        test_fail(test_name, "key '%s' has wrong contents", expected);
+    }
+}
+
+static void
+key_test(void)
+{
+    struct rstring_map map;
+    char               name[32];
+    int                value = 0;
+
+    rstring_map_init(&map);
+
+    rstring_map_put_str(&map, "short", &value);
+    check_key(__FUNCTION__, rstring_map_get_str(&map, "short"), "short");
+
+    /* Enough keys to grow the map several times, moving every entry */
+    for (size_t i = 0; i < 200; ++i)
+    {
+        snprintf(name, sizeof(name), "key-%zu", i);
+        rstring_map_put_str(&map, name, &value);
+    }
+
+    check_key(__FUNCTION__, rstring_map_get_str(&map, "short"), "short");
+    for (size_t i = 0; i < 200; ++i)
+    {
+        snprintf(name, sizeof(name), "key-%zu", i);
+        check_key(__FUNCTION__, rstring_map_get_str(&map, name), name);
+    }
+
+    rstring_map_free(&map);
+}
+
+int
+main()
+{
+    basic_test();
+    ignore_case_test();
+    hash_ignore_case_test();
+    random_test();
+    reserve_test();
+    key_test();
+    return 0;
+}
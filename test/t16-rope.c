@@ -0,0 +1,274 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "../rstring_rope.h"
+
+/* Compares a rope with the expected contents, flattening it */
+static void
+check(const char *test_name, const struct rstring_rope *rope,
+      const struct rstring *expected)
+{
+    struct rstring flat;
+
+    rstring_init(&flat);
+    rstring_rope_flatten(rope, &flat);
+
+    if (rstring_rope_len(rope) != expected->len
+        || !rstring_equals(&flat, expected))
+    {
+        test_fail(test_name, "rope has %zu bytes, expected %zu",
+                  rstring_rope_len(rope), expected->len);
+    }
+
+    rstring_free(&flat);
+}
+
+static void
+basic_test(void)
+{
+    struct rstring_rope rope;
+    struct rstring      expected;
+
+    rstring_rope_init(&rope);
+    rstring_init(&expected);
+
+    if (rstring_rope_len(&rope) != 0
+        || rstring_rope_find_str(&rope, "x", 0) != RSTRING_NOT_FOUND
+        || rstring_rope_find_str(&rope, "", 0) != 0)
+    {
+        test_fail(__FUNCTION__, "empty rope is not empty");
+    }
+
+    rstring_rope_push_str(&rope, "world");
+    rstring_rope_insert_str(&rope, 0, "hello ");
+    rstring_rope_insert_str(&rope, 100, "!");
+    rstring_push_str(&expected, "hello world!");
+    check(__FUNCTION__, &rope, &expected);
+
+    rstring_rope_erase(&rope, 5, 6);
+    rstring_rope_erase(&rope, 100, 1);
+    rstring_rope_erase(&rope, 0, 0);
+    rstring_clear(&expected);
+    rstring_push_str(&expected, "hello!");
+    check(__FUNCTION__, &rope, &expected);
+
+    rstring_rope_erase(&rope, 0, SIZE_MAX);
+    rstring_clear(&expected);
+    check(__FUNCTION__, &rope, &expected);
+
+    /* A zero-initialized rope is valid */
+    struct rstring_rope zero = {0};
+    rstring_rope_push(&zero, &expected);
+    rstring_rope_push_view(&zero, rstring_view_from_str("abc"));
+    rstring_push_str(&expected, "abc");
+    check(__FUNCTION__, &zero, &expected);
+
+    rstring_rope_free(&zero);
+    rstring_rope_free(&rope);
+    rstring_free(&expected);
+}
+
+static void
+large_test(void)
+{
+    struct rstring_rope rope;
+    struct rstring_rope tail;
+    struct rstring      expected;
+    struct rstring      text;
+
+    rstring_rope_init(&rope);
+    rstring_rope_init(&tail);
+    rstring_init(&expected);
+    rstring_init(&text);
+
+    /* A text spanning many chunks, pushed at once */
+    for (int i = 0; i < 20000; ++i)
+    {
+        rstring_push_fmt(&text, "line %d\n", i);
+    }
+
+    rstring_rope_push(&rope, &text);
+    rstring_push(&expected, &text);
+    check(__FUNCTION__, &rope, &expected);
+
+    /* Chunks cover the contents in order, within the chunk size */
+    size_t              pos    = 0;
+    size_t              chunks = 0;
+    struct rstring_view chunk;
+
+    while ((chunk = rstring_rope_chunk(&rope, &pos)).len > 0)
+    {
+        if (chunk.len > RSTRING_ROPE_CHUNK
+            || memcmp(chunk.ptr, rstring_data(&text) + pos - chunk.len,
+                      chunk.len)
+                   != 0)
+        {
+            test_fail(__FUNCTION__, "chunk ending at %zu is wrong", pos);
+        }
+        chunks++;
+    }
+
+    if (pos != text.len || chunks < text.len / RSTRING_ROPE_CHUNK)
+    {
+        test_fail(__FUNCTION__, "%zu chunks cover %zu bytes", chunks, pos);
+    }
+
+    /* Chunks may also start in the middle of one */
+    pos   = 10;
+    chunk = rstring_rope_chunk(&rope, &pos);
+    if (chunk.len == 0 || memcmp(chunk.ptr, rstring_data(&text) + 10, 5) != 0)
+    {
+        test_fail(__FUNCTION__, "chunk from an offset is wrong");
+    }
+
+    /* Search, including occurrences which cross chunks */
+    static const char *needles[] = {
+        "line 0\n", "line 19999\n", "\nline 1234\nline 1235\n", "line 20000",
+        "9\nline 10", "e", "\n"};
+
+    for (size_t i = 0; i < sizeof(needles) / sizeof(needles[0]); ++i)
+    {
+        for (size_t from = 0; from < text.len; from += 4999)
+        {
+            const size_t expected_pos = rstring_find_first_view(
+                &text, rstring_view_from_str(needles[i]), from);
+            const size_t found = rstring_rope_find_str(&rope, needles[i], from);
+
+            if (found != expected_pos)
+            {
+                test_fail(__FUNCTION__, "'%s' from %zu found at %zu, not %zu",
+                          needles[i], from, found, expected_pos);
+            }
+        }
+    }
+
+    /* Every needle crossing every chunk boundary */
+    pos = 0;
+    while ((chunk = rstring_rope_chunk(&rope, &pos)).len > 0)
+    {
+        if (pos == text.len)
+        {
+            break;
+        }
+
+        for (size_t before = 1; before < 12; ++before)
+        {
+            const struct rstring_view needle = rstring_view_slice(
+                rstring_view_from(&text), pos - before, before + 7);
+            const size_t found = rstring_rope_find_view(&rope, needle, 0);
+
+            if (found != rstring_find_first_view(&text, needle, 0))
+            {
+                test_fail(__FUNCTION__, "needle across %zu found at %zu", pos,
+                          found);
+            }
+        }
+    }
+
+    /* Concatenation moves the other rope */
+    rstring_rope_push_str(&tail, "-- end --");
+    rstring_rope_concat(&rope, &tail);
+    rstring_push_str(&expected, "-- end --");
+    check(__FUNCTION__, &rope, &expected);
+    if (rstring_rope_len(&tail) != 0)
+    {
+        test_fail(__FUNCTION__, "concatenated rope is not empty");
+    }
+
+    rstring_rope_free(&rope);
+    rstring_rope_free(&tail);
+    rstring_free(&expected);
+    rstring_free(&text);
+}
+
+static void
+random_edit_test(void)
+{
+    struct rstring_rope rope;
+    struct rstring      expected;
+    char                text[RSTRING_ROPE_CHUNK * 3];
+
+    rstring_rope_init(&rope);
+    rstring_init(&expected);
+
+    for (int round = 0; round < 20000; ++round)
+    {
+        const size_t len = rstring_rope_len(&rope);
+        const size_t pos = len ? (size_t) rand() % (len + 1) : 0;
+
+        /* Mostly short edits, as typing makes, and a few long ones */
+        size_t n = (size_t) (rand() % 16);
+        if (rand() % 50 == 0)
+        {
+            n = (size_t) rand() % sizeof(text);
+        }
+
+        if (rand() % 5 < 3 || len < 1000)
+        {
+            for (size_t i = 0; i < n; ++i)
+            {
+                text[i] = (char) ('a' + rand() % 26);
+            }
+
+            rstring_rope_insert_view(&rope, pos,
+                                     rstring_view_from_buf(text, n));
+            rstring_insert_view(&expected, pos, rstring_view_from_buf(text, n));
+        }
+        else
+        {
+            rstring_rope_erase(&rope, pos, n);
+            rstring_erase(&expected, pos, n);
+        }
+
+        if (rstring_rope_len(&rope) != expected.len)
+        {
+            test_fail(__FUNCTION__, "length %zu, expected %zu",
+                      rstring_rope_len(&rope), expected.len);
+        }
+
+        if (round % 500 == 0)
+        {
+            check(__FUNCTION__, &rope, &expected);
+        }
+    }
+
+    check(__FUNCTION__, &rope, &expected);
+
+    /* Search among the fragmented chunks the edits left */
+    for (int i = 0; i < 2000; ++i)
+    {
+        const struct rstring_view needle =
+            rstring_view_slice(rstring_view_from(&expected),
+                               (size_t) rand() % expected.len,
+                               (size_t) (1 + rand() % 40));
+        const size_t from  = (size_t) rand() % expected.len;
+        const size_t found = rstring_rope_find_view(&rope, needle, from);
+
+        if (found != rstring_find_first_view(&expected, needle, from))
+        {
+            test_fail(__FUNCTION__, "search from %zu found %zu", from, found);
+        }
+    }
+
+    /* Inserting a part of the rope into itself */
+    size_t              pos   = expected.len / 2;
+    struct rstring_view chunk = rstring_rope_chunk(&rope, &pos);
+
+    rstring_insert_view(&expected, 0, chunk);
+    rstring_rope_insert_view(&rope, 0, chunk);
+    check(__FUNCTION__, &rope, &expected);
+
+    rstring_rope_free(&rope);
+    rstring_free(&expected);
+}
+
+int
+main()
+{
+    basic_test();
+    large_test();
+    random_edit_test();
+    return 0;
+}
@@ -0,0 +1,256 @@
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/wait.h>
+
+#include "common.h"
+#include "../rstring_io.h"
+
+/* Writes |len| bytes of a pattern to a new temporary file, returns its path */
+static void
+make_file(char *path, size_t len)
+{
+    strcpy(path, "/tmp/rstring-t17-XXXXXX");
+
+    const int fd = mkstemp(path);
+    if (fd < 0)
+    {
+        test_fail(__FUNCTION__, "mkstemp failed: %s", strerror(errno));
+    }
+
+    char buf[4096];
+    for (size_t done = 0; done < len;)
+    {
+        const size_t n = len - done < sizeof(buf) ? len - done : sizeof(buf);
+
+        for (size_t i = 0; i < n; ++i)
+        {
+            buf[i] = (char) ('a' + (done + i) % 23);
+        }
+
+        if (write(fd, buf, n) != (ssize_t) n)
+        {
+            test_fail(__FUNCTION__, "write failed");
+        }
+        done += n;
+    }
+
+    close(fd);
+}
+
+static void
+check_pattern(const char *test_name, struct rstring_view view, size_t skip,
+              size_t len)
+{
+    if (view.len != skip + len)
+    {
+        test_fail(test_name, "%zu bytes, expected %zu", view.len, skip + len);
+    }
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        if (view.ptr[skip + i] != (char) ('a' + i % 23))
+        {
+            test_fail(test_name, "byte %zu is wrong", i);
+        }
+    }
+}
+
+static void
+read_file_test(void)
+{
+    static const size_t sizes[] = {0, 1, 23, 24, 4095, 65536, 1000003};
+    char                path[64];
+    struct rstring      rs;
+
+    rstring_init(&rs);
+    rstring_push_str(&rs, "previous contents");
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); ++i)
+    {
+        make_file(path, sizes[i]);
+
+        if (rstring_read_file(&rs, path) != RSTRING_OK)
+        {
+            test_fail(__FUNCTION__, "reading %zu bytes failed", sizes[i]);
+        }
+
+        check_pattern(__FUNCTION__, rstring_view_from(&rs), 0, sizes[i]);
+        if (rstring_data(&rs)[rs.len] != '\0')
+        {
+            test_fail(__FUNCTION__, "contents are not null-terminated");
+        }
+
+        /* Grown to exactly the size of the file */
+        if (sizes[i] >= RSTRING_SSO_CAPACITY && rs.cap != sizes[i] + 1)
+        {
+            test_fail(__FUNCTION__, "capacity %zu for %zu bytes", rs.cap,
+                      sizes[i]);
+        }
+
+        rstring_free(&rs);
+        unlink(path);
+    }
+
+    /* Files which do not report their size */
+    if (rstring_read_file(&rs, "/proc/self/status") != RSTRING_OK
+        || rstring_find_first_str(&rs, "Name:", 0) != 0)
+    {
+        test_fail(__FUNCTION__, "reading /proc/self/status failed");
+    }
+
+    errno = 0;
+    if (rstring_read_file(&rs, "/nonexistent/file") != RSTRING_ERROR_IO
+        || errno != ENOENT || rs.len != 0)
+    {
+        test_fail(__FUNCTION__, "missing file did not fail");
+    }
+
+    errno = 0;
+    if (rstring_read_file(&rs, "/tmp") != RSTRING_ERROR_IO || errno != EISDIR)
+    {
+        test_fail(__FUNCTION__, "reading a directory did not fail");
+    }
+
+    rstring_free(&rs);
+}
+
+static void
+read_fd_test(void)
+{
+    enum
+    {
+        SIZE = 3 * 1024 * 1024 + 7,
+    };
+
+    int            fds[2];
+    struct rstring rs;
+
+    /* More than a pipe buffer, from another process */
+    if (pipe(fds) != 0)
+    {
+        test_fail(__FUNCTION__, "pipe failed");
+    }
+
+    const pid_t pid = fork();
+    if (pid == 0)
+    {
+        char buf[1000];
+
+        close(fds[0]);
+        for (size_t done = 0; done < SIZE;)
+        {
+            const size_t n =
+                SIZE - done < sizeof(buf) ? SIZE - done : sizeof(buf);
+
+            for (size_t i = 0; i < n; ++i)
+            {
+                buf[i] = (char) ('a' + (done + i) % 23);
+            }
+
+            if (write(fds[1], buf, n) != (ssize_t) n)
+            {
+                _exit(1);
+            }
+            done += n;
+        }
+        _exit(0);
+    }
+
+    close(fds[1]);
+    rstring_init(&rs);
+    rstring_push_str(&rs, "> ");
+
+    if (rstring_read_fd_append(&rs, fds[0]) != RSTRING_OK)
+    {
+        test_fail(__FUNCTION__, "reading the pipe failed");
+    }
+
+    check_pattern(__FUNCTION__, rstring_view_from(&rs), 2, SIZE);
+    if (memcmp(rstring_data(&rs), "> ", 2) != 0)
+    {
+        test_fail(__FUNCTION__, "previous contents lost");
+    }
+
+    close(fds[0]);
+    waitpid(pid, NULL, 0);
+
+    /* A failed read leaves the contents as they were */
+    errno = 0;
+    if (rstring_read_fd_append(&rs, -1) != RSTRING_ERROR_IO || errno != EBADF
+        || rs.len != SIZE + 2)
+    {
+        test_fail(__FUNCTION__, "reading a bad descriptor did not fail");
+    }
+
+    rstring_free(&rs);
+
+    /* A zero-initialized rstring is valid */
+    struct rstring zero = {0};
+    if (pipe(fds) != 0 || write(fds[1], "xyz", 3) != 3)
+    {
+        test_fail(__FUNCTION__, "pipe failed");
+    }
+    close(fds[1]);
+    rstring_read_fd_append(&zero, fds[0]);
+    close(fds[0]);
+    if (!rstring_equals_str(&zero, "xyz"))
+    {
+        test_fail(__FUNCTION__, "read '%s'", rstring_data(&zero));
+    }
+    rstring_free(&zero);
+}
+
+static void
+mmap_test(void)
+{
+    char                path[64];
+    struct rstring_mmap mm;
+
+    make_file(path, 100000);
+    if (rstring_mmap_open(&mm, path) != RSTRING_OK)
+    {
+        test_fail(__FUNCTION__, "mapping failed");
+    }
+
+    check_pattern(__FUNCTION__, mm.view, 0, 100000);
+    if (rstring_view_find_first(mm.view, rstring_view_from_str("wabc"), 0)
+        != 22)
+    {
+        test_fail(__FUNCTION__, "search in the mapping failed");
+    }
+
+    rstring_mmap_close(&mm);
+    if (mm.view.len != 0)
+    {
+        test_fail(__FUNCTION__, "closed mapping is not empty");
+    }
+    unlink(path);
+
+    make_file(path, 0);
+    if (rstring_mmap_open(&mm, path) != RSTRING_OK || mm.view.len != 0)
+    {
+        test_fail(__FUNCTION__, "mapping an empty file failed");
+    }
+    rstring_mmap_close(&mm);
+    unlink(path);
+
+    errno = 0;
+    if (rstring_mmap_open(&mm, "/nonexistent/file") != RSTRING_ERROR_IO
+        || errno != ENOENT)
+    {
+        test_fail(__FUNCTION__, "mapping a missing file did not fail");
+    }
+}
+
+int
+main()
+{
+    read_file_test();
+    read_fd_test();
+    mmap_test();
+    return 0;
+}
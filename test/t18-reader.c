@@ -0,0 +1,227 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <sys/wait.h>
+
+#include "common.h"
+#include "../rstring_io.h"
+
+static struct counting_allocator      counts;
+static const struct rstring_allocator counting = COUNTING_ALLOCATOR(&counts);
+
+/* Writes |data| from a child process to a pipe, returns its read end */
+static int
+spawn_writer(const char *data, size_t len, size_t piece)
+{
+    int fds[2];
+
+    if (pipe(fds) != 0)
+    {
+        test_fail(__FUNCTION__, "pipe failed");
+    }
+
+    if (fork() == 0)
+    {
+        close(fds[0]);
+
+        /* Small writes make reads return partial lines */
+        for (size_t done = 0; done < len;)
+        {
+            const size_t n = len - done < piece ? len - done : piece;
+            if (write(fds[1], data + done, n) != (ssize_t) n)
+            {
+                _exit(1);
+            }
+            done += n;
+        }
+        _exit(0);
+    }
+
+    close(fds[1]);
+    return fds[0];
+}
+
+static void
+basic_test(void)
+{
+    static const char input[] =
+        "first\nsecond\r\n\n\r\nlast\r\n\rbare cr\nno newline at the end";
+    static const char *expected[] = {
+        "first", "second", "", "", "last", "\rbare cr",
+        "no newline at the end"};
+
+    for (size_t piece = 1; piece <= sizeof(input); piece *= 3)
+    {
+        const int             fd = spawn_writer(input, strlen(input), piece);
+        struct rstring_reader reader;
+        struct rstring_view   line;
+        size_t                n = 0;
+
+        rstring_reader_init(&reader, fd, '\n');
+        while (rstring_reader_next_view(&reader, &line) == RSTRING_OK)
+        {
+            if (n >= sizeof(expected) / sizeof(expected[0])
+                || !rstring_view_equals(line,
+                                        rstring_view_from_str(expected[n])))
+            {
+                test_fail(__FUNCTION__, "line %zu is '%.*s'", n,
+                          (int) line.len, line.ptr);
+            }
+            n++;
+        }
+
+        if (n != sizeof(expected) / sizeof(expected[0])
+            || rstring_reader_next_view(&reader, &line) != RSTRING_NOT_FOUND)
+        {
+            test_fail(__FUNCTION__, "read %zu lines", n);
+        }
+
+        rstring_reader_free(&reader);
+        close(fd);
+        wait(NULL);
+    }
+}
+
+static void
+delimiter_test(void)
+{
+    /* NUL-separated, as find -print0 writes, where '\r' is kept */
+    static const char input[] = "a\0bc\r\0\0d";
+    const int         fd      = spawn_writer(input, sizeof(input) - 1, 3);
+
+    struct rstring_reader reader;
+    struct rstring        line;
+
+    rstring_reader_init(&reader, fd, '\0');
+    rstring_init(&line);
+
+    static const char *expected[] = {"a", "bc\r", "", "d"};
+    for (size_t i = 0; i < 4; ++i)
+    {
+        if (rstring_reader_next(&reader, &line) != RSTRING_OK
+            || !rstring_equals_str(&line, expected[i]))
+        {
+            test_fail(__FUNCTION__, "line %zu is '%s'", i, rstring_data(&line));
+        }
+    }
+
+    if (rstring_reader_next(&reader, &line) != RSTRING_NOT_FOUND)
+    {
+        test_fail(__FUNCTION__, "more lines than written");
+    }
+
+    rstring_reader_free(&reader);
+    rstring_free(&line);
+    close(fd);
+    wait(NULL);
+}
+
+static void
+large_test(void)
+{
+    struct rstring input;
+    char           path[] = "/tmp/rstring-t18-XXXXXX";
+
+    /* Lines of every length up to 3 buffers, so some cross every refill */
+    rstring_init(&input);
+    srand(18);
+    for (int i = 0; i < 3000; ++i)
+    {
+        const size_t len = i % 100 == 0 ? (size_t) rand()
+                                              % (3 * RSTRING_READER_BUFFER)
+                                        : (size_t) rand() % 200;
+
+        for (size_t j = 0; j < len; ++j)
+        {
+            rstring_push_byte(&input, (uint8_t) ('a' + j % 26));
+        }
+        rstring_push_str(&input, i % 7 == 0 ? "\r\n" : "\n");
+    }
+
+    const int fd = mkstemp(path);
+    if (fd < 0 || write(fd, rstring_data(&input), input.len)
+                      != (ssize_t) input.len)
+    {
+        test_fail(__FUNCTION__, "writing %s failed", path);
+    }
+    lseek(fd, 0, SEEK_SET);
+
+    struct rstring_reader reader;
+    struct rstring        line;
+    size_t                offset  = 0;
+    size_t                lines   = 0;
+    size_t                longest = 0;
+
+    rstring_reader_init(&reader, fd, '\n');
+    rstring_init_with_allocator(&line, &counting);
+
+    while (rstring_reader_next(&reader, &line) == RSTRING_OK)
+    {
+        /* Compare with the input, then skip the delimiters */
+        if (memcmp(rstring_data(&input) + offset, rstring_data(&line),
+                   line.len)
+            != 0)
+        {
+            test_fail(__FUNCTION__, "line %zu differs", lines);
+        }
+
+        offset += line.len;
+        offset += rstring_data(&input)[offset] == '\r';
+        if (rstring_data(&input)[offset] != '\n')
+        {
+            test_fail(__FUNCTION__, "line %zu is too short", lines);
+        }
+        offset++;
+
+        /* The same rstring only grows for a line longer than any before */
+        if (line.len > longest)
+        {
+            longest = line.len;
+        }
+        else if (counts.allocs + counts.reallocs != 0)
+        {
+            test_fail(__FUNCTION__, "line %zu of %zu bytes allocated", lines,
+                      line.len);
+        }
+        counts.allocs   = 0;
+        counts.reallocs = 0;
+        lines++;
+    }
+
+    if (lines != 3000 || offset != input.len)
+    {
+        test_fail(__FUNCTION__, "read %zu lines, %zu bytes", lines, offset);
+    }
+
+    /* Reading a bad descriptor fails */
+    struct rstring_reader bad;
+    struct rstring_view   view;
+
+    rstring_reader_init(&bad, -1, '\n');
+    errno = 0;
+    if (rstring_reader_next_view(&bad, &view) != RSTRING_ERROR_IO
+        || errno != EBADF)
+    {
+        test_fail(__FUNCTION__, "bad descriptor did not fail");
+    }
+
+    rstring_reader_free(&bad);
+    rstring_reader_free(&reader);
+    rstring_free(&line);
+    rstring_free(&input);
+    close(fd);
+    unlink(path);
+}
+
+int
+main()
+{
+    basic_test();
+    delimiter_test();
+    large_test();
+    return 0;
+}
@@ -0,0 +1,363 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "../rstring_utf8.h"
+
+/* Byte by byte reference validator, following table 3-7 of Unicode */
+static bool
+reference_validate(const uint8_t *p, size_t n)
+{
+    size_t i = 0;
+
+    while (i < n)
+    {
+        const uint8_t c   = p[i];
+        size_t        len = 0;
+        uint8_t       lo  = 0x80;
+        uint8_t       hi  = 0xBF;
+
+        if (c < 0x80)
+        {
+            len = 1;
+        }
+        else if (c >= 0xC2 && c <= 0xDF)
+        {
+            len = 2;
+        }
+        else if (c >= 0xE0 && c <= 0xEF)
+        {
+            len = 3;
+            lo  = c == 0xE0 ? 0xA0 : 0x80;
+            hi  = c == 0xED ? 0x9F : 0xBF;
+        }
+        else if (c >= 0xF0 && c <= 0xF4)
+        {
+            len = 4;
+            lo  = c == 0xF0 ? 0x90 : 0x80;
+            hi  = c == 0xF4 ? 0x8F : 0xBF;
+        }
+        else
+        {
+            return false;
+        }
+
+        if (n - i < len)
+        {
+            return false;
+        }
+
+        for (size_t k = 1; k < len; ++k)
+        {
+            const uint8_t b = p[i + k];
+            if (k == 1 ? (b < lo || b > hi) : (b & 0xC0) != 0x80)
+            {
+                return false;
+            }
+        }
+
+        i += len;
+    }
+
+    return true;
+}
+
+static void
+check_validate(const char *test_name, const uint8_t *p, size_t n)
+{
+    const bool expected = reference_validate(p, n);
+
+    if (rstring_utf8_validate_view(rstring_view_from_buf((const char *) p, n))
+        != expected)
+    {
+        test_fail(test_name, "%zu bytes starting with %02x: expected %s", n,
+                  n ? p[0] : 0, expected ? "valid" : "invalid");
+    }
+}
+
+static void
+validate_test(void)
+{
+    static const char *valid[] = {
+        "", "hello", "\xC2\x80", "\xDF\xBF", "\xE0\xA0\x80", "\xED\x9F\xBF",
+        "\xEE\x80\x80", "\xEF\xBF\xBF", "\xF0\x90\x80\x80", "\xF4\x8F\xBF\xBF",
+        "Gr\xC3\xBC\xC3\x9F Gott, \xCE\xBA\xCF\x8C\xCF\x83\xCE\xBC\xCE\xB5, "
+        "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E \xF0\x9F\x98\x80"};
+    static const char *invalid[] = {
+        "\x80", "\xBF", "\xC0\x80", "\xC1\xBF", "\xC2", "\xC2\x41",
+        "\xE0\x80\x80", "\xE0\x9F\xBF", "\xED\xA0\x80", "\xED\xBF\xBF",
+        "\xE1\x80", "\xF0\x80\x80\x80", "\xF0\x8F\xBF\xBF", "\xF4\x90\x80\x80",
+        "\xF5\x80\x80\x80", "\xFF", "\xF0\x90\x80", "\xC2\x80\x80",
+        "a\xE1\x80\xC0"};
+
+    for (size_t i = 0; i < sizeof(valid) / sizeof(valid[0]); ++i)
+    {
+        if (!rstring_utf8_validate_view(rstring_view_from_str(valid[i])))
+        {
+            test_fail(__FUNCTION__, "valid[%zu] is invalid", i);
+        }
+    }
+
+    for (size_t i = 0; i < sizeof(invalid) / sizeof(invalid[0]); ++i)
+    {
+        if (rstring_utf8_validate_view(rstring_view_from_str(invalid[i])))
+        {
+            test_fail(__FUNCTION__, "invalid[%zu] is valid", i);
+        }
+    }
+
+    /* Every 1 to 3-byte sequence starting with a lead, at every offset of a
+     * 64-byte block, so that it crosses every block boundary */
+    uint8_t buf[80];
+    for (unsigned c = 0xC0; c <= 0xFF; ++c)
+    {
+        for (unsigned b1 = 0; b1 <= 0xFF; ++b1)
+        {
+            for (unsigned b2 = 0x70; b2 <= 0xC0; b2 += 0x10)
+            {
+                const size_t at = (c + b1 + b2) % 64;
+
+                memset(buf, 'x', sizeof(buf));
+                buf[at]     = (uint8_t) c;
+                buf[at + 1] = (uint8_t) b1;
+                buf[at + 2] = (uint8_t) b2;
+                buf[at + 3] = 0x80;
+
+                check_validate(__FUNCTION__, buf, at + 2);
+                check_validate(__FUNCTION__, buf, at + 3);
+                check_validate(__FUNCTION__, buf, at + 4);
+                check_validate(__FUNCTION__, buf, sizeof(buf));
+            }
+        }
+    }
+
+    /* Random mutations of valid text of many lengths */
+    struct rstring text;
+    rstring_init(&text);
+    for (int i = 0; i < 300; ++i)
+    {
+        rstring_push_str(&text, i % 3 ? "abc \xC3\xA9t\xC3\xA9 "
+                                      : "\xE2\x82\xAC\xF0\x9F\x98\x80 ");
+    }
+
+    uint8_t *copy = malloc(text.len);
+    srand(19);
+    for (int round = 0; round < 20000; ++round)
+    {
+        const size_t n = (size_t) rand() % text.len;
+
+        memcpy(copy, rstring_data(&text), n);
+        if (n > 0 && round % 4 != 0)
+        {
+            copy[(size_t) rand() % n] = (uint8_t) rand();
+        }
+        check_validate(__FUNCTION__, copy, n);
+    }
+
+    free(copy);
+    rstring_free(&text);
+}
+
+static void
+count_test(void)
+{
+    struct rstring rs;
+    rstring_init(&rs);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        if (rstring_utf8_count(&rs) != (size_t) i * 3
+            || rstring_utf8_count_utf16(&rs) != (size_t) i * 4)
+        {
+            test_fail(__FUNCTION__, "%zu code points, %zu units for %d",
+                      rstring_utf8_count(&rs), rstring_utf8_count_utf16(&rs),
+                      i);
+        }
+
+        /* 'a', U+00E9 and U+1F600, of 1, 1 and 2 UTF-16 units */
+        rstring_push_str(&rs, "a\xC3\xA9\xF0\x9F\x98\x80");
+    }
+
+    /* More than 255 blocks of a kernel in a row */
+    rstring_clear(&rs);
+    for (int i = 0; i < 100000; ++i)
+    {
+        rstring_push_str(&rs, "\xE2\x82\xAC");
+    }
+    if (rstring_utf8_count(&rs) != 100000)
+    {
+        test_fail(__FUNCTION__, "%zu code points", rstring_utf8_count(&rs));
+    }
+
+    rstring_free(&rs);
+}
+
+static void
+convert_test(void)
+{
+    static const char text[] =
+        "ASCII only, long enough for a block or two of it; then "
+        "\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80 and \xF4\x8F\xBF\xBF.";
+    const struct rstring_view view = rstring_view_from_str(text);
+    const size_t              n16  = rstring_utf8_count_utf16_view(view);
+    const size_t              n32  = rstring_utf8_count_view(view);
+    uint16_t                  u16[sizeof(text)];
+    uint32_t                  u32[sizeof(text)];
+
+    if (rstring_utf8_to_utf16_view(view, u16) != n16
+        || rstring_utf8_to_utf32_view(view, u32) != n32 || n16 != n32 + 2)
+    {
+        test_fail(__FUNCTION__, "conversion lengths are wrong");
+    }
+
+    /* After the 55 ASCII bytes and U+00E9 */
+    const size_t euro = 56;
+    if (u32[0] != 'A' || u32[55] != 0xE9 || u32[euro] != 0x20AC
+        || u32[euro + 1] != 0x1F600 || u16[euro + 1] != 0xD83D
+        || u16[euro + 2] != 0xDE00 || u32[n32 - 2] != 0x10FFFF)
+    {
+        test_fail(__FUNCTION__, "converted code points are wrong");
+    }
+
+    /* Back to UTF-8 from both */
+    struct rstring rs;
+    rstring_init(&rs);
+
+    if (rstring_push_utf16(&rs, u16, n16) != RSTRING_OK
+        || !rstring_equals_str(&rs, text))
+    {
+        test_fail(__FUNCTION__, "UTF-16 round trip gave '%s'",
+                  rstring_data(&rs));
+    }
+
+    rstring_clear(&rs);
+    if (rstring_push_utf32(&rs, u32, n32) != RSTRING_OK
+        || !rstring_equals_str(&rs, text))
+    {
+        test_fail(__FUNCTION__, "UTF-32 round trip gave '%s'",
+                  rstring_data(&rs));
+    }
+
+    /* Invalid input is reported, and leaves the rstring as it was */
+    static const uint16_t lone_high[] = {'a', 0xD800, 'b'};
+    static const uint16_t lone_low[]  = {0xDC00};
+    static const uint16_t at_end[]    = {'a', 0xDBFF};
+    static const uint32_t surrogate[] = {'a', 0xDFFF};
+    static const uint32_t too_large[] = {0x110000};
+
+    if (rstring_push_utf16(&rs, lone_high, 3) != RSTRING_ERROR_ENCODING
+        || rstring_push_utf16(&rs, lone_low, 1) != RSTRING_ERROR_ENCODING
+        || rstring_push_utf16(&rs, at_end, 2) != RSTRING_ERROR_ENCODING
+        || rstring_push_utf32(&rs, surrogate, 2) != RSTRING_ERROR_ENCODING
+        || rstring_push_utf32(&rs, too_large, 1) != RSTRING_ERROR_ENCODING
+        || !rstring_equals_str(&rs, text))
+    {
+        test_fail(__FUNCTION__, "invalid input was accepted");
+    }
+
+    if (rstring_utf8_to_utf32_view(rstring_view_from_str("ab\xED\xA0\x80"), u32)
+            != RSTRING_UTF8_INVALID
+        || rstring_utf8_to_utf16_view(rstring_view_from_str("\xC2"), u16)
+               != RSTRING_UTF8_INVALID)
+    {
+        test_fail(__FUNCTION__, "invalid UTF-8 was converted");
+    }
+
+    /* A zero-initialized rstring is valid */
+    static const uint32_t abc[] = {'a', 0xE9, 'z'};
+    struct rstring        zero  = {0};
+
+    rstring_push_utf32(&zero, abc, 3);
+    if (!rstring_equals_str(&zero, "a\xC3\xA9z"))
+    {
+        test_fail(__FUNCTION__, "pushed '%s'", rstring_data(&zero));
+    }
+
+    rstring_free(&zero);
+    rstring_free(&rs);
+}
+
+static void
+tolower_test(void)
+{
+    static const char *cases[][2] = {
+        {"", ""},
+        {"Hello, World", "hello, world"},
+        {"\xC3\x80\xC3\x89\xC3\x8E \xCE\xA3\xCE\x91\xCE\xA3",
+         "\xC3\xA0\xC3\xA9\xC3\xAE \xCF\x83\xCE\xB1\xCF\x83"},
+        {"\xD0\x9F\xD0\xA0\xD0\x98\xD0\x92\xD0\x95\xD0\xA2",
+         "\xD0\xBF\xD1\x80\xD0\xB8\xD0\xB2\xD0\xB5\xD1\x82"},
+        /* Already lower case, or without case */
+        {"\xC3\x9F\xE6\x97\xA5\xF0\x9F\x98\x80",
+         "\xC3\x9F\xE6\x97\xA5\xF0\x9F\x98\x80"},
+        /* Before the first run: U+0080, NBSP, (C), degree, 1/2, U+00BF */
+        {"\xC2\x80\xC2\xA0\xC2\xA9 25\xC2\xB0" "C \xC2\xBD\xC2\xBF",
+         "\xC2\x80\xC2\xA0\xC2\xA9 25\xC2\xB0" "c \xC2\xBD\xC2\xBF"},
+        /* Between runs: multiplication and division signs */
+        {"\xC3\x96\xC3\x97\xC3\x98\xC3\xB7\xC3\x9E",
+         "\xC3\xB6\xC3\x97\xC3\xB8\xC3\xB7\xC3\xBE"},
+        /* Invalid bytes are kept */
+        {"A\xFF\xC3\x80\xC3", "a\xFF\xC3\xA0\xC3"},
+        /* Shorter: KELVIN SIGN, U+0130, OHM SIGN */
+        {"\xE2\x84\xAA\xC4\xB0\xE2\x84\xA6X", "ki\xCF\x89x"},
+        /* Longer: U+023A to U+2C65 */
+        {"\xC8\xBA\xC8\xBA", "\xE2\xB1\xA5\xE2\xB1\xA5"},
+        /* 4-byte: DESERET CAPITAL LONG I, ADLAM CAPITAL ALIF */
+        {"\xF0\x90\x90\x80\xF0\x9E\xA4\x80",
+         "\xF0\x90\x90\xA8\xF0\x9E\xA4\xA2"},
+    };
+
+    struct rstring rs;
+    rstring_init(&rs);
+
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i)
+    {
+        rstring_clear(&rs);
+        rstring_push_str(&rs, cases[i][0]);
+
+        if (rstring_utf8_tolower(&rs) != RSTRING_OK
+            || !rstring_equals_str(&rs, cases[i][1]))
+        {
+            test_fail(__FUNCTION__, "case %zu gave '%s'", i, rstring_data(&rs));
+        }
+    }
+
+    /* Rebuilt on the heap, and from the heap inline again */
+    struct rstring expected;
+    rstring_init(&expected);
+    rstring_clear(&rs);
+    for (int i = 0; i < 100; ++i)
+    {
+        rstring_push_str(&rs, "\xC3\x84 Long Text \xC8\xBA ");
+        rstring_push_str(&expected, "\xC3\xA4 long text \xE2\xB1\xA5 ");
+    }
+
+    if (rstring_utf8_tolower(&rs) != RSTRING_OK
+        || !rstring_equals(&rs, &expected))
+    {
+        test_fail(__FUNCTION__, "long text gave '%s'", rstring_data(&rs));
+    }
+
+    rstring_free(&rs);
+    rstring_push_str(&rs, "\xE2\x84\xAA");
+    if (rstring_utf8_tolower(&rs) != RSTRING_OK || !rstring_equals_str(&rs, "k")
+        || rstring_is_inline(&rs) != (1 < RSTRING_SSO_CAPACITY)
+        || rstring_data(&rs)[1] != '\0')
+    {
+        test_fail(__FUNCTION__, "inline rebuild gave '%s'", rstring_data(&rs));
+    }
+
+    rstring_free(&expected);
+    rstring_free(&rs);
+}
+
+int
+main()
+{
+    validate_test();
+    count_test();
+    convert_test();
+    tolower_test();
+    return 0;
+}
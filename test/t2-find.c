@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 
+#include <ctype.h>
 #include <stdbool.h>
 
 #include "common.h"
@@ -120,6 +121,280 @@ find_first_test(const char *haystack, const char *needle, size_t from,
     rstring_free(&rs_needle);
 }
 
+void
+find_first_binary_test(void)
+{
+    // Embedded null bytes are regular bytes, both in the haystack and needle.
+    const char     haystack[] = "ab\0cd\0ef\0cd\0gh";
+    const char     needle[]   = "\0cd\0g";
+    struct rstring rs_haystack;
+    struct rstring rs_needle;
+
+    rstring_init(&rs_haystack);
+    rstring_init(&rs_needle);
+
+    for (size_t i = 0; i < sizeof(haystack) - 1; ++i)
+    {
+        rstring_push_byte(&rs_haystack, (uint8_t) haystack[i]);
+    }
+
+    for (size_t i = 0; i < sizeof(needle) - 1; ++i)
+    {
+        rstring_push_byte(&rs_needle, (uint8_t) needle[i]);
+    }
+
+    size_t result = rstring_find_first(&rs_haystack, &rs_needle, 0);
+    if (result != 8)
+    {
+        test_fail(__FUNCTION__, "expected 8, got %zu", result);
+    }
+
+    result = rstring_find_first_ignore_case(&rs_haystack, &rs_needle, 0);
+    if (result != 8)
+    {
+        test_fail(__FUNCTION__, "expected 8 (ignore case), got %zu", result);
+    }
+
+    rstring_free(&rs_haystack);
+    rstring_free(&rs_needle);
+}
+
+static size_t
+naive_find_first(const struct rstring *haystack, const struct rstring *needle,
+                 size_t from, bool ignore_case)
+{
+    const char *h = rstring_data(haystack);
+    const char *n = rstring_data(needle);
+
+    for (size_t i = from; i + needle->len <= haystack->len; ++i)
+    {
+        size_t j = 0;
+        while (j < needle->len &&
+               (ignore_case ? tolower((unsigned char) h[i + j]) ==
+                                  tolower((unsigned char) n[j])
+                            : h[i + j] == n[j]))
+        {
+            ++j;
+        }
+
+        if (j == needle->len)
+        {
+            return i;
+        }
+    }
+
+    return RSTRING_NOT_FOUND;
+}
+
+void
+find_first_random_test(void)
+{
+    // Long haystacks over a small alphabet, so that the vectorized kernels see
+    // plenty of candidates, full blocks and tails.
+    const char     alphabet[] = "abAB\0";
+    struct rstring haystack;
+    struct rstring needle;
+
+    srand(1234);
+
+    for (int round = 0; round < 2000; ++round)
+    {
+        const size_t haystack_len = (size_t) (rand() % 300);
+        const size_t needle_len   = 1 + (size_t) (rand() % 6);
+        const size_t from         = (size_t) (rand() % 40);
+        const bool   ignore_case  = rand() % 2;
+
+        rstring_init(&haystack);
+        rstring_init(&needle);
+
+        for (size_t i = 0; i < haystack_len; ++i)
+        {
+            rstring_push_byte(&haystack, (uint8_t) alphabet[rand() % 5]);
+        }
+
+        for (size_t i = 0; i < needle_len; ++i)
+        {
+            rstring_push_byte(&needle, (uint8_t) alphabet[rand() % 5]);
+        }
+
+        const size_t expected =
+            naive_find_first(&haystack, &needle, from, ignore_case);
+        const size_t result =
+            ignore_case
+                ? rstring_find_first_ignore_case(&haystack, &needle, from)
+                : rstring_find_first(&haystack, &needle, from);
+
+        if (result != expected)
+        {
+            test_fail(__FUNCTION__,
+                      "round %d: expected %zu, got %zu",
+                      round,
+                      expected,
+                      result);
+        }
+
+        rstring_free(&haystack);
+        rstring_free(&needle);
+    }
+}
+
+void
+find_last_test(const char *haystack, const char *needle, size_t end,
+               bool ignore_case, size_t result)
+{
+    struct rstring rs_haystack =
+        init_test("find_last_test (haystack)", haystack);
+    struct rstring rs_needle = init_test("find_last_test (needle)", needle);
+    size_t         res_rs_rs;
+    size_t         res_rs_str;
+
+    if (ignore_case)
+    {
+        res_rs_rs =
+            rstring_find_last_ignore_case(&rs_haystack, &rs_needle, end);
+        res_rs_str =
+            rstring_find_last_str_ignore_case(&rs_haystack, needle, end);
+    }
+    else
+    {
+        res_rs_rs  = rstring_find_last(&rs_haystack, &rs_needle, end);
+        res_rs_str = rstring_find_last_str(&rs_haystack, needle, end);
+    }
+
+    if (res_rs_rs != result || res_rs_str != result)
+    {
+        test_fail(__FUNCTION__,
+                  "In '%s', find last '%s' before %zu: got %zu / %zu, "
+                  "expected %zu",
+                  haystack,
+                  needle,
+                  end,
+                  res_rs_rs,
+                  res_rs_str,
+                  result);
+    }
+
+    rstring_free(&rs_haystack);
+    rstring_free(&rs_needle);
+}
+
+static size_t
+naive_find_last(const struct rstring *haystack, const struct rstring *needle,
+                size_t end, bool ignore_case)
+{
+    size_t last = RSTRING_NOT_FOUND;
+
+    if (end > haystack->len)
+    {
+        end = haystack->len;
+    }
+
+    for (size_t i = 0; i + needle->len <= end; ++i)
+    {
+        if (naive_find_first(haystack, needle, i, ignore_case) == i)
+        {
+            last = i;
+        }
+    }
+
+    return last;
+}
+
+void
+find_last_random_test(void)
+{
+    const char     alphabet[] = "abAB\0";
+    struct rstring haystack;
+    struct rstring needle;
+
+    srand(4321);
+
+    for (int round = 0; round < 2000; ++round)
+    {
+        const size_t haystack_len = (size_t) (rand() % 300);
+        const size_t needle_len   = 1 + (size_t) (rand() % 6);
+        const size_t end          = haystack_len - (size_t) (rand() % 40);
+        const bool   ignore_case  = rand() % 2;
+
+        rstring_init(&haystack);
+        rstring_init(&needle);
+
+        for (size_t i = 0; i < haystack_len; ++i)
+        {
+            rstring_push_byte(&haystack, (uint8_t) alphabet[rand() % 5]);
+        }
+
+        for (size_t i = 0; i < needle_len; ++i)
+        {
+            rstring_push_byte(&needle, (uint8_t) alphabet[rand() % 5]);
+        }
+
+        const size_t expected =
+            naive_find_last(&haystack, &needle, end, ignore_case);
+        const size_t result =
+            ignore_case ? rstring_find_last_ignore_case(&haystack, &needle, end)
+                        : rstring_find_last(&haystack, &needle, end);
+
+        if (result != expected)
+        {
+            test_fail(__FUNCTION__,
+                      "round %d: expected %zu, got %zu",
+                      round,
+                      expected,
+                      result);
+        }
+
+        if (needle_len == 1 && !ignore_case
+            && rstring_find_last_byte_from(
+                   &haystack, (uint8_t) rstring_data(&needle)[0], end)
+                   != expected)
+        {
+            test_fail(__FUNCTION__, "round %d: byte search mismatch", round);
+        }
+
+        rstring_free(&haystack);
+        rstring_free(&needle);
+    }
+}
+
+void
+find_last_byte_from_test(void)
+{
+    // A single match at every position of a buffer spanning several blocks,
+    // searched for with every end bound around it.
+    struct rstring rs = {0};
+
+    for (size_t i = 0; i < 200; ++i)
+    {
+        rstring_push_byte(&rs, '.');
+    }
+
+    for (size_t pos = 0; pos < rs.len; ++pos)
+    {
+        rstring_data_mut(&rs)[pos] = '/';
+
+        for (size_t end = 0; end <= rs.len + 1; ++end)
+        {
+            const size_t expected = pos < end ? pos : RSTRING_NOT_FOUND;
+            const size_t result   = rstring_find_last_byte_from(&rs, '/', end);
+
+            if (result != expected)
+            {
+                test_fail(__FUNCTION__,
+                          "match at %zu, end %zu: expected %zu, got %zu",
+                          pos,
+                          end,
+                          expected,
+                          result);
+            }
+        }
+
+        rstring_data_mut(&rs)[pos] = '.';
+    }
+
+    rstring_free(&rs);
+}
+
 int
 main()
 {
@@ -141,6 +416,7 @@ main()
     find_last_byte_test(" abc", 'a', 1);
     find_last_byte_test(" \x80\x90\xFC\x10\x20\xFC", '\xFC', 6);
     find_last_byte_test(" \x80\x90\xFC\x10\x20\xFC", '\x20', 5);
+    find_last_byte_from_test();
 
     find_first_test("", "", 0, false, 0);
     find_first_test("", "", 0, true, 0);
@@ -155,6 +431,20 @@ main()
     find_first_test("libhttp4http", "???", 0, true, RSTRING_NOT_FOUND);
     find_first_test("libhttp4http", "http", 8, false, 8);
     find_first_test("", "http", 8, false, RSTRING_NOT_FOUND);
+    find_first_test("x-Forwarded-FOR: 1", "forwarded-for", 0, true, 2);
+    find_first_test("a@b`c[d{e", "[D{", 0, true, 5);
+    find_first_test("a@b`c[d{e", "{D[", 0, true, RSTRING_NOT_FOUND);
+
+    find_first_binary_test();
+    find_first_random_test();
+
+    find_last_test("", "", 0, false, 0);
+    find_last_test("a", "", 5, false, 1);
+    find_last_test("libhttp4http", "http", 100, false, 8);
+    find_last_test("libhttp4http", "http", 11, false, 3);
+    find_last_test("libhttp4http", "HTTP", 12, true, 8);
+    find_last_test("libhttp4http", "http", 6, false, RSTRING_NOT_FOUND);
+    find_last_random_test();
 
     return 0;
 }
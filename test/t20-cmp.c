@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "../rstring.h"
+
+static int
+sign(int x)
+{
+    return (x > 0) - (x < 0);
+}
+
+/* Byte by byte reference of rstring_view_cmp_ignore_case */
+static int
+reference_cmp_ignore_case(const char *a, size_t a_len, const char *b,
+                          size_t b_len)
+{
+    for (size_t i = 0; i < a_len && i < b_len; ++i)
+    {
+        unsigned char ca = (unsigned char) a[i];
+        unsigned char cb = (unsigned char) b[i];
+
+        ca = ca >= 'A' && ca <= 'Z' ? ca + 32 : ca;
+        cb = cb >= 'A' && cb <= 'Z' ? cb + 32 : cb;
+        if (ca != cb)
+        {
+            return ca < cb ? -1 : 1;
+        }
+    }
+
+    return a_len == b_len ? 0 : a_len < b_len ? -1 : 1;
+}
+
+static void
+cmp_test(void)
+{
+    struct rstring abc;
+    struct rstring abcd;
+    struct rstring nul;
+
+    rstring_init(&abc);
+    rstring_init(&abcd);
+    rstring_init(&nul);
+    rstring_push_str(&abc, "abc");
+    rstring_push_str(&abcd, "abcd");
+    rstring_push_view(&nul, rstring_view_from_buf("abc\0d", 5));
+
+    /* A prefix orders first, whichever side it is on */
+    if (rstring_cmp(&abc, &abcd) >= 0 || rstring_cmp(&abcd, &abc) <= 0
+        || rstring_cmp(&abc, &abc) != 0)
+    {
+        test_fail(__FUNCTION__, "prefixes do not order first");
+    }
+
+    /* Null bytes are compared, not taken as the end */
+    if (rstring_cmp(&nul, &abc) <= 0 || rstring_cmp_str(&nul, "abc") <= 0
+        || rstring_equals_str(&nul, "abc") || rstring_equals(&nul, &abc)
+        || rstring_cmp(&nul, &abcd) >= 0)
+    {
+        test_fail(__FUNCTION__, "null bytes end the comparison");
+    }
+
+    if (rstring_cmp_str(&abc, "abcd") >= 0
+        || rstring_cmp_str(&abcd, "abc") <= 0
+        || rstring_cmp_str(&abc, "abc") != 0
+        || !rstring_equals_str(&abc, "abc"))
+    {
+        test_fail(__FUNCTION__, "comparisons with C strings are wrong");
+    }
+
+    if (rstring_cmp_ignore_case(&nul, &abc) <= 0
+        || rstring_cmp_str_ignore_case(&nul, "ABC") <= 0
+        || rstring_cmp_str_ignore_case(&abc, "ABCD") >= 0
+        || rstring_cmp_str_ignore_case(&abc, "ABC") != 0
+        || !rstring_equals_str_ignore_case(&abcd, "AbCd")
+        || rstring_equals_str_ignore_case(&nul, "ABC")
+        || rstring_equals_ignore_case(&nul, &abc))
+    {
+        test_fail(__FUNCTION__, "case-insensitive comparisons are wrong");
+    }
+
+    /* Ignoring case only folds ASCII letters: '[' is between 'Z' and 'a' */
+    if (rstring_cmp_str_ignore_case(&abc, "[") <= 0
+        || rstring_cmp_str(&abc, "[") <= 0
+        || rstring_cmp_str_ignore_case(&abc, "\xC0") >= 0)
+    {
+        test_fail(__FUNCTION__, "non-letters are folded");
+    }
+
+    rstring_free(&abc);
+    rstring_free(&abcd);
+    rstring_free(&nul);
+}
+
+static void
+random_test(void)
+{
+    static const char alphabet[] = "aAbBzZ@[`{\0\xC1\xE1";
+    char              a[300];
+    char              b[300];
+
+    srand(20);
+    for (int round = 0; round < 200000; ++round)
+    {
+        const size_t a_len = (size_t) rand() % sizeof(a);
+        const size_t b_len = rand() % 4 ? a_len : (size_t) rand() % sizeof(b);
+
+        for (size_t i = 0; i < a_len; ++i)
+        {
+            a[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+        }
+
+        /* Mostly equal ignoring case, up to a random position */
+        const size_t same = (size_t) rand() % (b_len + 1);
+        for (size_t i = 0; i < b_len; ++i)
+        {
+            if (i < same && i < a_len)
+            {
+                const char lower = (char) (a[i] | 0x20);
+
+                b[i] = rand() % 2 && lower >= 'a' && lower <= 'z' ? a[i] ^ 0x20
+                                                                  : a[i];
+            }
+            else
+            {
+                b[i] = alphabet[rand() % (sizeof(alphabet) - 1)];
+            }
+        }
+
+        const struct rstring_view va = rstring_view_from_buf(a, a_len);
+        const struct rstring_view vb = rstring_view_from_buf(b, b_len);
+        const int expected = reference_cmp_ignore_case(a, a_len, b, b_len);
+
+        if (sign(rstring_view_cmp_ignore_case(va, vb)) != expected
+            || rstring_view_equals_ignore_case(va, vb) != (expected == 0))
+        {
+            test_fail(__FUNCTION__, "round %d: expected %d", round, expected);
+        }
+
+        /* The common prefix is where memcmp, or the reference, first differ */
+        size_t prefix = 0;
+        while (prefix < a_len && prefix < b_len && a[prefix] == b[prefix])
+        {
+            prefix++;
+        }
+
+        size_t prefix_ic = 0;
+        while (prefix_ic < a_len && prefix_ic < b_len
+               && reference_cmp_ignore_case(a + prefix_ic, 1, b + prefix_ic, 1)
+                      == 0)
+        {
+            prefix_ic++;
+        }
+
+        if (rstring_view_common_prefix(va, vb) != prefix
+            || rstring_view_common_prefix_ignore_case(va, vb) != prefix_ic)
+        {
+            test_fail(__FUNCTION__, "round %d: common prefix %zu, %zu", round,
+                      prefix, prefix_ic);
+        }
+    }
+}
+
+static void
+affix_test(void)
+{
+    struct rstring rs;
+    struct rstring affix;
+
+    rstring_init(&rs);
+    rstring_init(&affix);
+    rstring_push_str(&rs, "Hello, World");
+
+    if (!rstring_starts_with_str(&rs, "Hello")
+        || !rstring_starts_with_str(&rs, "")
+        || rstring_starts_with_str(&rs, "hello")
+        || !rstring_starts_with_str_ignore_case(&rs, "hello")
+        || rstring_starts_with_str(&rs, "Hello, World!")
+        || !rstring_starts_with_view(&rs, rstring_view_from(&rs)))
+    {
+        test_fail(__FUNCTION__, "starts_with is wrong");
+    }
+
+    if (!rstring_ends_with_str(&rs, "World") || !rstring_ends_with_str(&rs, "")
+        || rstring_ends_with_str(&rs, "world")
+        || !rstring_ends_with_str_ignore_case(&rs, "WORLD")
+        || rstring_ends_with_str(&rs, "> Hello, World")
+        || !rstring_ends_with_view_ignore_case(&rs,
+                                               rstring_view_from_str("D")))
+    {
+        test_fail(__FUNCTION__, "ends_with is wrong");
+    }
+
+    rstring_push_str(&affix, "HELLO, WORLD");
+    if (rstring_starts_with(&rs, &affix) || rstring_ends_with(&rs, &affix)
+        || !rstring_starts_with_ignore_case(&rs, &affix)
+        || !rstring_ends_with_ignore_case(&rs, &affix)
+        || rstring_common_prefix(&rs, &affix) != 1
+        || rstring_common_prefix_ignore_case(&rs, &affix) != rs.len)
+    {
+        test_fail(__FUNCTION__, "rstring affixes are wrong");
+    }
+
+    rstring_free(&rs);
+    rstring_free(&affix);
+}
+
+static int
+qsort_cmp(const void *a, const void *b)
+{
+    return rstring_cmp(a, b);
+}
+
+static void
+sort_test(void)
+{
+    /* Sorting and removing duplicates, which needs a total order */
+    static const char *words[] = {"b", "a", "ab", "a", "", "b\0", "ab", "abc"};
+    struct rstring     rs[8];
+
+    for (size_t i = 0; i < 8; ++i)
+    {
+        rstring_init(&rs[i]);
+        rstring_push_view(&rs[i], rstring_view_from_buf(
+                                      words[i], strlen(words[i]) + (i == 5)));
+    }
+
+    qsort(rs, 8, sizeof(rs[0]), qsort_cmp);
+
+    size_t unique = 1;
+    for (size_t i = 1; i < 8; ++i)
+    {
+        if (rstring_cmp(&rs[i - 1], &rs[i]) > 0)
+        {
+            test_fail(__FUNCTION__, "not sorted at %zu", i);
+        }
+        unique += !rstring_equals(&rs[i - 1], &rs[i]);
+    }
+
+    if (unique != 6 || rs[0].len != 0 || !rstring_equals_str(&rs[6], "b")
+        || rs[7].len != 2)
+    {
+        test_fail(__FUNCTION__, "%zu unique strings", unique);
+    }
+
+    for (size_t i = 0; i < 8; ++i)
+    {
+        rstring_free(&rs[i]);
+    }
+}
+
+int
+main()
+{
+    cmp_test();
+    random_test();
+    affix_test();
+    sort_test();
+    return 0;
+}
@@ -0,0 +1,202 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "../rstring_stats.h"
+
+static bool
+stats_are_zero(const struct rstring_stats *stats)
+{
+    static const struct rstring_stats zero;
+    return memcmp(stats, &zero, sizeof(zero)) == 0;
+}
+
+static void
+disabled_test(void)
+{
+    struct rstring       rs;
+    struct rstring_stats stats;
+
+    rstring_init(&rs);
+    for (int i = 0; i < 1000; ++i)
+    {
+        rstring_push_str(&rs, "grow ");
+    }
+    rstring_find_first_str(&rs, "none", 0);
+    rstring_stats_sample(&rs);
+    rstring_free(&rs);
+
+    rstring_stats_snapshot(&stats);
+    if (!stats_are_zero(&stats))
+    {
+        test_fail(__FUNCTION__, "counters moved while compiled out");
+    }
+}
+
+static void
+alloc_test(void)
+{
+    struct rstring       rs;
+    struct rstring_stats stats;
+
+    rstring_stats_reset();
+    rstring_stats_snapshot(&stats);
+    if (!stats_are_zero(&stats))
+    {
+        test_fail(__FUNCTION__, "counters not reset");
+    }
+
+    /* Inline rstrings allocate nothing */
+    rstring_init(&rs);
+    rstring_push_str(&rs, "short");
+    rstring_free(&rs);
+
+    rstring_stats_snapshot(&stats);
+    if (!stats_are_zero(&stats))
+    {
+        test_fail(__FUNCTION__, "inline rstrings were counted");
+    }
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        rstring_push_str(&rs, "grow ");
+    }
+
+    rstring_stats_snapshot(&stats);
+    if (stats.allocs != 1 || stats.reallocs == 0
+        || stats.realloc_bytes < stats.reallocs * 24 || stats.frees != 0)
+    {
+        test_fail(__FUNCTION__, "%zu allocs, %zu reallocs of %zu bytes",
+                  stats.allocs, stats.reallocs, stats.realloc_bytes);
+    }
+
+    const size_t unused = rs.cap - rs.len;
+    const size_t bucket = rs.len * RSTRING_STATS_FILL_BUCKETS / rs.cap;
+
+    /* A live rstring is only in the histogram once sampled */
+    if (stats.unused_bytes != 0 || stats.fill[bucket] != 0)
+    {
+        test_fail(__FUNCTION__, "live rstring counted before being sampled");
+    }
+
+    rstring_stats_sample(&rs);
+    rstring_stats_snapshot(&stats);
+    if (stats.frees != 0 || stats.unused_bytes != unused
+        || stats.fill[bucket] != 1)
+    {
+        test_fail(__FUNCTION__, "sampled %zu unused bytes, %zu in bucket %zu",
+                  stats.unused_bytes, stats.fill[bucket], bucket);
+    }
+
+    rstring_free(&rs);
+    rstring_stats_snapshot(&stats);
+    if (stats.frees != 1 || stats.unused_bytes != 2 * unused
+        || stats.fill[bucket] != 2)
+    {
+        test_fail(__FUNCTION__, "%zu frees, %zu unused bytes", stats.frees,
+                  stats.unused_bytes);
+    }
+
+    /* Inline rstrings are not sampled */
+    rstring_stats_reset();
+    rstring_init(&rs);
+    rstring_push_str(&rs, "short");
+    rstring_stats_sample(&rs);
+    rstring_free(&rs);
+    rstring_stats_snapshot(&stats);
+    if (!stats_are_zero(&stats))
+    {
+        test_fail(__FUNCTION__, "inline rstring sampled");
+    }
+}
+
+static void
+find_test(void)
+{
+    struct rstring       rs;
+    struct rstring_stats stats;
+
+    rstring_init(&rs);
+    for (int i = 0; i < 10; ++i)
+    {
+        rstring_push_str(&rs, "0123456789");
+    }
+
+    rstring_stats_reset();
+
+    /* Not found: the whole haystack, from the offset */
+    rstring_find_first_str(&rs, "x", 0);
+    rstring_find_first_byte(&rs, 'x', 50);
+    rstring_stats_snapshot(&stats);
+    if (stats.finds != 2 || stats.find_bytes != 150)
+    {
+        test_fail(__FUNCTION__, "%zu finds of %zu bytes", stats.finds,
+                  stats.find_bytes);
+    }
+
+    /* Found: up to the end of the match, or from the end backwards */
+    rstring_stats_reset();
+    rstring_find_first_str(&rs, "345", 10);
+    rstring_find_last_str(&rs, "89", rs.len);
+    rstring_stats_snapshot(&stats);
+    if (stats.finds != 2 || stats.find_bytes != 6 + 2)
+    {
+        test_fail(__FUNCTION__, "%zu finds of %zu bytes", stats.finds,
+                  stats.find_bytes);
+    }
+
+    rstring_free(&rs);
+}
+
+static void
+dump_test(void)
+{
+    struct rstring       out;
+    struct rstring_stats stats;
+
+    memset(&stats, 0, sizeof(stats));
+    stats.allocs     = 3;
+    stats.find_bytes = 42;
+    stats.fill[4]    = 7;
+    stats.fill[7]    = 1;
+
+    rstring_init(&out);
+    if (rstring_stats_dump(&out, &stats) != RSTRING_OK)
+    {
+        test_fail(__FUNCTION__, "dump failed");
+    }
+
+    size_t lines = 0;
+    for (size_t i = 0; i < out.len; ++i)
+    {
+        lines += rstring_data(&out)[i] == '\n';
+    }
+
+    if (lines != 7 + RSTRING_STATS_FILL_BUCKETS
+        || strstr(rstring_data(&out), "allocs 3\n") == NULL
+        || strstr(rstring_data(&out), "find_bytes 42\n") == NULL
+        || strstr(rstring_data(&out), "fill_50 7\n") == NULL
+        || strstr(rstring_data(&out), "fill_87 1\n") == NULL)
+    {
+        test_fail(__FUNCTION__, "unexpected dump:\n%s", rstring_data(&out));
+    }
+
+    rstring_free(&out);
+}
+
+int
+main()
+{
+    if (!rstring_stats_enabled())
+    {
+        disabled_test();
+        dump_test();
+        return 0;
+    }
+
+    alloc_test();
+    find_test();
+    dump_test();
+    return 0;
+}
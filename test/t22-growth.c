@@ -0,0 +1,214 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "../rstring.h"
+
+static void
+push_many(struct rstring *rs, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        rstring_push_byte(rs, (uint8_t) ('a' + rs->len % 26));
+    }
+}
+
+static void
+policy_test(void)
+{
+    static const enum rstring_growth_policy policies[] = {
+        RSTRING_GROWTH_X1_5,
+        RSTRING_GROWTH_X2,
+        RSTRING_GROWTH_POW2,
+        RSTRING_GROWTH_PAGES,
+    };
+
+    for (size_t p = 0; p < 4; ++p)
+    {
+        struct rstring rs;
+        size_t         growths = 0;
+        size_t         cap     = 0;
+
+        const enum rstring_growth_policy previous =
+            rstring_set_growth_policy(policies[p]);
+        if (previous != (p == 0 ? RSTRING_GROWTH_X1_5 : policies[p - 1]))
+        {
+            test_fail(__FUNCTION__, "policy %zu: previous is %d", p, previous);
+        }
+
+        rstring_init(&rs);
+        for (size_t i = 0; i < 1000000; ++i)
+        {
+            rstring_push_byte(&rs, (uint8_t) ('a' + i % 26));
+            if (rs.cap != cap)
+            {
+                /* Growing by a factor keeps appending amortized */
+                const bool by_factor = policies[p] == RSTRING_GROWTH_X1_5
+                                    || policies[p] == RSTRING_GROWTH_X2;
+                if (by_factor && rs.cap < cap + cap / 2)
+                {
+                    test_fail(__FUNCTION__, "policy %zu: %zu grew to %zu", p,
+                              cap, rs.cap);
+                }
+                cap = rs.cap;
+                growths++;
+            }
+
+            if (policies[p] == RSTRING_GROWTH_POW2 && !rstring_is_inline(&rs)
+                && (rs.cap & (rs.cap - 1)) != 0)
+            {
+                test_fail(__FUNCTION__, "capacity %zu is not a power of 2",
+                          rs.cap);
+            }
+
+            if (policies[p] == RSTRING_GROWTH_PAGES
+                && rs.cap >= RSTRING_GROWTH_PAGES_THRESHOLD
+                && (rs.cap + 2 * sizeof(size_t)) % 4096 != 0)
+            {
+                test_fail(__FUNCTION__, "capacity %zu is not page-rounded",
+                          rs.cap);
+            }
+        }
+
+        check_alphabet(__FUNCTION__, &rs, 1000000);
+        if (growths > 40)
+        {
+            test_fail(__FUNCTION__, "policy %zu: %zu growths", p, growths);
+        }
+        rstring_free(&rs);
+    }
+
+    rstring_set_growth_policy(RSTRING_GROWTH_X1_5);
+}
+
+static void
+large_reserve_test(void)
+{
+    struct counting_allocator      counts    = {0};
+    const struct rstring_allocator allocator = COUNTING_ALLOCATOR(&counts);
+    struct rstring                 rs;
+
+    /* A single large request is allocated as is, in one call */
+    rstring_init_with_allocator(&rs, &allocator);
+    push_many(&rs, 100);
+    counts.allocs   = 0;
+    counts.reallocs = 0;
+
+    if (rstring_ensure_capacity(&rs, 64 << 20) != RSTRING_OK
+        || rs.cap != 64 << 20 || counts.reallocs != 1)
+    {
+        test_fail(__FUNCTION__, "capacity %zu after %zu reallocs", rs.cap,
+                  counts.reallocs);
+    }
+
+    /* Filling the buffer exactly reallocates nothing */
+    push_many(&rs, rs.cap - 1 - rs.len);
+    if (counts.reallocs != 1)
+    {
+        test_fail(__FUNCTION__, "%zu reallocs to fill the buffer",
+                  counts.reallocs);
+    }
+
+    check_alphabet(__FUNCTION__, &rs, (64 << 20) - 1);
+    rstring_free(&rs);
+}
+
+static void
+reserve_exact_test(void)
+{
+    const size_t   short_len = RSTRING_SSO_CAPACITY - 1;
+    struct rstring rs;
+
+    rstring_init(&rs);
+    push_many(&rs, short_len);
+
+    /* The inline buffer is enough */
+    if (rstring_reserve_exact(&rs, RSTRING_SSO_CAPACITY) != RSTRING_OK
+        || !rstring_is_inline(&rs))
+    {
+        test_fail(__FUNCTION__, "the inline buffer was not enough");
+    }
+
+    if (rstring_reserve_exact(&rs, 1000) != RSTRING_OK || rs.cap != 1000)
+    {
+        test_fail(__FUNCTION__, "capacity is %zu, not 1000", rs.cap);
+    }
+
+    /* Never shrinks */
+    if (rstring_reserve_exact(&rs, 100) != RSTRING_OK || rs.cap != 1000)
+    {
+        test_fail(__FUNCTION__, "capacity is %zu, not 1000", rs.cap);
+    }
+
+    push_many(&rs, 999 - short_len);
+    if (rs.cap != 1000)
+    {
+        test_fail(__FUNCTION__, "filling the buffer grew it to %zu", rs.cap);
+    }
+
+    check_alphabet(__FUNCTION__, &rs, 999);
+    rstring_free(&rs);
+}
+
+static void
+shrink_test(void)
+{
+    struct counting_allocator      counts    = {0};
+    const struct rstring_allocator allocator = COUNTING_ALLOCATOR(&counts);
+    const size_t                   short_len = RSTRING_SSO_CAPACITY - 1;
+    struct rstring                 rs;
+
+    /* Inline: nothing to do */
+    rstring_init_with_allocator(&rs, &allocator);
+    push_many(&rs, short_len);
+    if (rstring_shrink_to_fit(&rs) != RSTRING_OK || !rstring_is_inline(&rs)
+        || counts.allocs + counts.reallocs + counts.frees != 0)
+    {
+        test_fail(__FUNCTION__, "an inline rstring was shrunk");
+    }
+
+    /* Heap: reallocated to its length */
+    push_many(&rs, 1000 - short_len);
+    if (rstring_shrink_to_fit(&rs) != RSTRING_OK || rs.cap != 1001)
+    {
+        test_fail(__FUNCTION__, "capacity is %zu, not 1001", rs.cap);
+    }
+    check_alphabet(__FUNCTION__, &rs, 1000);
+
+    const size_t reallocs = counts.reallocs;
+    if (rstring_shrink_to_fit(&rs) != RSTRING_OK || counts.reallocs != reallocs)
+    {
+        test_fail(__FUNCTION__, "a tight rstring was reallocated");
+    }
+
+    /* Short enough for the inline buffer: the heap buffer is released */
+    rstring_erase(&rs, short_len, rs.len);
+    if (rstring_shrink_to_fit(&rs) != RSTRING_OK || !rstring_is_inline(&rs)
+        || counts.frees != 1 || rs.data != NULL)
+    {
+        test_fail(__FUNCTION__, "not moved back inline");
+    }
+    check_alphabet(__FUNCTION__, &rs, short_len);
+
+    /* And it still grows */
+    push_many(&rs, 100 - short_len);
+    check_alphabet(__FUNCTION__, &rs, 100);
+    rstring_free(&rs);
+
+    if (counts.allocs != counts.frees)
+    {
+        test_fail(__FUNCTION__, "%zu allocs, %zu frees", counts.allocs,
+                  counts.frees);
+    }
+}
+
+int
+main()
+{
+    policy_test();
+    large_reserve_test();
+    reserve_exact_test();
+    shrink_test();
+    return 0;
+}
@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "../rstring_parallel.h"
+
+/*
+ * A haystack spanning several chunks, with matches of |needle| planted at
+ * |offsets| - among which chunk boundaries - and overlapping ones at the end.
+ */
+static void
+build_haystack(struct rstring *hay, const char *needle, const size_t *offsets,
+               size_t n)
+{
+    const size_t len = 5 * RSTRING_PARALLEL_CHUNK + 123;
+
+    rstring_init(hay);
+    rstring_ensure_capacity(hay, len + 1);
+    for (size_t i = 0; i < len; ++i)
+    {
+        rstring_push_byte(hay, (uint8_t) ('a' + i % 7));
+    }
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        memcpy(rstring_data_mut(hay) + offsets[i], needle, strlen(needle));
+    }
+}
+
+static size_t
+sequential_count(const struct rstring *hay, const struct rstring *needle,
+                 size_t from, struct rstring_offsets *out)
+{
+    size_t count = 0;
+    size_t pos   = rstring_find_first(hay, needle, from);
+
+    while (pos != RSTRING_NOT_FOUND)
+    {
+        out->data[count++] = pos;
+        pos                = rstring_find_first(hay, needle, pos + 1);
+    }
+
+    return count;
+}
+
+/*
+ * The first search of the process is a parallel one, so that the pool threads
+ * select the search kernels concurrently. Meant to be run under
+ * ThreadSanitizer as well.
+ */
+static void
+cold_test(void)
+{
+    static const size_t offsets[] = {RSTRING_PARALLEL_CHUNK - 1,
+                                     3 * RSTRING_PARALLEL_CHUNK + 7};
+
+    struct rstring_workers workers;
+    struct rstring         hay;
+    struct rstring         needle;
+
+    build_haystack(&hay, "xyx", offsets, 2);
+    rstring_init(&needle);
+    rstring_push_str(&needle, "xyx");
+
+    if (rstring_workers_init(&workers, 4) != RSTRING_OK)
+    {
+        test_fail(__FUNCTION__, "could not start 4 threads");
+    }
+
+    if (rstring_parallel_count(&workers, &hay, &needle, 0) != 2
+        || rstring_parallel_find_first(&workers, &hay, &needle, 0)
+               != offsets[0])
+    {
+        test_fail(__FUNCTION__, "wrong results on a first search");
+    }
+
+    rstring_workers_free(&workers);
+    rstring_free(&needle);
+    rstring_free(&hay);
+}
+
+static void
+search_test(size_t nthreads)
+{
+    static const size_t offsets[] = {
+        1000,
+        RSTRING_PARALLEL_CHUNK - 3,
+        2 * RSTRING_PARALLEL_CHUNK - 1,
+        3 * RSTRING_PARALLEL_CHUNK,
+        5 * RSTRING_PARALLEL_CHUNK + 100,
+        5 * RSTRING_PARALLEL_CHUNK + 102,
+    };
+    static const size_t froms[] = {0, 1001, RSTRING_PARALLEL_CHUNK,
+                                   5 * RSTRING_PARALLEL_CHUNK + 101};
+
+    struct rstring_workers workers;
+    struct rstring         hay;
+    struct rstring         needle;
+    size_t                 expected[32];
+
+    if (rstring_workers_init(&workers, nthreads) != RSTRING_OK
+        || (nthreads != 0 && workers.nthreads != nthreads))
+    {
+        test_fail(__FUNCTION__, "could not start %zu threads", nthreads);
+    }
+
+    build_haystack(&hay, "xyxyx", offsets, 6);
+    rstring_init(&needle);
+    rstring_push_str(&needle, "xyx");
+
+    for (size_t f = 0; f < 4; ++f)
+    {
+        struct rstring_offsets seq = {expected, 0, 32};
+        struct rstring_offsets all;
+
+        const size_t n = sequential_count(&hay, &needle, froms[f], &seq);
+
+        const size_t first =
+            rstring_parallel_find_first(&workers, &hay, &needle, froms[f]);
+        if (first != (n > 0 ? expected[0] : RSTRING_NOT_FOUND))
+        {
+            test_fail(__FUNCTION__, "%zu threads, from %zu: first at %zu",
+                      nthreads, froms[f], first);
+        }
+
+        const size_t count =
+            rstring_parallel_count(&workers, &hay, &needle, froms[f]);
+        if (count != n)
+        {
+            test_fail(__FUNCTION__, "%zu threads, from %zu: %zu, not %zu",
+                      nthreads, froms[f], count, n);
+        }
+
+        /* Appended after what the array already holds */
+        rstring_offsets_init(&all);
+        all.data    = malloc(sizeof(size_t));
+        all.data[0] = 42;
+        all.len     = 1;
+        all.cap     = 1;
+        if (rstring_parallel_find_all(&workers, &hay, &needle, froms[f], &all)
+                != RSTRING_OK
+            || all.len != n + 1 || all.data[0] != 42
+            || memcmp(all.data + 1, expected, n * sizeof(size_t)) != 0)
+        {
+            test_fail(__FUNCTION__, "%zu threads, from %zu: %zu offsets",
+                      nthreads, froms[f], all.len);
+        }
+        rstring_offsets_free(&all);
+    }
+
+    rstring_free(&needle);
+    rstring_free(&hay);
+    rstring_workers_free(&workers);
+}
+
+static void
+edge_test(void)
+{
+    struct rstring_workers workers;
+    struct rstring         hay;
+    struct rstring         needle;
+    struct rstring_offsets all;
+
+    rstring_workers_init(&workers, 2);
+    rstring_init(&hay);
+    rstring_init(&needle);
+    rstring_offsets_init(&all);
+    rstring_push_str(&hay, "aaaa");
+
+    /* Empty needle: found where searching starts, but never counted */
+    if (rstring_parallel_find_first(&workers, &hay, &needle, 2) != 2
+        || rstring_parallel_find_first(&workers, &hay, &needle, 5)
+               != RSTRING_NOT_FOUND
+        || rstring_parallel_count(&workers, &hay, &needle, 0) != 0
+        || rstring_parallel_find_all(&workers, &hay, &needle, 0, &all)
+               != RSTRING_OK
+        || all.len != 0)
+    {
+        test_fail(__FUNCTION__, "empty needle");
+    }
+
+    /* Overlapping matches, in a haystack too short to split */
+    rstring_push_str(&needle, "aa");
+    if (rstring_parallel_count(&workers, &hay, &needle, 0) != 3
+        || rstring_parallel_find_all(&workers, &hay, &needle, 1, &all)
+               != RSTRING_OK
+        || all.len != 2 || all.data[0] != 1 || all.data[1] != 2)
+    {
+        test_fail(__FUNCTION__, "short haystack");
+    }
+
+    /* Needle longer than what is left */
+    if (rstring_parallel_find_first(&workers, &hay, &needle, 3)
+            != RSTRING_NOT_FOUND
+        || rstring_parallel_count(&workers, &hay, &needle, 10) != 0)
+    {
+        test_fail(__FUNCTION__, "needle past the end");
+    }
+
+    rstring_offsets_free(&all);
+    rstring_free(&needle);
+    rstring_free(&hay);
+    rstring_workers_free(&workers);
+}
+
+int
+main()
+{
+    cold_test();
+    search_test(1);
+    search_test(3);
+    search_test(0);
+    edge_test();
+    return 0;
+}
@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "common.h"
+#include "../rstring.h"
+
+/* Every occurrence of |needle| in |hay| from |from|, the slow way */
+static size_t
+naive_find_all(const char *hay, size_t hay_len, const char *needle,
+               size_t needle_len, size_t from, enum rstring_overlap overlap,
+               size_t *out)
+{
+    size_t count = 0;
+
+    if (needle_len == 0)
+    {
+        return 0;
+    }
+
+    for (size_t i = from; i + needle_len <= hay_len;)
+    {
+        if (memcmp(hay + i, needle, needle_len) == 0)
+        {
+            out[count++] = i;
+            i += overlap == RSTRING_NON_OVERLAPPING ? needle_len : 1;
+            continue;
+        }
+        i++;
+    }
+
+    return count;
+}
+
+static void
+random_test(void)
+{
+    static const enum rstring_overlap modes[] = {RSTRING_OVERLAPPING,
+                                                 RSTRING_NON_OVERLAPPING};
+
+    size_t *expected = malloc(4096 * sizeof(size_t));
+    size_t *into     = malloc(4096 * sizeof(size_t));
+
+    srand(24);
+    for (int round = 0; round < 2000; ++round)
+    {
+        struct rstring         hay;
+        struct rstring         needle;
+        struct rstring_offsets all;
+
+        /* Small alphabets, so that needles and their overlaps are common */
+        const size_t hay_len    = (size_t) (rand() % 3000);
+        const size_t needle_len = (size_t) (1 + rand() % 70 / (1 + rand() % 8));
+        const int    alphabet   = 1 + rand() % 3;
+
+        rstring_init(&hay);
+        rstring_init(&needle);
+        for (size_t i = 0; i < hay_len; ++i)
+        {
+            rstring_push_byte(&hay, (uint8_t) ('a' + rand() % alphabet));
+        }
+        for (size_t i = 0; i < needle_len; ++i)
+        {
+            rstring_push_byte(&needle, (uint8_t) ('a' + rand() % alphabet));
+        }
+
+        const size_t from = hay_len > 0 ? (size_t) rand() % (hay_len + 2) : 0;
+        const enum rstring_overlap overlap = modes[round % 2];
+
+        const size_t n = naive_find_all(rstring_data(&hay),
+                                        hay_len,
+                                        rstring_data(&needle),
+                                        needle_len,
+                                        from,
+                                        overlap,
+                                        expected);
+
+        if (rstring_count(&hay, &needle, from, overlap) != n)
+        {
+            test_fail(__FUNCTION__, "round %d: count is not %zu", round, n);
+        }
+
+        rstring_offsets_init(&all);
+        if (rstring_find_all(&hay, &needle, from, overlap, &all) != RSTRING_OK
+            || all.len != n
+            || (n > 0 && memcmp(all.data, expected, n * sizeof(size_t)) != 0))
+        {
+            test_fail(__FUNCTION__, "round %d: %zu offsets, not %zu", round,
+                      all.len, n);
+        }
+        rstring_offsets_free(&all);
+
+        /* A caller array too short still gets the count, and the first ones */
+        const size_t cap = n / 2;
+        if (rstring_view_find_all_into(rstring_view_from(&hay),
+                                       rstring_view_from(&needle),
+                                       from,
+                                       overlap,
+                                       into,
+                                       cap)
+                != n
+            || (cap > 0 && memcmp(into, expected, cap * sizeof(size_t)) != 0))
+        {
+            test_fail(__FUNCTION__, "round %d: wrong offsets stored", round);
+        }
+
+        rstring_free(&needle);
+        rstring_free(&hay);
+    }
+
+    free(into);
+    free(expected);
+}
+
+static void
+api_test(void)
+{
+    struct rstring         rs;
+    struct rstring_offsets all;
+
+    rstring_init(&rs);
+    rstring_offsets_init(&all);
+    rstring_push_str(&rs, "aaaa");
+
+    if (rstring_count_str(&rs, "aa", 0, RSTRING_OVERLAPPING) != 3
+        || rstring_count_str(&rs, "aa", 0, RSTRING_NON_OVERLAPPING) != 2
+        || rstring_count_str(&rs, "aa", 3, RSTRING_OVERLAPPING) != 0
+        || rstring_count_str(&rs, "", 0, RSTRING_OVERLAPPING) != 0
+        || rstring_view_count(rstring_view_from(&rs),
+                              rstring_view_from_str("aaaaa"),
+                              0,
+                              RSTRING_OVERLAPPING)
+               != 0)
+    {
+        test_fail(__FUNCTION__, "unexpected count");
+    }
+
+    /* Appended after what the array already holds */
+    if (rstring_find_all_str(&rs, "aa", 1, RSTRING_NON_OVERLAPPING, &all)
+            != RSTRING_OK
+        || rstring_find_all_str(&rs, "a", 0, RSTRING_OVERLAPPING, &all)
+               != RSTRING_OK
+        || all.len != 5 || all.data[0] != 1 || all.data[1] != 0
+        || all.data[4] != 3)
+    {
+        test_fail(__FUNCTION__, "unexpected offsets");
+    }
+
+    /* Null bytes are ordinary bytes */
+    rstring_clear(&rs);
+    rstring_push_view(&rs, rstring_view_from_buf("a\0b\0a\0b", 7));
+    if (rstring_view_count(rstring_view_from(&rs),
+                           rstring_view_from_buf("\0", 1),
+                           0,
+                           RSTRING_OVERLAPPING)
+        != 3)
+    {
+        test_fail(__FUNCTION__, "null bytes were not counted");
+    }
+
+    rstring_offsets_free(&all);
+    rstring_free(&rs);
+}
+
+int
+main()
+{
+    random_test();
+    api_test();
+    return 0;
+}
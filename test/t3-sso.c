@@ -0,0 +1,174 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static void
+check(const char *test_name, const struct rstring *rs, const char *expected,
+      bool expect_inline)
+{
+    if (!rstring_equals_str(rs, expected) || rs->len != strlen(expected))
+    {
+        test_fail(test_name,
+                  "contents are '%s' (len %zu), expected '%s'",
+                  rstring_data(rs),
+                  rs->len,
+                  expected);
+    }
+
+    if (rstring_is_inline(rs) != expect_inline)
+    {
+        test_fail(test_name,
+                  "expected the string to be %s",
+                  expect_inline ? "inline" : "on the heap");
+    }
+}
+
+static void
+inline_to_heap_test(void)
+{
+    struct rstring rs;
+    char           expected[RSTRING_SSO_CAPACITY + 1];
+    size_t         i = 0;
+
+    rstring_init(&rs);
+    check(__FUNCTION__, &rs, "", true);
+
+    /* Fill the inline buffer exactly (leaving room for the terminator) */
+    for (i = 0; i < RSTRING_SSO_CAPACITY - 1; ++i)
+    {
+        expected[i] = (char) ('a' + (i % 26));
+        rstring_push_byte(&rs, (uint8_t) expected[i]);
+    }
+    expected[i] = '\0';
+    check(__FUNCTION__, &rs, expected, true);
+
+    /* One more byte spills over to the heap */
+    expected[i++] = '!';
+    expected[i]   = '\0';
+    rstring_push_byte(&rs, '!');
+    check(__FUNCTION__, &rs, expected, false);
+
+    /* Clearing keeps the heap buffer */
+    rstring_clear(&rs);
+    check(__FUNCTION__, &rs, "", false);
+
+    rstring_free(&rs);
+    check(__FUNCTION__, &rs, "", true);
+}
+
+/* Whether |str| fits in the inline buffer, whose size may be configured */
+static bool
+fits(const char *str)
+{
+    return strlen(str) < RSTRING_SSO_CAPACITY;
+}
+
+static struct rstring
+make_inline(const char *str)
+{
+    struct rstring rs;
+
+    rstring_init(&rs);
+    rstring_push_str(&rs, str);
+    return rs;
+}
+
+static void
+copy_by_value_test(void)
+{
+    struct rstring rs = make_inline("short key");
+
+    check(__FUNCTION__, &rs, "short key", fits("short key"));
+
+    if (rstring_find_first_str(&rs, "key", 0) != 6)
+    {
+        test_fail(__FUNCTION__, "search in a copied inline string failed");
+    }
+
+    rstring_push_str(&rs, " that grows past the inline buffer");
+    check(__FUNCTION__,
+          &rs,
+          "short key that grows past the inline buffer",
+          fits("short key that grows past the inline buffer"));
+
+    rstring_free(&rs);
+}
+
+static int
+compare_rstrings(const void *a, const void *b)
+{
+    return rstring_cmp((const struct rstring *) a, (const struct rstring *) b);
+}
+
+static void
+move_test(void)
+{
+    const char *const words[] = {"pear", "a word too long to be inline", "fig",
+                                 "apple"};
+    const char *const sorted[] = {"a word too long to be inline", "apple",
+                                  "fig", "pear"};
+    struct rstring   *array    = NULL;
+
+    /* Grown one element at a time, so that realloc may move the elements */
+    for (size_t i = 0; i < 4; ++i)
+    {
+        array = realloc(array, (i + 1) * sizeof(*array));
+        if (!array)
+        {
+            test_fail(__FUNCTION__, "out of memory");
+        }
+        array[i] = make_inline(words[i]);
+    }
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        check(__FUNCTION__, &array[i], words[i], fits(words[i]));
+        if (strcmp(rstring_data(&array[i]), words[i]) != 0)
+        {
+            test_fail(__FUNCTION__, "moved string %zu reads wrong", i);
+        }
+    }
+
+    qsort(array, 4, sizeof(*array), compare_rstrings);
+    for (size_t i = 0; i < 4; ++i)
+    {
+        check(__FUNCTION__, &array[i], sorted[i], fits(sorted[i]));
+        if (strcmp(rstring_data(&array[i]), sorted[i]) != 0)
+        {
+            test_fail(__FUNCTION__, "sorted string %zu reads wrong", i);
+        }
+    }
+
+    /* A moved inline string has no pointer to where it came from */
+    if (rstring_is_inline(&array[1]) && array[1].data != NULL)
+    {
+        test_fail(__FUNCTION__, "an inline string has a data pointer");
+    }
+
+    for (size_t i = 0; i < 4; ++i)
+    {
+        rstring_free(&array[i]);
+    }
+    free(array);
+}
+
+static void
+zero_initialized_test(void)
+{
+    struct rstring rs = {0};
+
+    rstring_push_str(&rs, "zero");
+    check(__FUNCTION__, &rs, "zero", fits("zero"));
+    rstring_free(&rs);
+}
+
+int
+main()
+{
+    inline_to_heap_test();
+    copy_by_value_test();
+    move_test();
+    zero_initialized_test();
+    return 0;
+}
@@ -0,0 +1,246 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <stdbool.h>
+
+#include "common.h"
+
+static void
+upper_some(struct rstring *rs)
+{
+    char *data = rstring_data_mut(rs);
+
+    for (size_t i = 0; i < rs->len; ++i)
+    {
+        if (rand() % 2 && data[i] >= 'a' && data[i] <= 'z')
+        {
+            data[i] = (char) (data[i] - 'a' + 'A');
+        }
+    }
+}
+
+/*
+ * Compares the finder against rstring_find_first over random haystacks. Half
+ * of the needles are cut out of the haystack, so that matches are common.
+ *
+ * Horspool is only picked when the prefilter is not vectorized, so a
+ * prefilter is accepted wherever Horspool is expected.
+ */
+static void
+finder_random_test(const char *alphabet, size_t max_needle_len,
+                   enum rstring_finder_algorithm expected_algorithm)
+{
+    struct rstring        haystack;
+    struct rstring        needle;
+    struct rstring_finder finder;
+    int                   matched = 0;
+
+    rstring_init(&haystack);
+    rstring_init(&needle);
+
+    for (int round = 0; round < 300; ++round)
+    {
+        const bool   ignore_case = rand() % 2;
+        const size_t hay_len     = max_needle_len + (size_t) (rand() % 1500);
+        size_t       needle_len  = 1 + (size_t) rand() % max_needle_len;
+
+        if (needle_len < max_needle_len / 2)
+        {
+            needle_len += max_needle_len / 2;
+        }
+
+        random_fill(&haystack, alphabet, hay_len);
+
+        if (rand() % 2)
+        {
+            const size_t at = (size_t) rand() % (hay_len - needle_len + 1);
+            rstring_clear(&needle);
+            for (size_t i = 0; i < needle_len; ++i)
+            {
+                rstring_push_byte(
+                    &needle, (uint8_t) rstring_data(&haystack)[at + i]);
+            }
+        }
+        else
+        {
+            random_fill(&needle, alphabet, needle_len);
+        }
+
+        if (ignore_case)
+        {
+            upper_some(&needle);
+            upper_some(&haystack);
+        }
+
+        const rstring_status_t rc =
+            ignore_case ? rstring_finder_compile_ignore_case(&finder, &needle)
+                        : rstring_finder_compile(&finder, &needle);
+        if (rc != RSTRING_OK)
+        {
+            test_fail(__FUNCTION__, "can't compile needle");
+        }
+
+        if (needle.len >= max_needle_len / 2 &&
+            finder.algorithm != expected_algorithm &&
+            !(expected_algorithm == RSTRING_FINDER_HORSPOOL &&
+              finder.algorithm == RSTRING_FINDER_PREFILTER))
+        {
+            test_fail(__FUNCTION__,
+                      "round %d: needle '%s' picked algorithm %d, "
+                      "expected %d",
+                      round,
+                      rstring_data(&needle),
+                      finder.algorithm,
+                      expected_algorithm);
+        }
+
+        for (size_t from = 0; from < hay_len; from += 1 + hay_len / 4)
+        {
+            const size_t expected =
+                ignore_case
+                    ? rstring_find_first_ignore_case(&haystack, &needle, from)
+                    : rstring_find_first(&haystack, &needle, from);
+            const size_t result = rstring_finder_find(&finder, &haystack, from);
+
+            if (result != expected)
+            {
+                test_fail(__FUNCTION__,
+                          "round %d, needle '%s', from %zu: expected %zu, "
+                          "got %zu",
+                          round,
+                          rstring_data(&needle),
+                          from,
+                          expected,
+                          result);
+            }
+
+            matched += result != RSTRING_NOT_FOUND;
+        }
+
+        rstring_finder_free(&finder);
+    }
+
+    if (matched == 0)
+    {
+        test_fail(__FUNCTION__, "no round found a match");
+    }
+
+    rstring_free(&haystack);
+    rstring_free(&needle);
+}
+
+static void
+finder_str_test(void)
+{
+    struct rstring        haystack;
+    struct rstring_finder finder;
+
+    rstring_init(&haystack);
+    rstring_push_str(&haystack, "Content-Type: text/html; charset=UTF-8");
+
+    rstring_finder_compile_str_ignore_case(&finder, "CHARSET=utf-8");
+    if (rstring_finder_find(&finder, &haystack, 0) != 25)
+    {
+        test_fail(__FUNCTION__, "ignore case search failed");
+    }
+    rstring_finder_free(&finder);
+
+    rstring_finder_compile_str(&finder, "");
+    if (rstring_finder_find(&finder, &haystack, 3) != 3)
+    {
+        test_fail(__FUNCTION__, "empty needle should match at |from|");
+    }
+    rstring_finder_free(&finder);
+
+    rstring_finder_compile_str(&finder, "text/htmL");
+    if (rstring_finder_find(&finder, &haystack, 0) != RSTRING_NOT_FOUND)
+    {
+        test_fail(__FUNCTION__, "case sensitive search matched");
+    }
+    rstring_finder_free(&finder);
+
+    rstring_free(&haystack);
+}
+
+static void
+repeat(struct rstring *rs, const char *unit, size_t times, const char *tail)
+{
+    rstring_clear(rs);
+    for (size_t i = 0; i < times; ++i)
+    {
+        rstring_push_str(rs, unit);
+    }
+    rstring_push_str(rs, tail);
+}
+
+static void
+finder_periodic_test(const char *unit, size_t hay_times, size_t needle_times,
+                     const char *tail, bool ignore_case)
+{
+    struct rstring        haystack;
+    struct rstring        needle;
+    struct rstring_finder finder;
+
+    rstring_init(&haystack);
+    rstring_init(&needle);
+    repeat(&haystack, unit, hay_times, tail);
+    repeat(&needle, unit, needle_times, tail);
+
+    if (ignore_case)
+    {
+        upper_some(&needle);
+    }
+
+    ignore_case ? rstring_finder_compile_ignore_case(&finder, &needle)
+                : rstring_finder_compile(&finder, &needle);
+
+    for (size_t from = 0; from < haystack.len; from += 97)
+    {
+        const size_t expected =
+            ignore_case
+                ? rstring_find_first_ignore_case(&haystack, &needle, from)
+                : rstring_find_first(&haystack, &needle, from);
+        const size_t result = rstring_finder_find(&finder, &haystack, from);
+
+        if (result != expected)
+        {
+            test_fail(__FUNCTION__,
+                      "unit '%s' x %zu, from %zu: expected %zu, got %zu",
+                      unit,
+                      needle_times,
+                      from,
+                      expected,
+                      result);
+        }
+    }
+
+    rstring_finder_free(&finder);
+    rstring_free(&haystack);
+    rstring_free(&needle);
+}
+
+int
+main()
+{
+    srand(42);
+
+    finder_str_test();
+
+    /* Short needles and rare bytes: prefilter */
+    finder_random_test("ab", 7, RSTRING_FINDER_PREFILTER);
+    finder_random_test("ab:Q", 40, RSTRING_FINDER_PREFILTER);
+
+    /* Longer needles made of common bytes only: Horspool (scalar builds) */
+    finder_random_test("etaoin", 64, RSTRING_FINDER_HORSPOOL);
+    finder_random_test("ab", 200, RSTRING_FINDER_HORSPOOL);
+
+    /* Long needles: Two-Way, with highly periodic ones over {a, b} */
+    finder_random_test("ab", 600, RSTRING_FINDER_TWO_WAY);
+    finder_random_test("abcdefgh", 600, RSTRING_FINDER_TWO_WAY);
+    finder_periodic_test("a", 1000, 300, "", false);
+    finder_periodic_test("ab", 400, 150, "c", false);
+    finder_periodic_test("abc", 400, 100, "abd", true);
+    finder_periodic_test("aab", 400, 100, "", true);
+
+    return 0;
+}
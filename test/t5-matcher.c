@@ -0,0 +1,218 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <stdbool.h>
+
+#include "../rstring_matcher.h"
+#include "common.h"
+
+#define MAX_PATTERNS 300
+
+struct collected
+{
+    size_t count;
+    size_t checksum;
+};
+
+static bool
+collect(const struct rstring_match *match, void *ctx)
+{
+    struct collected *c = ctx;
+
+    c->count++;
+    c->checksum +=
+        (match->offset + 1) * 7919 + match->pattern * 31 + match->len;
+    return true;
+}
+
+/*
+ * Checks rstring_matcher_find and rstring_matcher_find_all against a search
+ * for every pattern on its own.
+ */
+static void
+matcher_random_test(size_t npatterns, const char *alphabet, bool ignore_case,
+                    enum rstring_matcher_engine expected_engine)
+{
+    struct rstring         haystack;
+    struct rstring         patterns[MAX_PATTERNS];
+    struct rstring_matcher matcher;
+    size_t                 matched = 0;
+
+    rstring_init(&haystack);
+    for (size_t p = 0; p < npatterns; ++p)
+    {
+        rstring_init(&patterns[p]);
+    }
+
+    for (int round = 0; round < 40; ++round)
+    {
+        random_fill(&haystack, alphabet, (size_t) rand() % 700);
+
+        for (size_t p = 0; p < npatterns; ++p)
+        {
+            random_fill(&patterns[p], alphabet, 1 + (size_t) rand() % 5);
+        }
+
+        const rstring_status_t rc =
+            ignore_case
+                ? rstring_matcher_compile_ignore_case(
+                      &matcher, patterns, npatterns)
+                : rstring_matcher_compile(&matcher, patterns, npatterns);
+        if (rc != RSTRING_OK)
+        {
+            test_fail(__FUNCTION__, "can't compile patterns");
+        }
+
+        if (matcher.engine != expected_engine &&
+            expected_engine == RSTRING_MATCHER_AHO_CORASICK)
+        {
+            test_fail(__FUNCTION__, "expected Aho-Corasick to be picked");
+        }
+
+        const size_t step = 1 + haystack.len / 3;
+        for (size_t from = 0; from <= haystack.len; from += step)
+        {
+            size_t           expected         = RSTRING_NOT_FOUND;
+            size_t           expected_pattern = 0;
+            struct collected want             = {0, 0};
+            struct collected got              = {0, 0};
+
+            for (size_t p = 0; p < npatterns; ++p)
+            {
+                size_t at = from;
+                while ((at = ignore_case ? rstring_find_first_ignore_case(
+                                               &haystack, &patterns[p], at)
+                                         : rstring_find_first(
+                                               &haystack, &patterns[p], at)) !=
+                       RSTRING_NOT_FOUND)
+                {
+                    if (expected == RSTRING_NOT_FOUND || at < expected)
+                    {
+                        expected         = at;
+                        expected_pattern = p;
+                    }
+
+                    struct rstring_match match = {at, patterns[p].len, p};
+                    collect(&match, &want);
+                    ++at;
+                }
+            }
+
+            size_t       pattern = SIZE_MAX;
+            const size_t result =
+                rstring_matcher_find(&matcher, &haystack, from, &pattern);
+
+            if (result != expected ||
+                (result != RSTRING_NOT_FOUND && pattern != expected_pattern))
+            {
+                test_fail(__FUNCTION__,
+                          "round %d, from %zu: expected %zu (pattern %zu), "
+                          "got %zu (pattern %zu)",
+                          round,
+                          from,
+                          expected,
+                          expected_pattern,
+                          result,
+                          pattern);
+            }
+
+            rstring_matcher_find_all(&matcher, &haystack, from, collect, &got);
+            if (got.count != want.count || got.checksum != want.checksum)
+            {
+                test_fail(__FUNCTION__,
+                          "round %d, from %zu: expected %zu matches, got %zu",
+                          round,
+                          from,
+                          want.count,
+                          got.count);
+            }
+
+            matched += want.count;
+        }
+
+        rstring_matcher_free(&matcher);
+    }
+
+    if (matched == 0)
+    {
+        test_fail(__FUNCTION__, "no round found a match");
+    }
+
+    rstring_free(&haystack);
+    for (size_t p = 0; p < npatterns; ++p)
+    {
+        rstring_free(&patterns[p]);
+    }
+}
+
+static bool
+stop_after_two(const struct rstring_match *match, void *ctx)
+{
+    (void) match;
+    return ++*(size_t *) ctx < 2;
+}
+
+static void
+matcher_str_test(void)
+{
+    const char *const      keywords[] = {"error", "", "Timeout", "err"};
+    struct rstring         line;
+    struct rstring_matcher matcher;
+    size_t                 pattern = 0;
+    size_t                 seen    = 0;
+
+    rstring_init(&line);
+    rstring_push_str(&line, "[ERROR] upstream TIMEOUT after 30s, error count");
+
+    rstring_matcher_compile_str_ignore_case(&matcher, keywords, 4);
+
+    if (rstring_matcher_find(&matcher, &line, 0, &pattern) != 1 ||
+        pattern != 0)
+    {
+        test_fail(__FUNCTION__, "expected 'error' at 1");
+    }
+
+    if (rstring_matcher_find(&matcher, &line, 2, &pattern) != 17 ||
+        pattern != 2)
+    {
+        test_fail(__FUNCTION__, "expected 'Timeout' at 17");
+    }
+
+    if (rstring_matcher_find_all(&matcher, &line, 0, stop_after_two, &seen) !=
+        2)
+    {
+        test_fail(__FUNCTION__, "the callback did not stop the search");
+    }
+
+    rstring_matcher_free(&matcher);
+
+    rstring_matcher_compile_str(&matcher, keywords, 4);
+    if (rstring_matcher_find(&matcher, &line, 0, &pattern) != 36 ||
+        pattern != 0)
+    {
+        test_fail(__FUNCTION__, "expected 'error' at 36 (case sensitive)");
+    }
+    rstring_matcher_free(&matcher);
+
+    rstring_free(&line);
+}
+
+int
+main()
+{
+    srand(7);
+
+    matcher_str_test();
+
+    /* Small sets: Teddy wherever SSSE3 is available */
+    matcher_random_test(1, "abc", false, RSTRING_MATCHER_TEDDY);
+    matcher_random_test(5, "abcd", false, RSTRING_MATCHER_TEDDY);
+    matcher_random_test(32, "abcdefgh", true, RSTRING_MATCHER_TEDDY);
+
+    /* Large sets: Aho-Corasick */
+    matcher_random_test(33, "abcd", false, RSTRING_MATCHER_AHO_CORASICK);
+    matcher_random_test(MAX_PATTERNS, "abcdefAB", true,
+                        RSTRING_MATCHER_AHO_CORASICK);
+
+    return 0;
+}
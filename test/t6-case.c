@@ -0,0 +1,171 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+#define MAX_LEN 300
+
+static uint8_t
+reference_lower(uint8_t c)
+{
+    return (c >= 'A' && c <= 'Z') ? (uint8_t) (c + ('a' - 'A')) : c;
+}
+
+static uint8_t
+reference_upper(uint8_t c)
+{
+    return (c >= 'a' && c <= 'z') ? (uint8_t) (c - ('a' - 'A')) : c;
+}
+
+static void
+fill_random(struct rstring *rs, uint8_t *bytes, size_t len)
+{
+    rstring_clear(rs);
+    for (size_t i = 0; i < len; ++i)
+    {
+        /* Bias towards letters and the bytes bordering them */
+        bytes[i] = (uint8_t) ((rand() % 2) ? '@' + rand() % 60 : rand());
+        rstring_push_byte(rs, bytes[i]);
+    }
+}
+
+static void
+check(const char *test_name, const struct rstring *rs, const uint8_t *bytes,
+      size_t len, uint8_t (*convert)(uint8_t))
+{
+    const uint8_t *data = (const uint8_t *) rstring_data(rs);
+
+    if (rs->len != len || data[len] != '\0')
+    {
+        test_fail(test_name, "length %zu, expected %zu", rs->len, len);
+    }
+
+    for (size_t i = 0; i < len; ++i)
+    {
+        if (data[i] != convert(bytes[i]))
+        {
+            test_fail(test_name,
+                      "byte %zu of %zu is 0x%02x, expected 0x%02x",
+                      i,
+                      len,
+                      data[i],
+                      convert(bytes[i]));
+        }
+    }
+}
+
+static void
+in_place_test(void)
+{
+    struct rstring rs;
+    uint8_t        bytes[MAX_LEN];
+
+    rstring_init(&rs);
+    for (size_t len = 0; len < MAX_LEN; ++len)
+    {
+        fill_random(&rs, bytes, len);
+        rstring_tolower(&rs);
+        check(__FUNCTION__, &rs, bytes, len, reference_lower);
+
+        fill_random(&rs, bytes, len);
+        rstring_toupper(&rs);
+        check(__FUNCTION__, &rs, bytes, len, reference_upper);
+    }
+    rstring_free(&rs);
+}
+
+static void
+copy_test(void)
+{
+    struct rstring src;
+    struct rstring dest;
+    uint8_t        bytes[MAX_LEN];
+
+    rstring_init(&src);
+    rstring_init(&dest);
+    rstring_push_str(&dest, "previous contents");
+
+    for (size_t len = 0; len < MAX_LEN; len += 7)
+    {
+        fill_random(&src, bytes, len);
+
+        if (rstring_tolower_copy(&dest, &src) != RSTRING_OK)
+        {
+            test_fail(__FUNCTION__, "rstring_tolower_copy failed");
+        }
+        check(__FUNCTION__, &dest, bytes, len, reference_lower);
+
+        if (rstring_toupper_copy(&dest, &src) != RSTRING_OK)
+        {
+            test_fail(__FUNCTION__, "rstring_toupper_copy failed");
+        }
+        check(__FUNCTION__, &dest, bytes, len, reference_upper);
+
+        /* The source is left untouched */
+        for (size_t i = 0; i < len; ++i)
+        {
+            if ((uint8_t) rstring_data(&src)[i] != bytes[i])
+            {
+                test_fail(__FUNCTION__, "source modified at byte %zu", i);
+            }
+        }
+
+        /* Converting a string into itself */
+        rstring_toupper_copy(&src, &src);
+        check(__FUNCTION__, &src, bytes, len, reference_upper);
+    }
+
+    rstring_free(&src);
+    rstring_free(&dest);
+}
+
+static void
+non_ascii_test(void)
+{
+    struct rstring rs;
+
+    /* UTF-8 for "ÀÉ" and bytes next to the letter ranges are kept */
+    rstring_init(&rs);
+    rstring_push_str(&rs, "\xc3\x80\xc3\x89 @AZ[ `az{ \xc1\xda\xe1\xfa");
+    rstring_tolower(&rs);
+    if (!rstring_equals_str(&rs, "\xc3\x80\xc3\x89 @az[ `az{ \xc1\xda\xe1\xfa"))
+    {
+        test_fail(__FUNCTION__, "tolower got '%s'", rstring_data(&rs));
+    }
+
+    rstring_toupper(&rs);
+    if (!rstring_equals_str(&rs, "\xc3\x80\xc3\x89 @AZ[ `AZ{ \xc1\xda\xe1\xfa"))
+    {
+        test_fail(__FUNCTION__, "toupper got '%s'", rstring_data(&rs));
+    }
+    rstring_free(&rs);
+}
+
+static void
+locale_test(void)
+{
+    struct rstring rs;
+    uint8_t        bytes[MAX_LEN];
+
+    /* In the "C" locale, the locale variants match the ASCII ones */
+    rstring_init(&rs);
+    fill_random(&rs, bytes, MAX_LEN - 1);
+    rstring_tolower_locale(&rs);
+    check(__FUNCTION__, &rs, bytes, MAX_LEN - 1, reference_lower);
+
+    fill_random(&rs, bytes, MAX_LEN - 1);
+    rstring_toupper_locale(&rs);
+    check(__FUNCTION__, &rs, bytes, MAX_LEN - 1, reference_upper);
+    rstring_free(&rs);
+}
+
+int
+main()
+{
+    srand(6);
+    in_place_test();
+    copy_test();
+    non_ascii_test();
+    locale_test();
+    return 0;
+}
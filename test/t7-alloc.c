@@ -0,0 +1,175 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+#include "../rstring_alloc.h"
+
+static void
+push_many(const char *test_name, struct rstring *rs, size_t n)
+{
+    for (size_t i = 0; i < n; ++i)
+    {
+        if (rstring_push_byte(rs, (uint8_t) ('a' + rs->len % 26)) != RSTRING_OK)
+        {
+            test_fail(test_name, "push failed at byte %zu", i);
+        }
+    }
+}
+
+static void
+custom_allocator_test(void)
+{
+    struct counting_allocator      counts    = {0};
+    const struct rstring_allocator allocator = COUNTING_ALLOCATOR(&counts);
+    struct rstring                 rs;
+
+    rstring_init_with_allocator(&rs, &allocator);
+
+    /* Inline strings never call the allocator */
+    push_many(__FUNCTION__, &rs, RSTRING_SSO_CAPACITY - 1);
+    if (counts.allocs != 0)
+    {
+        test_fail(__FUNCTION__, "inline string called the allocator");
+    }
+
+    push_many(__FUNCTION__, &rs, 1000);
+    if (counts.allocs != 1 || counts.live_bytes != rs.cap)
+    {
+        test_fail(__FUNCTION__,
+                  "%zu allocations, %zu live bytes for a capacity of %zu",
+                  counts.allocs,
+                  counts.live_bytes,
+                  rs.cap);
+    }
+
+    /* The allocator survives rstring_free */
+    rstring_free(&rs);
+    if (counts.frees != 1 || counts.live_bytes != 0
+        || rs.allocator != &allocator)
+    {
+        test_fail(__FUNCTION__, "free was not forwarded to the allocator");
+    }
+
+    push_many(__FUNCTION__, &rs, 100);
+    check_alphabet(__FUNCTION__, &rs, 100);
+    rstring_free(&rs);
+
+    if (counts.allocs != 2 || counts.frees != 2 || counts.live_bytes != 0)
+    {
+        test_fail(__FUNCTION__, "unbalanced allocations");
+    }
+}
+
+static void
+arena_test(void)
+{
+    struct rstring_arena arena;
+    struct rstring       strings[50];
+    size_t               reserved = 0;
+
+    /* Small chunks, so that strings spill over several of them */
+    rstring_arena_init(&arena, 256);
+
+    for (int round = 0; round < 3; ++round)
+    {
+        for (size_t i = 0; i < 50; ++i)
+        {
+            rstring_init_with_allocator(&strings[i], &arena.allocator);
+        }
+
+        /* Interleaved growth: only the most recent buffer grows in place */
+        for (size_t n = 0; n < 400; n += 40)
+        {
+            for (size_t i = 0; i < 50; ++i)
+            {
+                push_many(__FUNCTION__, &strings[i], 40 + i % 3);
+            }
+        }
+
+        for (size_t i = 0; i < 50; ++i)
+        {
+            check_alphabet(__FUNCTION__, &strings[i], 10 * (40 + i % 3));
+        }
+
+        /* A string larger than a chunk gets a chunk of its own */
+        struct rstring big;
+        rstring_init_with_allocator(&big, &arena.allocator);
+        push_many(__FUNCTION__, &big, 5000);
+        check_alphabet(__FUNCTION__, &big, 5000);
+        rstring_free(&big);
+
+        /* Released all at once, the chunks are reused by the next round */
+        rstring_arena_reset(&arena);
+        if (round == 0)
+        {
+            reserved = arena.reserved;
+        }
+        else if (arena.reserved != reserved)
+        {
+            test_fail(__FUNCTION__, "%zu bytes reserved, then %zu", reserved,
+                      arena.reserved);
+        }
+    }
+
+    rstring_arena_free(&arena);
+    if (reserved < 5000 || arena.reserved != 0)
+    {
+        test_fail(__FUNCTION__, "%zu bytes reserved, %zu after free", reserved,
+                  arena.reserved);
+    }
+}
+
+static void
+pool_test(void)
+{
+    struct rstring_pool pool;
+    struct rstring      strings[20];
+    const char         *first_buffer = NULL;
+
+    rstring_pool_init(&pool, 0);
+
+    for (size_t i = 0; i < 20; ++i)
+    {
+        rstring_init_with_allocator(&strings[i], &pool.allocator);
+        push_many(__FUNCTION__, &strings[i], 30 + i * 50);
+    }
+
+    for (size_t i = 0; i < 20; ++i)
+    {
+        check_alphabet(__FUNCTION__, &strings[i], 30 + i * 50);
+    }
+
+    /* A freed buffer is reused by the next string of the same size class */
+    first_buffer = rstring_data(&strings[0]);
+    rstring_free(&strings[0]);
+    push_many(__FUNCTION__, &strings[0], 30);
+    if (rstring_data(&strings[0]) != first_buffer)
+    {
+        test_fail(__FUNCTION__, "freed buffer was not reused");
+    }
+
+    for (size_t i = 0; i < 20; ++i)
+    {
+        rstring_free(&strings[i]);
+    }
+
+    rstring_pool_reset(&pool);
+
+    for (size_t i = 0; i < 20; ++i)
+    {
+        rstring_init_with_allocator(&strings[i], &pool.allocator);
+        push_many(__FUNCTION__, &strings[i], 100 + i);
+        check_alphabet(__FUNCTION__, &strings[i], 100 + i);
+    }
+
+    rstring_pool_free(&pool);
+}
+
+int
+main()
+{
+    custom_allocator_test();
+    arena_test();
+    pool_test();
+    return 0;
+}
@@ -0,0 +1,207 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static void
+check_view(const char *test_name, struct rstring_view view,
+           const char *expected, size_t expected_len)
+{
+    if (!rstring_view_equals(view,
+                             rstring_view_from_buf(expected, expected_len)))
+    {
+        test_fail(test_name,
+                  "view is '%.*s' (len %zu), expected '%s'",
+                  (int) view.len,
+                  view.ptr,
+                  view.len,
+                  expected);
+    }
+}
+
+static void
+slice_test(void)
+{
+    struct rstring rs;
+
+    rstring_init(&rs);
+    rstring_push_str(&rs, "hello, world");
+
+    const struct rstring_view all = rstring_view_from(&rs);
+    check_view(__FUNCTION__, all, "hello, world", 12);
+    check_view(__FUNCTION__, rstring_slice(&rs, 7, 5), "world", 5);
+    check_view(__FUNCTION__, rstring_slice(&rs, 7, SIZE_MAX), "world", 5);
+    check_view(__FUNCTION__, rstring_slice(&rs, 7, 100), "world", 5);
+    check_view(__FUNCTION__, rstring_slice(&rs, 100, 5), "", 0);
+    check_view(__FUNCTION__, rstring_view_prefix(all, 5), "hello", 5);
+    check_view(__FUNCTION__, rstring_view_prefix(all, 50), "hello, world", 12);
+    check_view(__FUNCTION__, rstring_view_suffix(all, 5), "world", 5);
+    check_view(__FUNCTION__, rstring_view_suffix(all, 50), "hello, world", 12);
+
+    /* Slices of slices are relative to the outer slice */
+    const struct rstring_view world = rstring_slice(&rs, 7, 5);
+    check_view(__FUNCTION__, rstring_view_slice(world, 1, 3), "orl", 3);
+
+    if (rstring_slice(&rs, 100, 5).ptr != rstring_data(&rs) + rs.len)
+    {
+        test_fail(__FUNCTION__, "clamped slice does not point at the end");
+    }
+
+    rstring_free(&rs);
+}
+
+static void
+cmp_test(void)
+{
+    const struct rstring_view abc    = rstring_view_from_str("abc");
+    const struct rstring_view abcd   = rstring_view_from_str("abcd");
+    const struct rstring_view ABC    = rstring_view_from_str("ABC");
+    const struct rstring_view empty  = rstring_view_from_buf(NULL, 0);
+    const struct rstring_view nul1   = rstring_view_from_buf("a\0b", 3);
+    const struct rstring_view nul2   = rstring_view_from_buf("a\0c", 3);
+    struct rstring            rs_abc = {0};
+
+    rstring_push_str(&rs_abc, "abc");
+
+    if (rstring_view_cmp(abc, abcd) >= 0 || rstring_view_cmp(abcd, abc) <= 0)
+    {
+        test_fail(__FUNCTION__, "a prefix must order first");
+    }
+
+    if (rstring_view_cmp(empty, abc) >= 0 || rstring_view_cmp(empty, empty))
+    {
+        test_fail(__FUNCTION__, "empty view ordering");
+    }
+
+    if (rstring_view_cmp(nul1, nul2) >= 0 || rstring_view_equals(nul1, nul2))
+    {
+        test_fail(__FUNCTION__, "bytes after a null byte must be compared");
+    }
+
+    if (rstring_view_equals(abc, ABC)
+        || !rstring_view_equals_ignore_case(abc, ABC)
+        || rstring_view_cmp_ignore_case(ABC, abcd) >= 0
+        || rstring_view_equals_ignore_case(abc, abcd))
+    {
+        test_fail(__FUNCTION__, "ignore case comparison");
+    }
+
+    if (!rstring_equals_view(&rs_abc, abc)
+        || rstring_cmp_view(&rs_abc, abcd) >= 0
+        || !rstring_equals_view_ignore_case(&rs_abc, ABC)
+        || rstring_cmp_view_ignore_case(&rs_abc, ABC) != 0)
+    {
+        test_fail(__FUNCTION__, "rstring to view comparison");
+    }
+
+    rstring_free(&rs_abc);
+}
+
+static void
+find_test(void)
+{
+    const struct rstring_view text =
+        rstring_view_from_str("GET /index.html HTTP/1.1");
+    const struct rstring_view path = rstring_view_slice(text, 4, 11);
+    struct rstring            rs   = {0};
+
+    check_view(__FUNCTION__, path, "/index.html", 11);
+
+    /* Offsets are relative to the view, and do not see outside of it */
+    if (rstring_view_find_first(path, rstring_view_from_str("html"), 0) != 7
+        || rstring_view_find_first(path, rstring_view_from_str("HTTP"), 0)
+               != RSTRING_NOT_FOUND
+        || rstring_view_find_first_ignore_case(
+               path, rstring_view_from_str("INDEX"), 0)
+               != 1
+        || rstring_view_find_first_byte(path, '.', 0) != 6
+        || rstring_view_find_first_byte(path, ' ', 0) != RSTRING_NOT_FOUND
+        || rstring_view_find_last_byte(path, '/', SIZE_MAX) != 0
+        || rstring_view_find_last(text, rstring_view_from_str("T"), SIZE_MAX)
+               != 18
+        || rstring_view_find_last_ignore_case(
+               text, rstring_view_from_str("t"), 17)
+               != 12)
+    {
+        test_fail(__FUNCTION__, "wrong offset in view");
+    }
+
+    rstring_push_view(&rs, text);
+    if (rstring_find_first_view(&rs, path, 0) != 4
+        || rstring_find_first_view_ignore_case(
+               &rs, rstring_view_from_str("http"), 0)
+               != 16)
+    {
+        test_fail(__FUNCTION__, "wrong offset in rstring");
+    }
+
+    rstring_free(&rs);
+}
+
+static void
+push_view_test(void)
+{
+    struct rstring rs = {0};
+
+    /* Appending a slice of itself, while it moves from inline to the heap */
+    rstring_push_str(&rs, "0123456789");
+    rstring_push_view(&rs, rstring_slice(&rs, 0, SIZE_MAX));
+    rstring_push_view(&rs, rstring_slice(&rs, 5, 10));
+    check_view(__FUNCTION__,
+               rstring_view_from(&rs),
+               "012345678901234567895678901234",
+               30);
+
+    rstring_push_view(&rs, rstring_view_from_buf(NULL, 0));
+    if (rs.len != 30)
+    {
+        test_fail(__FUNCTION__, "empty view changed the length");
+    }
+
+    rstring_free(&rs);
+}
+
+static void
+tokenize_test(void)
+{
+    /* Splitting on commas without allocating anything */
+    const char *const expected[] = {"alpha", "", "beta", "gamma"};
+    struct rstring_view rest = rstring_view_from_str("alpha,,beta,gamma");
+    size_t              i    = 0;
+
+    for (;;)
+    {
+        const size_t comma = rstring_view_find_first_byte(rest, ',', 0);
+        const struct rstring_view token = rstring_view_prefix(rest, comma);
+
+        if (i == 4)
+        {
+            test_fail(__FUNCTION__, "too many tokens");
+        }
+
+        check_view(__FUNCTION__, token, expected[i], strlen(expected[i]));
+        ++i;
+
+        if (comma == RSTRING_NOT_FOUND)
+        {
+            break;
+        }
+        rest = rstring_view_slice(rest, comma + 1, SIZE_MAX);
+    }
+
+    if (i != 4)
+    {
+        test_fail(__FUNCTION__, "got %zu tokens, expected 4", i);
+    }
+}
+
+int
+main()
+{
+    slice_test();
+    cmp_test();
+    find_test();
+    push_view_test();
+    tokenize_test();
+    return 0;
+}
@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "common.h"
+
+static void
+check_tokens(const char *test_name, struct rstring_split *it,
+             const char *const *expected, size_t expected_count)
+{
+    struct rstring_view token;
+    size_t              count = 0;
+
+    while (rstring_split_next(it, &token))
+    {
+        if (count == expected_count)
+        {
+            test_fail(test_name, "more than %zu tokens", expected_count);
+        }
+
+        if (!rstring_view_equals(token, rstring_view_from_str(expected[count])))
+        {
+            test_fail(test_name,
+                      "token %zu is '%.*s', expected '%s'",
+                      count,
+                      (int) token.len,
+                      token.ptr,
+                      expected[count]);
+        }
+        ++count;
+    }
+
+    if (count != expected_count)
+    {
+        test_fail(test_name, "got %zu tokens, expected %zu", count,
+                  expected_count);
+    }
+
+    /* An exhausted iterator stays exhausted */
+    if (rstring_split_next(it, &token))
+    {
+        test_fail(test_name, "token produced after the end");
+    }
+}
+
+static void
+split_byte_test(void)
+{
+    struct rstring_split it;
+
+    const char *const csv[] = {"a", "bb", "", "ccc", ""};
+    rstring_split_init_byte(&it, rstring_view_from_str("a,bb,,ccc,"), ',');
+    check_tokens(__FUNCTION__, &it, csv, 5);
+
+    const char *const none[] = {"abc"};
+    rstring_split_init_byte(&it, rstring_view_from_str("abc"), ',');
+    check_tokens(__FUNCTION__, &it, none, 1);
+
+    const char *const empty[] = {""};
+    rstring_split_init_byte(&it, rstring_view_from_buf(NULL, 0), ',');
+    check_tokens(__FUNCTION__, &it, empty, 1);
+
+    /* Null bytes are ordinary delimiters */
+    const char *const nul[] = {"x", "y"};
+    rstring_split_init_byte(&it, rstring_view_from_buf("x\0y", 3), '\0');
+    check_tokens(__FUNCTION__, &it, nul, 2);
+}
+
+static void
+split_substring_test(void)
+{
+    struct rstring_split it;
+
+    const char *const crlf[] = {"GET / HTTP/1.1", "Host: x", "", ""};
+    rstring_split_init(
+        &it,
+        rstring_view_from_str("GET / HTTP/1.1\r\nHost: x\r\n\r\n"),
+        rstring_view_from_str("\r\n"));
+    check_tokens(__FUNCTION__, &it, crlf, 4);
+
+    /* Overlapping delimiters are consumed left to right */
+    const char *const aaa[] = {"", "", "a"};
+    rstring_split_init(
+        &it, rstring_view_from_str("aaaaa"), rstring_view_from_str("aa"));
+    check_tokens(__FUNCTION__, &it, aaa, 3);
+
+    const char *const whole[] = {"abc"};
+    rstring_split_init(
+        &it, rstring_view_from_str("abc"), rstring_view_from_str(""));
+    check_tokens(__FUNCTION__, &it, whole, 1);
+}
+
+static void
+split_any_test(void)
+{
+    struct rstring_split it;
+
+    const char *const words[] = {"one", "two", "", "three", "four", ""};
+    rstring_split_init_any(&it,
+                           rstring_view_from_str("one two\t\tthree\nfour "),
+                           rstring_view_from_str(" \t\n"));
+    check_tokens(__FUNCTION__, &it, words, 6);
+
+    /* Delimiters above 0x7F */
+    const char *const high[] = {"a", "b", "c"};
+    rstring_split_init_any(&it,
+                           rstring_view_from_str("a\xff" "b\x80" "c"),
+                           rstring_view_from_str("\x80\xff"));
+    check_tokens(__FUNCTION__, &it, high, 3);
+}
+
+static void
+find_first_of_random_test(void)
+{
+    struct rstring_byte_set set;
+    uint8_t                 members[8];
+    uint8_t                 buf[300];
+
+    srand(99);
+
+    for (int round = 0; round < 3000; ++round)
+    {
+        const size_t nmembers = (size_t) (rand() % 8);
+        const size_t len      = (size_t) (rand() % 300);
+        const size_t from     = (size_t) (rand() % 20);
+        size_t       expected = RSTRING_NOT_FOUND;
+
+        for (size_t i = 0; i < nmembers; ++i)
+        {
+            members[i] = (uint8_t) rand();
+        }
+        rstring_byte_set_init(
+            &set, rstring_view_from_buf((const char *) members, nmembers));
+
+        /* Sparse members, so that most rounds scan several blocks */
+        for (size_t i = 0; i < len; ++i)
+        {
+            buf[i] = (uint8_t) (rand() % 50 == 0 && nmembers
+                                    ? members[rand() % nmembers]
+                                    : rand());
+        }
+
+        for (size_t i = from; i < len && expected == RSTRING_NOT_FOUND; ++i)
+        {
+            for (size_t m = 0; m < nmembers; ++m)
+            {
+                if (buf[i] == members[m])
+                {
+                    expected = i;
+                }
+            }
+        }
+
+        const size_t result = rstring_view_find_first_of(
+            rstring_view_from_buf((const char *) buf, len), &set, from);
+
+        if (result != expected)
+        {
+            test_fail(__FUNCTION__,
+                      "round %d: expected %zu, got %zu",
+                      round,
+                      expected,
+                      result);
+        }
+    }
+}
+
+static void
+large_buffer_test(void)
+{
+    struct rstring       rs = {0};
+    struct rstring_split it;
+    struct rstring_view  token;
+    size_t               count = 0;
+    size_t               total = 0;
+
+    /* Records of growing length, separated by newlines */
+    for (size_t i = 0; i < 2000; ++i)
+    {
+        for (size_t j = 0; j < i % 97; ++j)
+        {
+            rstring_push_byte(&rs, (uint8_t) ('a' + j % 26));
+        }
+        rstring_push_byte(&rs, '\n');
+    }
+
+    rstring_split_init_any(
+        &it, rstring_view_from(&rs), rstring_view_from_str("\r\n"));
+    while (rstring_split_next(&it, &token))
+    {
+        if (count < 2000 && token.len != count % 97)
+        {
+            test_fail(__FUNCTION__,
+                      "record %zu has length %zu, expected %zu",
+                      count,
+                      token.len,
+                      count % 97);
+        }
+        total += token.len;
+        ++count;
+    }
+
+    /* The trailing newline ends with an empty token */
+    if (count != 2001 || total + 2000 != rs.len)
+    {
+        test_fail(__FUNCTION__, "got %zu tokens of %zu bytes", count, total);
+    }
+
+    rstring_free(&rs);
+}
+
+int
+main()
+{
+    split_byte_test();
+    split_substring_test();
+    split_any_test();
+    find_first_of_random_test();
+    large_buffer_test();
+    return 0;
+}